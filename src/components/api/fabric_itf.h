@@ -222,6 +222,21 @@ class IFabric_op_completer {
    */
   virtual void wait_for_next_completion(std::chrono::milliseconds timeout) = 0;
 
+  /**
+   * Prepare to wait for the next completion alongside other file
+   * descriptors, e.g. in a caller's poll().
+   *
+   * @param fds Receives the file descriptors which become readable when a
+   * completion arrives
+   *
+   * @return true if fds were appended and the caller may block on them,
+   * false if a completion may already be pending (poll instead) or the
+   * endpoint cannot provide descriptors
+   *
+   * @throw IFabric_runtime_error - ::fi_control fail
+   */
+  virtual bool arm_completion_wait(std::vector<int> &fds) = 0;
+
   /**
    * Unblock any threads waiting on completions
    *
@@ -668,6 +683,16 @@ class IFabric_server_factory : public IFabric_passive_endpoint {
 	virtual IFabric_endpoint_unconnected_server *get_new_endpoint_unconnected() = 0;
 	virtual IFabric_server *open_connection(IFabric_endpoint_unconnected_server *) = 0;
 
+  /**
+   * File descriptor which is readable while a new connection is waiting
+   * to be taken by get_new_endpoint_unconnected. Allows a polling thread
+   * to block (poll/select) until a connection arrives. The caller must
+   * not read from the descriptor.
+   *
+   * @return File descriptor
+   */
+  virtual int new_endpoint_fd() const noexcept = 0;
+
   /**
    * Close connection and release any associated resources
    *
@@ -718,6 +743,15 @@ class IFabric_server_grouped_factory : public IFabric_passive_endpoint {
 	virtual IFabric_endpoint_unconnected_server *get_new_endpoint_unconnected() = 0;
 	virtual IFabric_server_grouped *open_connection(IFabric_endpoint_unconnected_server *) = 0;
 
+  /**
+   * File descriptor which is readable while a new connection is waiting
+   * to be taken by get_new_endpoint_unconnected. The caller must not read
+   * from the descriptor.
+   *
+   * @return File descriptor
+   */
+  virtual int new_endpoint_fd() const noexcept = 0;
+
   /**
    * Close connection and release any associated resources
    *
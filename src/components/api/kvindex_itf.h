@@ -40,16 +40,51 @@ class IKVIndex : public component::IBase {
     FIND_TYPE_EXACT  = 0x2, /*< perform exact match comparison on key */
     FIND_TYPE_REGEX  = 0x3, /*< apply as regular expression */
     FIND_TYPE_PREFIX = 0x4, /*< match prefix only */
+    FIND_TYPE_RANGE  = 0x5, /*< keys in [from, to), see make_range_expression */
   } find_t;
 
   inline static find_t convert_find_type(int i)
   {
-    static const find_t array[] = {FIND_TYPE_NONE, FIND_TYPE_NEXT, FIND_TYPE_EXACT, FIND_TYPE_REGEX, FIND_TYPE_PREFIX};
+    static const find_t array[] = {FIND_TYPE_NONE, FIND_TYPE_NEXT, FIND_TYPE_EXACT, FIND_TYPE_REGEX, FIND_TYPE_PREFIX,
+                                   FIND_TYPE_RANGE};
     assert(i > 0);
-    if (i > 4) throw API_exception("out of enum bounds");
+    if (i > 5) throw API_exception("out of enum bounds");
     return array[i];
   }
 
+  /**
+   * Build the key expression for FIND_TYPE_RANGE. The bounds are
+   * separated by a NUL character, so keys containing NUL cannot be
+   * used as bounds.
+   *
+   * @param from Inclusive lower bound
+   * @param to Exclusive upper bound; empty for no upper bound
+   *
+   * @return Key expression
+   */
+  inline static std::string make_range_expression(const std::string& from, const std::string& to)
+  {
+    std::string expr(from);
+    expr += '\0';
+    expr += to;
+    return expr;
+  }
+
+  /**
+   * Split a FIND_TYPE_RANGE key expression into its bounds
+   *
+   * @param expr Key expression from make_range_expression
+   * @param out_from Inclusive lower bound
+   * @param out_to Exclusive upper bound; empty for no upper bound
+   */
+  inline static void split_range_expression(const std::string& expr, std::string& out_from, std::string& out_to)
+  {
+    const auto sep = expr.find('\0');
+    if (sep == std::string::npos) throw API_exception("range expression has no upper bound separator");
+    out_from = expr.substr(0, sep);
+    out_to   = expr.substr(sep + 1);
+  }
+
   using offset_t = uint64_t;
 
 
@@ -105,9 +140,14 @@ class IKVIndex : public component::IBase {
   /**
    * Perform a key search
    *
+   * FIND_TYPE_PREFIX and FIND_TYPE_RANGE use the ordering of the index:
+   * the first key at or after begin_position which is not below the
+   * lower bound is either the match or, if it is out of the range, ends
+   * the search with E_FAIL, at a cost of O(log n) rather than a scan.
+   *
    * @param key_expression Key expression to match on
    * @param begin_position Position from which to start from. Counting from 0.
-   * @param find_type FIND_TYPE_NEXT, ..EXACT, ..REGEX, ..PREFIX
+   * @param find_type FIND_TYPE_NEXT, ..EXACT, ..REGEX, ..PREFIX, ..RANGE
    * @param out_matched_position [out] Position of the match
    * @param out_matched_key Matching key result
    * @param max_comparisons Maximum number of comparisons
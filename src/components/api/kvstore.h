@@ -30,6 +30,7 @@
 #include <map>
 #include <list>
 #include <mutex>
+#include <string>
 #include <vector>
 
 namespace nupm
@@ -82,6 +83,19 @@ protected:
   using string_view_key = string_view_byte;
   using string_view_value = string_view_byte;
 
+  /* A string_view_key from a std::string, and the reverse. The string_view_key
+   * overloads below default to the std::string forms, at the cost of a copy;
+   * stores which hold keys natively (hstore, mapstore) override them.
+   */
+  static string_view_key to_key_view(const std::string& key)
+  {
+    return string_view_key(static_cast<const byte*>(static_cast<const void*>(key.data())), key.size());
+  }
+  static std::string to_key_string(const string_view_key key)
+  {
+    return std::string(static_cast<const char*>(static_cast<const void*>(key.data())), key.size());
+  }
+
   static constexpr memory_handle_t HANDLE_NONE = nullptr; /* old name */
   static constexpr memory_handle_t MEMORY_HANDLE_NONE = nullptr; /* better name */
   static constexpr key_t           KEY_NONE    = nullptr;
@@ -109,6 +123,13 @@ protected:
   static constexpr flags_t FLAGS_NO_RESIZE     = 0x10; /* if size < existing size, do not resize */
   static constexpr flags_t FLAGS_MAX_VALUE     = 0x10;
 
+  /* create_pool: key hash algorithm, recorded in the pool and kept when it is reopened */
+  static constexpr flags_t FLAGS_HASH_CITY     = 0x000; /* CityHash64 (default) */
+  static constexpr flags_t FLAGS_HASH_WY       = 0x100; /* wyhash */
+  static constexpr flags_t FLAGS_HASH_CRC32C   = 0x200; /* CRC32C, crc32 instruction where available */
+  static constexpr flags_t FLAGS_HASH_MASK     = 0x300;
+  static constexpr unsigned FLAGS_HASH_SHIFT   = 8; /* (flags & FLAGS_HASH_MASK) >> FLAGS_HASH_SHIFT is a common::key_hash_t */
+
   using unlock_flags_t = std::uint32_t;
   static constexpr unlock_flags_t UNLOCK_FLAGS_NONE = 0x0;
   static constexpr unlock_flags_t UNLOCK_FLAGS_FLUSH = 0x1; /* indicates for PM backends to flush */
@@ -141,6 +162,8 @@ protected:
     MEMORY_TYPE              = 7, /* type of memory */
     MEMORY_SIZE              = 8, /* size of pool or store in bytes */
     NUMA_MASK                = 9, /* mask of first 64 numa nodes eligible for mapstore allocation */
+    NUMA_HITS                = 10, /* per numa node of a numa partitioned mapstore pool, in node order:
+                                     count of key lookups which found the key */
   };
 
   enum {
@@ -387,6 +410,18 @@ protected:
     return error_value(E_NOT_SUPPORTED, pool, key, value, value_len, flags);
   }
 
+  /**
+   * Write or overwrite an object value (see put above)
+   */
+  virtual status_t put(const pool_t          pool,
+                       const string_view_key key,
+                       const void*           value,
+                       const size_t          value_len,
+                       flags_t               flags = FLAGS_NONE)
+  {
+    return put(pool, to_key_string(key), value, value_len, flags);
+  }
+
   /**
    * Zero-copy put operation.  If there does not exist an object
    * with matching key, then an error E_KEY_EXISTS should be returned.
@@ -438,6 +473,19 @@ protected:
     );
   }
 
+  /**
+   * Zero-copy put operation (see put_direct above)
+   */
+  virtual status_t put_direct(const pool_t          pool,
+                              const string_view_key key,
+                              const void*           value,
+                              const size_t          value_len,
+                              const memory_handle_t handle = MEMORY_HANDLE_NONE,
+                              flags_t               flags  = FLAGS_NONE)
+  {
+    return put_direct(pool, to_key_string(key), value, value_len, handle, flags);
+  }
+
   /**
    * Resize memory for a value
    *
@@ -460,6 +508,17 @@ protected:
     return error_value(E_NOT_SUPPORTED, pool, key, new_size, alignment);
   }
 
+  /**
+   * Resize memory for a value (see resize_value above)
+   */
+  virtual status_t resize_value(const pool_t          pool,
+                                const string_view_key key,
+                                const size_t          new_size,
+                                const size_t          alignment)
+  {
+    return resize_value(pool, to_key_string(key), new_size, alignment);
+  }
+
   /**
    * Read an object value
    *
@@ -475,6 +534,17 @@ protected:
                        void*&             out_value, /* release with free_memory() API */
                        size_t&            out_value_len) = 0;
 
+  /**
+   * Read an object value (see get above)
+   */
+  virtual status_t get(const pool_t          pool,
+                       const string_view_key key,
+                       void*&                out_value, /* release with free_memory() API */
+                       size_t&               out_value_len)
+  {
+    return get(pool, to_key_string(key), out_value, out_value_len);
+  }
+
   /**
    * Read an object value directly into client-provided memory.
    *
@@ -500,6 +570,18 @@ protected:
     return error_value(E_NOT_SUPPORTED, pool, key, out_value, out_value_len, handle);
   }
 
+  /**
+   * Read an object value directly into client-provided memory (see get_direct above)
+   */
+  virtual status_t get_direct(pool_t                pool,
+                              const string_view_key key,
+                              void*                 out_value,
+                              size_t&               out_value_len,
+                              memory_handle_t       handle = HANDLE_NONE)
+  {
+    return get_direct(pool, to_key_string(key), out_value, out_value_len, handle);
+  }
+
   /**
    * Get attribute for key or pool (see enum Attribute)
    *
@@ -515,6 +597,18 @@ protected:
                                  std::vector<uint64_t>& out_value,
                                  const std::string*     key = nullptr) = 0;
 
+  /**
+   * Get attribute for key (see get_attribute above)
+   */
+  virtual status_t get_attribute(pool_t                 pool,
+                                 Attribute              attr,
+                                 std::vector<uint64_t>& out_value,
+                                 const string_view_key  key)
+  {
+    const auto k = to_key_string(key);
+    return get_attribute(pool, attr, out_value, &k);
+  }
+
   /**
    * Atomically (crash-consistent for pmem) swap keys (K,V)(K',V') -->
    * (K,V')(K',V).  Before calling this API, both KV-pairs must be
@@ -642,6 +736,21 @@ protected:
                        out_key_handle, out_key_ptr);
   }
 
+  /**
+   * Take a lock on an object (see lock above)
+   */
+  virtual status_t lock(const pool_t          pool,
+                        const string_view_key key,
+                        const lock_type_t     type,
+                        void*&                out_value,
+                        size_t&               inout_value_len,
+                        size_t                alignment,
+                        key_t&                out_key_handle,
+                        const char**          out_key_ptr = nullptr)
+  {
+    return lock(pool, to_key_string(key), type, out_value, inout_value_len, alignment, out_key_handle, out_key_ptr);
+  }
+
   /**
    * Unlock a key-value pair
    *
@@ -680,6 +789,17 @@ protected:
     return error_value(E_NOT_SUPPORTED, pool, key, op_vector, take_lock);
   }
 
+  /**
+   * Update an existing value by applying a series of operations (see atomic_update above)
+   */
+  virtual status_t atomic_update(const pool_t                   pool,
+                                 const string_view_key          key,
+                                 const std::vector<Operation*>& op_vector,
+                                 bool                           take_lock = true)
+  {
+    return atomic_update(pool, to_key_string(key), op_vector, take_lock);
+  }
+
   /**
    * Erase an object
    *
@@ -690,6 +810,107 @@ protected:
    */
   virtual status_t erase(pool_t pool, const std::string& key) = 0;
 
+  /**
+   * Erase an object (see erase above)
+   */
+  virtual status_t erase(pool_t pool, const string_view_key key)
+  {
+    return erase(pool, to_key_string(key));
+  }
+
+  /**
+   * Read several object values directly into client-provided memory. A
+   * store may interleave the lookups so that the memory misses of
+   * independent keys overlap; the default reads one key at a time.
+   *
+   * @param pool Pool handle
+   * @param keys Object keys
+   * @param inout_values [in] buffer for each value [out] size of each value (see get_direct)
+   * @param out_status Result for each key, as from get_direct
+   *
+   * @return S_OK if each key was read (see out_status), E_POOL_NOT_FOUND,
+   * E_INVAL if the spans differ in length
+   */
+  virtual status_t multi_get(pool_t                           pool,
+                             gsl::span<const string_view_key> keys,
+                             gsl::span<::iovec>               inout_values,
+                             gsl::span<status_t>              out_status)
+  {
+    if (keys.size() != inout_values.size() || keys.size() != out_status.size()) return E_INVAL;
+    auto v = inout_values.begin();
+    auto s = out_status.begin();
+    for (const auto& key : keys) {
+      *s++ = get_direct(pool, key, v->iov_base, v->iov_len);
+      ++v;
+    }
+    return S_OK;
+  }
+
+  /**
+   * Write or overwrite several objects (see multi_get above)
+   *
+   * @param pool Pool handle
+   * @param keys Object keys
+   * @param values Value for each key
+   * @param flags Optional flags, applied to each put
+   * @param out_status Result for each key, as from put
+   *
+   * @return S_OK if each key was written (see out_status), E_POOL_NOT_FOUND,
+   * E_INVAL if the spans differ in length
+   */
+  virtual status_t multi_put(pool_t                             pool,
+                             gsl::span<const string_view_key>   keys,
+                             gsl::span<const string_view_value> values,
+                             flags_t                            flags,
+                             gsl::span<status_t>                out_status)
+  {
+    if (keys.size() != values.size() || keys.size() != out_status.size()) return E_INVAL;
+    auto v = values.begin();
+    auto s = out_status.begin();
+    for (const auto& key : keys) {
+      *s++ = put(pool, key, v->data(), v->size(), flags);
+      ++v;
+    }
+    return S_OK;
+  }
+
+  /**
+   * Lock several objects (see lock and multi_get above)
+   *
+   * @param pool Pool handle
+   * @param keys Object keys
+   * @param type STORE_LOCK_READ | STORE_LOCK_WRITE
+   * @param inout_values [in] length of value space to create for each key
+   * [out] pointer to and length of each value, if locked
+   * @param alignment Alignment of new value space in bytes
+   * @param out_key_handles Handle for unlock of each key, KEY_NONE if not locked
+   * @param out_status Result for each key, as from lock
+   *
+   * @return S_OK if each lock was attempted (see out_status), E_POOL_NOT_FOUND,
+   * E_INVAL if the spans differ in length
+   */
+  virtual status_t multi_lock(pool_t                           pool,
+                              gsl::span<const string_view_key> keys,
+                              lock_type_t                      type,
+                              gsl::span<::iovec>               inout_values,
+                              size_t                           alignment,
+                              gsl::span<key_t>                 out_key_handles,
+                              gsl::span<status_t>              out_status)
+  {
+    if (keys.size() != inout_values.size() || keys.size() != out_key_handles.size() ||
+        keys.size() != out_status.size())
+      return E_INVAL;
+    auto v = inout_values.begin();
+    auto h = out_key_handles.begin();
+    auto s = out_status.begin();
+    for (const auto& key : keys) {
+      *h = KEY_NONE;
+      *s++ = lock(pool, key, type, v->iov_base, v->iov_len, alignment, *h++);
+      ++v;
+    }
+    return S_OK;
+  }
+
   /**
    * Return number of objects in the pool
    *
@@ -753,6 +974,91 @@ protected:
     return error_value(E_NOT_SUPPORTED, pool, function);
   }
 
+  /**
+   * Position of a chunked map over one partition of a pool (see
+   * map_partition). A default-constructed cursor is at the start of its
+   * partition.
+   */
+  struct map_cursor_t {
+    map_cursor_t() : started(false), position(0), mark(0) {}
+    bool     started;
+    uint64_t position; /* implementation-defined */
+    uint64_t mark;     /* implementation-defined, to detect a disturbed cursor */
+  };
+
+  /**
+   * Runs a task, now or later, on a thread of its choosing (see map_parallel)
+   */
+  using executor_t = std::function<void(std::function<void()> task)>;
+
+  /**
+   * Apply functor to the objects of one of partition_count partitions of
+   * the pool, at most about max_objects objects per call, so that a caller
+   * (e.g., a shard) can interleave a long map with other work. The
+   * partitions are disjoint and together cover the pool.
+   *
+   * Objects added or erased between calls may or may not be visited. A
+   * change to the layout of the pool between calls (e.g., a resize)
+   * disturbs the cursor; the partition can be mapped again with a fresh
+   * cursor.
+   *
+   * @param pool Pool handle
+   * @param partition Partition to map, less than partition_count
+   * @param partition_count Number of partitions
+   * @param cursor [in-out] Position within the partition
+   * @param max_objects Objects to visit in this call (a hint)
+   * @param function Functor to apply. If functor returns < 0, the map of
+   *                 the partition ends
+   *
+   * @return S_OK (partition done), S_MORE (call again with the same cursor),
+   *   E_INVAL, E_POOL_NOT_FOUND, E_ITERATOR_DISTURBED, E_NOT_SUPPORTED
+   */
+  virtual status_t map_partition(const pool_t   pool,
+                                 const unsigned partition,
+                                 const unsigned partition_count,
+                                 map_cursor_t&  cursor,
+                                 const size_t   max_objects,
+                                 std::function<int(const void* key,
+                                                   const size_t key_len,
+                                                   const void* value,
+                                                   const size_t value_len)> function)
+  {
+    return error_value(E_NOT_SUPPORTED, pool, partition, partition_count, cursor, max_objects, function);
+  }
+
+  /**
+   * Apply functor to all objects in the pool, split into partition_count
+   * partitions mapped concurrently. Each partition is mapped on a thread
+   * of its own (the first on the calling thread) or, if an executor is
+   * given, by tasks passed to the executor. Once a partition is done,
+   * merge is called for it on the calling thread: in partition order if
+   * ordered, else in order of completion. The pool must not be modified
+   * during the map.
+   *
+   * @param pool Pool handle
+   * @param partition_count Number of partitions
+   * @param function Functor to apply, concurrently for different
+   *                 partitions. If functor returns < 0, then map aborts
+   * @param merge Called once for each partition (may be empty)
+   * @param ordered Call merge in partition order
+   * @param executor Runs partition tasks (may be empty)
+   *
+   * @return S_OK, E_INVAL, E_POOL_NOT_FOUND, E_NOT_SUPPORTED
+   */
+  virtual status_t map_parallel(const pool_t   pool,
+                                const unsigned partition_count,
+                                std::function<int(const unsigned partition,
+                                                  const void*    key,
+                                                  const size_t   key_len,
+                                                  const void*    value,
+                                                  const size_t   value_len)> function,
+                                std::function<void(const unsigned partition)> merge,
+                                const bool       ordered,
+                                executor_t       executor = executor_t())
+  {
+    return error_value(E_NOT_SUPPORTED, pool, partition_count, function, merge, ordered, executor);
+  }
+
   /*
      auto iter = open_pool_iterator(pool);
 
@@ -896,6 +1202,28 @@ protected:
     return error_value(E_NOT_SUPPORTED, pool, addr, size);
   }
 
+  /**
+   * Begin a group commit on a pool. Until the matching group_commit_end,
+   * the store may defer persistence work common to the operations on the
+   * pool, so their effects are durable only once group_commit_end returns.
+   * Callers must not acknowledge the operations of a group before then.
+   * Groups do not nest.
+   *
+   * @param pool Pool handle
+   *
+   * @return S_OK, E_POOL_NOT_FOUND, E_BUSY (group already open), E_NOT_SUPPORTED
+   */
+  virtual status_t group_commit_begin(const pool_t pool) { return error_value(E_NOT_SUPPORTED, pool); }
+
+  /**
+   * End a group commit: complete the deferred persistence work
+   *
+   * @param pool Pool handle
+   *
+   * @return S_OK, E_POOL_NOT_FOUND, E_INVAL (no group open), E_NOT_SUPPORTED
+   */
+  virtual status_t group_commit_end(const pool_t pool) { return error_value(E_NOT_SUPPORTED, pool); }
+
   /**
    * Perform control invocation on component
    *
@@ -23,9 +23,13 @@
 #include <common/string_view.h>
 #include <gsl/span>
 
+#include <algorithm> /* max, min */
 #include <array>
 #include <cstdint> /* uint16_t */
+#include <cstring> /* memset */
 #include <memory>
+#include <string>
+#include <vector>
 
 #define DECLARE_OPAQUE_TYPE(NAME)               \
   struct Opaque_##NAME {                        \
@@ -65,9 +69,125 @@ public:
         FLAGS_DONT_STOMP  = KVStore::FLAGS_DONT_STOMP,
         FLAGS_NO_RESIZE   = KVStore::FLAGS_NO_RESIZE,
         FLAGS_MAX_VALUE   = KVStore::FLAGS_MAX_VALUE,
+        FLAGS_HASH_CITY   = KVStore::FLAGS_HASH_CITY, /* create_pool */
+        FLAGS_HASH_WY     = KVStore::FLAGS_HASH_WY,
+        FLAGS_HASH_CRC32C = KVStore::FLAGS_HASH_CRC32C,
   };
 
 
+  /**
+   * Log-linear (HDR style) latency histogram.  Values below SUB_COUNT
+   * nanoseconds have a bucket each; above that every power of two is
+   * split into SUB_COUNT linear sub-buckets, so a reported value is
+   * within 1/SUB_COUNT of the recorded one.  Values at or beyond
+   * 2^MAX_BITS ns (about 68 seconds) saturate into the last bucket.
+   */
+  struct Latency_histogram {
+    static constexpr unsigned SUB_BITS     = 3;
+    static constexpr unsigned SUB_COUNT    = 1U << SUB_BITS;
+    static constexpr unsigned MAX_BITS     = 36;
+    static constexpr unsigned BUCKET_COUNT = (MAX_BITS - SUB_BITS + 1) * SUB_COUNT;
+
+    uint64_t count;  /*< samples recorded */
+    uint64_t sum_ns; /*< sum of samples, for the mean */
+    uint64_t max_ns; /*< largest sample */
+    uint32_t bucket[BUCKET_COUNT];
+
+    static unsigned bucket_index(uint64_t ns)
+    {
+      if (ns < SUB_COUNT) return unsigned(ns);
+      if (ns >= (uint64_t(1) << MAX_BITS)) ns = (uint64_t(1) << MAX_BITS) - 1;
+      const unsigned shift = unsigned(63 - __builtin_clzll(ns)) - SUB_BITS;
+      return (shift + 1) * SUB_COUNT + unsigned((ns >> shift) - SUB_COUNT);
+    }
+
+    /* smallest value which maps to bucket i */
+    static uint64_t bucket_floor(unsigned i)
+    {
+      if (i < SUB_COUNT) return i;
+      return uint64_t(SUB_COUNT + i % SUB_COUNT) << (i / SUB_COUNT - 1);
+    }
+
+    inline void record(uint64_t ns)
+    {
+      ++bucket[bucket_index(ns)];
+      ++count;
+      sum_ns += ns;
+      if (ns > max_ns) max_ns = ns;
+    }
+
+    /* add the samples of another histogram, e.g. of another shard */
+    void merge(const Latency_histogram& other)
+    {
+      for (unsigned i = 0; i != BUCKET_COUNT; ++i) bucket[i] += other.bucket[i];
+      count += other.count;
+      sum_ns += other.sum_ns;
+      if (other.max_ns > max_ns) max_ns = other.max_ns;
+    }
+
+    inline double mean() const { return count ? double(sum_ns) / double(count) : 0.0; }
+
+    /**
+     * Value at a given percentile
+     *
+     * @param pct Percentile in the range 0.0 to 100.0
+     *
+     * @return Highest value equivalent to the bucket holding the
+     * percentile, capped at the largest sample; 0 if empty
+     */
+    uint64_t percentile(double pct) const
+    {
+      if (count == 0) return 0;
+      const uint64_t rank = std::max(uint64_t(1), uint64_t(pct / 100.0 * double(count) + 0.5));
+      uint64_t seen = 0;
+      for (unsigned i = 0; i != BUCKET_COUNT; ++i) {
+        seen += bucket[i];
+        if (seen >= rank) {
+          const uint64_t top = i + 1 == BUCKET_COUNT ? max_ns : bucket_floor(i + 1) - 1;
+          return std::min(top, uint64_t(max_ns));
+        }
+      }
+      return max_ns;
+    }
+
+    void reset() { std::memset(static_cast<void *>(this), 0, sizeof *this); }
+  } __attribute__((packed));
+
+  /* request classes for which shard latencies are kept */
+  enum Latency_op : unsigned {
+    LATENCY_OP_PUT,        /*< put, including two-stage put */
+    LATENCY_OP_GET,        /*< get, including two-stage get */
+    LATENCY_OP_PUT_DIRECT, /*< put_direct locate/release */
+    LATENCY_OP_GET_DIRECT, /*< get_direct locate/release */
+    LATENCY_OP_ERASE,
+    LATENCY_OP_MULTI,      /*< batched put/get/erase */
+    LATENCY_OP_ADO,        /*< invoke_ado and invoke_put_ado */
+    LATENCY_OP_INFO,       /*< count, attributes, find and statistics */
+    LATENCY_OP_OTHER,      /*< pool operations, configure and the rest */
+    LATENCY_OP_COUNT,
+  };
+
+  /* server-side latencies for one request class */
+  struct Op_latency {
+    Latency_histogram wait;  /*< receipt to start of processing (queue wait) */
+    Latency_histogram store; /*< processing by the shard, including store access */
+    Latency_histogram total; /*< receipt to response; for ADO requests, to ADO completion */
+
+    void merge(const Op_latency& other)
+    {
+      wait.merge(other.wait);
+      store.merge(other.store);
+      total.merge(other.total);
+    }
+
+    void reset()
+    {
+      wait.reset();
+      store.reset();
+      total.reset();
+    }
+  } __attribute__((packed));
+
   /* per-shard statistics */
   struct Shard_stats {
     uint64_t op_request_count;
@@ -82,6 +202,18 @@ public:
     uint64_t op_failed_request_count;
     uint64_t last_op_count_snapshot;
     uint16_t client_count;
+    /* message drain per handler per shard tick */
+    uint64_t drain_tick_count;             /*< handler ticks which drained one or more messages */
+    uint64_t drain_msg_count;              /*< messages drained over all handler ticks */
+    uint64_t drain_max_depth;              /*< most messages drained in a single handler tick */
+    uint64_t drain_budget_count_exhausted; /*< drains cut short by the message count budget */
+    uint64_t drain_budget_time_exhausted;  /*< drains cut short by the time budget */
+    uint64_t idle_block_count;             /*< blocking waits by an idle shard */
+    /* group commit of puts and erases */
+    uint64_t group_commit_count;           /*< groups committed */
+    uint64_t group_commit_op_count;        /*< operations acknowledged at group commit */
+    /* latency histograms per request class, cleared by get_statistics(.., true) */
+    Op_latency latency[LATENCY_OP_COUNT];
 
   public:
     Shard_stats()
@@ -89,6 +221,10 @@ public:
       , op_put_count(0), op_get_count(0), op_put_direct_count(0), op_get_direct_count(0), op_get_twostage_count(0)
       , op_ado_count(0), op_erase_count(0), op_get_direct_offset_count(0)
       , op_failed_request_count(0), last_op_count_snapshot(0), client_count(0)
+      , drain_tick_count(0), drain_msg_count(0), drain_max_depth(0)
+      , drain_budget_count_exhausted(0), drain_budget_time_exhausted(0), idle_block_count(0)
+      , group_commit_count(0), group_commit_op_count(0)
+      , latency{}
     {
     }
   } __attribute__((packed));
@@ -273,6 +409,22 @@ public:
     return s;
   }
 
+  /**
+   * Asynchronously read a small object value (one that fits in a
+   * message). Several such reads may be in flight on one connection.
+   *
+   * @param pool Pool handle
+   * @param key Object key
+   * @param out_value Out value, valid once the handle completes
+   * @param out_handle Async work handle
+   *
+   * @return S_OK or error code
+   */
+  virtual status_t async_get(const IMCAS::pool_t pool,
+                             const std::string&  key,
+                             std::string&        out_value,
+                             async_handle_t&     out_handle) = 0;
+
   /**
    * Asynchronously read an object value directly into client-provided memory.
    *
@@ -353,10 +505,27 @@ public:
   virtual status_t check_async_completion(async_handle_t& handle) = 0;
 
   /**
-   * Perform key search based on regex or prefix
+   * Build a find expression for keys in [from, to)
+   *
+   * @param from Inclusive lower bound
+   * @param to Exclusive upper bound; empty for no upper bound
+   *
+   * @return Key expression for find/async_find
+   */
+  static std::string range_expression(const std::string& from, const std::string& to)
+  {
+    return "range:" + IKVIndex::make_range_expression(from, to);
+  }
+
+  /**
+   * Perform key search based on regex, prefix or range.  Prefix and
+   * range searches seek in the ordered index rather than testing every
+   * key; call again from out_matched_offset + 1 for the next match.
    *
    * @param pool Pool handle
-   * @param key_expression Regular expression or prefix (e.g. "prefix:carKey")
+   * @param key_expression "next:", "exact:<key>", "regex:<expr>",
+   * "prefix:<prefix>" (e.g. "prefix:sensor/2026-10-17/") or a range
+   * from range_expression
    * @param offset Offset from which to search
    * @param out_matched_offset Out offset of match
    * @param out_keys Out vector of matching keys
@@ -369,6 +538,168 @@ public:
                         offset_t&           out_matched_offset,
                         std::string&        out_matched_key) = 0;
 
+  /**
+   * Asynchronous form of find
+   *
+   * @param pool Pool handle
+   * @param key_expression Key expression, as for find
+   * @param offset Offset from which to search
+   * @param out_matched_offset Out offset of match, valid once the handle completes
+   * @param out_matched_key Out matching key, valid once the handle completes
+   * @param out_handle Async work handle
+   *
+   * @return S_OK or error code
+   */
+  virtual status_t async_find(const IMCAS::pool_t pool,
+                              const std::string&  key_expression,
+                              const offset_t      offset,
+                              offset_t&           out_matched_offset,
+                              std::string&        out_matched_key,
+                              async_handle_t&     out_handle) = 0;
+
+  /**
+   * Perform key search returning a batch of matches per round trip.  The
+   * server packs as many matching keys as fit in one response buffer, or
+   * up to limit keys, and returns the offset from which to continue.
+   *
+   * @param pool Pool handle
+   * @param key_expression Key expression, as for find
+   * @param offset Offset from which to search
+   * @param limit Maximum number of keys to return; 0 for as many as fit
+   * @param out_keys Out vector of matching keys (appended to)
+   * @param out_next_offset Out offset from which to continue
+   *
+   * @return S_MORE if the search should continue from out_next_offset,
+   * S_OK if it is complete, or error code
+   */
+  virtual status_t find_batch(const IMCAS::pool_t       pool,
+                              const std::string&        key_expression,
+                              const offset_t            offset,
+                              const unsigned            limit,
+                              std::vector<std::string>& out_keys,
+                              offset_t&                 out_next_offset) = 0;
+
+  /**
+   * Asynchronous form of find_batch.  check_async_completion returns the
+   * status find_batch would have returned.
+   *
+   * @param pool Pool handle
+   * @param key_expression Key expression, as for find
+   * @param offset Offset from which to search
+   * @param limit Maximum number of keys to return; 0 for as many as fit
+   * @param out_keys Out vector of matching keys, valid once the handle completes
+   * @param out_next_offset Out continuation offset, valid once the handle completes
+   * @param out_handle Async work handle
+   *
+   * @return S_OK or error code
+   */
+  virtual status_t async_find_batch(const IMCAS::pool_t       pool,
+                                    const std::string&        key_expression,
+                                    const offset_t            offset,
+                                    const unsigned            limit,
+                                    std::vector<std::string>& out_keys,
+                                    offset_t&                 out_next_offset,
+                                    async_handle_t&           out_handle) = 0;
+
+  /**
+   * Iterator over the keys matching an expression.  Keys arrive in
+   * batches (find_batch); the request for the next batch is issued as soon
+   * as the current one arrives, so that the caller consumes one batch while
+   * the next is in flight.
+   *
+   * e.g.
+   *   IMCAS::Key_stream keys(mcas, pool, "prefix:sensor/");
+   *   std::string k;
+   *   while (keys.next(k) == S_OK) ...
+   */
+  class Key_stream {
+   public:
+    Key_stream(IMCAS*              mcas,
+               const IMCAS::pool_t pool,
+               const std::string&  key_expression,
+               const unsigned      batch_limit = 0,
+               const offset_t      offset      = 0)
+        : _mcas(mcas),
+          _pool(pool),
+          _expression(key_expression),
+          _limit(batch_limit),
+          _current(),
+          _position(0),
+          _pending(),
+          _next_offset(offset),
+          _handle(nullptr),
+          _status(S_MORE)
+    {
+      issue();
+    }
+
+    Key_stream(const Key_stream&) = delete;
+    Key_stream& operator=(const Key_stream&) = delete;
+
+    ~Key_stream()
+    {
+      /* the in-flight request writes to _pending; wait for it */
+      if (_handle) wait();
+    }
+
+    /**
+     * Get the next matching key
+     *
+     * @param out_key Out key
+     *
+     * @return S_OK, E_EOF when there are no more keys, or error code
+     */
+    status_t next(std::string& out_key)
+    {
+      while (_position == _current.size()) {
+        if (!_handle) return _status == S_OK ? E_EOF : _status;
+
+        auto hr = wait();
+        if (hr != S_OK && hr != S_MORE) {
+          _status = hr;
+          return hr;
+        }
+        _status = hr;
+        _current.swap(_pending);
+        _pending.clear();
+        _position = 0;
+        if (hr == S_MORE) issue(); /* prefetch */
+      }
+      out_key = std::move(_current[_position++]);
+      return S_OK;
+    }
+
+   private:
+    void issue()
+    {
+      auto hr = _mcas->async_find_batch(_pool, _expression, _next_offset, _limit, _pending, _next_offset, _handle);
+      if (hr != S_OK) {
+        _handle = nullptr;
+        _status = hr;
+      }
+    }
+
+    status_t wait()
+    {
+      status_t hr;
+      while ((hr = _mcas->check_async_completion(_handle)) == E_BUSY)
+        ;
+      _handle = nullptr;
+      return hr;
+    }
+
+    IMCAS*                   _mcas;
+    const IMCAS::pool_t      _pool;
+    const std::string        _expression;
+    const unsigned           _limit;
+    std::vector<std::string> _current; /*< batch being consumed */
+    std::size_t              _position;
+    std::vector<std::string> _pending; /*< batch in flight */
+    offset_t                 _next_offset;
+    async_handle_t           _handle;
+    status_t                 _status; /*< S_MORE until the search completes or fails */
+  };
+
   /**
    * Erase an object asynchronously
    *
@@ -380,14 +711,92 @@ public:
    */
   virtual status_t async_erase(const IMCAS::pool_t pool, const std::string& key, async_handle_t& out_handle) = 0;
 
+  /**
+   * Put a batch of key-value pairs. Records are packed into as few
+   * messages as the IO buffer allows (normally one) and the shard
+   * stores them in a single pass.
+   *
+   * @param pool Pool handle
+   * @param keys Object keys
+   * @param values Values, one per key
+   * @param out_status Out per-key status
+   * @param flags Optional flags (applied to every put)
+   *
+   * @return S_OK if every put succeeded, otherwise the first failing
+   * per-key status; E_TOO_LARGE if a single record exceeds a message
+   */
+  virtual status_t put_batch(const IMCAS::pool_t          pool,
+                             gsl::span<const std::string> keys,
+                             gsl::span<const std::string> values,
+                             std::vector<status_t>&       out_status,
+                             const unsigned int           flags = IMCAS::FLAGS_NONE) = 0;
+
+  /**
+   * Get a batch of values. Values which do not fit in the batched
+   * response are re-fetched individually.
+   *
+   * @param pool Pool handle
+   * @param keys Object keys
+   * @param out_values Out values, one per key (empty on failure)
+   * @param out_status Out per-key status
+   *
+   * @return S_OK if every get succeeded, otherwise the first failing
+   * per-key status
+   */
+  virtual status_t get_batch(const IMCAS::pool_t          pool,
+                             gsl::span<const std::string> keys,
+                             std::vector<std::string>&    out_values,
+                             std::vector<status_t>&       out_status) = 0;
+
+  /**
+   * Erase a batch of keys
+   *
+   * @param pool Pool handle
+   * @param keys Object keys
+   * @param out_status Out per-key status
+   *
+   * @return S_OK if every erase succeeded, otherwise the first failing
+   * per-key status
+   */
+  virtual status_t erase_batch(const IMCAS::pool_t          pool,
+                               gsl::span<const std::string> keys,
+                               std::vector<status_t>&       out_status) = 0;
+
+  /**
+   * Asynchronous batch operations. The batch must fit in one message
+   * (E_TOO_LARGE otherwise). out_values and out_status must remain
+   * valid until check_async_completion returns other than E_BUSY. An
+   * async get does not re-fetch values which did not fit in the
+   * response; those keys report E_INSUFFICIENT_BUFFER.
+   */
+  virtual status_t async_put_batch(const IMCAS::pool_t          pool,
+                                   gsl::span<const std::string> keys,
+                                   gsl::span<const std::string> values,
+                                   std::vector<status_t>&       out_status,
+                                   async_handle_t&              out_handle,
+                                   const unsigned int           flags = IMCAS::FLAGS_NONE) = 0;
+
+  virtual status_t async_get_batch(const IMCAS::pool_t          pool,
+                                   gsl::span<const std::string> keys,
+                                   std::vector<std::string>&    out_values,
+                                   std::vector<status_t>&       out_status,
+                                   async_handle_t&              out_handle) = 0;
+
+  virtual status_t async_erase_batch(const IMCAS::pool_t          pool,
+                                     gsl::span<const std::string> keys,
+                                     std::vector<status_t>&       out_status,
+                                     async_handle_t&              out_handle) = 0;
+
   /**
    * Retrieve shard statistics
    *
    * @param out_stats
+   * @param reset_latency Clear the shard's latency histograms once they
+   * have been read, so that periodic scrapes see only the latest interval
    *
    * @return S_OK on success
    */
-  virtual status_t get_statistics(Shard_stats& out_stats) = 0;
+  virtual status_t get_statistics(Shard_stats& out_stats, bool reset_latency = false) = 0;
 
   /**
    * ADO_response data structure manages response data sent back from the ADO
@@ -714,7 +1123,7 @@ public:
    * @param src_nic_device      Client-side network device (e.g., mlx5_0, eth0)
    * @param src_ip_addr         Client-side IP address
    * @param dest_addr_with_port Server-side IP address and port (e.g. 10.0.0.21:11911, 9.1.75.6:11911:sockets)
-   * @param other               Other optional parameters (e.g. { "security":"tls:auth" })
+   * @param other               Other optional parameters (e.g. { "security":"tls:auth", "pipeline_window":16 })
    *
    * @return Pointer to IMCAS instance. Use release_ref() to close.
    */
@@ -737,7 +1146,7 @@ public:
    * @param owner                Owner information (not used)
    * @param dest_addr_with_port  Destination server IP address and port
    * @param nic_device           Local NIC device to use (e.g., mlx5_0, eth0)
-   * @param other                Other optional parameters (e.g. { "security":"tls:auth" })
+   * @param other                Other optional parameters (e.g. { "security":"tls:auth", "pipeline_window":16 })
    * 
    * @return Pointer to IMCAS instance. Use release_ref() to close.
    */
@@ -93,6 +93,7 @@ private:
 public:
   iob_free(Connection_handler *h_) : _h(h_) {}
   void operator()(Connection_handler::buffer_t *iob) { _h->free_buffer(iob); }
+  Connection_handler *handler() const { return _h; }
 };
 
 struct memory_registered {
@@ -179,6 +180,8 @@ protected:
           , common::p_fmt(&*iobs)
           , common::p_fmt(&*iobr)
           );
+    /* a posted response receive is routed to its slot, which is now ours */
+    if (iobr) iobr.get_deleter().handler()->rebind_response(iobr);
   }
 
   async_buffer_set_t()                           = delete;
@@ -205,7 +208,7 @@ struct async_buffer_set_simple : public async_buffer_set_t {
     }
 
     if (iobr) { /* check recv, clear and free on completion */
-      if (c->test_completion(&*iobr) == false) {
+      if (c->test_response(iobr) == false) {
         return E_BUSY;
       }
 
@@ -221,6 +224,282 @@ struct async_buffer_set_simple : public async_buffer_set_t {
   }
 };
 
+/* Two buffers plus the caller's value. Used for async get */
+struct async_buffer_set_get : public async_buffer_set_t {
+  std::string *_out_value;
+
+ public:
+  async_buffer_set_get(unsigned debug_level_, iob_ptr &&iobs_, iob_ptr &&iobr_, std::string *out_value_) noexcept
+    : async_buffer_set_t(debug_level_, std::move(iobs_), std::move(iobr_)),
+      _out_value(out_value_)
+  {
+  }
+  DELETE_COPY(async_buffer_set_get);
+  int move_along(Connection_handler *c) override
+  {
+    if (iobs) { /* check submission, clear and free on completion */
+      if (c->test_completion(&*iobs) == false) {
+        return E_BUSY;
+      }
+      iobs.reset(nullptr);
+    }
+
+    if (iobr) { /* check recv, clear and free on completion */
+      if (c->test_response(iobr) == false) {
+        return E_BUSY;
+      }
+
+      const auto response_msg = c->msg_recv<const mcas::protocol::Message_IO_response>(&*iobr, "ASYNC GET");
+
+      auto status = response_msg->get_status();
+      if (status == S_OK) {
+        _out_value->assign(response_msg->cdata(), response_msg->data_length());
+      }
+      iobr.reset(nullptr);
+      return status;
+    }
+    else {
+      throw API_exception("invalid async handle, task already completed?");
+    }
+  }
+};
+
+/* Two buffers plus the caller's match results. Used for async find */
+struct async_buffer_set_find : public async_buffer_set_t {
+  offset_t *   _out_matched_offset;
+  std::string *_out_matched_key;
+
+ public:
+  async_buffer_set_find(unsigned     debug_level_,
+                        iob_ptr &&   iobs_,
+                        iob_ptr &&   iobr_,
+                        offset_t *   out_matched_offset_,
+                        std::string *out_matched_key_) noexcept
+    : async_buffer_set_t(debug_level_, std::move(iobs_), std::move(iobr_)),
+      _out_matched_offset(out_matched_offset_),
+      _out_matched_key(out_matched_key_)
+  {
+  }
+  DELETE_COPY(async_buffer_set_find);
+  int move_along(Connection_handler *c) override
+  {
+    if (iobs) { /* check submission, clear and free on completion */
+      if (c->test_completion(&*iobs) == false) {
+        return E_BUSY;
+      }
+      iobs.reset(nullptr);
+    }
+
+    if (iobr) { /* check recv, clear and free on completion */
+      if (c->test_response(iobr) == false) {
+        return E_BUSY;
+      }
+
+      const auto response_msg = c->msg_recv<const mcas::protocol::Message_INFO_response>(&*iobr, "ASYNC FIND");
+
+      auto status = response_msg->get_status();
+      if (status == S_OK) {
+        *_out_matched_key    = response_msg->c_str();
+        *_out_matched_offset = response_msg->Offset();
+      }
+      iobr.reset(nullptr);
+      return status;
+    }
+    else {
+      throw API_exception("invalid async handle, task already completed?");
+    }
+  }
+};
+
+namespace
+{
+  /* Decode the key records of a FIND_KEY_BATCH response. Returns the
+   * response status, or E_FAIL if the records are malformed.
+   */
+  status_t unpack_find_batch(const mcas::protocol::Message_INFO_response *response_msg_,
+                             std::vector<std::string> *                   out_keys_,
+                             offset_t *                                   out_next_offset_)
+  {
+    const auto status = response_msg_->get_status();
+    if (status != S_OK && status != S_MORE) return status;
+
+    const auto end = response_msg_->key_records_end();
+    auto r = response_msg_->first_key_record();
+    for ( ; static_cast<const void *>(r) < static_cast<const void *>(end); r = r->next() ) {
+      if ( ! r->within(end) ) {
+        PWRN("%s: truncated key record in find batch response", __func__);
+        return E_FAIL;
+      }
+      out_keys_->push_back(r->skey());
+    }
+    *out_next_offset_ = response_msg_->Offset();
+    return status;
+  }
+}
+
+/* Two buffers plus the caller's batch results. Used for async find_batch */
+struct async_buffer_set_find_batch : public async_buffer_set_t {
+  std::vector<std::string> *_out_keys;
+  offset_t *                _out_next_offset;
+
+ public:
+  async_buffer_set_find_batch(unsigned                  debug_level_,
+                              iob_ptr &&                iobs_,
+                              iob_ptr &&                iobr_,
+                              std::vector<std::string> *out_keys_,
+                              offset_t *                out_next_offset_) noexcept
+    : async_buffer_set_t(debug_level_, std::move(iobs_), std::move(iobr_)),
+      _out_keys(out_keys_),
+      _out_next_offset(out_next_offset_)
+  {
+  }
+  DELETE_COPY(async_buffer_set_find_batch);
+  int move_along(Connection_handler *c) override
+  {
+    if (iobs) { /* check submission, clear and free on completion */
+      if (c->test_completion(&*iobs) == false) {
+        return E_BUSY;
+      }
+      iobs.reset(nullptr);
+    }
+
+    if (iobr) { /* check recv, clear and free on completion */
+      if (c->test_response(iobr) == false) {
+        return E_BUSY;
+      }
+
+      const auto response_msg = c->msg_recv<const mcas::protocol::Message_INFO_response>(&*iobr, "ASYNC FIND BATCH");
+
+      auto status = unpack_find_batch(response_msg, _out_keys, _out_next_offset);
+      iobr.reset(nullptr);
+      return status;
+    }
+    else {
+      throw API_exception("invalid async handle, task already completed?");
+    }
+  }
+};
+
+namespace
+{
+  /* Append batch records starting at first while they fit in the buffer.
+   * Returns the number of records appended.
+   */
+  std::size_t pack_multi_records(mcas::protocol::Message_IO_request *msg_,
+                                 std::size_t                         buffer_size_,
+                                 gsl::span<const std::string>        keys_,
+                                 gsl::span<const std::string>        values_,
+                                 std::size_t                         first_)
+  {
+    auto i = first_;
+    for ( ; i != keys_.size(); ++i )
+    {
+      const auto &k = keys_[i];
+      const void *v = nullptr;
+      std::size_t vlen = 0;
+      if ( ! values_.empty() )
+      {
+        v = values_[i].data();
+        vlen = values_[i].size();
+      }
+      if ( ! msg_->would_fit_record(buffer_size_, k.size(), vlen) ) break;
+      msg_->append_record(buffer_size_, k.data(), k.size(), v, vlen);
+    }
+    return i - first_;
+  }
+
+  /* Copy per-record results (and OP_MULTI_GET values) out of a batch
+   * response. Returns S_OK or the first failing record status.
+   */
+  status_t unpack_multi_response(const mcas::protocol::Message_IO_response *response_,
+                                 std::size_t                                first_,
+                                 std::size_t                                count_,
+                                 std::vector<status_t> &                    out_status_,
+                                 std::vector<std::string> *                 out_values_)
+  {
+    using multi_result = mcas::protocol::Message_IO_response::multi_result;
+    const auto results_len = count_ * sizeof(multi_result);
+    if ( response_->data_length() < results_len )
+      throw Protocol_exception("%s: batch response too short (%zu < %zu)", __func__, response_->data_length(), results_len);
+
+    const auto results = response_->rdata();
+    auto value = response_->cdata() + results_len;
+    const auto value_end = response_->cdata() + response_->data_length();
+    status_t status = S_OK;
+
+    for ( std::size_t i = 0; i != count_; ++i )
+    {
+      const status_t rc = results[i].status;
+      out_status_[first_ + i] = rc;
+      if ( rc == S_OK )
+      {
+        const std::size_t len = results[i].value_len;
+        if ( std::size_t(value_end - value) < len )
+          throw Protocol_exception("%s: batch response value overrun", __func__);
+        if ( out_values_ ) (*out_values_)[first_ + i].assign(value, len);
+        value += len;
+      }
+      else if ( status == S_OK )
+      {
+        status = rc;
+      }
+    }
+    return status;
+  }
+}
+
+/* Two buffers plus the caller's result vectors. Used for async batch operations */
+struct async_buffer_set_multi : public async_buffer_set_t {
+  std::size_t               _count;
+  std::vector<status_t> *   _out_status;
+  std::vector<std::string> *_out_values;
+
+ public:
+  async_buffer_set_multi(unsigned                  debug_level_,
+                         iob_ptr &&                iobs_,
+                         iob_ptr &&                iobr_,
+                         std::size_t               count_,
+                         std::vector<status_t> *   out_status_,
+                         std::vector<std::string> *out_values_)
+    : async_buffer_set_t(debug_level_, std::move(iobs_), std::move(iobr_)),
+      _count(count_),
+      _out_status(out_status_),
+      _out_values(out_values_)
+  {
+  }
+  DELETE_COPY(async_buffer_set_multi);
+  int move_along(Connection_handler *c) override
+  {
+    if (iobs) { /* check submission, clear and free on completion */
+      if (c->test_completion(&*iobs) == false) {
+        return E_BUSY;
+      }
+      iobs.reset(nullptr);
+    }
+
+    if (iobr) { /* check recv, clear and free on completion */
+      if (c->test_response(iobr) == false) {
+        return E_BUSY;
+      }
+
+      const auto response_msg = c->msg_recv<const mcas::protocol::Message_IO_response>(&*iobr, "ASYNC MULTI");
+
+      status_t status = response_msg->get_status();
+      if (status == S_OK) {
+        status = unpack_multi_response(response_msg, 0, _count, *_out_status, _out_values);
+      }
+      else {
+        std::fill(_out_status->begin(), _out_status->end(), status);
+      }
+      iobr.reset(nullptr);
+      return status;
+    }
+    else {
+      throw API_exception("invalid async handle, task already completed?");
+    }
+  }
+};
+
 struct async_buffer_set_get_locate
   : public async_buffer_set_t
   , public memory_registered {
@@ -303,14 +582,14 @@ public:
       const auto msg = new (iobs->base())
         protocol::Message_IO_request(_auth_id, c->request_id(), _pool, protocol::OP_TYPE::OP_GET_RELEASE, _addr);
 
-      c->post_recv(&*iobr);
+      c->post_response_recv(iobr, msg->request_id());
       c->sync_inject_send(&*iobs, msg, __func__);
       /* End */
     }
 
     if ( iobr )
       {
-        if ( ! c->test_completion(&*iobr) )
+        if ( ! c->test_response(iobr) )
           {
             return E_BUSY;
           }
@@ -421,7 +700,7 @@ public:
     }
 
     if (iobr) { /* check recv, clear and free on completion */
-      if (c->test_completion(&*iobr) == false) {
+      if (c->test_response(iobr) == false) {
         return E_BUSY;
       }
       /* What to do when first recv completes */
@@ -469,13 +748,13 @@ public:
       const auto msg = new (_iobs2->base())
         protocol::Message_IO_request(_auth_id, c->request_id(), _pool, protocol::OP_TYPE::OP_PUT_RELEASE, _addr);
 
-      c->post_recv(&*_iobr2);
+      c->post_response_recv(_iobr2, msg->request_id());
       c->sync_inject_send(&*_iobs2, msg, __func__);
       /* End */
     }
 
     if (_iobr2) {
-      if (!c->test_completion(&*_iobr2)) {
+      if (!c->test_response(_iobr2)) {
         return E_BUSY;
       }
       /* What to do when second recv completes */
@@ -515,7 +794,7 @@ public:
     }
 
     if (iobr) { /* check recv, clear and free on completion */
-      if (c->test_completion(&*iobr) == false) {
+      if (c->test_response(iobr) == false) {
         return E_BUSY;
       }
       return c->receive_and_process_ado_response(iobr, *out_ado_response);
@@ -599,7 +878,7 @@ public:
     }
 
     if (iobr) { /* check recv, clear and free on completion */
-      if (c->test_completion(&*iobr) == false) {
+      if (c->test_response(iobr) == false) {
         return E_BUSY;
       }
       /* What to do when first recv completes */
@@ -688,14 +967,14 @@ public:
       const auto msg = new (_iobs2->base()) protocol::Message_IO_request(
                                                                          _auth_id, c->request_id(), _pool, protocol::OP_TYPE::OP_RELEASE, _offset, _length);
 
-      c->post_recv(&*_iobr2);
+      c->post_response_recv(_iobr2, msg->request_id());
       c->sync_inject_send(&*_iobs2, msg, __func__);
       /* End */
     }
 
     /* release in process, or not needed because length is 0 */
     if ( _iobr2 ) {
-      if ( _iobr2 && ! c->test_completion(&*_iobr2) ) {
+      if ( _iobr2 && ! c->test_response(_iobr2) ) {
         return E_BUSY;
       }
       /* What to do when second recv completes */
@@ -783,7 +1062,7 @@ public:
     }
 
     if (iobr) { /* check recv, clear and free on completion */
-      if (c->test_completion(&*iobr) == false) {
+      if (c->test_response(iobr) == false) {
         return E_BUSY;
       }
       /* What to do when first recv completes */
@@ -877,13 +1156,13 @@ public:
       const auto msg = new (_iobs2->base()) protocol::Message_IO_request(
                                                                          _auth_id, c->request_id(), _pool, protocol::OP_TYPE::OP_RELEASE_WITH_FLUSH, _offset, _length);
 
-      c->post_recv(&*_iobr2);
+      c->post_response_recv(_iobr2, msg->request_id());
       c->sync_inject_send(&*_iobs2, msg, __func__);
       /* End */
     }
 
     if ( _iobr2 ) {
-      if ( ! c->test_completion(&*_iobr2) ) {
+      if ( ! c->test_response(_iobr2) ) {
         return E_BUSY;
       }
       /* What to do when second recv completes */
@@ -908,6 +1187,10 @@ Connection_handler::Connection_handler(const unsigned              debug_level,
 #endif
     _exit{false},
     _request_id{0},
+    _response_fifo{},
+    _awaiting{},
+    _held_for{},
+    _pipeline_window{1}, /* until the handshake reports the server's receive depth */
     _max_message_size{0},
     _max_inject_size(connection->max_inject_size()),
     _options()
@@ -943,6 +1226,12 @@ Connection_handler::Connection_handler(const unsigned              debug_level,
           _options.tls = true;
         }
       }
+
+      /* maximum number of outstanding requests */
+      auto pipeline_window = doc.FindMember("pipeline_window");
+      if(pipeline_window != doc.MemberEnd() && pipeline_window->value.IsUint()) {
+        _options.pipeline_window = pipeline_window->value.GetUint();
+      }
     }
     catch (...) {
       throw API_exception("extra configuration string parse failed");
@@ -990,7 +1279,7 @@ Connection_handler::pool_t Connection_handler::open_pool(const std::string name,
    *
    */
   const auto iobs = make_iob_ptr_send();
-  const auto iobr = make_iob_ptr_recv();
+  auto iobr = make_iob_ptr_recv();
   assert(iobs);
   assert(iobr);
 
@@ -1023,9 +1312,9 @@ Connection_handler::pool_t Connection_handler::open_pool(const std::string name,
      * a single template function.
      */
 
-    post_recv(&*iobr);
+    post_response_recv(iobr, 0); /* pool responses are not numbered */
     sync_inject_send(&*iobs, msg, __func__);
-    wait_for_completion(&*iobr); /* await response */
+    wait_for_response(iobr); /* await response */
 
     const auto response_msg = msg_recv<const mcas::protocol::Message_pool_response>(&*iobr, __func__);
 
@@ -1055,7 +1344,7 @@ Connection_handler::create_pool(const std::string  name,
 
   /* send pool request message */
   const auto iobs = make_iob_ptr_send();
-  const auto iobr = make_iob_ptr_recv();
+  auto iobr = make_iob_ptr_recv();
   assert(iobs);
   assert(iobr);
 
@@ -1074,9 +1363,9 @@ Connection_handler::create_pool(const std::string  name,
                                      base);
     assert(msg->op());
 
-    post_recv(&*iobr);
+    post_response_recv(iobr, 0); /* pool responses are not numbered */
     sync_inject_send(&*iobs, msg, __func__);
-    wait_for_completion(&*iobr);
+    wait_for_response(iobr);
 
     const auto response_msg = msg_recv<const mcas::protocol::Message_pool_response>(&*iobr, __func__);
 
@@ -1103,14 +1392,14 @@ status_t Connection_handler::close_pool(const pool_t pool)
   API_LOCK();
   /* send pool request message */
   const auto iobs = make_iob_ptr_send();
-  const auto iobr = make_iob_ptr_recv();
+  auto iobr = make_iob_ptr_recv();
   const auto msg  = new (iobs->base())
     mcas::protocol::Message_pool_request(iobs->length(), auth_id(), request_id(), mcas::protocol::OP_CLOSE, pool);
 
-  post_recv(&*iobr);
+  post_response_recv(iobr, 0); /* pool responses are not numbered */
   sync_inject_send(&*iobs, msg, __func__);
   try {
-    wait_for_completion(&*iobr);
+    wait_for_response(iobr);
 
     const auto response_msg = msg_recv<const mcas::protocol::Message_pool_response>(&*iobr, __func__);
 
@@ -1135,7 +1424,7 @@ status_t Connection_handler::delete_pool(const std::string &name)
   API_LOCK();
 
   const auto iobs = make_iob_ptr_send();
-  const auto iobr = make_iob_ptr_recv();
+  auto iobr = make_iob_ptr_recv();
 
   const auto msg = new (iobs->base())
     mcas::protocol::Message_pool_request(iobs->length(),
@@ -1148,10 +1437,10 @@ status_t Connection_handler::delete_pool(const std::string &name)
                                          0, // flags
                                          0); // base
 
-  post_recv(&*iobr);
+  post_response_recv(iobr, 0); /* pool responses are not numbered */
   sync_inject_send(&*iobs, msg, __func__);
   try {
-    wait_for_completion(&*iobr);
+    wait_for_response(iobr);
 
     const auto response_msg = msg_recv<const mcas::protocol::Message_pool_response>(&*iobr, __func__);
 
@@ -1174,15 +1463,15 @@ status_t Connection_handler::delete_pool(const IMCAS::pool_t pool)
   API_LOCK();
 
   const auto iobs = make_iob_ptr_send();
-  const auto iobr = make_iob_ptr_recv();
+  auto iobr = make_iob_ptr_recv();
 
   const auto msg = new (iobs->base())
     mcas::protocol::Message_pool_request(iobs->length(), auth_id(), request_id(), mcas::protocol::OP_DELETE, pool);
 
-  post_recv(&*iobr);
+  post_response_recv(iobr, 0); /* pool responses are not numbered */
   sync_inject_send(&*iobs, msg, __func__);
   try {
-    wait_for_completion(&*iobr);
+    wait_for_response(iobr);
 
     const auto response_msg = msg_recv<const mcas::protocol::Message_pool_response>(&*iobr, __func__);
 
@@ -1203,7 +1492,7 @@ status_t Connection_handler::configure_pool(const IMCAS::pool_t pool, const std:
   API_LOCK();
 
   const auto iobs = make_iob_ptr_send();
-  const auto iobr = make_iob_ptr_recv();
+  auto iobr = make_iob_ptr_recv();
 
   if (!mcas::protocol::Message_IO_request::would_fit(json.length(), iobs->original_length())) {
     return E_NO_MEM;
@@ -1213,10 +1502,10 @@ status_t Connection_handler::configure_pool(const IMCAS::pool_t pool, const std:
                                                                          mcas::protocol::OP_CONFIGURE,  // op
                                                                          json);
 
-  post_recv(&*iobr);
+  post_response_recv(iobr, msg->request_id());
   sync_inject_send(&*iobs, msg, __func__);
   try {
-    wait_for_completion(&*iobr);
+    wait_for_response(iobr);
     const auto response_msg = msg_recv<const mcas::protocol::Message_IO_response>(&*iobr, __func__);
 
     return response_msg->get_status();
@@ -1256,7 +1545,7 @@ status_t Connection_handler::put(const pool_t       pool,
   API_LOCK();
 
   const auto iobs = make_iob_ptr_send();
-  const auto iobr = make_iob_ptr_recv();
+  auto iobr = make_iob_ptr_recv();
 
   if (debug_level() > 1)
     PINF("put: %.*s (key_len=%lu) (value_len=%lu)", int(key_len), static_cast<const char *>(key), key_len, value_len);
@@ -1279,11 +1568,11 @@ status_t Connection_handler::put(const pool_t       pool,
 
     iobs->set_length(msg->msg_len());
 
-    post_recv(&*iobr);
+    post_response_recv(iobr, msg->request_id());
     sync_send(&*iobs, msg, __func__); /* this will clean up iobs */
     {
       TM_SCOPE(wait_recv)
-      wait_for_completion(&*iobr);
+      wait_for_response(iobr);
     }
 
     const auto response_msg = msg_recv<const mcas::protocol::Message_IO_response>(&*iobr, __func__);
@@ -1305,17 +1594,17 @@ status_t Connection_handler::put(const pool_t       pool,
 auto Connection_handler::locate(const pool_t pool_, const std::size_t offset_, const std::size_t size_)
   -> std::tuple<uint64_t, std::vector<locate_element>>
 {
-  const auto iobr = make_iob_ptr_recv();
+  auto iobr = make_iob_ptr_recv();
   const auto iobs = make_iob_ptr_send();
 
   /* send advance leader message */
   const auto msg = new (iobs->base())
     protocol::Message_IO_request(auth_id(), pool_, request_id(), protocol::OP_LOCATE, offset_, size_);
 
-  post_recv(&*iobr);
+  post_response_recv(iobr, msg->request_id());
   sync_inject_send(&*iobs, msg, __func__);
   /* wait for response from header before posting the value */
-  wait_for_completion(&*iobr);
+  wait_for_response(iobr);
 
   const auto response = msg_recv<const mcas::protocol::Message_IO_response>(&*iobr, __func__);
 
@@ -1361,7 +1650,7 @@ IMCAS::async_handle_t Connection_handler::put_locate_async(TM_ACTUAL const pool_
                                                                    iobs->length(), auth_id(), request_id(), pool, protocol::OP_PUT_LOCATE, key, key_len, values_size(values), flags);
   iobs->set_length(msg->msg_len());
 
-  post_recv(&*iobr);
+  post_response_recv(iobr, msg->request_id());
   post_send(iobs->iov, iobs->iov + 1, iobs->desc, &*iobs, msg, __func__);
 
   /*
@@ -1405,7 +1694,7 @@ IMCAS::async_handle_t Connection_handler::get_direct_offset_async(const pool_t
     protocol::Message_IO_request(auth_id(), request_id(), pool_, protocol::OP_LOCATE, offset_, len_);
   iobs->set_length(msg->msg_len());
 
-  post_recv(&*iobr);
+  post_response_recv(iobr, msg->request_id());
   post_send(iobs->iov, iobs->iov + 1, iobs->desc, &*iobs, msg, __func__);
 
   /*
@@ -1435,7 +1724,7 @@ IMCAS::async_handle_t Connection_handler::put_direct_offset_async(const pool_t
     protocol::Message_IO_request(auth_id(), request_id(), pool_, protocol::OP_LOCATE, offset_, length_);
   iobs->set_length(msg->msg_len());
 
-  post_recv(&*iobr);
+  post_response_recv(iobr, msg->request_id());
   post_send(iobs->iov, iobs->iov + 1, iobs->desc, &*iobs, msg, __func__);
 
   /*
@@ -1482,7 +1771,7 @@ Connection_handler::get_locate_async(TM_ACTUAL const pool_t
   TM_SCOPE(1)
   iobs->set_length(msg->msg_len());
 
-  post_recv(&*iobr);
+  post_response_recv(iobr, msg->request_id());
   post_send(iobs->iov, iobs->iov + 1, iobs->desc, &*iobs, msg, __func__);
 
   {
@@ -1493,7 +1782,7 @@ Connection_handler::get_locate_async(TM_ACTUAL const pool_t
 
   {
   TM_SCOPE(wait_recv)
-  wait_for_completion(&*iobr);
+  wait_for_response(iobr);
   }
   }
   const auto response_msg = msg_recv<const mcas::protocol::Message_IO_response>(&*iobr, "ASYNC GET_LOCATE");
@@ -1586,7 +1875,7 @@ status_t Connection_handler::async_put(const IMCAS::pool_t    pool,
     iobs->set_length(msg->msg_len());
 
     /* post both send and receive */
-    post_recv(&*iobr);
+    post_response_recv(iobr, msg->request_id());
     post_send(iobs->iov, iobs->iov + 1, iobs->desc, &*iobs, msg, __func__);
 
     out_handle = new async_buffer_set_simple(debug_level(), std::move(iobs), std::move(iobr));
@@ -1653,7 +1942,7 @@ status_t Connection_handler::async_put_direct(const IMCAS::pool_t
 
       if (_options.short_circuit_backend) msg->add_scbe();
 
-      post_recv(&*iobr);
+      post_response_recv(iobr, msg->request_id());
 
       iobs->set_length(msg->msg_len());
       iobs->iov[1].iov_base = const_cast<void*>(::base(values_.front()));
@@ -1778,7 +2067,7 @@ status_t Connection_handler::get(const pool_t pool, const std::string &key, std:
   }
 
   const auto iobs = make_iob_ptr_send();
-  const auto iobr = make_iob_ptr_recv();
+  auto iobr = make_iob_ptr_recv();
   assert(iobs);
   assert(iobr);
 
@@ -1792,9 +2081,9 @@ status_t Connection_handler::get(const pool_t pool, const std::string &key, std:
 
     if (_options.short_circuit_backend) msg->add_scbe();
 
-    post_recv(&*iobr);
+    post_response_recv(iobr, msg->request_id());
     sync_inject_send(&*iobs, msg, __func__);
-    wait_for_completion(&*iobr);
+    wait_for_response(iobr);
 
     const auto response_msg = msg_recv<const mcas::protocol::Message_IO_response>(&*iobr, __func__);
 #if 0
@@ -1832,7 +2121,7 @@ status_t Connection_handler::get(const pool_t pool, const std::string &key, std:
     }
 
     const auto iobs = make_iob_ptr_send();
-    const auto iobr = make_iob_ptr_recv();
+    auto iobr = make_iob_ptr_recv();
     assert(iobs);
     assert(iobr);
 
@@ -1851,11 +2140,11 @@ status_t Connection_handler::get(const pool_t pool, const std::string &key, std:
 
       if (_options.short_circuit_backend) msg->add_scbe();
 
-      post_recv(&*iobr);
+      post_response_recv(iobr, msg->request_id());
       sync_inject_send(&*iobs, msg, __func__);
       {
         TM_SCOPE(wait_recv)
-        wait_for_completion(&*iobr); /* TODO; could we issue the recv and send together? */
+        wait_for_response(iobr); /* TODO; could we issue the recv and send together? */
       }
 
       const auto response_msg = msg_recv<const mcas::protocol::Message_IO_response>(&*iobr, __func__);
@@ -1912,6 +2201,50 @@ status_t Connection_handler::get(const pool_t pool, const std::string &key, std:
     return status;
   }
 
+  status_t Connection_handler::async_get(const pool_t           pool,
+                                         const std::string &    key,
+                                         std::string &          out_value,
+                                         IMCAS::async_handle_t &out_async_handle)
+  {
+    API_LOCK();
+
+    auto iobs = make_iob_ptr_send();
+    auto iobr = make_iob_ptr_recv();
+
+    assert(iobs);
+    assert(iobr);
+
+    try {
+      const auto msg =
+        new (iobs->base()) mcas::protocol::Message_IO_request(iobs->length(), auth_id(), request_id(), pool,
+                                                              mcas::protocol::OP_GET,  // op
+                                                              key.c_str(), key.length(), 0);
+
+      /* a value too large for the response buffer fails with E_TOO_LARGE; use async_get_direct */
+      msg->set_availabe_val_len_from_iob_len(iobs->original_length());
+
+      if (_options.short_circuit_backend) msg->add_scbe();
+
+      iobs->set_length(msg->msg_len());
+
+      /* post both send and receive */
+      post_response_recv(iobr, msg->request_id());
+      post_send(iobs->iov, iobs->iov + 1, iobs->desc, &*iobs, msg, __func__);
+
+      out_async_handle = new async_buffer_set_get(debug_level(), std::move(iobs), std::move(iobr), &out_value);
+    }
+    catch (const Exception &e) {
+      PLOG("%s %s fail %s", __FILE__, __func__, e.cause());
+      throw Logic_exception("%s: network posting failed unexpectedly.", __func__);
+    }
+    catch (const std::exception &e) {
+      PLOG("%s %s fail %s", __FILE__, __func__, e.what());
+      throw Logic_exception("%s: network posting failed unexpectedly.", __func__);
+    }
+
+    return S_OK;
+  }
+
   status_t Connection_handler::get_direct(const pool_t                              pool_,
                                           const void *const                         key_,
                                           const size_t                              key_len_,
@@ -2049,7 +2382,7 @@ status_t Connection_handler::get(const pool_t pool, const std::string &key, std:
     API_LOCK();
 
     const auto iobs = make_iob_ptr_send();
-    const auto iobr = make_iob_ptr_recv();
+    auto iobr = make_iob_ptr_recv();
     assert(iobs);
     assert(iobr);
 
@@ -2058,9 +2391,9 @@ status_t Connection_handler::get(const pool_t pool, const std::string &key, std:
     try {
       const auto msg = new (iobs->base()) mcas::protocol::Message_IO_request(iobs->length(), auth_id(), request_id(), pool, mcas::protocol::OP_ERASE, key.c_str(), key.length(), 0);
 
-      post_recv(&*iobr);
+      post_response_recv(iobr, msg->request_id());
       sync_inject_send(&*iobs, msg, __func__);
-      wait_for_completion(&*iobr);
+      wait_for_response(iobr);
 
       const auto response_msg = msg_recv<const mcas::protocol::Message_IO_response>(&*iobr, __func__);
 
@@ -2103,7 +2436,7 @@ status_t Connection_handler::get(const pool_t pool, const std::string &key, std:
       iobs->set_length(msg->msg_len());
 
       /* post both send and receive */
-      post_recv(&*iobr);
+      post_response_recv(iobr, msg->request_id());
       post_send(iobs->iov, iobs->iov + 1, iobs->desc, &*iobs, msg, __func__);
 
       out_async_handle = new async_buffer_set_simple(debug_level(), std::move(iobs), std::move(iobr));
@@ -2120,22 +2453,210 @@ status_t Connection_handler::get(const pool_t pool, const std::string &key, std:
     return S_OK;
   }
 
+  status_t Connection_handler::multi_op(const pool_t                       pool,
+                                        const mcas::protocol::OP_TYPE      op,
+                                        const gsl::span<const std::string> keys,
+                                        const gsl::span<const std::string> values,
+                                        std::vector<std::string> *         out_values,
+                                        std::vector<status_t> &            out_status,
+                                        const IMCAS::flags_t               flags)
+  {
+    API_LOCK();
+
+    /* records never reached report failure */
+    out_status.assign(keys.size(), E_FAIL);
+    if (out_values) out_values->assign(keys.size(), std::string());
+
+    status_t status = S_OK;
+
+    try {
+      for (std::size_t first = 0; first != keys.size();) {
+        const auto iobs = make_iob_ptr_send();
+        auto iobr = make_iob_ptr_recv();
+        assert(iobs);
+        assert(iobr);
+
+        const auto msg = new (iobs->base())
+          mcas::protocol::Message_IO_request(iobs->original_length(), auth_id(), request_id(), pool, op, flags);
+
+        const auto count = pack_multi_records(msg, iobs->original_length(), keys, values, first);
+        if (count == 0) {
+          PWRN("mcas_client::%s record %zu too long. Use put_direct.", __func__, first);
+          out_status[first] = IKVStore::E_TOO_LARGE;
+          return IKVStore::E_TOO_LARGE;
+        }
+
+        CPLOG(2, "%s: op %d records [%zu,%zu)", __func__, int(op), first, first + count);
+
+        iobs->set_length(msg->msg_len());
+
+        post_response_recv(iobr, msg->request_id());
+        sync_send(&*iobs, msg, __func__);
+        wait_for_response(iobr);
+
+        const auto response_msg = msg_recv<const mcas::protocol::Message_IO_response>(&*iobr, __func__);
+
+        status_t rc = response_msg->get_status();
+        if (rc == S_OK) {
+          rc = unpack_multi_response(response_msg, first, count, out_status, out_values);
+        }
+        else {
+          std::fill(out_status.begin() + long(first), out_status.begin() + long(first + count), rc);
+        }
+
+        if (status == S_OK) status = rc;
+        first += count;
+      }
+    }
+    catch (const Exception &e) {
+      PLOG("%s %s fail %s", __FILE__, __func__, e.cause());
+      status = E_FAIL;
+    }
+    catch (const std::exception &e) {
+      PLOG("%s %s fail %s", __FILE__, __func__, e.what());
+      status = E_FAIL;
+    }
+
+    return status;
+  }
+
+  status_t Connection_handler::async_multi_op(const pool_t                       pool,
+                                              const mcas::protocol::OP_TYPE      op,
+                                              const gsl::span<const std::string> keys,
+                                              const gsl::span<const std::string> values,
+                                              std::vector<std::string> *         out_values,
+                                              std::vector<status_t> &            out_status,
+                                              IMCAS::async_handle_t &            out_async_handle,
+                                              const IMCAS::flags_t               flags)
+  {
+    API_LOCK();
+
+    out_status.assign(keys.size(), E_FAIL);
+    if (out_values) out_values->assign(keys.size(), std::string());
+
+    auto iobs = make_iob_ptr_send();
+    auto iobr = make_iob_ptr_recv();
+
+    assert(iobs);
+    assert(iobr);
+
+    try {
+      const auto msg = new (iobs->base())
+        mcas::protocol::Message_IO_request(iobs->original_length(), auth_id(), request_id(), pool, op, flags);
+
+      if (pack_multi_records(msg, iobs->original_length(), keys, values, 0) != keys.size()) {
+        PWRN("mcas_client::%s batch of %zu records too large for one message. Use the synchronous batch call.",
+             __func__, keys.size());
+        return IKVStore::E_TOO_LARGE;
+      }
+
+      iobs->set_length(msg->msg_len());
+
+      /* post both send and receive */
+      post_response_recv(iobr, msg->request_id());
+      post_send(iobs->iov, iobs->iov + 1, iobs->desc, &*iobs, msg, __func__);
+
+      out_async_handle =
+        new async_buffer_set_multi(debug_level(), std::move(iobs), std::move(iobr), keys.size(), &out_status, out_values);
+    }
+    catch (const Exception &e) {
+      PLOG("%s %s fail %s", __FILE__, __func__, e.cause());
+      throw Logic_exception("%s: network posting failed unexpectedly.", __func__);
+    }
+    catch (const std::exception &e) {
+      PLOG("%s %s fail %s", __FILE__, __func__, e.what());
+      throw Logic_exception("%s: network posting failed unexpectedly.", __func__);
+    }
+
+    return S_OK;
+  }
+
+  status_t Connection_handler::put_batch(const pool_t                       pool,
+                                         const gsl::span<const std::string> keys,
+                                         const gsl::span<const std::string> values,
+                                         std::vector<status_t> &            out_status,
+                                         const IMCAS::flags_t               flags)
+  {
+    if (keys.size() != values.size()) return E_INVAL;
+    return multi_op(pool, mcas::protocol::OP_MULTI_PUT, keys, values, nullptr, out_status, flags);
+  }
+
+  status_t Connection_handler::get_batch(const pool_t                       pool,
+                                         const gsl::span<const std::string> keys,
+                                         std::vector<std::string> &         out_values,
+                                         std::vector<status_t> &            out_status)
+  {
+    auto status = multi_op(pool, mcas::protocol::OP_MULTI_GET, keys, {}, &out_values, out_status, 0);
+    if (status == S_OK) return status;
+
+    /* re-fetch values which did not fit in a batched response */
+    status = S_OK;
+    for (std::size_t i = 0; i != keys.size(); ++i) {
+      if (out_status[i] == E_INSUFFICIENT_BUFFER) {
+        void *      value     = nullptr;
+        std::size_t value_len = 0;
+        out_status[i]         = get(pool, keys[i], value, value_len);
+        if (out_status[i] == S_OK) {
+          out_values[i].assign(static_cast<const char *>(value), value_len);
+          ::free(value);
+        }
+      }
+      if (status == S_OK) status = out_status[i];
+    }
+    return status;
+  }
+
+  status_t Connection_handler::erase_batch(const pool_t                       pool,
+                                           const gsl::span<const std::string> keys,
+                                           std::vector<status_t> &            out_status)
+  {
+    return multi_op(pool, mcas::protocol::OP_MULTI_ERASE, keys, {}, nullptr, out_status, 0);
+  }
+
+  status_t Connection_handler::async_put_batch(const pool_t                       pool,
+                                               const gsl::span<const std::string> keys,
+                                               const gsl::span<const std::string> values,
+                                               std::vector<status_t> &            out_status,
+                                               IMCAS::async_handle_t &            out_async_handle,
+                                               const IMCAS::flags_t               flags)
+  {
+    if (keys.size() != values.size()) return E_INVAL;
+    return async_multi_op(pool, mcas::protocol::OP_MULTI_PUT, keys, values, nullptr, out_status, out_async_handle, flags);
+  }
+
+  status_t Connection_handler::async_get_batch(const pool_t                       pool,
+                                               const gsl::span<const std::string> keys,
+                                               std::vector<std::string> &         out_values,
+                                               std::vector<status_t> &            out_status,
+                                               IMCAS::async_handle_t &            out_async_handle)
+  {
+    return async_multi_op(pool, mcas::protocol::OP_MULTI_GET, keys, {}, &out_values, out_status, out_async_handle, 0);
+  }
+
+  status_t Connection_handler::async_erase_batch(const pool_t                       pool,
+                                                 const gsl::span<const std::string> keys,
+                                                 std::vector<status_t> &            out_status,
+                                                 IMCAS::async_handle_t &            out_async_handle)
+  {
+    return async_multi_op(pool, mcas::protocol::OP_MULTI_ERASE, keys, {}, nullptr, out_status, out_async_handle, 0);
+  }
+
   size_t Connection_handler::count(const pool_t pool)
   {
     API_LOCK();
 
     const auto iobs = make_iob_ptr_send();
-    const auto iobr = make_iob_ptr_recv();
+    auto iobr = make_iob_ptr_recv();
     assert(iobs);
     assert(iobr);
 
     try {
       const auto msg =
-        new (iobs->base()) mcas::protocol::Message_INFO_request(auth_id(), IKVStore::Attribute::COUNT, pool);
+        new (iobs->base()) mcas::protocol::Message_INFO_request(auth_id(), request_id(), IKVStore::Attribute::COUNT, pool);
 
-      post_recv(&*iobr);
+      post_response_recv(iobr, msg->request_id());
       sync_inject_send(&*iobs, msg, msg->base_message_size(), __func__);
-      wait_for_completion(&*iobr);
+      wait_for_response(iobr);
 
       const auto response_msg = msg_recv<const mcas::protocol::Message_INFO_response>(&*iobr, __func__);
 
@@ -2159,21 +2680,21 @@ status_t Connection_handler::get(const pool_t pool, const std::string &key, std:
     API_LOCK();
 
     const auto iobs = make_iob_ptr_send();
-    const auto iobr = make_iob_ptr_recv();
+    auto iobr = make_iob_ptr_recv();
     assert(iobs);
     assert(iobr);
 
     status_t status;
 
     try {
-      const auto msg = new (iobs->base()) mcas::protocol::Message_INFO_request(auth_id(), attr, pool);
+      const auto msg = new (iobs->base()) mcas::protocol::Message_INFO_request(auth_id(), request_id(), attr, pool);
 
       if (key) msg->set_key(iobs->length(), *key);
 
-      post_recv(&*iobr);
+      post_response_recv(iobr, msg->request_id());
       sync_inject_send(&*iobs, msg, msg->message_size(), __func__);
 
-      wait_for_completion(&*iobr);
+      wait_for_response(iobr);
       const auto response_msg = msg_recv<const mcas::protocol::Message_INFO_response>(&*iobr, __func__);
 
       out_attr.clear();
@@ -2191,12 +2712,12 @@ status_t Connection_handler::get(const pool_t pool, const std::string &key, std:
     return status;
   }
 
-  status_t Connection_handler::get_statistics(IMCAS::Shard_stats &out_stats)
+  status_t Connection_handler::get_statistics(IMCAS::Shard_stats &out_stats, const bool reset_latency)
   {
     API_LOCK();
 
     const auto iobs = make_iob_ptr_send();
-    const auto iobr = make_iob_ptr_recv();
+    auto iobr = make_iob_ptr_recv();
     assert(iobs);
     assert(iobr);
 
@@ -2204,12 +2725,15 @@ status_t Connection_handler::get(const pool_t pool, const std::string &key, std:
 
     try {
       const auto msg =
-        new (iobs->base()) mcas::protocol::Message_INFO_request(auth_id(), mcas::protocol::INFO_TYPE_GET_STATS, 0);
+        new (iobs->base()) mcas::protocol::Message_INFO_request(auth_id(), request_id(),
+                                                                reset_latency ? mcas::protocol::INFO_TYPE_GET_STATS_RESET
+                                                                              : mcas::protocol::INFO_TYPE_GET_STATS,
+                                                                0);
 
-      post_recv(&*iobr);
+      post_response_recv(iobr, 0); /* Message_stats is not numbered */
       sync_inject_send(&*iobs, msg, msg->message_size(), __func__);
 
-      wait_for_completion(&*iobr);
+      wait_for_response(iobr);
       const auto response_msg = msg_recv<const mcas::protocol::Message_stats>(&*iobr, __func__);
 
       status = response_msg->get_status();
@@ -2241,7 +2765,7 @@ status_t Connection_handler::get(const pool_t pool, const std::string &key, std:
     API_LOCK();
 
     const auto iobs = make_iob_ptr_send();
-    const auto iobr = make_iob_ptr_recv();
+    auto iobr = make_iob_ptr_recv();
     assert(iobs);
     assert(iobr);
 
@@ -2250,16 +2774,17 @@ status_t Connection_handler::get(const pool_t pool, const std::string &key, std:
     try {
       const auto msg =
         new (iobs->base()) mcas::protocol::Message_INFO_request(auth_id(),
+                                                                request_id(),
                                                                 mcas::protocol::INFO_TYPE_FIND_KEY,
                                                                 pool,
                                                                 offset);
 
       msg->set_key(iobs->length(), key_expression);
 
-      post_recv(&*iobr);
+      post_response_recv(iobr, msg->request_id());
       sync_inject_send(&*iobs, msg, msg->message_size(), __func__);
 
-      wait_for_completion(&*iobr);
+      wait_for_response(iobr);
       const auto response_msg = msg_recv<const mcas::protocol::Message_INFO_response>(&*iobr, "FIND");
 
       status = response_msg->get_status();
@@ -2280,6 +2805,144 @@ status_t Connection_handler::get(const pool_t pool, const std::string &key, std:
     return status;
   }
 
+  status_t Connection_handler::async_find(const IMCAS::pool_t    pool,
+                                          const std::string &    key_expression,
+                                          const offset_t         offset,
+                                          offset_t &             out_matched_offset,
+                                          std::string &          out_matched_key,
+                                          IMCAS::async_handle_t &out_async_handle)
+  {
+    API_LOCK();
+
+    auto iobs = make_iob_ptr_send();
+    auto iobr = make_iob_ptr_recv();
+
+    assert(iobs);
+    assert(iobr);
+
+    try {
+      const auto msg =
+        new (iobs->base()) mcas::protocol::Message_INFO_request(auth_id(),
+                                                                request_id(),
+                                                                mcas::protocol::INFO_TYPE_FIND_KEY,
+                                                                pool,
+                                                                offset);
+
+      msg->set_key(iobs->length(), key_expression);
+      iobs->set_length(msg->message_size());
+
+      /* post both send and receive */
+      post_response_recv(iobr, msg->request_id());
+      post_send(iobs->iov, iobs->iov + 1, iobs->desc, &*iobs, msg, __func__);
+
+      out_async_handle = new async_buffer_set_find(debug_level(), std::move(iobs), std::move(iobr),
+                                                   &out_matched_offset, &out_matched_key);
+    }
+    catch (const Exception &e) {
+      PLOG("%s %s fail %s", __FILE__, __func__, e.cause());
+      throw Logic_exception("%s: network posting failed unexpectedly.", __func__);
+    }
+    catch (const std::exception &e) {
+      PLOG("%s %s fail %s", __FILE__, __func__, e.what());
+      throw Logic_exception("%s: network posting failed unexpectedly.", __func__);
+    }
+
+    return S_OK;
+  }
+
+  status_t Connection_handler::find_batch(const IMCAS::pool_t        pool,
+                                          const std::string &        key_expression,
+                                          const offset_t             offset,
+                                          const unsigned             limit,
+                                          std::vector<std::string> & out_keys,
+                                          offset_t &                 out_next_offset)
+  {
+    API_LOCK();
+
+    const auto iobs = make_iob_ptr_send();
+    auto iobr = make_iob_ptr_recv();
+    assert(iobs);
+    assert(iobr);
+
+    status_t status;
+
+    try {
+      const auto msg =
+        new (iobs->base()) mcas::protocol::Message_INFO_request(auth_id(),
+                                                                request_id(),
+                                                                mcas::protocol::INFO_TYPE_FIND_KEY_BATCH,
+                                                                pool,
+                                                                offset);
+
+      msg->limit = limit;
+      msg->set_key(iobs->length(), key_expression);
+
+      post_response_recv(iobr, msg->request_id());
+      sync_inject_send(&*iobs, msg, msg->message_size(), __func__);
+
+      wait_for_response(iobr);
+      const auto response_msg = msg_recv<const mcas::protocol::Message_INFO_response>(&*iobr, "FIND BATCH");
+
+      status = unpack_find_batch(response_msg, &out_keys, &out_next_offset);
+    }
+    catch (const Exception &e) {
+      PLOG("%s %s fail %s", __FILE__, __func__, e.cause());
+      status = E_FAIL;
+    }
+    catch (const std::exception &e) {
+      PLOG("%s %s fail %s", __FILE__, __func__, e.what());
+      status = E_FAIL;
+    }
+    return status;
+  }
+
+  status_t Connection_handler::async_find_batch(const IMCAS::pool_t        pool,
+                                                const std::string &        key_expression,
+                                                const offset_t             offset,
+                                                const unsigned             limit,
+                                                std::vector<std::string> & out_keys,
+                                                offset_t &                 out_next_offset,
+                                                IMCAS::async_handle_t &    out_async_handle)
+  {
+    API_LOCK();
+
+    auto iobs = make_iob_ptr_send();
+    auto iobr = make_iob_ptr_recv();
+
+    assert(iobs);
+    assert(iobr);
+
+    try {
+      const auto msg =
+        new (iobs->base()) mcas::protocol::Message_INFO_request(auth_id(),
+                                                                request_id(),
+                                                                mcas::protocol::INFO_TYPE_FIND_KEY_BATCH,
+                                                                pool,
+                                                                offset);
+
+      msg->limit = limit;
+      msg->set_key(iobs->length(), key_expression);
+      iobs->set_length(msg->message_size());
+
+      /* post both send and receive */
+      post_response_recv(iobr, msg->request_id());
+      post_send(iobs->iov, iobs->iov + 1, iobs->desc, &*iobs, msg, __func__);
+
+      out_async_handle = new async_buffer_set_find_batch(debug_level(), std::move(iobs), std::move(iobr),
+                                                         &out_keys, &out_next_offset);
+    }
+    catch (const Exception &e) {
+      PLOG("%s %s fail %s", __FILE__, __func__, e.cause());
+      throw Logic_exception("%s: network posting failed unexpectedly.", __func__);
+    }
+    catch (const std::exception &e) {
+      PLOG("%s %s fail %s", __FILE__, __func__, e.what());
+      throw Logic_exception("%s: network posting failed unexpectedly.", __func__);
+    }
+
+    return S_OK;
+  }
+
   status_t Connection_handler::receive_and_process_ado_response(
     const iob_ptr & iobr_
     , std::vector<IMCAS::ADO_response> & out_response_
@@ -2339,12 +3002,12 @@ status_t Connection_handler::get(const pool_t pool, const std::string &key, std:
         return S_OK;
       }
 
-      const auto iobr = make_iob_ptr_recv();
+      auto iobr = make_iob_ptr_recv();
       assert(iobr);
 
-      post_recv(&*iobr);
+      post_response_recv(iobr, msg_->request_id());
       sync_send(&*iobs_, msg_, __func__);
-      wait_for_completion(&*iobr); /* wait for response */
+      wait_for_response(iobr); /* wait for response */
 
       return receive_and_process_ado_response(iobr, out_response_);
     }
@@ -2413,7 +3076,7 @@ status_t Connection_handler::get(const pool_t pool, const std::string &key, std:
                                                                               value_size);
       iobs->set_length(msg->message_size());
 
-      post_recv(&*iobr);
+      post_response_recv(iobr, msg->request_id());
       post_send(&*iobs, msg, __func__);
 
       out_async_handle = new async_buffer_set_invoke(debug_level(), std::move(iobs), std::move(iobr), &out_response);
@@ -2504,7 +3167,7 @@ status_t Connection_handler::get(const pool_t pool, const std::string &key, std:
                                                                                   flags);
       iobs->set_length(msg->message_size());
 
-      post_recv(&*iobr);
+      post_response_recv(iobr, msg->request_id());
       post_send(&*iobs, msg, __func__);
 
       out_async_handle = new async_buffer_set_invoke(debug_level(), std::move(iobs), std::move(iobr), &out_response);
@@ -2551,6 +3214,125 @@ status_t Connection_handler::get(const pool_t pool, const std::string &key, std:
     return make_iob_ptr(read_complete);
   }
 
+  namespace
+  {
+    /* _held_for value of a posted receive whose slot has gone away */
+    constexpr uint64_t RID_ORPHAN = ~uint64_t(0);
+  }
+
+  void Connection_handler::post_response_recv(iob_ptr &slot_, const uint64_t request_id_)
+  {
+    assert(slot_);
+    /* an unnumbered response can only be recognized if nothing else is outstanding */
+    while ( request_id_ == 0 ? ! _awaiting.empty() : _pipeline_window <= _awaiting.size() ) {
+      route_response(true);
+    }
+
+    post_recv(&*slot_);
+    _response_fifo.push_back(&*slot_);
+    _held_for.emplace(&*slot_, request_id_);
+    _awaiting.emplace(request_id_, &slot_);
+  }
+
+  bool Connection_handler::test_response(iob_ptr &slot_)
+  {
+    while ( _held_for.count(slot_.get()) ) {
+      if ( ! route_response(false) ) return false;
+    }
+    return true;
+  }
+
+  void Connection_handler::wait_for_response(iob_ptr &slot_)
+  {
+    while ( _held_for.count(slot_.get()) ) {
+      route_response(true);
+    }
+  }
+
+  void Connection_handler::rebind_response(iob_ptr &slot_) noexcept
+  {
+    const auto held = _held_for.find(slot_.get());
+    if ( held != _held_for.end() ) {
+      const auto awaiting = _awaiting.find(held->second);
+      if ( awaiting != _awaiting.end() ) awaiting->second = &slot_;
+    }
+  }
+
+  void Connection_handler::free_buffer(buffer_t *iob_)
+  {
+    const auto held = _held_for.find(iob_);
+    if ( held == _held_for.end() ) {
+      Connection_base::free_buffer(iob_);
+    }
+    else {
+      /* still posted: the next response to land in it is routed elsewhere
+         and the buffer is then released */
+      _awaiting.erase(held->second);
+      held->second = RID_ORPHAN;
+    }
+  }
+
+  /*
+   * Complete the oldest posted response receive, if it has completed (or,
+   * if wait, when it completes), and deliver its response to the slot
+   * awaiting that request id.
+   *
+   * @return True iff a receive completed
+   */
+  bool Connection_handler::route_response(const bool wait_)
+  {
+    if ( _response_fifo.empty() ) throw Logic_exception("%s: no response outstanding", __func__);
+
+    const auto iob = _response_fifo.front();
+    if ( wait_ ) {
+      wait_for_completion(iob);
+    }
+    else if ( ! test_completion(iob) ) {
+      return false;
+    }
+    _response_fifo.pop_front();
+
+    const auto held = _held_for.find(iob);
+    assert(held != _held_for.end());
+    auto holder_rid = held->second;
+    _held_for.erase(held);
+
+    const auto rid = mcas::protocol::response_request_id(mcas::protocol::message_cast(iob->base()));
+    const auto target = _awaiting.find(rid);
+
+    if ( target == _awaiting.end() ) {
+      /* no one is waiting, e.g. the request timed out */
+      CPLOG(1, "%s: dropping response for request %" PRIu64, __func__, rid);
+      if ( holder_rid == RID_ORPHAN ) {
+        Connection_base::free_buffer(iob);
+      }
+      else {
+        post_recv(iob);
+        _response_fifo.push_back(iob);
+        _held_for.emplace(iob, holder_rid);
+      }
+      return true;
+    }
+
+    iob_ptr &slot = *target->second;
+    if ( slot.get() != iob ) {
+      /* response landed in another request's receive: exchange buffers */
+      const auto other = slot.get();
+      const auto holder = _awaiting.find(holder_rid);
+      if ( holder != _awaiting.end() ) {
+        std::swap(slot, *holder->second);
+      }
+      else {
+        slot.release();
+        slot.reset(iob);
+        holder_rid = RID_ORPHAN;
+      }
+      _held_for[other] = holder_rid;
+    }
+    _awaiting.erase(target);
+    return true;
+  }
+
   int Connection_handler::tick()
   {
     using namespace mcas::protocol;
@@ -2595,6 +3377,11 @@ status_t Connection_handler::get(const pool_t pool, const std::string &key, std:
         wait_for_completion(&*iobr);
         const auto response_msg = msg_recv<const mcas::protocol::Message_handshake_reply>(&*iobr, "handshake");
 
+        /* the server keeps recv_depth receives posted; never have more requests outstanding */
+        const unsigned depth = response_msg->recv_depth ? unsigned(response_msg->recv_depth) : 1U;
+        _pipeline_window = _options.pipeline_window ? std::min(_options.pipeline_window, depth) : depth;
+        CPLOG(1, "%s: pipeline window %u (server receive depth %u)", __func__, _pipeline_window, depth);
+
         /* server is indicating that it wants to start TLS session */
         if(response_msg->start_tls)
           start_tls();
@@ -38,9 +38,11 @@
 #include <gnutls/crypto.h>
 
 #include <boost/numeric/conversion/cast.hpp>
+#include <deque>
 #include <map>
 #include <set>
 #include <tuple>
+#include <unordered_map>
 
 /* Enable this to introduce locks to prevent re-entry by multiple
    threads.  The client is not re-entrant because of the state machine
@@ -222,6 +224,11 @@ public:
 
   status_t get(const pool_t pool, const std::string &key, void *&value, size_t &value_len);
 
+  status_t async_get(const pool_t                      pool,
+                     const std::string &               key,
+                     std::string &                     out_value,
+                     component::IMCAS::async_handle_t &out_handle);
+
   status_t get_direct(const pool_t                         pool,
                       const void *                         key,
                       size_t                               key_len,
@@ -266,6 +273,39 @@ public:
                        const std::string &               key,
                        component::IMCAS::async_handle_t &out_handle);
 
+  status_t put_batch(const pool_t                     pool,
+                     gsl::span<const std::string>     keys,
+                     gsl::span<const std::string>     values,
+                     std::vector<status_t> &          out_status,
+                     component::IMCAS::flags_t        flags);
+
+  status_t get_batch(const pool_t                     pool,
+                     gsl::span<const std::string>     keys,
+                     std::vector<std::string> &       out_values,
+                     std::vector<status_t> &          out_status);
+
+  status_t erase_batch(const pool_t                   pool,
+                       gsl::span<const std::string>   keys,
+                       std::vector<status_t> &        out_status);
+
+  status_t async_put_batch(const pool_t                      pool,
+                           gsl::span<const std::string>      keys,
+                           gsl::span<const std::string>      values,
+                           std::vector<status_t> &           out_status,
+                           component::IMCAS::async_handle_t &out_handle,
+                           component::IMCAS::flags_t         flags);
+
+  status_t async_get_batch(const pool_t                      pool,
+                           gsl::span<const std::string>      keys,
+                           std::vector<std::string> &        out_values,
+                           std::vector<status_t> &           out_status,
+                           component::IMCAS::async_handle_t &out_handle);
+
+  status_t async_erase_batch(const pool_t                      pool,
+                             gsl::span<const std::string>      keys,
+                             std::vector<status_t> &           out_status,
+                             component::IMCAS::async_handle_t &out_handle);
+
   uint64_t key_hash(const void *key, const size_t key_len);
 
   uint64_t auth_id() const
@@ -291,7 +331,7 @@ public:
                          std::vector<uint64_t> &              out_attr,
                          const std::string *                  key);
 
-  status_t get_statistics(component::IMCAS::Shard_stats &out_stats);
+  status_t get_statistics(component::IMCAS::Shard_stats &out_stats, bool reset_latency);
 
   status_t find(const component::IKVStore::pool_t pool,
                 const std::string &               key_expression,
@@ -299,6 +339,28 @@ public:
                 offset_t &                        out_matched_offset,
                 std::string &                     out_matched_key);
 
+  status_t async_find(const component::IKVStore::pool_t pool,
+                      const std::string &               key_expression,
+                      const offset_t                    offset,
+                      offset_t &                        out_matched_offset,
+                      std::string &                     out_matched_key,
+                      component::IMCAS::async_handle_t &out_handle);
+
+  status_t find_batch(const component::IKVStore::pool_t pool,
+                      const std::string &               key_expression,
+                      const offset_t                    offset,
+                      const unsigned                    limit,
+                      std::vector<std::string> &        out_keys,
+                      offset_t &                        out_next_offset);
+
+  status_t async_find_batch(const component::IKVStore::pool_t pool,
+                            const std::string &               key_expression,
+                            const offset_t                    offset,
+                            const unsigned                    limit,
+                            std::vector<std::string> &        out_keys,
+                            offset_t &                        out_next_offset,
+                            component::IMCAS::async_handle_t &out_handle);
+
   status_t invoke_ado(const component::IMCAS::pool_t               pool,
                       basic_string_view<byte>                      key,
                       basic_string_view<byte>                      request,
@@ -368,6 +430,25 @@ private:
 
   void start_tls();
 
+  /* OP_MULTI_PUT/GET/ERASE: synchronous (split over as many messages as
+     needed) and asynchronous (single message) */
+  status_t multi_op(const pool_t                  pool,
+                    mcas::protocol::OP_TYPE       op,
+                    gsl::span<const std::string>  keys,
+                    gsl::span<const std::string>  values,
+                    std::vector<std::string> *    out_values,
+                    std::vector<status_t> &       out_status,
+                    component::IMCAS::flags_t     flags);
+
+  status_t async_multi_op(const pool_t                      pool,
+                          mcas::protocol::OP_TYPE           op,
+                          gsl::span<const std::string>      keys,
+                          gsl::span<const std::string>      values,
+                          std::vector<std::string> *        out_values,
+                          std::vector<status_t> &           out_status,
+                          component::IMCAS::async_handle_t &out_handle,
+                          component::IMCAS::flags_t         flags);
+
   template <typename MT>
   void msg_send_log(const MT *m, const void *context, const char *desc) { msg_send_log(1, m, context, desc); }
 
@@ -535,6 +616,57 @@ private:
 public: /* for async "move_along" processing */
   uint64_t request_id() { return ++_request_id; }
 
+  /* Response routing. Receives complete in the order they were posted,
+   * not the order in which requests were issued, so each completed
+   * response is moved (by exchanging buffers) into the slot of the
+   * request whose request_id it carries. This lets up to
+   * pipeline_window() requests be outstanding and complete in any order.
+   */
+
+  /**
+   * Post the receive for a request's response. Blocks while the window
+   * is full. request_id 0 is for unnumbered (pool and stats) responses
+   * and first drains all outstanding responses.
+   *
+   * @param slot Receive buffer, which may be exchanged until delivery
+   * @param request_id Request id the response will carry
+   */
+  void post_response_recv(iob_ptr &slot, uint64_t request_id);
+
+  /**
+   * Test for delivery of a response into slot
+   *
+   * @return True iff the response is in slot
+   */
+  bool test_response(iob_ptr &slot);
+
+  /**
+   * Wait (at most the patience period) for a response to be delivered
+   * into slot
+   */
+  void wait_for_response(iob_ptr &slot);
+
+  /**
+   * Note that a posted slot has moved (e.g. into an async handle)
+   */
+  void rebind_response(iob_ptr &slot) noexcept;
+
+  /**
+   * Free a buffer. A receive still posted is kept until a response
+   * lands in it.
+   */
+  void free_buffer(buffer_t *iob);
+
+  unsigned pipeline_window() const { return _pipeline_window; }
+
+private:
+  bool route_response(bool wait);
+
+  std::deque<buffer_t *>                         _response_fifo; /* posted response receives, in post order */
+  std::unordered_map<uint64_t, iob_ptr *>        _awaiting;      /* request id -> slot awaiting its response */
+  std::unordered_map<buffer_t *, uint64_t>       _held_for;      /* posted receive -> request id of its slot */
+  unsigned                                       _pipeline_window;
+
 private:
   size_t _max_message_size;
   size_t _max_inject_size;
@@ -543,9 +675,10 @@ private:
     bool short_circuit_backend;
     unsigned tls   : 1;
     unsigned hmac : 1;
+    unsigned pipeline_window; /* maximum outstanding requests, 0 is the server's receive depth */
 
     options_s()
-      : short_circuit_backend(env_scbe && env_scbe[0] == '1'), tls(0), hmac(0)
+      : short_circuit_backend(env_scbe && env_scbe[0] == '1'), tls(0), hmac(0), pipeline_window(0)
     {}
   };
 
@@ -261,6 +261,14 @@ status_t MCAS_client::async_put_direct(const IKVStore::pool_t          pool,
   return _connection->async_put_direct(pool, key.data(), key.size(), values, out_handle, registrar(), handles, flags);
 }
 
+status_t MCAS_client::async_get(const IMCAS::pool_t pool,
+                                const std::string & key,
+                                std::string &       out_value,
+                                async_handle_t &    out_handle)
+{
+  return _connection->async_get(pool, key, out_value, out_handle);
+}
+
 status_t MCAS_client::async_get_direct(IKVStore::pool_t          pool,
                                        const std::string &       key,
                                        void *                    value,
@@ -364,6 +372,57 @@ status_t MCAS_client::async_erase(const IMCAS::pool_t pool, const std::string &k
   return _connection->async_erase(pool, key, out_handle);
 }
 
+status_t MCAS_client::put_batch(const IMCAS::pool_t                pool,
+                                const gsl::span<const std::string> keys,
+                                const gsl::span<const std::string> values,
+                                std::vector<status_t> &            out_status,
+                                const unsigned int                 flags)
+{
+  return _connection->put_batch(pool, keys, values, out_status, flags);
+}
+
+status_t MCAS_client::get_batch(const IMCAS::pool_t                pool,
+                                const gsl::span<const std::string> keys,
+                                std::vector<std::string> &         out_values,
+                                std::vector<status_t> &            out_status)
+{
+  return _connection->get_batch(pool, keys, out_values, out_status);
+}
+
+status_t MCAS_client::erase_batch(const IMCAS::pool_t                pool,
+                                  const gsl::span<const std::string> keys,
+                                  std::vector<status_t> &            out_status)
+{
+  return _connection->erase_batch(pool, keys, out_status);
+}
+
+status_t MCAS_client::async_put_batch(const IMCAS::pool_t                pool,
+                                      const gsl::span<const std::string> keys,
+                                      const gsl::span<const std::string> values,
+                                      std::vector<status_t> &            out_status,
+                                      async_handle_t &                   out_handle,
+                                      const unsigned int                 flags)
+{
+  return _connection->async_put_batch(pool, keys, values, out_status, out_handle, flags);
+}
+
+status_t MCAS_client::async_get_batch(const IMCAS::pool_t                pool,
+                                      const gsl::span<const std::string> keys,
+                                      std::vector<std::string> &         out_values,
+                                      std::vector<status_t> &            out_status,
+                                      async_handle_t &                   out_handle)
+{
+  return _connection->async_get_batch(pool, keys, out_values, out_status, out_handle);
+}
+
+status_t MCAS_client::async_erase_batch(const IMCAS::pool_t                pool,
+                                        const gsl::span<const std::string> keys,
+                                        std::vector<status_t> &            out_status,
+                                        async_handle_t &                   out_handle)
+{
+  return _connection->async_erase_batch(pool, keys, out_status, out_handle);
+}
+
 size_t MCAS_client::count(const IKVStore::pool_t pool) { return _connection->count(pool); }
 
 status_t MCAS_client::get_attribute(const IKVStore::pool_t    pool,
@@ -374,7 +433,10 @@ status_t MCAS_client::get_attribute(const IKVStore::pool_t    pool,
   return _connection->get_attribute(pool, attr, out_attr, key);
 }
 
-status_t MCAS_client::get_statistics(Shard_stats &out_stats) { return _connection->get_statistics(out_stats); }
+status_t MCAS_client::get_statistics(Shard_stats &out_stats, bool reset_latency)
+{
+  return _connection->get_statistics(out_stats, reset_latency);
+}
 
 status_t MCAS_client::free_memory(void *p)
 {
@@ -400,6 +462,37 @@ status_t MCAS_client::find(const IKVStore::pool_t pool,
   return _connection->find(pool, key_expression, offset, out_matched_offset, out_matched_key);
 }
 
+status_t MCAS_client::async_find(const IKVStore::pool_t pool,
+                                 const std::string &    key_expression,
+                                 const offset_t         offset,
+                                 offset_t &             out_matched_offset,
+                                 std::string &          out_matched_key,
+                                 async_handle_t &       out_handle)
+{
+  return _connection->async_find(pool, key_expression, offset, out_matched_offset, out_matched_key, out_handle);
+}
+
+status_t MCAS_client::find_batch(const IKVStore::pool_t     pool,
+                                 const std::string &        key_expression,
+                                 const offset_t             offset,
+                                 const unsigned             limit,
+                                 std::vector<std::string> & out_keys,
+                                 offset_t &                 out_next_offset)
+{
+  return _connection->find_batch(pool, key_expression, offset, limit, out_keys, out_next_offset);
+}
+
+status_t MCAS_client::async_find_batch(const IKVStore::pool_t     pool,
+                                       const std::string &        key_expression,
+                                       const offset_t             offset,
+                                       const unsigned             limit,
+                                       std::vector<std::string> & out_keys,
+                                       offset_t &                 out_next_offset,
+                                       async_handle_t &           out_handle)
+{
+  return _connection->async_find_batch(pool, key_expression, offset, limit, out_keys, out_next_offset, out_handle);
+}
+
 status_t MCAS_client::invoke_ado(const IKVStore::pool_t            pool,
                                  basic_string_view<byte>           key,
                                  basic_string_view<byte>           request,
@@ -194,6 +194,11 @@ class MCAS_client
                        void *&            out_value, /* release with free() */
                        size_t &           out_value_len) override;
 
+  virtual status_t async_get(const IMCAS::pool_t pool,
+                             const std::string & key,
+                             std::string &       out_value,
+                             async_handle_t &    out_handle) override;
+
   virtual status_t async_get_direct(const pool_t                 pool,
                               const std::string &          key,
                               void *                       out_value,
@@ -237,6 +242,39 @@ class MCAS_client
 
   virtual status_t async_erase(const IMCAS::pool_t pool, const std::string &key, async_handle_t &out_handle) override;
 
+  virtual status_t put_batch(const IMCAS::pool_t          pool,
+                             gsl::span<const std::string> keys,
+                             gsl::span<const std::string> values,
+                             std::vector<status_t> &      out_status,
+                             const unsigned int           flags = IMCAS::FLAGS_NONE) override;
+
+  virtual status_t get_batch(const IMCAS::pool_t          pool,
+                             gsl::span<const std::string> keys,
+                             std::vector<std::string> &   out_values,
+                             std::vector<status_t> &      out_status) override;
+
+  virtual status_t erase_batch(const IMCAS::pool_t          pool,
+                               gsl::span<const std::string> keys,
+                               std::vector<status_t> &      out_status) override;
+
+  virtual status_t async_put_batch(const IMCAS::pool_t          pool,
+                                   gsl::span<const std::string> keys,
+                                   gsl::span<const std::string> values,
+                                   std::vector<status_t> &      out_status,
+                                   async_handle_t &             out_handle,
+                                   const unsigned int           flags = IMCAS::FLAGS_NONE) override;
+
+  virtual status_t async_get_batch(const IMCAS::pool_t          pool,
+                                   gsl::span<const std::string> keys,
+                                   std::vector<std::string> &   out_values,
+                                   std::vector<status_t> &      out_status,
+                                   async_handle_t &             out_handle) override;
+
+  virtual status_t async_erase_batch(const IMCAS::pool_t          pool,
+                                     gsl::span<const std::string> keys,
+                                     std::vector<status_t> &      out_status,
+                                     async_handle_t &             out_handle) override;
+
   virtual size_t count(const pool_t pool) override;
 
   virtual status_t get_attribute(const IKVStore::pool_t    pool,
@@ -244,7 +282,7 @@ class MCAS_client
                                  std::vector<uint64_t> &   out_attr,
                                  const std::string *       key) override;
 
-  virtual status_t get_statistics(Shard_stats &out_stats) override;
+  virtual status_t get_statistics(Shard_stats &out_stats, bool reset_latency = false) override;
 
   virtual void debug(const pool_t pool, const unsigned cmd, const uint64_t arg) override;
 
@@ -261,6 +299,28 @@ class MCAS_client
                         offset_t &             out_matched_offset,
                         std::string &          out_matched_key) override;
 
+  virtual status_t async_find(const IKVStore::pool_t pool,
+                              const std::string &    key_expression,
+                              const offset_t         offset,
+                              offset_t &             out_matched_offset,
+                              std::string &          out_matched_key,
+                              async_handle_t &       out_handle) override;
+
+  virtual status_t find_batch(const IKVStore::pool_t     pool,
+                              const std::string &        key_expression,
+                              const offset_t             offset,
+                              const unsigned             limit,
+                              std::vector<std::string> & out_keys,
+                              offset_t &                 out_next_offset) override;
+
+  virtual status_t async_find_batch(const IKVStore::pool_t     pool,
+                                    const std::string &        key_expression,
+                                    const offset_t             offset,
+                                    const unsigned             limit,
+                                    std::vector<std::string> & out_keys,
+                                    offset_t &                 out_next_offset,
+                                    async_handle_t &           out_handle) override;
+
   virtual status_t invoke_ado(const IKVStore::pool_t            pool,
                               const basic_string_view<byte>     key,
                               const basic_string_view<byte>     request,
@@ -16,6 +16,7 @@
 
 #include <api/components.h>
 #include <api/kvstore_itf.h>
+#include <api/mcas_itf.h>
 #include <common/cpu.h>
 #include <common/str_utils.h>
 #include <common/task.h>
@@ -31,9 +32,12 @@
 
 #include <boost/program_options.hpp>
 #include <boost/optional.hpp>
+#include <algorithm> /* sort */
 #include <chrono> /* milliseconds */
 #include <iostream>
+#include <string>
 #include <thread> /* this_thread::sleep_for */
+#include <vector>
 
 //#define TEST_PERF_SMALL_PUT
 //#define TEST_PERF_SMALL_GET_DIRECT
@@ -90,9 +94,14 @@ struct mcas_client_test : public ::testing::Test {
 
   // Objects declared here can be used by all tests in the test case
   static component::Itf_ref<component::IKVStore> _mcas;
+  static component::Itf_ref<component::IMCAS>    _imcas;
 };
 
 component::Itf_ref<component::IKVStore> mcas_client_test::_mcas;
+component::Itf_ref<component::IMCAS>    mcas_client_test::_imcas;
+
+/* pipeline window of _imcas, kept small so that tests can exceed it */
+constexpr unsigned PIPELINE_WINDOW = 4;
 
 DECLARE_STATIC_COMPONENT_UUID(mcas_client, 0x2f666078, 0xcb8a, 0x4724, 0xa454, 0xd1, 0xd8, 0x8d, 0xe2, 0xdb, 0x87);
 DECLARE_STATIC_COMPONENT_UUID(mcas_client_factory,
@@ -201,6 +210,25 @@ TEST_F(mcas_client_test, Instantiate)
   ASSERT_TRUE(_mcas.get());
 }
 
+TEST_F(mcas_client_test, InstantiateMcas)
+{
+  PMAJOR("Running InstantiateMcas...");
+  component::IBase *comp = component::load_component("libcomponent-mcasclient.so", mcas_client_factory);
+
+  ASSERT_TRUE(comp);
+  auto fact = make_itf_ref(static_cast<IMCAS_factory *>(comp->query_interface(IMCAS_factory::iid())));
+
+  const std::string other = "{\"pipeline_window\":" + std::to_string(PIPELINE_WINDOW) + "}";
+  _imcas.reset(fact->mcas_create_nsd(Options.debug_level,
+                                     30,
+                                     "dwaddington",
+                                     Options.device ? *Options.device : std::string(),
+                                     Options.src_addr ? *Options.src_addr : std::string(),
+                                     Options.addr,
+                                     other));
+  ASSERT_TRUE(_imcas.get());
+}
+
 TEST_F(mcas_client_test, OpenCloseDelete)
 {
   PMAJOR("Running OpenCloseDelete...");
@@ -297,6 +325,355 @@ TEST_F(mcas_client_test, BasicPutAndGet)
   PLOG("BasicPutAndGet OK!");
 }
 
+TEST_F(mcas_client_test, MultiOpBadRecord)
+{
+  PMAJOR("Running MultiOpBadRecord...");
+  ASSERT_TRUE(_imcas.get());
+
+  const std::string poolname = Options.pool + "/MultiOpBadRecord";
+  auto              pool     = _imcas->create_pool(poolname, MB(32), 0, 100);
+  ASSERT_NE(+IMCAS::POOL_ERROR, pool);
+
+  std::vector<std::string> keys;
+  std::vector<std::string> values;
+  for (unsigned i = 0; i != 8; ++i) {
+    keys.push_back("multi-" + std::to_string(i));
+    values.push_back("value-" + std::to_string(i));
+  }
+
+  std::vector<status_t> status;
+  ASSERT_EQ(S_OK, _imcas->put_batch(pool, keys, values, status));
+  ASSERT_EQ(keys.size(), status.size());
+  for (auto s : status) EXPECT_EQ(S_OK, s);
+
+  /* put: an existing key, refused under FLAGS_DONT_STOMP, among new keys */
+  {
+    const std::vector<std::string> k{"multi-new-0", keys[3], "multi-new-1"};
+    const std::vector<std::string> v{"new-0", "stomp", "new-1"};
+    const auto rc = _imcas->put_batch(pool, k, v, status, IMCAS::FLAGS_DONT_STOMP);
+    ASSERT_EQ(k.size(), status.size());
+    EXPECT_EQ(S_OK, status[0]);
+    EXPECT_NE(S_OK, status[1]);
+    EXPECT_EQ(S_OK, status[2]);
+    EXPECT_EQ(status[1], rc);
+  }
+
+  /* get: a missing key among present ones */
+  {
+    const std::vector<std::string> k{keys[0], "multi-missing", keys[3], "multi-new-1"};
+    std::vector<std::string>       v;
+    const auto                     rc = _imcas->get_batch(pool, k, v, status);
+    ASSERT_EQ(k.size(), status.size());
+    ASSERT_EQ(k.size(), v.size());
+    EXPECT_EQ(S_OK, status[0]);
+    EXPECT_EQ(values[0], v[0]);
+    EXPECT_NE(S_OK, status[1]);
+    EXPECT_TRUE(v[1].empty());
+    EXPECT_EQ(S_OK, status[2]);
+    EXPECT_EQ(values[3], v[2]); /* not stomped */
+    EXPECT_EQ(S_OK, status[3]);
+    EXPECT_EQ("new-1", v[3]);
+    EXPECT_EQ(status[1], rc);
+  }
+
+  /* async get: a missing key */
+  {
+    const std::vector<std::string> k{keys[0], "multi-missing"};
+    std::vector<std::string>       v;
+    IMCAS::async_handle_t          handle = IMCAS::ASYNC_HANDLE_INIT;
+    ASSERT_EQ(S_OK, _imcas->async_get_batch(pool, k, v, status, handle));
+    while (_imcas->check_async_completion(handle) == E_BUSY)
+      ;
+    ASSERT_EQ(k.size(), status.size());
+    EXPECT_EQ(S_OK, status[0]);
+    EXPECT_EQ(values[0], v[0]);
+    EXPECT_NE(S_OK, status[1]);
+  }
+
+  /* erase: a missing key; the keys around it are still erased */
+  {
+    const std::vector<std::string> k{keys[1], "multi-missing", keys[2]};
+    const auto                     rc = _imcas->erase_batch(pool, k, status);
+    ASSERT_EQ(k.size(), status.size());
+    EXPECT_EQ(S_OK, status[0]);
+    EXPECT_NE(S_OK, status[1]);
+    EXPECT_EQ(S_OK, status[2]);
+    EXPECT_EQ(status[1], rc);
+
+    std::string v;
+    EXPECT_NE(S_OK, _imcas->get(pool, keys[1], v));
+    EXPECT_NE(S_OK, _imcas->get(pool, keys[2], v));
+    EXPECT_EQ(S_OK, _imcas->get(pool, keys[4], v));
+  }
+
+  /* a record too large for a message: records before it are stored, and
+     records after it are not sent */
+  {
+    const std::vector<std::string> k{"multi-small", "multi-huge", "multi-after"};
+    const std::vector<std::string> v{"small", std::string(MB(8), 'x'), "after"};
+    EXPECT_EQ(IKVStore::E_TOO_LARGE, _imcas->put_batch(pool, k, v, status));
+    ASSERT_EQ(k.size(), status.size());
+    EXPECT_EQ(S_OK, status[0]);
+    EXPECT_EQ(IKVStore::E_TOO_LARGE, status[1]);
+    EXPECT_NE(S_OK, status[2]);
+
+    std::string out;
+    EXPECT_EQ(S_OK, _imcas->get(pool, "multi-small", out));
+    EXPECT_NE(S_OK, _imcas->get(pool, "multi-after", out));
+  }
+
+  ASSERT_EQ(S_OK, _imcas->close_pool(pool));
+  ASSERT_EQ(S_OK, _imcas->delete_pool(poolname));
+}
+
+namespace
+{
+status_t complete(IMCAS *mcas, IMCAS::async_handle_t &handle)
+{
+  status_t rc;
+  while ((rc = mcas->check_async_completion(handle)) == E_BUSY)
+    ;
+  return rc;
+}
+}  // namespace
+
+TEST_F(mcas_client_test, PipelineOutOfOrder)
+{
+  PMAJOR("Running PipelineOutOfOrder...");
+  ASSERT_TRUE(_imcas.get());
+
+  const std::string poolname = Options.pool + "/PipelineOutOfOrder";
+  auto              pool     = _imcas->create_pool(poolname, MB(32), 0, 100);
+  ASSERT_NE(+IMCAS::POOL_ERROR, pool);
+
+  /* Several windows of requests are issued before any is checked, so
+     issue blocks on a full window and routes earlier responses to their
+     handles. The handles are then completed in other than issue order. */
+  constexpr unsigned       count = 4 * PIPELINE_WINDOW;
+  std::vector<std::string> keys;
+  std::vector<std::string> values;
+  for (unsigned i = 0; i != count; ++i) {
+    keys.push_back("pipe-" + std::to_string(i));
+    values.push_back(std::string(i + 1, char('a' + i % 26)));
+  }
+
+  std::vector<IMCAS::async_handle_t> handles(count, IMCAS::ASYNC_HANDLE_INIT);
+
+  /* puts, completed newest first */
+  for (unsigned i = 0; i != count; ++i) ASSERT_EQ(S_OK, _imcas->async_put(pool, keys[i], values[i], handles[i]));
+  for (unsigned i = count; i != 0; --i) EXPECT_EQ(S_OK, complete(_imcas.get(), handles[i - 1]));
+
+  /* gets, odd indices (newest first) and then even */
+  std::vector<std::string> out(count);
+  for (unsigned i = 0; i != count; ++i) ASSERT_EQ(S_OK, _imcas->async_get(pool, keys[i], out[i], handles[i]));
+  for (unsigned i = count; i > 1; i -= 2) EXPECT_EQ(S_OK, complete(_imcas.get(), handles[i - 1]));
+  for (unsigned i = 0; i < count; i += 2) EXPECT_EQ(S_OK, complete(_imcas.get(), handles[i]));
+  for (unsigned i = 0; i != count; ++i) EXPECT_EQ(values[i], out[i]) << keys[i];
+
+  /* a synchronous request behind a full window of async ones: its
+     response is routed past theirs */
+  for (unsigned i = 0; i != PIPELINE_WINDOW; ++i) {
+    out[i].clear();
+    ASSERT_EQ(S_OK, _imcas->async_get(pool, keys[i], out[i], handles[i]));
+  }
+  std::string sync_value;
+  EXPECT_EQ(S_OK, _imcas->get(pool, keys[count - 1], sync_value));
+  EXPECT_EQ(values[count - 1], sync_value);
+  for (unsigned i = PIPELINE_WINDOW; i != 0; --i) {
+    EXPECT_EQ(S_OK, complete(_imcas.get(), handles[i - 1]));
+    EXPECT_EQ(values[i - 1], out[i - 1]);
+  }
+
+  /* erases, including a missing key, completed newest first */
+  for (unsigned i = 0; i != count; ++i) ASSERT_EQ(S_OK, _imcas->async_erase(pool, keys[i], handles[i]));
+  IMCAS::async_handle_t missing = IMCAS::ASYNC_HANDLE_INIT;
+  ASSERT_EQ(S_OK, _imcas->async_erase(pool, "pipe-missing", missing));
+  EXPECT_NE(S_OK, complete(_imcas.get(), missing));
+  for (unsigned i = count; i != 0; --i) EXPECT_EQ(S_OK, complete(_imcas.get(), handles[i - 1]));
+  for (unsigned i = 0; i != count; ++i) EXPECT_NE(S_OK, _imcas->get(pool, keys[i], sync_value));
+
+  ASSERT_EQ(S_OK, _imcas->close_pool(pool));
+  ASSERT_EQ(S_OK, _imcas->delete_pool(poolname));
+}
+
+TEST_F(mcas_client_test, FindStreamBatches)
+{
+  PMAJOR("Running FindStreamBatches...");
+  ASSERT_TRUE(_imcas.get());
+
+  const std::string poolname = Options.pool + "/FindStreamBatches";
+  auto              pool     = _imcas->create_pool(poolname, MB(32), 0, 1000);
+  ASSERT_NE(+IMCAS::POOL_ERROR, pool);
+  ASSERT_EQ(S_OK, _imcas->configure_pool(pool, "AddIndex::VolatileTree"));
+
+  constexpr unsigned       count = 100;
+  constexpr unsigned       limit = 7; /* several batches, the last one short */
+  std::vector<std::string> expected;
+  for (unsigned i = 0; i != count; ++i) {
+    expected.push_back("stream/" + std::to_string(1000 + i));
+    ASSERT_EQ(S_OK, _imcas->put(pool, expected.back(), "v"));
+    ASSERT_EQ(S_OK, _imcas->put(pool, "other/" + std::to_string(i), "v"));
+  }
+
+  /* find_batch, continued from each returned offset */
+  {
+    std::vector<std::string> keys;
+    offset_t                 offset  = 0;
+    unsigned                 batches = 0;
+    status_t                 rc;
+    do {
+      std::vector<std::string> batch;
+      rc = _imcas->find_batch(pool, "prefix:stream/", offset, limit, batch, offset);
+      ASSERT_TRUE(rc == S_OK || rc == S_MORE) << rc;
+      EXPECT_GE(limit, batch.size());
+      keys.insert(keys.end(), batch.begin(), batch.end());
+      ASSERT_GT(count, batches++);
+    } while (rc == S_MORE);
+    EXPECT_LE((count + limit - 1) / limit, batches);
+
+    std::sort(keys.begin(), keys.end());
+    EXPECT_EQ(expected, keys);
+  }
+
+  /* Key_stream, which prefetches the next batch */
+  {
+    std::vector<std::string> keys;
+    IMCAS::Key_stream        stream(_imcas.get(), pool, "prefix:stream/", limit);
+    std::string              key;
+    status_t                 rc;
+    while ((rc = stream.next(key)) == S_OK) {
+      keys.push_back(key);
+      ASSERT_GE(count, keys.size());
+    }
+    EXPECT_EQ(E_EOF, rc);
+
+    std::sort(keys.begin(), keys.end());
+    EXPECT_EQ(expected, keys);
+  }
+
+  /* a stream abandoned part way waits for its prefetch */
+  {
+    IMCAS::Key_stream stream(_imcas.get(), pool, "prefix:stream/", limit);
+    std::string       key;
+    EXPECT_EQ(S_OK, stream.next(key));
+  }
+
+  ASSERT_EQ(S_OK, _imcas->close_pool(pool));
+  ASSERT_EQ(S_OK, _imcas->delete_pool(poolname));
+}
+
+using Latency_histogram = IMCAS::Latency_histogram;
+
+TEST(Latency_histogram_test, BucketBoundaries)
+{
+  /* a bucket per value below SUB_COUNT */
+  for (unsigned ns = 0; ns != Latency_histogram::SUB_COUNT; ++ns) EXPECT_EQ(ns, Latency_histogram::bucket_index(ns));
+  /* then SUB_COUNT buckets per power of two */
+  EXPECT_EQ(8U, Latency_histogram::bucket_index(8));
+  EXPECT_EQ(15U, Latency_histogram::bucket_index(15));
+  EXPECT_EQ(16U, Latency_histogram::bucket_index(16));
+  EXPECT_EQ(16U, Latency_histogram::bucket_index(17));
+  EXPECT_EQ(17U, Latency_histogram::bucket_index(18));
+  EXPECT_EQ(24U, Latency_histogram::bucket_index(32));
+
+  /* each bucket runs from its floor to the next bucket's floor, and is
+     no wider than 1/SUB_COUNT of its floor */
+  for (unsigned i = 0; i + 1 != Latency_histogram::BUCKET_COUNT; ++i) {
+    const auto lo = Latency_histogram::bucket_floor(i);
+    const auto hi = Latency_histogram::bucket_floor(i + 1) - 1;
+    EXPECT_EQ(i, Latency_histogram::bucket_index(lo)) << lo;
+    EXPECT_EQ(i, Latency_histogram::bucket_index(hi)) << hi;
+    EXPECT_LE((hi - lo) * Latency_histogram::SUB_COUNT, lo) << i;
+  }
+}
+
+TEST(Latency_histogram_test, Overflow)
+{
+  constexpr unsigned last = Latency_histogram::BUCKET_COUNT - 1;
+  constexpr uint64_t limit = uint64_t(1) << Latency_histogram::MAX_BITS;
+  EXPECT_EQ(last, Latency_histogram::bucket_index(limit - 1));
+  EXPECT_EQ(last, Latency_histogram::bucket_index(limit));
+  EXPECT_EQ(last, Latency_histogram::bucket_index(~uint64_t(0)));
+
+  Latency_histogram h{};
+  h.record(~uint64_t(0));
+  EXPECT_EQ(1U, h.bucket[last]);
+  EXPECT_EQ(~uint64_t(0), h.max_ns);
+  EXPECT_EQ(~uint64_t(0), h.percentile(100.0));
+}
+
+TEST(Latency_histogram_test, RecordAndPercentile)
+{
+  Latency_histogram h{};
+  EXPECT_EQ(0U, h.percentile(50.0));
+  for (uint64_t ns = 1; ns <= 1000; ++ns) h.record(ns);
+  EXPECT_EQ(1000U, h.count);
+  EXPECT_DOUBLE_EQ(500.5, h.mean());
+  EXPECT_EQ(1000U, h.max_ns);
+  /* within one bucket (1/SUB_COUNT) above the true percentile */
+  const auto p50 = h.percentile(50.0);
+  EXPECT_LE(500U, p50);
+  EXPECT_GE(500U + 500U / Latency_histogram::SUB_COUNT, p50);
+  EXPECT_EQ(1000U, h.percentile(100.0));
+}
+
+TEST(Latency_histogram_test, Merge)
+{
+  Latency_histogram a{};
+  Latency_histogram b{};
+  Latency_histogram both{};
+  for (uint64_t ns = 0; ns != 500; ++ns) {
+    a.record(ns * 3);
+    both.record(ns * 3);
+  }
+  for (uint64_t ns = 0; ns != 300; ++ns) {
+    b.record(ns * 7 + 100000);
+    both.record(ns * 7 + 100000);
+  }
+  a.merge(b);
+  EXPECT_EQ(both.count, a.count);
+  EXPECT_EQ(both.sum_ns, a.sum_ns);
+  EXPECT_EQ(both.max_ns, a.max_ns);
+  for (unsigned i = 0; i != Latency_histogram::BUCKET_COUNT; ++i) EXPECT_EQ(both.bucket[i], a.bucket[i]) << i;
+  EXPECT_EQ(both.percentile(99.0), a.percentile(99.0));
+
+  a.reset();
+  EXPECT_EQ(0U, a.count);
+  EXPECT_EQ(0U, a.max_ns);
+  EXPECT_EQ(0U, a.percentile(50.0));
+}
+
+TEST_F(mcas_client_test, LatencyStatsReset)
+{
+  PMAJOR("Running LatencyStatsReset...");
+  ASSERT_TRUE(_imcas.get());
+
+  const std::string poolname = Options.pool + "/LatencyStatsReset";
+  auto              pool     = _imcas->create_pool(poolname, MB(8), 0, 100);
+  ASSERT_NE(+IMCAS::POOL_ERROR, pool);
+
+  constexpr unsigned count = 10;
+  for (unsigned i = 0; i != count; ++i) ASSERT_EQ(S_OK, _imcas->put(pool, "latency-" + std::to_string(i), "v"));
+
+  /* the reading which resets still reports the puts */
+  IMCAS::Shard_stats stats;
+  ASSERT_EQ(S_OK, _imcas->get_statistics(stats, true));
+  const auto &put = stats.latency[IMCAS::LATENCY_OP_PUT];
+  EXPECT_LE(count, put.total.count);
+  EXPECT_LE(count, put.store.count);
+  EXPECT_LE(put.store.percentile(50.0), put.total.percentile(50.0));
+  const auto put_count = stats.op_put_count;
+
+  /* after it, the histograms are empty but the counters are not reset */
+  ASSERT_EQ(S_OK, _imcas->get_statistics(stats));
+  EXPECT_EQ(0U, stats.latency[IMCAS::LATENCY_OP_PUT].total.count);
+  EXPECT_EQ(0U, stats.latency[IMCAS::LATENCY_OP_PUT].store.count);
+  EXPECT_EQ(put_count, stats.op_put_count);
+
+  ASSERT_EQ(S_OK, _imcas->close_pool(pool));
+  ASSERT_EQ(S_OK, _imcas->delete_pool(poolname));
+}
+
 #ifdef TEST_SCALE_IOPS
 
 struct record_t {
@@ -726,6 +1103,7 @@ TEST_F(mcas_client_test, Release)
 
   /* release instance */
   _mcas.reset(nullptr);
+  _imcas.reset(nullptr);
 }
 
 }  // namespace
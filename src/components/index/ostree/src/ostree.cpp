@@ -0,0 +1,282 @@
+/*
+ * (C) Copyright IBM Corporation 2021. All rights reserved.
+ *
+ */
+
+#include "ostree.h"
+
+#include <algorithm>
+#include <cassert>
+#include <numeric>
+#include <utility>
+
+namespace
+{
+template <typename T>
+void insert_at(T *array, unsigned n, unsigned pos, T &&v)
+{
+  std::move_backward(array + pos, array + n, array + n + 1);
+  array[pos] = std::move(v);
+}
+
+template <typename T>
+void erase_at(T *array, unsigned n, unsigned pos)
+{
+  std::move(array + pos + 1, array + n, array + pos);
+  array[n - 1] = T();
+}
+}  // namespace
+
+const std::string &Ostree::cursor::key() const
+{
+  assert(_leaf);
+  return _leaf->key[_slot];
+}
+
+void Ostree::cursor::next()
+{
+  assert(_leaf);
+  if (++_slot == _leaf->n) {
+    _leaf = _leaf->next; /* empty leaves are unlinked, so next is non-empty */
+    _slot = 0;
+  }
+}
+
+unsigned Ostree::Inner::child_for(const std::string &key) const
+{
+  return unsigned(std::upper_bound(sep + 1, sep + n, key) - sep) - 1;
+}
+
+Ostree::Ostree() : _root(nullptr), _size(0), _version(0) {}
+
+Ostree::~Ostree() { destroy(_root); }
+
+void Ostree::destroy(Node *n)
+{
+  if (n == nullptr) return;
+
+  if (n->is_leaf) {
+    delete static_cast<Leaf *>(n);
+  }
+  else {
+    auto in = static_cast<Inner *>(n);
+    for (unsigned i = 0; i != in->n; ++i) destroy(in->child[i]);
+    delete in;
+  }
+}
+
+void Ostree::clear()
+{
+  destroy(_root);
+  _root = nullptr;
+  _size = 0;
+  ++_version;
+}
+
+std::size_t Ostree::descend(const std::string &key, step_t *path, Leaf *&leaf) const
+{
+  std::size_t depth = 0;
+  Node *      n     = _root;
+
+  while (!n->is_leaf) {
+    assert(depth < MAX_DEPTH);
+    auto in       = static_cast<Inner *>(n);
+    auto i        = in->child_for(key);
+    path[depth++] = {in, i};
+    n             = in->child[i];
+  }
+  leaf = static_cast<Leaf *>(n);
+  return depth;
+}
+
+bool Ostree::insert(const std::string &key)
+{
+  if (_root == nullptr) {
+    _root = new Leaf();
+  }
+
+  step_t     path[MAX_DEPTH];
+  Leaf *     lf;
+  const auto depth = descend(key, path, lf);
+  const auto pos   = unsigned(std::lower_bound(lf->key, lf->key + lf->n, key) - lf->key);
+
+  if (pos < lf->n && lf->key[pos] == key) return false;
+
+  for (std::size_t d = 0; d != depth; ++d) ++path[d].node->count[path[d].index];
+  ++_size;
+  ++_version;
+
+  if (lf->n < LEAF_MAX) {
+    insert_at(lf->key, lf->n++, pos, std::string(key));
+    return true;
+  }
+
+  /* split the full leaf, then carry the new right sibling up the path,
+     splitting inner nodes as they fill */
+  constexpr unsigned LH    = LEAF_MAX / 2;
+  auto               right = new Leaf();
+  std::move(lf->key + LH, lf->key + LEAF_MAX, right->key);
+  right->n = LEAF_MAX - LH;
+  lf->n    = LH;
+
+  right->next = lf->next;
+  right->prev = lf;
+  if (lf->next) lf->next->prev = right;
+  lf->next = right;
+
+  if (pos <= LH)
+    insert_at(lf->key, lf->n++, pos, std::string(key));
+  else
+    insert_at(right->key, right->n++, pos - LH, std::string(key));
+
+  Node *      left_node  = lf;
+  std::size_t left_count = lf->n;
+  Node *      new_node   = right;
+  std::size_t new_count  = right->n;
+  std::string up         = right->key[0];
+
+  const auto total = [](const Inner *in) { return std::accumulate(in->count, in->count + in->n, std::size_t(0)); };
+
+  const auto insert_child = [&](Inner *in, unsigned at) {
+    insert_at(in->count, in->n, at, std::size_t(new_count));
+    insert_at(in->child, in->n, at, std::move(new_node));
+    insert_at(in->sep, in->n, at, std::move(up));
+    ++in->n;
+  };
+
+  for (std::size_t d = depth; d-- != 0;) {
+    auto       in = path[d].node;
+    const auto i  = path[d].index;
+
+    in->count[i] = left_count;
+    if (in->n < INNER_MAX) {
+      insert_child(in, i + 1);
+      return true;
+    }
+
+    constexpr unsigned IH  = INNER_MAX / 2;
+    auto               rin = new Inner();
+    std::move(in->count + IH, in->count + INNER_MAX, rin->count);
+    std::move(in->child + IH, in->child + INNER_MAX, rin->child);
+    std::move(in->sep + IH, in->sep + INNER_MAX, rin->sep); /* rin->sep[0] is the separator to push up */
+    rin->n = INNER_MAX - IH;
+    in->n  = IH;
+
+    if (i + 1 <= IH)
+      insert_child(in, i + 1);
+    else
+      insert_child(rin, i + 1 - IH);
+
+    left_node  = in;
+    left_count = total(in);
+    new_node   = rin;
+    new_count  = total(rin);
+    up         = rin->sep[0];
+  }
+
+  /* the root was split */
+  assert(left_node == _root);
+  auto root      = new Inner();
+  root->child[0] = left_node;
+  root->count[0] = left_count;
+  root->child[1] = new_node;
+  root->count[1] = new_count;
+  root->sep[1]   = std::move(up);
+  root->n        = 2;
+  _root          = root;
+  return true;
+}
+
+bool Ostree::erase(const std::string &key)
+{
+  if (_root == nullptr) return false;
+
+  step_t     path[MAX_DEPTH];
+  Leaf *     lf;
+  const auto depth = descend(key, path, lf);
+  const auto pos   = unsigned(std::lower_bound(lf->key, lf->key + lf->n, key) - lf->key);
+
+  if (pos == lf->n || lf->key[pos] != key) return false;
+
+  for (std::size_t d = 0; d != depth; ++d) --path[d].node->count[path[d].index];
+  erase_at(lf->key, lf->n--, pos);
+  --_size;
+  ++_version;
+
+  if (lf->n != 0) return true;
+
+  /* unlink and free the emptied leaf */
+  if (lf->prev) lf->prev->next = lf->next;
+  if (lf->next) lf->next->prev = lf->prev;
+  delete lf;
+
+  if (depth == 0)
+    _root = nullptr;
+  else
+    remove_child(path, depth);
+
+  return true;
+}
+
+void Ostree::remove_child(step_t *path, std::size_t depth)
+{
+  /* remove the (freed) child at the bottom of the path, freeing any
+     inner nodes left empty */
+  while (depth != 0) {
+    auto       in = path[depth - 1].node;
+    const auto i  = path[depth - 1].index;
+
+    erase_at(in->count, in->n, i);
+    erase_at(in->child, in->n, i);
+    erase_at(in->sep, in->n, i);
+    if (--in->n != 0) break;
+
+    delete in;
+    if (--depth == 0) _root = nullptr;
+  }
+
+  /* collapse a root with a single child */
+  while (_root && !_root->is_leaf && static_cast<Inner *>(_root)->n == 1) {
+    auto old = static_cast<Inner *>(_root);
+    _root    = old->child[0];
+    delete old;
+  }
+}
+
+Ostree::cursor Ostree::select(std::size_t position) const
+{
+  cursor c;
+  if (position >= _size) return c;
+
+  const Node *n = _root;
+  while (!n->is_leaf) {
+    auto     in = static_cast<const Inner *>(n);
+    unsigned i  = 0;
+    while (position >= in->count[i]) {
+      position -= in->count[i];
+      ++i;
+    }
+    n = in->child[i];
+  }
+
+  c._leaf = static_cast<const Leaf *>(n);
+  c._slot = unsigned(position);
+  return c;
+}
+
+std::size_t Ostree::rank(const std::string &key) const
+{
+  if (_root == nullptr) return 0;
+
+  std::size_t r = 0;
+  const Node *n = _root;
+  while (!n->is_leaf) {
+    auto       in = static_cast<const Inner *>(n);
+    const auto i  = in->child_for(key);
+    r             = std::accumulate(in->count, in->count + i, r);
+    n             = in->child[i];
+  }
+
+  auto lf = static_cast<const Leaf *>(n);
+  return r + std::size_t(std::lower_bound(lf->key, lf->key + lf->n, key) - lf->key);
+}
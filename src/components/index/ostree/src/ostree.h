@@ -0,0 +1,136 @@
+/*
+ * (C) Copyright IBM Corporation 2021. All rights reserved.
+ *
+ */
+
+#ifndef __OSTREE_H__
+#define __OSTREE_H__
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+/**
+ * Order-statistic B+tree of unique strings.  Inner nodes keep the size
+ * of each child subtree beside the child pointer, so that positional
+ * lookup (select) and key rank are O(log n).  Leaves are chained, so
+ * that moving a cursor to the next position is O(1).
+ *
+ * Keys are variable length, so nodes cannot be a single cache line;
+ * instead nodes are cache line aligned and the subtree counts which a
+ * select descent reads are kept in one contiguous array ahead of the
+ * keys.
+ *
+ * Erase does not rebalance: emptied nodes are unlinked and a root with
+ * a single child is collapsed, but part-full nodes are not merged.
+ */
+class Ostree {
+ public:
+  static constexpr unsigned LEAF_MAX  = 32; /*< keys per leaf */
+  static constexpr unsigned INNER_MAX = 32; /*< children per inner node */
+
+ private:
+  struct Node;
+  struct Leaf;
+  struct Inner;
+
+ public:
+  /**
+   * Position in the tree.  A cursor is invalidated by any insert or
+   * erase which changes the tree.
+   */
+  class cursor {
+    friend class Ostree;
+    const Leaf *_leaf;
+    unsigned    _slot;
+
+   public:
+    cursor() : _leaf(nullptr), _slot(0) {}
+    bool               valid() const { return _leaf != nullptr; }
+    const std::string &key() const;
+    void               next();
+  };
+
+  Ostree();
+  Ostree(const Ostree &) = delete;
+  Ostree &operator=(const Ostree &) = delete;
+  ~Ostree();
+
+  /**
+   * Insert a key
+   *
+   * @return true if inserted, false if already present
+   */
+  bool insert(const std::string &key);
+
+  /**
+   * Erase a key
+   *
+   * @return true if erased, false if not present
+   */
+  bool erase(const std::string &key);
+
+  void clear();
+
+  std::size_t size() const { return _size; }
+
+  /**
+   * Cursor at a position counting from zero; invalid if position >= size()
+   */
+  cursor select(std::size_t position) const;
+
+  /**
+   * Number of keys which compare less than key, i.e. the position key
+   * has or would have
+   */
+  std::size_t rank(const std::string &key) const;
+
+  /**
+   * Modification count, so that callers can tell whether a saved
+   * cursor is still usable
+   */
+  std::uint64_t version() const { return _version; }
+
+ private:
+  struct Node {
+    bool     is_leaf;
+    unsigned n; /*< keys (leaf) or children (inner) in use */
+    explicit Node(bool leaf) : is_leaf(leaf), n(0) {}
+  };
+
+  struct alignas(64) Leaf : Node {
+    Leaf *      next;
+    Leaf *      prev;
+    std::string key[LEAF_MAX];
+    Leaf() : Node(true), next(nullptr), prev(nullptr), key{} {}
+    Leaf(const Leaf &) = delete;
+    Leaf &operator=(const Leaf &) = delete;
+  };
+
+  struct alignas(64) Inner : Node {
+    std::size_t count[INNER_MAX]; /*< keys in each child subtree */
+    Node *      child[INNER_MAX];
+    std::string sep[INNER_MAX]; /*< sep[i] <= every key in child[i], i > 0 */
+    Inner() : Node(false), count{}, child{}, sep{} {}
+    Inner(const Inner &) = delete;
+    Inner &operator=(const Inner &) = delete;
+    unsigned child_for(const std::string &key) const;
+  };
+
+  struct step_t {
+    Inner *  node;
+    unsigned index;
+  };
+
+  static constexpr unsigned MAX_DEPTH = 16; /*< 32^16 keys, well beyond memory */
+
+  void        destroy(Node *n);
+  std::size_t descend(const std::string &key, step_t *path, Leaf *&leaf) const;
+  void        remove_child(step_t *path, std::size_t depth);
+
+  Node *        _root;
+  std::size_t   _size;
+  std::uint64_t _version;
+};
+
+#endif  // __OSTREE_H__
@@ -0,0 +1,167 @@
+/*
+ * (C) Copyright IBM Corporation 2021. All rights reserved.
+ *
+ */
+
+#include "ostree_index.h"
+
+#include <common/logging.h>
+#include <stdexcept>
+
+using namespace component;
+using namespace std;
+
+Ostree_secondary_index::Ostree_secondary_index()
+  : _index{},
+    _cursor{},
+    _cursor_position(0),
+    _cursor_version(0),
+    _matcher()
+{
+}
+
+Ostree_secondary_index::~Ostree_secondary_index() {}
+
+void Ostree_secondary_index::insert(const string& key) { _index.insert(key); }
+
+void Ostree_secondary_index::erase(const std::string& key) { _index.erase(key); }
+
+void Ostree_secondary_index::clear() { _index.clear(); }
+
+size_t Ostree_secondary_index::count() const { return _index.size(); }
+
+Ostree::cursor Ostree_secondary_index::seek(offset_t position) const
+{
+  if (_cursor.valid() && _cursor_position == position && _cursor_version == _index.version())
+    return _cursor;
+
+  return _index.select(position);
+}
+
+void Ostree_secondary_index::save_cursor(offset_t position, const Ostree::cursor& at) const
+{
+  _cursor          = at;
+  _cursor_position = position;
+  _cursor_version  = _index.version();
+}
+
+string Ostree_secondary_index::get(offset_t position) const
+{
+  auto c = seek(position);
+  if (!c.valid()) {
+    throw out_of_range("Position out of range");
+  }
+
+  string key = c.key();
+  c.next();
+  save_cursor(position + 1, c);
+  return key;
+}
+
+status_t Ostree_secondary_index::find(const std::string& key_expression,
+                                      offset_t           begin_position,
+                                      find_t             find_type,
+                                      offset_t&          out_matched_pos,
+                                      std::string&       out_matched_key,
+                                      unsigned           max_comparisons)
+{
+  if (begin_position >= _index.size()) {
+    return E_FAIL;
+  }
+
+  switch (find_type) {
+  case FIND_TYPE_NEXT:
+    out_matched_key = get(begin_position);
+    out_matched_pos = begin_position;
+    return S_OK;
+
+  case FIND_TYPE_EXACT:
+  case FIND_TYPE_PREFIX:
+  case FIND_TYPE_RANGE: {
+    /* ordered: the first key at or after begin_position which is not
+       below the lower bound is the only candidate, found in O(log n),
+       or O(1) when resuming at the cursor */
+    string from, to;
+    if (find_type == FIND_TYPE_RANGE)
+      split_range_expression(key_expression, from, to);
+    else
+      from = key_expression;
+
+    offset_t pos = begin_position;
+    auto     c   = seek(pos);
+    if (c.key() < from) {
+      pos = _index.rank(from);
+      c   = _index.select(pos);
+    }
+    if (!c.valid()) return E_FAIL;
+
+    bool matched;
+    if (find_type == FIND_TYPE_EXACT)
+      matched = c.key() == from;
+    else if (find_type == FIND_TYPE_PREFIX)
+      matched = c.key().compare(0, from.size(), from) == 0;
+    else
+      matched = to.empty() || c.key() < to;
+    if (!matched) return E_FAIL;
+
+    out_matched_key = c.key();
+    out_matched_pos = pos;
+    c.next();
+    save_cursor(pos + 1, c);
+    return S_OK;
+  }
+
+  case FIND_TYPE_REGEX: {
+    /* compiled once per expression, not once per call; a literal prefix
+       of the expression bounds the scan */
+    if (!_matcher || _matcher->expression() != key_expression)
+      _matcher = common::Key_matcher::create(key_expression);
+    const string& prefix = _matcher->literal_prefix();
+
+    unsigned attempts = 0;
+    auto     c        = seek(begin_position);
+    out_matched_pos   = begin_position;
+    if (c.valid() && c.key() < prefix) {
+      out_matched_pos = _index.rank(prefix);
+      c               = _index.select(out_matched_pos);
+    }
+
+    for (; c.valid(); ++out_matched_pos, c.next()) {
+      if (c.key().compare(0, prefix.size(), prefix) != 0) break; /* past the keys with the prefix */
+
+      if (_matcher->match(c.key())) {
+        out_matched_key = c.key();
+        c.next();
+        save_cursor(out_matched_pos + 1, c);
+        return S_OK;
+      }
+
+      /* the caller resumes at out_matched_pos + 1, which the saved cursor makes O(1) */
+      if (max_comparisons && ++attempts > max_comparisons) {
+        c.next();
+        save_cursor(out_matched_pos + 1, c);
+        return E_MAX_REACHED;
+      }
+    }
+    return E_FAIL;
+  }
+
+  default:
+    break;
+  }
+
+  return E_FAIL;
+}
+
+/**
+ * Factory entry point.  The shard loads every index component
+ * (AddIndex::<name>) with the generic index_factory identifier.
+ */
+extern "C" void* factory_createInstance(component::uuid_t component_id)
+{
+  if (component_id == Ostree_secondary_index_factory::component_id() || component_id == component::index_factory) {
+    return static_cast<void*>(new Ostree_secondary_index_factory());
+  }
+  else
+    return NULL;
+}
@@ -0,0 +1,101 @@
+/*
+ * (C) Copyright IBM Corporation 2021. All rights reserved.
+ *
+ */
+
+#ifndef __OSTREE_INDEX_COMPONENT_H__
+#define __OSTREE_INDEX_COMPONENT_H__
+
+#include <api/components.h>
+#include <api/kvindex_itf.h>
+#include <common/key_matcher.h>
+#include <memory>
+#include <string>
+
+#include "ostree.h"
+
+/**
+ * Volatile secondary index over an order-statistic B+tree.  Positional
+ * access is O(log n), as opposed to O(n) for the rbtree index.  The
+ * position following the last key returned by get or find is remembered,
+ * so that a scan which resumes there (e.g. Key_find_task) continues in
+ * O(1) rather than seeking again.
+ *
+ * Differences from the rbtree index: FIND_TYPE_EXACT also uses the
+ * ordering, a scan which reaches the end of the index returns E_FAIL,
+ * and max_comparisons of 0 means unlimited.
+ */
+class Ostree_secondary_index : public component::IKVIndex {
+ public:
+  Ostree_secondary_index();
+  virtual ~Ostree_secondary_index();
+
+  DECLARE_VERSION(0.1f);
+  DECLARE_COMPONENT_UUID(0x0b5e7c61, 0x5a0d, 0x4f3e, 0x9c27, 0x41, 0xd8, 0x6e, 0x2b, 0x73, 0x05);
+
+  void* query_interface(component::uuid_t& itf_uuid) override
+  {
+    if (itf_uuid == component::IKVIndex::iid()) {
+      return static_cast<component::IKVIndex*>(this);
+    }
+    else
+      return NULL;  // we don't support this interface
+  }
+
+  void unload() override { delete this; }
+
+ public:
+  virtual void        insert(const std::string& key) override;
+  virtual void        erase(const std::string& key) override;
+  virtual void        clear() override;
+  virtual std::string get(offset_t position) const override;
+  virtual size_t      count() const override;
+  virtual status_t    find(const std::string& key_expression,
+                           offset_t           begin_position,
+                           find_t             find_type,
+                           offset_t&          out_end_position,
+                           std::string&       out_matched_key,
+                           unsigned           max_comparisons = 0) override;
+
+ private:
+  Ostree::cursor seek(offset_t position) const;
+  void           save_cursor(offset_t position, const Ostree::cursor& at) const;
+
+  Ostree _index;
+
+  /* continuation: cursor at _cursor_position, valid while the tree is
+     at _cursor_version */
+  mutable Ostree::cursor _cursor;
+  mutable offset_t       _cursor_position;
+  mutable uint64_t       _cursor_version;
+
+  /* regex of the last FIND_TYPE_REGEX, kept for the calls which resume it */
+  std::unique_ptr<common::Key_matcher> _matcher;
+};
+
+class Ostree_secondary_index_factory : public component::IKVIndex_factory {
+ public:
+  DECLARE_VERSION(0.1f);
+
+  /* index_factory - see components.h */
+  DECLARE_COMPONENT_UUID(0xfac57c61, 0x5a0d, 0x4f3e, 0x9c27, 0x41, 0xd8, 0x6e, 0x2b, 0x73, 0x05);
+
+  void* query_interface(component::uuid_t& itf_uuid) override
+  {
+    if (itf_uuid == component::IKVIndex_factory::iid())
+      return static_cast<component::IKVIndex_factory*>(this);
+    else
+      return NULL;  // we don't support this interface
+  }
+
+  void unload() override { delete this; }
+
+  virtual component::IKVIndex* create_dynamic(const std::string& /*not used: dax_config*/) override
+  {
+    component::IKVIndex* obj = static_cast<component::IKVIndex*>(new Ostree_secondary_index());
+    assert(obj);
+    obj->add_ref();
+    return obj;
+  }
+};
+#endif  // __OSTREE_INDEX_COMPONENT_H__
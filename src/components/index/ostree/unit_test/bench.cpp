@@ -0,0 +1,88 @@
+/*
+ * Compare the ostree and rbtree index components on the operations used
+ * by key find: positional get and a bounded-comparison regex scan resumed
+ * after each call, as Key_find_task does.
+ *
+ * usage: ostree-bench [key count]
+ */
+#include <api/components.h>
+#include <api/kvindex_itf.h>
+#include <common/logging.h>
+#include <common/str_utils.h>
+
+#include <chrono>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+using namespace component;
+
+namespace
+{
+constexpr unsigned LENGTH                = 16;
+constexpr unsigned MAX_COMPARES_PER_WORK = 5; /* as Key_find_task */
+
+IKVIndex *load_index(const char *dll)
+{
+  IBase *comp = load_component(dll, index_factory);
+  if (!comp) {
+    PERR("unable to load %s", dll);
+    return nullptr;
+  }
+  auto fact = make_itf_ref(static_cast<IKVIndex_factory *>(comp->query_interface(IKVIndex_factory::iid())));
+  return fact->create_dynamic("");
+}
+
+double since(std::chrono::steady_clock::time_point start)
+{
+  return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+void run(const char *name, IKVIndex *index, const std::vector<std::string> &keys)
+{
+  auto start = std::chrono::steady_clock::now();
+  for (const auto &k : keys) index->insert(k);
+  const double insert_sec = since(start);
+
+  /* positional get over the whole index */
+  start = std::chrono::steady_clock::now();
+  for (offset_t i = 0; i != index->count(); ++i) index->get(i);
+  const double get_sec = since(start);
+
+  /* regex which never matches, so the scan visits every key */
+  start               = std::chrono::steady_clock::now();
+  offset_t pos        = 0;
+  unsigned work_count = 0;
+  for (;;) {
+    offset_t    matched;
+    std::string key;
+    ++work_count;
+    auto hr = index->find("#.*", pos, IKVIndex::FIND_TYPE_REGEX, matched, key, MAX_COMPARES_PER_WORK);
+    if (hr != E_MAX_REACHED) break;
+    pos = matched + 1;
+  }
+  const double find_sec = since(start);
+
+  PINF("%-8s keys=%zu insert %.3f s, get-all %.3f s, regex scan %.3f s (%u calls)", name, index->count(), insert_sec,
+       get_sec, find_sec, work_count);
+}
+}  // namespace
+
+int main(int argc, char **argv)
+{
+  const size_t count = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 20000;
+
+  std::vector<std::string> keys;
+  keys.reserve(count);
+  for (size_t i = 0; i != count; ++i) keys.push_back(common::random_string(LENGTH));
+
+  for (auto name : {"ostree", "rbtree"}) {
+    const std::string dll = std::string("libcomponent-index-") + name + ".so";
+    auto              index = load_index(dll.c_str());
+    if (!index) return 1;
+    run(name, index, keys);
+    index->release_ref();
+  }
+
+  return 0;
+}
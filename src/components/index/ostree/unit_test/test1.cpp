@@ -0,0 +1,179 @@
+/* note: we do not include component source, only the API definition */
+#include <api/components.h>
+#include <api/kvindex_itf.h>
+#include <common/str_utils.h>
+#include <common/utils.h>
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Weffc++"
+#include <gtest/gtest.h>
+#pragma GCC diagnostic pop
+
+#include <set>
+#include <string>
+
+#define COUNT 100000
+#define LENGTH 16
+
+using namespace component;
+using namespace common;
+using namespace std;
+
+namespace
+{
+class Ostree_test : public ::testing::Test {
+ protected:
+  static component::IKVIndex *_kvindex;
+  static std::set<std::string> _model;
+};
+
+component::IKVIndex *Ostree_test::_kvindex;
+std::set<std::string> Ostree_test::_model;
+
+TEST_F(Ostree_test, Instantiate)
+{
+  /* create object instance through factory */
+  component::IBase *comp = component::load_component("libcomponent-index-ostree.so",
+                                                     component::index_factory);
+
+  ASSERT_TRUE(comp);
+  auto fact =
+    make_itf_ref(
+      static_cast<IKVIndex_factory *>(comp->query_interface(IKVIndex_factory::iid()))
+    );
+
+  _kvindex = fact->create_dynamic("");
+  ASSERT_TRUE(_kvindex);
+}
+
+TEST_F(Ostree_test, Insert)
+{
+  for (int i = 0; i < COUNT; i++) {
+    auto k = random_string(LENGTH);
+    _kvindex->insert(k);
+    _model.insert(k);
+  }
+  /* duplicates are ignored */
+  _kvindex->insert(*_model.begin());
+  ASSERT_EQ(_model.size(), _kvindex->count());
+}
+
+TEST_F(Ostree_test, Get)
+{
+  /* sequential (cursor) and random (select) access */
+  offset_t pos = 0;
+  for (const auto &k : _model) {
+    ASSERT_EQ(k, _kvindex->get(pos));
+    pos++;
+  }
+  pos = 0;
+  for (const auto &k : _model) {
+    if (pos % 97 == 0) {
+      ASSERT_EQ(k, _kvindex->get(pos));
+    }
+    pos++;
+  }
+  ASSERT_THROW(_kvindex->get(_model.size()), std::out_of_range);
+}
+
+TEST_F(Ostree_test, Erase)
+{
+  /* erase every other key */
+  unsigned i = 0;
+  for (auto it = _model.begin(); it != _model.end();) {
+    if (i++ % 2) {
+      _kvindex->erase(*it);
+      it = _model.erase(it);
+    }
+    else
+      ++it;
+  }
+  _kvindex->erase("not-a-key");
+  ASSERT_EQ(_model.size(), _kvindex->count());
+
+  offset_t pos = 0;
+  for (const auto &k : _model) {
+    ASSERT_EQ(k, _kvindex->get(pos));
+    pos++;
+  }
+}
+
+TEST_F(Ostree_test, FindExact)
+{
+  auto     it = std::next(_model.begin(), offset_t(_model.size() / 2));
+  offset_t matched;
+  string   key;
+  ASSERT_EQ(S_OK, _kvindex->find(*it, 0, IKVIndex::FIND_TYPE_EXACT, matched, key));
+  ASSERT_EQ(*it, key);
+  ASSERT_EQ(offset_t(_model.size() / 2), matched);
+  /* not found after the match position */
+  ASSERT_EQ(E_FAIL, _kvindex->find(*it, matched + 1, IKVIndex::FIND_TYPE_EXACT, matched, key));
+}
+
+TEST_F(Ostree_test, FindRegexContinuation)
+{
+  /* scan as Key_find_task does: bounded comparisons, resume after the last */
+  const string expr = "a.*";
+  offset_t     pos  = 0;
+  size_t       hits = 0;
+  for (;;) {
+    string   key;
+    offset_t matched;
+    auto     hr = _kvindex->find(expr, pos, IKVIndex::FIND_TYPE_REGEX, matched, key, 5);
+    if (hr == E_MAX_REACHED) {
+      pos = matched + 1;
+      continue;
+    }
+    if (hr != S_OK) break;
+    ASSERT_EQ('a', key[0]);
+    hits++;
+    pos = matched + 1;
+  }
+
+  size_t expected = 0;
+  for (const auto &k : _model)
+    if (k[0] == 'a') expected++;
+  ASSERT_EQ(expected, hits);
+}
+
+TEST_F(Ostree_test, FindPrefixRange)
+{
+  /* ordered finds: each call yields the next match or E_FAIL */
+  auto count_matches = [](IKVIndex::find_t type, const string &expr) {
+    offset_t pos = 0, matched;
+    size_t   hits = 0;
+    string   key;
+    while (_kvindex->find(expr, pos, type, matched, key) == S_OK) {
+      hits++;
+      pos = matched + 1;
+    }
+    return hits;
+  };
+
+  size_t prefix_expected = 0, range_expected = 0;
+  for (const auto &k : _model) {
+    if (k.compare(0, 2, "ab") == 0) prefix_expected++;
+    if (k >= "B" && k < "D") range_expected++;
+  }
+
+  ASSERT_EQ(prefix_expected, count_matches(IKVIndex::FIND_TYPE_PREFIX, "ab"));
+  ASSERT_EQ(range_expected, count_matches(IKVIndex::FIND_TYPE_RANGE, IKVIndex::make_range_expression("B", "D")));
+  ASSERT_EQ(_model.size(), count_matches(IKVIndex::FIND_TYPE_RANGE, IKVIndex::make_range_expression("", "")));
+}
+
+TEST_F(Ostree_test, Clear)
+{
+  _kvindex->clear();
+  ASSERT_EQ(0UL, _kvindex->count());
+  _kvindex->release_ref();
+}
+
+}  // namespace
+
+int main(int argc, char **argv)
+{
+  ::testing::InitGoogleTest(&argc, argv);
+  auto r = RUN_ALL_TESTS();
+
+  return r;
+}
@@ -1,6 +1,6 @@
 #include "ramrbtree.h"
+#include <common/key_matcher.h>
 #include <stdlib.h>
-#include <regex>
 #include <set>
 
 #define SINGLE_THREADED
@@ -9,7 +9,11 @@ using namespace component;
 using namespace std;
 
 Rbtree_secondary_index::Rbtree_secondary_index()
-  : _index{}
+  : _index{},
+    _cursor{},
+    _cursor_position(0),
+    _cursor_valid(false),
+    _matcher()
 {
 }
 
@@ -18,20 +22,51 @@ Rbtree_secondary_index::~Rbtree_secondary_index() {}
 void Rbtree_secondary_index::insert(const string& key)
 {
   _index.insert(key);
+  _cursor_valid = false;
 }
 
-void Rbtree_secondary_index::erase(const std::string& key) { _index.erase(key); }
+void Rbtree_secondary_index::erase(const std::string& key)
+{
+  _index.erase(key);
+  _cursor_valid = false;
+}
 
-void Rbtree_secondary_index::clear() { _index.clear(); }
+void Rbtree_secondary_index::clear()
+{
+  _index.clear();
+  _cursor_valid = false;
+}
 
-string Rbtree_secondary_index::get(offset_t position) const
+Rbtree_secondary_index::iterator Rbtree_secondary_index::seek(offset_t position) const
 {
-  if (position >= _index.size()) {
-    throw out_of_range("Position out of range");
+  if (position >= _index.size()) return _index.end();
+
+  if (_cursor_valid && position >= _cursor_position) {
+    auto it = _cursor;
+    advance(it, position - _cursor_position);
+    return it;
   }
 
   auto it = _index.begin();
   advance(it, position);
+  return it;
+}
+
+void Rbtree_secondary_index::save_cursor(offset_t position, iterator it) const
+{
+  _cursor          = it;
+  _cursor_position = position;
+  _cursor_valid    = true;
+}
+
+string Rbtree_secondary_index::get(offset_t position) const
+{
+  auto it = seek(position);
+  if (it == _index.end()) {
+    throw out_of_range("Position out of range");
+  }
+
+  save_cursor(position + 1, std::next(it));
   return *it;
 }
 
@@ -58,16 +93,33 @@ status_t Rbtree_secondary_index::find(const std::string& key_expression,
     switch (find_type) {
     case FIND_TYPE_REGEX:
       {
-        std::regex r(key_expression);
-        for (out_matched_pos = begin_position; out_matched_pos <= end_position; out_matched_pos++) {
-          string key = Rbtree_secondary_index::get(out_matched_pos);
-          if (regex_match(key, r)) {
-            out_matched_key = key;
+        /* compiled once per expression, not once per call; a literal
+           prefix of the expression bounds the scan */
+        if (!_matcher || _matcher->expression() != key_expression)
+          _matcher = common::Key_matcher::create(key_expression);
+        const string& prefix = _matcher->literal_prefix();
+
+        offset_t pos = begin_position;
+        auto     it  = seek(pos);
+        if (*it < prefix) {
+          it  = _index.lower_bound(prefix);
+          pos = offset_t(distance(_index.begin(), it));
+        }
+        for (; it != _index.end(); ++it, ++pos) {
+          if (it->compare(0, prefix.size(), prefix) != 0)
+            break; /* past the keys with the prefix */
+          if (_matcher->match(*it)) {
+            out_matched_key = *it;
+            out_matched_pos = pos;
+            save_cursor(pos + 1, std::next(it));
             return S_OK;
           }
           else {
-            if(++attempts > max_comparisons)
+            if(++attempts > max_comparisons) {
+              out_matched_pos = pos;
+              save_cursor(pos + 1, std::next(it));
               return E_MAX_REACHED;
+            }
           }
         }
       }
@@ -87,14 +139,36 @@ status_t Rbtree_secondary_index::find(const std::string& key_expression,
       }
       break;
     case FIND_TYPE_PREFIX:
-      for (out_matched_pos = begin_position; out_matched_pos <= end_position; out_matched_pos++) {
-        string key = Rbtree_secondary_index::get(out_matched_pos);
-        if (key.find(key_expression) != string::npos) {
-          out_matched_key = key;
-          return S_OK;
+    case FIND_TYPE_RANGE:
+      {
+        /* ordered: seek to the first key not below the lower bound; it
+           is either the match or past the end of the prefix/range */
+        string from, to;
+        if (find_type == FIND_TYPE_RANGE)
+          split_range_expression(key_expression, from, to);
+        else
+          from = key_expression;
+
+        offset_t pos = begin_position;
+        auto     it  = seek(pos);
+        if (*it < from) {
+          it  = _index.lower_bound(from);
+          pos = offset_t(distance(_index.begin(), it)); /* set has no rank; linear, once per search */
         }
+        if (it == _index.end())
+          return E_FAIL;
+
+        const bool in_range = find_type == FIND_TYPE_RANGE
+          ? (to.empty() || *it < to)
+          : it->compare(0, key_expression.size(), key_expression) == 0;
+        if (!in_range)
+          return E_FAIL;
+
+        out_matched_key = *it;
+        out_matched_pos = pos;
+        save_cursor(pos + 1, std::next(it));
+        return S_OK;
       }
-      break;
     case FIND_TYPE_NEXT:
       if(begin_position >= end_position)
         return E_FAIL;
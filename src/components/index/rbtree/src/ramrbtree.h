@@ -8,7 +8,9 @@
 
 #include <string>
 #include <set>
+#include <memory>
 #include <api/kvindex_itf.h>
+#include <common/key_matcher.h>
 
 class Rbtree_secondary_index : public component::IKVIndex {
  public:
@@ -43,7 +45,21 @@ class Rbtree_secondary_index : public component::IKVIndex {
                            std::string&       out_matched_key,
                            unsigned           max_comparisons = 0) override;
 private:
+  using iterator = std::set<std::string>::const_iterator;
+
+  iterator seek(offset_t position) const;
+  void     save_cursor(offset_t position, iterator it) const;
+
   std::set<std::string> _index;
+
+  /* continuation: iterator at _cursor_position, so that sequential get
+     and resumed finds do not advance from the beginning each time */
+  mutable iterator _cursor;
+  mutable offset_t _cursor_position;
+  mutable bool     _cursor_valid;
+
+  /* regex of the last FIND_TYPE_REGEX, kept for the calls which resume it */
+  std::unique_ptr<common::Key_matcher> _matcher;
 };
 
 class Rbtree_secondary_index_factory : public component::IKVIndex_factory {
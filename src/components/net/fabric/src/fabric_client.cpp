@@ -77,6 +77,11 @@ void Fabric_client::wait_for_next_completion(std::chrono::milliseconds timeout)
 	return aep()->wait_for_next_completion(timeout);
 }
 
+bool Fabric_client::arm_completion_wait(std::vector<int> &fds_)
+{
+	return aep()->arm_completion_wait(fds_);
+}
+
 void Fabric_client::unblock_completions()
 {
 	return aep()->unblock_completions();
@@ -191,6 +191,10 @@ public:
    * @throw std::system_error : pselect fail
    */
   void wait_for_next_completion(std::chrono::milliseconds timeout) override { return _g.wait_for_next_completion(timeout); }
+  /*
+   * @throw fabric_runtime_error : std::runtime_error : ::fi_control fail
+   */
+  bool arm_completion_wait(std::vector<int> &fds_) override { return _g.arm_completion_wait(fds_); }
   void unblock_completions() override { return _g.unblock_completions(); }
   /* END IFabric_client_grouped (IFabric_op_completer) */
 
@@ -615,6 +615,43 @@ void fabric_endpoint::wait_for_next_completion(std::chrono::milliseconds timeout
   }
 }
 
+/**
+ * Prepare to wait for the next completion in a caller's poll.
+ *
+ * @param fds_ receives the cq file descriptors
+ *
+ * @return true if the caller may block on fds_
+ * @throw fabric_runtime_error - ::fi_control fail
+ */
+bool fabric_endpoint::arm_completion_wait(std::vector<int> &fds_)
+{
+  /* after FI_SHUTDOWN, the caller will learn of it by polling */
+  if ( _shut_down )
+  {
+    return false;
+  }
+#if USE_WAIT_SETS
+  /* a wait set has no single fd to offer */
+  (void) fds_;
+  return false;
+#else
+  static constexpr unsigned cq_count = 2;
+  ::fid_t f[cq_count] = { _rxcq.fid(), _txcq.fid() };
+  /* as in wait_for_next_completion: no waiting unless the cqs are quiet */
+  if ( fabric().trywait(f, cq_count) != FI_SUCCESS )
+  {
+    return false;
+  }
+  for ( unsigned i = 0; i != cq_count; ++i )
+  {
+    int fd;
+    CHECK_FI_ERR(::fi_control(f[i], FI_GETWAIT, &fd));
+    fds_.push_back(fd);
+  }
+  return true;
+#endif
+}
+
 void fabric_endpoint::wait_for_next_completion(unsigned polls_limit)
 {
   for ( ; polls_limit != 0; --polls_limit )
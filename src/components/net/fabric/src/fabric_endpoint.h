@@ -228,6 +228,10 @@ public:
    * @throw std::system_error : pselect fail
    */
   void wait_for_next_completion(std::chrono::milliseconds timeout) override;
+  /*
+   * @throw fabric_runtime_error : std::runtime_error : ::fi_control fail
+   */
+  bool arm_completion_wait(std::vector<int> &fds) override;
   void unblock_completions() override;
 
   /*
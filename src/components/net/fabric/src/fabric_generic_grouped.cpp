@@ -139,6 +139,12 @@ void Fabric_generic_grouped::wait_for_next_completion(std::chrono::milliseconds
   return aep()->wait_for_next_completion(timeout);
 }
 
+bool Fabric_generic_grouped::arm_completion_wait(std::vector<int> &fds_)
+{
+  std::lock_guard<std::mutex> k{_m_cnxn};
+  return aep()->arm_completion_wait(fds_);
+}
+
 void Fabric_generic_grouped::unblock_completions()
 {
   std::lock_guard<std::mutex> k{_m_cnxn};
@@ -75,6 +75,11 @@ void Fabric_server::wait_for_next_completion(std::chrono::milliseconds timeout)
 	return aep()->wait_for_next_completion(timeout);
 }
 
+bool Fabric_server::arm_completion_wait(std::vector<int> &fds_)
+{
+	return aep()->arm_completion_wait(fds_);
+}
+
 void Fabric_server::unblock_completions()
 {
 	return aep()->unblock_completions();
@@ -28,6 +28,7 @@
 #include <common/pointer_cast.h>
 #include <unistd.h> /* write */
 #include <netinet/in.h> /* sockaddr_in */
+#include <sys/eventfd.h> /* eventfd */
 #include <sys/select.h> /* fd_set, pselect */
 
 #include <algorithm> /* max */
@@ -48,6 +49,7 @@ Fabric_server_generic_factory::Fabric_server_generic_factory(Fabric &fabric_, ev
   , _event_registration(eq_, *this, *_pep)
   , _m_pending{}
   , _pending{}
+  , _pending_fd(::eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK | EFD_SEMAPHORE))
   , _open{}
   , _end{}
   , _eq{eq_}
@@ -107,6 +109,9 @@ try
       std::lock_guard<std::mutex> g{_m_pending};
       pending_count++;
       _pending.push(std::move(aep));
+      std::uint64_t one = 1;
+      auto sz = ::write(_pending_fd.fd(), &one, sizeof one);
+      (void) sz;
     }
     break;
   default:
@@ -295,7 +300,15 @@ auto Fabric_server_generic_factory::get_new_endpoint_unconnected() -> component:
   }
 
   std::lock_guard<std::mutex> g{_m_pending};
-  return _pending.remove().release();
+  auto c = _pending.remove();
+  if ( c )
+  {
+    /* consume one count of the semaphore */
+    std::uint64_t v;
+    auto sz = ::read(_pending_fd.fd(), &v, sizeof v);
+    (void) sz;
+  }
+  return c.release();
 }
 
 void Fabric_server_generic_factory::open_connection_generic(event_expecter *c)
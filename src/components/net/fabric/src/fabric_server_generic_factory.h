@@ -24,6 +24,8 @@
 #include "pending_cnxns.h"
 #include "open_cnxns.h"
 
+#include <common/fd_open.h>
+
 #include <cstdint> /* uint16_t */
 #include <future>
 #include <memory> /* shared_ptr */
@@ -52,6 +54,8 @@ class Fabric_server_generic_factory
   /* pending connections: inserts by polling thread, removes by user thread */
   std::mutex _m_pending;
   Pending_cnxns _pending;
+  /* eventfd (semaphore mode) counting the entries in _pending */
+  common::Fd_open _pending_fd;
 
   Open_cnxns _open;
   /* a write tells the listener thread to exit */
@@ -107,6 +111,8 @@ public:
    */
   component::IFabric_endpoint_unconnected_server * get_new_endpoint_unconnected();
 
+  int new_endpoint_fd() const noexcept { return _pending_fd.fd(); }
+
   void close_connection(event_expecter* connection);
 
   std::vector<event_expecter *> connections();
@@ -175,6 +175,10 @@ public:
    * @throw std::system_error : pselect fail
    */
   void wait_for_next_completion(std::chrono::milliseconds timeout) override { return aep()->wait_for_next_completion(timeout); }
+  /*
+   * @throw fabric_runtime_error : std::runtime_error : ::fi_control fail
+   */
+  bool arm_completion_wait(std::vector<int> &fds_) override { return aep()->arm_completion_wait(fds_); }
   void unblock_completions() override { return aep()->unblock_completions(); }
   /* END IFabric_server_grouped (IFabric_op_completer) */
 
@@ -23,7 +23,9 @@
 #include "persister_cc.h"
 #include "persistent.h"
 
+#include <common/byte_span.h>
 #include <cstddef> /* size_t, ptrdiff_t */
+#include <vector>
 
 template <typename T, typename Heap, typename Persister>
 	struct allocator_cc;
@@ -114,6 +116,17 @@ template <typename T, typename Heap, typename Persister = persister>
 			this->pool()->inject_allocation(location, s * sizeof(T));
 		}
 
+		/* Reconstitute many allocations (byte sizes, sorted by address) at once.
+		 * If background, the work may finish after the call returns.
+		 */
+		void reconstitute_batch(
+			std::vector<common::byte_span> &&spans
+			, bool background
+		)
+		{
+			this->pool()->inject_allocations(std::move(spans), background);
+		}
+
 		/* The crash-consistent allocator reconstitutes nothing */
 		bool is_reconstituted(
 			const void *location
@@ -20,13 +20,24 @@
 #include "hop_hash_log.h"
 #include "segment_layout.h"
 #include "trace_flags.h"
+#include <common/byte_span.h>
 #include <array>
 #include <cassert>
 #include <cstddef> /* size_t */
+#include <tuple> /* tuple_element */
+#include <type_traits> /* remove_const */
+#include <vector>
 
 
 namespace impl
 {
+	/* Outline data found by a parallel reconstitute, and how to restore it */
+	struct reconstitute_ref
+	{
+		void *p;
+		common::byte_span (*restore)(void *p, unsigned ref_count);
+	};
+
 	template <typename Bucket>
 		struct bucket_control_unlocked
 		{
@@ -198,12 +209,21 @@ namespace impl
 			std::size_t segment_size() const { return bi_mask() + 1U; }
 			bucket_aligned_t &deref(bix_t bi) const { return _buckets[bi]; }
 
+			/* Restore the allocators of keys and values in buckets [first, last)
+			 * of the segment, and note the data which the allocator must
+			 * reconstitute. May run in parallel with other ranges.
+			 */
 			template <typename Allocator>
-				void reconstitute(
+				void reconstitute_local(
 					Allocator av_
+					, std::size_t first_
+					, std::size_t last_
+					, std::vector<reconstitute_ref> &refs_
 				)
 				{
-					for ( auto it = _buckets; it != _buckets_end; ++it )
+					using key_t = typename std::remove_const<typename bucket_type::content_type::key_t>::type;
+					using value_t = typename std::tuple_element<0, typename bucket_type::content_type::value_type::second_type>::type;
+					for ( auto it = _buckets + first_; it != _buckets + last_; ++it )
 					{
 						typename bucket_type::owner_type &w = *it;
 						typename bucket_type::content_type &c = *it;
@@ -213,10 +233,14 @@ namespace impl
 							/* ERROR: depends on the types of first and second,
 							 * so should be handled by the session level, not here
 							 */
-							const_cast<
-								typename std::remove_const<typename bucket_type::content_type::key_t>::type &
-							>(c.value().first).reconstitute(av_);
-							std::get<0>(c.value().second).reconstitute(av_);
+							if ( auto p = const_cast<key_t &>(c.value().first).reconstitute_local(av_) )
+							{
+								refs_.push_back(reconstitute_ref{p, &key_t::reconstitute_element});
+							}
+							if ( auto p = std::get<0>(c.value().second).reconstitute_local(av_) )
+							{
+								refs_.push_back(reconstitute_ref{p, &value_t::reconstitute_element});
+							}
 						}
 					}
 				}
@@ -14,12 +14,15 @@
 #ifndef _MCAS_HSTORE_BUCKET_MUTEXES_H
 #define _MCAS_HSTORE_BUCKET_MUTEXES_H
 
+#include "versioned_shared_mutex.h"
+
 namespace impl
 {
 	template <typename Mutex>
 		struct bucket_mutexes
 		{
-			Mutex _m_owner;
+			/* versioned, so that lookups may read owner and content without locking */
+			versioned_shared_mutex<Mutex> _m_owner;
 			Mutex _m_content;
 		public:
 			bucket_mutexes()
@@ -0,0 +1,56 @@
+/*
+   Copyright [2021] [IBM Corporation]
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+       http://www.apache.org/licenses/LICENSE-2.0
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#ifndef _MCAS_HSTORE_BUCKET_OPTIMISTIC_LOCK_H
+#define _MCAS_HSTORE_BUCKET_OPTIMISTIC_LOCK_H
+
+#include "bucket_ref.h"
+
+namespace impl
+{
+	/*
+	 * A stand-in for bucket_shared_lock which takes no lock. It notes the
+	 * version of a versioned_shared_mutex; the reads made under it are
+	 * to be trusted only if validate() returns true afterwards.
+	 *
+	 * Reads made under it may see a bucket in mid-change, and must not
+	 * rely on anything they read (other than for bounds) until validated.
+	 */
+	template <typename Bucket, typename Referent, typename VersionedMutex>
+		struct bucket_optimistic_lock
+			: public bucket_ref<Bucket, Referent>
+		{
+			using base_ref = bucket_ref<Bucket, Referent>;
+			using typename base_ref::segment_and_bucket_t;
+		private:
+			const VersionedMutex *_m;
+			typename VersionedMutex::version_type _version;
+		public:
+			bucket_optimistic_lock(
+				Bucket &b_
+				, const segment_and_bucket_t &i_
+				, const VersionedMutex &m_
+			)
+				: base_ref(&b_, i_)
+				, _m(&m_)
+				, _version(m_.read_begin())
+			{
+			}
+			/* false if a writer held the mutex as the read began: the read is pointless */
+			bool readable() const { return (_version & 1U) == 0; }
+			/* true if no writer has held the mutex since the read began */
+			bool validate() const { return _m->read_validate(_version); }
+		};
+}
+
+#endif
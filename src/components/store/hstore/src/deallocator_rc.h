@@ -113,6 +113,11 @@ template <typename T, typename Heap, typename Persister = persister>
 			persister_type::persist(ptr, len);
 		}
 
+		void memcpy_persist(void *dst, const void *src, size_type len) const
+		{
+			persister_type::memcpy_persist(dst, src, len);
+		}
+
 		auto pool() const
 		{
 			return _pool;
@@ -132,6 +132,41 @@ template <typename T>
 			{
 				al_.persist(this, sizeof *this + alloc_element_count() * sizeof(T));
 			}
+
+		/* Fill and persist the data of a fixed_string constructed with only a
+		 * length. Unlike the iterator constructor followed by persist_this, a
+		 * contiguous source is copied by the allocator, which may bypass the
+		 * cache for large values.
+		 */
+		template <typename IT, typename Allocator>
+			void assign_persist(IT first_, IT last_, std::size_t pad_, const Allocator &al_)
+			{
+				std::fill_n(common::pointer_cast<char>(this+1), front_pad(), 0);
+				const auto e0 = data();
+				const auto n = std::size_t(last_ - first_);
+				std::fill_n(e0 + n, pad_, T());
+				copy_persist(first_, last_, e0, al_);
+				/* header and alignment fill, then any trailing pad */
+				al_.persist(this, _data_offset);
+				if ( pad_ )
+				{
+					al_.persist(e0 + n, pad_ * sizeof(T));
+				}
+			}
+	private:
+		template <typename Allocator>
+			static void copy_persist(const T *first_, const T *last_, T *dst_, const Allocator &al_)
+			{
+				al_.memcpy_persist(dst_, first_, std::size_t(last_ - first_) * sizeof(T));
+			}
+
+		template <typename IT, typename Allocator>
+			static void copy_persist(IT first_, IT last_, T *dst_, const Allocator &al_)
+			{
+				const auto e = std::copy(first_, last_, dst_);
+				al_.persist(dst_, std::size_t(e - dst_) * sizeof(T));
+			}
+	public:
 		uint64_t size() const { return _size; }
 		uint64_t alignment() const noexcept { return uint64_t(1) << _log_alignment; }
 		unsigned inc_ref(int, const char *) noexcept { return _ref_count++; }
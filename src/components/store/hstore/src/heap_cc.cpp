@@ -407,6 +407,11 @@ void heap_cc::inject_allocation(const void *, std::size_t)
 	throw std::logic_error(std::string(__func__) + " not supported (and not needed) by crash-consistent heap");
 }
 
+void heap_cc::inject_allocations(std::vector<byte_span> &&, bool)
+{
+	throw std::logic_error(std::string(__func__) + " not supported (and not needed) by crash-consistent heap");
+}
+
 void heap_cc::free(persistent_t<void *> &p_, std::size_t sz_)
 {
 	VALGRIND_MEMPOOL_FREE(::base(_pool0_heap), p_);
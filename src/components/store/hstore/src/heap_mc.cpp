@@ -424,6 +424,11 @@ void heap_mc::inject_allocation(const void *, std::size_t)
 	throw std::logic_error(std::string(__func__) + " not supported (and not needed) by crash-consistent heap");
 }
 
+void heap_mc::inject_allocations(std::vector<byte_span> &&, bool)
+{
+	throw std::logic_error(std::string(__func__) + " not supported (and not needed) by crash-consistent heap");
+}
+
 void heap_mc::free(persistent_t<void *> &p_, std::size_t sz_)
 {
 	VALGRIND_MEMPOOL_FREE(::base(_pool0_heap), p_);
@@ -33,6 +33,7 @@
 #include <numeric> /* acccumulate */
 #include <stdexcept> /* range_error */
 #include <string> /* to_string */
+#include <utility> /* move */
 
 namespace
 {
@@ -893,6 +894,21 @@ void heap_mm::inject_allocation(const void * p, std::size_t sz_)
 	hop_hash_log<trace_heap>::write(LOG_LOCATION, "pool ", ::base(_pool0_heap), " addr ", p, " size ", sz);
 }
 
+void heap_mm::inject_allocations(std::vector<byte_span> &&spans_, const bool background_)
+{
+	/* sizes as in inject_allocation */
+	auto alignment = sizeof(void *);
+	for ( auto &s : spans_ )
+	{
+		auto sz = (std::max(::size(s), alignment) + alignment - 1U)/alignment * alignment;
+		s = common::make_byte_span(::base(s), sz);
+		VALGRIND_MEMPOOL_ALLOC(::base(_pool0_heap), ::base(s), sz);
+	}
+	hop_hash_log<trace_heap>::write(LOG_LOCATION, "pool ", ::base(_pool0_heap), " count ", spans_.size(), " background ", background_);
+	auto &eph = dynamic_cast<heap_mr_ephemeral &>(*_eph);
+	eph.inject_allocations(std::move(spans_), background_);
+}
+
 void heap_mm::free(void *&p_, std::size_t sz_)
 {
 	if ( is_crash_consistent() )
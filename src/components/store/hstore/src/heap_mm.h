@@ -114,6 +114,7 @@ public:
 	void *alloc_tracked(std::size_t sz, std::size_t alignment);
 
 	void inject_allocation(const void * p, std::size_t sz);
+	void inject_allocations(std::vector<byte_span> &&spans, bool background);
 
 	void free(persistent_t<void *> &p, std::size_t sz);
 	void free_tracked(const void *p, std::size_t sz);
@@ -21,6 +21,7 @@
 #include <memory> /* make_unique */
 #include <mutex>
 #include <shared_mutex> /* shared_lock, unique_lock */
+#include <utility> /* move */
 
 constexpr unsigned heap_mr_ephemeral::log_min_alignment;
 constexpr unsigned heap_mr_ephemeral::hist_report_upper_bound;
@@ -37,6 +38,7 @@ heap_mr_ephemeral::heap_mr_ephemeral(
 	, _allocated(0)
 	, _capacity(0)
 	, _reconstituted()
+	, _injection()
 {}
 
 /* heap_mm version */
@@ -51,6 +53,7 @@ heap_mr_ephemeral::heap_mr_ephemeral(
 	, _allocated(0)
 	, _capacity(0)
 	, _reconstituted()
+	, _injection()
 {}
 
 heap_mr_ephemeral::~heap_mr_ephemeral()
@@ -59,6 +62,7 @@ heap_mr_ephemeral::~heap_mr_ephemeral()
 
 void heap_mr_ephemeral::add_managed_region_to_heap(byte_span r_heap)
 {
+	_injection.wait();
 	_heap->add_managed_region(r_heap);
 	_capacity += ::size(r_heap);
 }
@@ -68,7 +72,32 @@ void heap_mr_ephemeral::inject_allocation(
 	, std::size_t sz_
 )
 {
+	_injection.wait();
 	std::unique_lock<hstore_impl::shared_mutex> alloc_lk(_alloc_mutex);
+	inject_allocation_locked(p_, sz_);
+}
+
+void heap_mr_ephemeral::inject_allocations(std::vector<byte_span> &&spans_, const bool background_)
+{
+	_injection.run(
+		[this, spans = std::move(spans_)] ()
+		{
+			std::unique_lock<hstore_impl::shared_mutex> alloc_lk(_alloc_mutex);
+			for ( const auto &s : spans )
+			{
+				inject_allocation_locked(::base(s), ::size(s));
+			}
+			CPLOG(1, "%s: injected %zu allocations", __func__, spans.size());
+		}
+		, background_
+	);
+}
+
+void heap_mr_ephemeral::inject_allocation_locked(
+	void *p_
+	, std::size_t sz_
+)
+{
 	_heap->inject_allocation(p_, sz_);
 	{
 		auto pc = static_cast<alloc_set_t::element_type>(p_);
@@ -84,6 +113,7 @@ void heap_mr_ephemeral::allocate(
 	, std::size_t alignment_
 )
 {
+	_injection.wait();
 	std::unique_lock<hstore_impl::shared_mutex> alloc_lk(_alloc_mutex);
 	if ( S_OK != _heap->allocate(*reinterpret_cast<void **>(&p_), sz_, alignment_) )
 	{
@@ -95,6 +125,7 @@ void heap_mr_ephemeral::allocate(
 
 std::size_t heap_mr_ephemeral::free(persistent_t<void *> &p_, std::size_t sz_)
 {
+	_injection.wait();
 	std::unique_lock<hstore_impl::shared_mutex> alloc_lk(_alloc_mutex);
 	_heap->free(*reinterpret_cast<void **>(&p_), sz_);
 	_allocated -= sz_;
@@ -104,6 +135,7 @@ std::size_t heap_mr_ephemeral::free(persistent_t<void *> &p_, std::size_t sz_)
 
 void heap_mr_ephemeral::free_tracked(const void *p_, std::size_t sz_)
 {
+	_injection.wait();
 	std::unique_lock<hstore_impl::shared_mutex> alloc_lk(_alloc_mutex);
 	void *p = const_cast<void *>(p_);
 	_heap->free(p, sz_);
@@ -113,6 +145,7 @@ void heap_mr_ephemeral::free_tracked(const void *p_, std::size_t sz_)
 
 bool heap_mr_ephemeral::is_reconstituted(const void * p_)
 {
+	_injection.wait();
 	std::shared_lock<hstore_impl::shared_mutex> alloc_lk(_alloc_mutex);
 	return contains(_reconstituted, static_cast<alloc_set_t::element_type>(p_));
 }
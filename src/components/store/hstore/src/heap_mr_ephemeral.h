@@ -17,6 +17,7 @@
 
 #include "heap_mm_ephemeral.h"
 #include "injectee.h"
+#include "injection_gate.h"
 
 #include "hstore_config.h"
 #include "histogram_log2.h"
@@ -30,6 +31,7 @@
 
 #include <algorithm> /* min, swap */
 #include <cstddef> /* size_t */
+#include <vector>
 
 struct heap_mr_shim;
 
@@ -57,7 +59,11 @@ private:
 	/* Rca_LB seems not to allocate at or above about 2GiB. Limit reporting to 16 GiB. */
 	static constexpr unsigned hist_report_upper_bound = 34U;
 
+	/* Last, so that a background injection ends before the heap state */
+	mutable injection_gate _injection;
+
 	void add_managed_region(const byte_span r);
+	void inject_allocation_locked(void *p, std::size_t sz);
 public:
 	/* heap_mr version */
 	explicit heap_mr_ephemeral(
@@ -102,9 +108,13 @@ public:
 			}
 		}
 
-	std::size_t allocated() const override { return _allocated; }
+	std::size_t allocated() const override { _injection.wait(); return _allocated; }
 	std::size_t capacity() const override { return _capacity; }
 	void inject_allocation(void *p, std::size_t sz) override;
+	/* Inject allocations, sorted by address. If background, the injection
+	 * continues on a thread of its own and other heap calls wait for it.
+	 */
+	void inject_allocations(std::vector<byte_span> &&spans, bool background);
 	void allocate(persistent_t<void *> &p, std::size_t sz, std::size_t alignment) override;
 	void *allocate_tracked(std::size_t sz, std::size_t alignment);
 	void add_managed_region_to_heap(byte_span r_heap) override;
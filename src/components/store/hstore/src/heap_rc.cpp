@@ -26,6 +26,7 @@
 #include <numeric> /* acccumulate */
 #include <stdexcept> /* range_error */
 #include <string> /* to_string */
+#include <utility> /* move */
 
 namespace
 {
@@ -416,6 +417,20 @@ void heap_rc::inject_allocation(const void * p, std::size_t sz_)
 	hop_hash_log<trace_heap>::write(LOG_LOCATION, "pool ", ::base(_pool0_heap), " addr ", p, " size ", sz);
 }
 
+void heap_rc::inject_allocations(std::vector<byte_span> &&spans_, const bool background_)
+{
+	/* sizes as in inject_allocation */
+	auto alignment = sizeof(void *);
+	for ( auto &s : spans_ )
+	{
+		auto sz = (std::max(::size(s), alignment) + alignment - 1U)/alignment * alignment;
+		s = common::make_byte_span(::base(s), sz);
+		VALGRIND_MEMPOOL_ALLOC(::base(_pool0_heap), ::base(s), sz);
+	}
+	hop_hash_log<trace_heap>::write(LOG_LOCATION, "pool ", ::base(_pool0_heap), " count ", spans_.size(), " background ", background_);
+	_eph->inject_allocations(std::move(spans_), background_);
+}
+
 std::size_t heap_rc::free(persistent_t<void *> &p_, std::size_t sz_)
 {
 	auto sz = std::max(sz_, sizeof(void *));
@@ -134,6 +134,10 @@ public:
 	void *alloc_tracked(std::size_t sz, std::size_t alignment);
 
 	void inject_allocation(const void * p, std::size_t sz);
+	/* Inject allocations sorted by address, perhaps in the background
+	 * (lazy reconstitution). Later heap calls wait for a background injection.
+	 */
+	void inject_allocations(std::vector<byte_span> &&spans, bool background);
 	std::size_t free(persistent_t<void *> &p, std::size_t sz);
 	void free_tracked(const void *p, std::size_t sz);
 
@@ -35,10 +35,12 @@ heap_rc_ephemeral::heap_rc_ephemeral(
 	, _hist_alloc()
 	, _hist_inject()
 	, _hist_free()
+	, _injection()
 {}
 
 void heap_rc_ephemeral::add_managed_region(byte_span r_full, byte_span r_heap, const unsigned numa_node)
 {
+	_injection.wait();
 	std::unique_lock<hstore_impl::shared_mutex> alloc_lk(_alloc_mutex);
 	_heap.add_managed_region(::base(r_heap), ::size(r_heap), int(numa_node));
 	CPLOG(2, "%s : %p.%zx", __func__, ::base(r_heap), ::size(r_heap));
@@ -48,7 +50,29 @@ void heap_rc_ephemeral::add_managed_region(byte_span r_full, byte_span r_heap, c
 
 void heap_rc_ephemeral::inject_allocation(void *p_, std::size_t sz_)
 {
+	_injection.wait();
 	std::unique_lock<hstore_impl::shared_mutex> alloc_lk(_alloc_mutex);
+	inject_allocation_locked(p_, sz_);
+}
+
+void heap_rc_ephemeral::inject_allocations(std::vector<byte_span> &&spans_, const bool background_)
+{
+	_injection.run(
+		[this, spans = std::move(spans_)] ()
+		{
+			std::unique_lock<hstore_impl::shared_mutex> alloc_lk(_alloc_mutex);
+			for ( const auto &s : spans )
+			{
+				inject_allocation_locked(::base(s), ::size(s));
+			}
+			CPLOG(1, "%s: injected %zu allocations", __func__, spans.size());
+		}
+		, background_
+	);
+}
+
+void heap_rc_ephemeral::inject_allocation_locked(void *p_, std::size_t sz_)
+{
 	_heap.inject_allocation(p_, sz_, 0);
 	{
 		auto pc = static_cast<alloc_set_t::element_type>(p_);
@@ -60,6 +84,7 @@ void heap_rc_ephemeral::inject_allocation(void *p_, std::size_t sz_)
 
 void heap_rc_ephemeral::allocate(persistent_t<void *> &p_, std::size_t sz_, unsigned _numa_node_, std::size_t alignment_)
 {
+	_injection.wait();
 	std::unique_lock<hstore_impl::shared_mutex> alloc_lk(_alloc_mutex);
 	p_ = _heap.alloc(sz_, int(_numa_node_), alignment_);
 	_allocated += sz_;
@@ -68,6 +93,7 @@ void heap_rc_ephemeral::allocate(persistent_t<void *> &p_, std::size_t sz_, unsi
 
 std::size_t heap_rc_ephemeral::free(persistent_t<void *> &p_, std::size_t sz_, unsigned numa_node_)
 {
+	_injection.wait();
 	std::unique_lock<hstore_impl::shared_mutex> alloc_lk(_alloc_mutex);
 	_heap.free(p_, int(numa_node_), sz_);
 	p_ = nullptr;
@@ -78,6 +104,7 @@ std::size_t heap_rc_ephemeral::free(persistent_t<void *> &p_, std::size_t sz_, u
 
 void heap_rc_ephemeral::free_tracked(const void *p_, std::size_t sz_, unsigned numa_node_)
 {
+	_injection.wait();
 	std::unique_lock<hstore_impl::shared_mutex> alloc_lk(_alloc_mutex);
 	_heap.free(const_cast<void *>(p_), int(numa_node_), sz_);
 	_allocated -= sz_;
@@ -86,6 +113,7 @@ void heap_rc_ephemeral::free_tracked(const void *p_, std::size_t sz_, unsigned n
 
 bool heap_rc_ephemeral::is_reconstituted(const void * p_)
 {
+	_injection.wait();
 	std::shared_lock<hstore_impl::shared_mutex> alloc_lk(_alloc_mutex);
 	return contains(_reconstituted, static_cast<alloc_set_t::element_type>(p_));
 }
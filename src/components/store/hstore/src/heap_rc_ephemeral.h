@@ -17,6 +17,7 @@
 
 #include "heap_ephemeral.h"
 #include "injectee.h"
+#include "injection_gate.h"
 
 #include "hstore_config.h"
 #include "histogram_log2.h"
@@ -31,6 +32,7 @@
 
 #include <algorithm> /* min, swap */
 #include <cstddef> /* size_t */
+#include <vector>
 
 struct heap_rc_ephemeral
 	: private heap_ephemeral
@@ -59,7 +61,11 @@ private:
 	/* Rca_LB seems not to allocate at or above about 2GiB. Limit reporting to 16 GiB. */
 	static constexpr unsigned hist_report_upper_bound = 34U;
 
+	/* Last, so that a background injection ends before the heap state */
+	mutable injection_gate _injection;
+
 	void add_managed_region(byte_span r);
+	void inject_allocation_locked(void *p, std::size_t sz);
 public:
 	explicit heap_rc_ephemeral(unsigned debug_level, string_view id, string_view backing_file);
 	virtual ~heap_rc_ephemeral() {}
@@ -94,9 +100,13 @@ public:
 			}
 		}
 
-	std::size_t allocated() const {  return _allocated; }
+	std::size_t allocated() const { _injection.wait(); return _allocated; }
 	std::size_t capacity() const { return _capacity; };
 	void inject_allocation(void *p, std::size_t sz) override;
+	/* Inject allocations, sorted by address. If background, the injection
+	 * continues on a thread of its own and other heap calls wait for it.
+	 */
+	void inject_allocations(std::vector<byte_span> &&spans, bool background);
 	void allocate(persistent_t<void *> &p, std::size_t sz, unsigned numa_node, std::size_t alignment);
 	void *allocate_tracked(std::size_t sz, unsigned numa_node, std::size_t alignment);
 	void free_tracked(const void *p, std::size_t sz, unsigned numa_node);
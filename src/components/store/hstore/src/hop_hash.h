@@ -98,6 +98,11 @@ template <
 		using base::get_auto_resize;
 		using base::set_auto_resize;
 		using base::bucket_count;
+		using base::for_each_owned;
+		using base::layout_changes;
+		using base::group_commit_begin;
+		using base::group_commit_end;
+		using base::in_group_commit;
 		auto max_size() const noexcept -> size_type
 		{
 			return (size_type(1U) << (base::_segment_capacity-1U));
@@ -121,6 +126,8 @@ template <
 
 		/* lookup */
 		using base::find;
+		using base::find_n;
+		using base::prefetch;
 		using base::at;
 
 		template <typename HopHash>
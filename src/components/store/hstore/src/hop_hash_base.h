@@ -20,6 +20,7 @@
 
 #include "alloc_key.h" /* AK_FORMAL */
 #include "bucket_control.h"
+#include "bucket_optimistic_lock.h"
 #include "bucket_shared_lock.h"
 #include "bucket_unique_lock.h"
 #include "construction_mode.h"
@@ -27,10 +28,14 @@
 #include "trace_flags.h"
 #include <common/string_view.h>
 
+#include <array>
+#include <atomic>
 #include <cstddef> /* size_t */
+#include <limits> /* numeric_limits */
 #include <memory> /* allocator_traits */
 #include <tuple>
 #include <utility> /* pair */
+#include <vector>
 
 /* Inteded to implement Hopscotch hashing
  * http://mcg.cs.tau.ac.il/papers/disc2008-hopscotch.pdf
@@ -76,6 +81,9 @@ namespace impl
 	template <typename Bucket, typename Referent, typename SharedMutex>
 		struct bucket_shared_lock;
 
+	template <typename Bucket, typename Referent, typename VersionedMutex>
+		struct bucket_optimistic_lock;
+
 	template <typename Mutex>
 		struct bucket_mutexes;
 
@@ -155,8 +163,10 @@ namespace impl
 #endif
 			using bucket_allocator_t =
 				typename allocator_traits_type::template rebind_alloc<bucket_aligned_t>;
-			using owner_unique_lock_t = bucket_unique_lock<bucket_t, owner, SharedMutex>;
-			using owner_shared_lock_t = bucket_shared_lock<bucket_t, owner, SharedMutex>;
+			using owner_mutex_t = versioned_shared_mutex<SharedMutex>;
+			using owner_unique_lock_t = bucket_unique_lock<bucket_t, owner, owner_mutex_t>;
+			using owner_shared_lock_t = bucket_shared_lock<bucket_t, owner, owner_mutex_t>;
+			using owner_optimistic_lock_t = bucket_optimistic_lock<bucket_t, owner, owner_mutex_t>;
 			using content_unique_lock_t = bucket_unique_lock<bucket_t, content_t, SharedMutex>;
 			using content_shared_lock_t = bucket_shared_lock<bucket_t, content_t, SharedMutex>;
 #if HSTORE_TRACE_RESIZE
@@ -192,9 +202,69 @@ namespace impl
 
 			bucket_control_t _bc[_segment_capacity];
 
+			/*
+			 * A resize doubles the table incrementally, a few buckets at each
+			 * emplace or erase, in two phases:
+			 *
+			 * construct: the junior segment is allocated but is not part of the
+			 *   table. Each step constructs resize_step_buckets junior buckets.
+			 *
+			 * move: the segment count is unstable and the junior segment is part
+			 *   of the table, which has twice the "senior" bucket count. Each step
+			 *   moves the content of resize_step_buckets senior buckets, in index
+			 *   order, to its place in the doubled table. The first resize_moved()
+			 *   senior buckets, and the junior buckets at the same offsets, are
+			 *   laid out as in the doubled table. Content in the remaining senior
+			 *   buckets is still owned by its owner in the senior table, which
+			 *   lookups must also consult.
+			 *
+			 * The first move step covers a full owner range, so that an owner never
+			 * owns unmoved content by wrapping past the end of the table.
+			 */
+			static constexpr bix_t resize_step_buckets = 64U;
+			static_assert(
+				owner::size <= resize_step_buckets
+				, "A resize step must cover an owner range"
+			);
+			/* begin a resize when this fraction (of 256) of the buckets are in use */
+			static constexpr unsigned resize_load_256 = 192U;
+			/* keys in flight in find_n: enough to cover a memory miss, few
+			 * enough that the prefetched buckets are still cached when probed
+			 */
+			static constexpr unsigned find_group_size = 16U;
+
+			bool _resize_constructing;
+			bix_t _resize_constructed;
+			/* resize move steps taken, counted twice (volatile, not persisted):
+			 * odd while a step is changing the layout. Atomic because lookups
+			 * check it for a concurrent resize step.
+			 */
+			std::atomic<std::uint64_t> _layout_changes;
+			/* Holds layout_changes() odd for the duration of a resize step */
+			struct layout_change
+			{
+			private:
+				std::atomic<std::uint64_t> *_count;
+			public:
+				explicit layout_change(std::atomic<std::uint64_t> &count_)
+					: _count(&count_)
+				{
+					_count->fetch_add(1U, std::memory_order_relaxed);
+					/* the odd count precedes the step's stores */
+					std::atomic_thread_fence(std::memory_order_release);
+				}
+				layout_change(const layout_change &) = delete;
+				layout_change &operator=(const layout_change &) = delete;
+				~layout_change()
+				{
+					_count->fetch_add(1U, std::memory_order_release);
+				}
+			};
+
 			six_t segment_count() const override
 			{
-				return persist_map_controller_t::segment_count_actual().value();
+				const auto sc = persist_map_controller_t::segment_count_actual();
+				return sc.value_not_stable() + ( sc.is_stable() ? 0U : 1U );
 			}
 
 			six_t segment_count_not_stable() const
@@ -202,8 +272,32 @@ namespace impl
 				return persist_map_controller_t::segment_count_actual().value_not_stable();
 			}
 
+			bool is_resize_moving() const
+			{
+				return ! persist_map_controller_t::segment_count_actual().is_stable();
+			}
+
+			bool is_resizing() const
+			{
+				return _resize_constructing || is_resize_moving();
+			}
+
+			using persist_map_controller_t::resize_moved;
+
+			/* Restore the keys and values of (re)opened segments on several
+			 * threads, then inject their data into the allocator in one batch.
+			 */
+			void reconstitute_segments(
+				const Allocator &av
+				, const std::vector<bucket_control_t *> &segments
+			);
+
 			auto bucket_ix(const hash_result_t h) const -> bix_t;
-			auto bucket_expanded_ix(const hash_result_t h) const -> bix_t;
+			/* High hash bits, which no bucket index uses */
+			static auto fingerprint(const hash_result_t h) -> owner::fingerprint_type
+			{
+				return owner::fingerprint_type(h >> (std::numeric_limits<hash_result_t>::digits - owner::fingerprint_bits));
+			}
 
 			auto nearest_free_bucket(segment_and_bucket_t bi) -> content_unique_lock_t;
 
@@ -217,12 +311,14 @@ namespace impl
 			 * locate key is called with two flavors of arguments:
 			 *   For emplace: Lock is owner_unique_lock and K is persist_fixed_string
 			 *   For other uses (find, count, at): Lock is owner_shared_lock and K is std::string
+			 * Only content with the key's fingerprint fp is compared.
 			 */
 			template <typename Lock, typename K>
 				auto locate_key(
 					TM_FORMAL
 					Lock &bi
 					, const K &k
+					, owner::fingerprint_type fp
 				) const -> segment_and_bucket_t;
 
 			auto locate_key_inner(
@@ -230,20 +326,59 @@ namespace impl
 				owner::value_type ownership_bits_
 				, segment_and_bucket_t sb_
 				, common::string_view k_
+				, owner::fingerprint_type fp_
 			) const -> segment_and_bucket_t;
 
+			/* A senior owner which may still own the key, or bucket_count() if none */
+			auto resize_senior_owner(hash_result_t h, bix_t ix_owner) const -> bix_t;
+			/* true iff the range [first, last] of the table has been moved */
+			bool resize_is_moved(bix_t first, bix_t last) const;
+			template <typename Lock, typename K>
+				auto locate_owner_and_key(
+					TM_FORMAL
+					Lock &owner_lk
+					, hash_result_t h
+					, const K &k
+				) const -> segment_and_bucket_t;
+
+			/* Lock-free lookup attempts before a lookup takes a shared owner lock */
+			static constexpr unsigned optimistic_read_attempts = 4U;
+			/* As locate_owner_and_key, but reading the owner optimistically (see
+			 * versioned_shared_mutex), falling back to shared locks on repeated
+			 * conflicts. Neither form searches while a resize step is changing
+			 * the layout. Returns the owner and the key location; if the key is
+			 * not found, the key location is owner::size past the owner.
+			 */
+			template <typename K>
+				auto locate_owner_and_key_optimistic(
+					TM_FORMAL
+					hash_result_t h
+					, const K &k
+				) const -> std::pair<segment_and_bucket_t, segment_and_bucket_t>;
+
 			void resize(AK_FORMAL0);
-			void resize_pass1();
-			void resize_pass2();
-			bool resize_pass2_adjust_owner(
+			void resize_begin(AK_FORMAL0);
+			void resize_step();
+			void resize_move(bix_t ix_senior, bix_t senior_count);
+			bool resize_move_adjust_owner(
 				bix_t ix_senior
-				, bucket_control_t &junior_bucket_control
+				, bix_t senior_count
 				, content_unique_lock_t &populated_content_lk
 			);
 			auto locate_bucket_mutexes(
 				const segment_and_bucket_t &
 			) const -> bucket_mutexes_t &;
 
+			/* Start fetching an owner bucket (for read, RW 0, or write, RW 1)
+			 * and the mutexes which guard it, which any lock writes.
+			 */
+			template <int RW>
+				void prefetch_owner(const segment_and_bucket_t &sb_) const
+				{
+					__builtin_prefetch(&sb_.deref(), RW);
+					__builtin_prefetch(&locate_bucket_mutexes(sb_), 1);
+				}
+
 			auto make_owner_unique_lock(
 				const segment_and_bucket_t &a
 			) const -> owner_unique_lock_t;
@@ -275,7 +410,6 @@ namespace impl
 			auto owner_value_at(owner_shared_lock_t &bi) const -> owner::value_type;
 
 			auto make_segment_and_bucket(bix_t ix) const -> segment_and_bucket_t;
-			auto make_segment_and_bucket_unsafe(bix_t ix) const -> segment_and_bucket_t;
 			auto make_segment_and_bucket_for_iterator(
 				bix_t ix
 			) const -> segment_and_bucket_t;
@@ -356,6 +490,27 @@ namespace impl
 					const K &key
 				) const -> const_iterator;
 
+			/* find for each key in [first, last), calling f with each result
+			 * (end() if not found) in key order. Each group of keys is hashed,
+			 * then the owner bucket of each is prefetched, then each is probed,
+			 * so that the memory misses of the group overlap rather than follow
+			 * one another.
+			 */
+			template <typename KIT, typename F>
+				void find_n(
+					TM_FORMAL
+					KIT first
+					, KIT last
+					, F f
+				) const;
+
+			/* Start fetching the owner bucket of key, ahead of an update of key */
+			template <typename K>
+				void prefetch(const K &key) const
+				{
+					prefetch_owner<1>(make_segment_and_bucket(bucket_ix(_hasher.hf(key))));
+				}
+
 			template <typename K>
 				auto at(
 					TM_FORMAL
@@ -399,6 +554,23 @@ namespace impl
 
 			using persist_map_controller_t::bucket_count;
 			using persist_map_controller_t::max_bucket_count;
+			using persist_map_controller_t::group_commit_begin;
+			using persist_map_controller_t::group_commit_end;
+			using persist_map_controller_t::in_group_commit;
+
+			/* Call f(const value_type &) for the content of each owner in
+			 * [first, last), in owner order. If f returns false the visit stops
+			 * at the end of the current owner. Returns the index of the first
+			 * owner not visited, from which a later call may continue.
+			 *
+			 * Content moves by hopscotch displacement stay with their owner,
+			 * so a visit in several calls sees each element once, provided that
+			 * layout_changes() is unchanged between the calls. A resize step
+			 * changes ownership, and bucket_count(), and so layout_changes().
+			 */
+			template <typename F>
+				auto for_each_owned(bix_t first, bix_t last, F f) const -> bix_t;
+			auto layout_changes() const -> std::uint64_t { return _layout_changes.load(std::memory_order_acquire); }
 
 			auto begin(size_type n) -> local_iterator
 			{
@@ -26,14 +26,19 @@
 #include "test_flags.h"
 
 #include <common/perf/tm.h>
+#include <common/utils.h> /* cpu_relax */
 #include <boost/iterator/transform_iterator.hpp>
 
 #include <algorithm>
+#include <atomic>
 #include <cassert>
+#include <cstdlib> /* getenv */
 #include <exception>
+#include <iterator> /* back_inserter */
 #include <sstream> /* ostringstream */
 #include <thread> /* this_thread */
 #include <utility> /* move */
+#include <vector>
 
 
 /*
@@ -43,6 +48,19 @@
 namespace
 {
 	const char *hstore_consistency_check() { return std::getenv("HSTORE_CONSISTENCY_CHECK"); }
+	/* threads to reconstitute a table (default: hardware concurrency) */
+	unsigned hstore_reconstitute_threads()
+	{
+		const auto e = std::getenv("HSTORE_RECONSTITUTE_THREADS");
+		const auto n = e ? unsigned(std::atoi(e)) : std::thread::hardware_concurrency();
+		return std::max(n, 1U);
+	}
+	/* if set, allocator reconstitution continues in the background after the table opens */
+	bool hstore_reconstitute_lazy()
+	{
+		const auto e = std::getenv("HSTORE_RECONSTITUTE_LAZY");
+		return e && std::atoi(e) != 0;
+	}
 }
 
 template <
@@ -57,8 +75,11 @@ template <
 	)
 		: hop_hash_allocator<Allocator>{av_}
 		, persist_map_controller_t(AK_REF av_, pc_, mode_)
-		, _hasher{}
+		, _hasher{this->persist_map_controller_t::hash_algorithm()}
 		, _auto_resize{true}
+		, _resize_constructing{false}
+		, _resize_constructed{0U}
+		, _layout_changes{0U}
 		, _consistency_check(hstore_consistency_check() ? atoi(hstore_consistency_check()) : 0)
 	{
 		const auto bp_src = this->persist_map_controller_t::bp_src();
@@ -76,13 +97,15 @@ template <
 			}
 		);
 
+		/* segments whose content is to be reconstituted */
+		std::vector<bucket_control_t *> reconstitute;
 		{
 			segment_layout::six_t ix = 0U;
 			_bc[ix].extend(_bc[ix].buckets(), &_bc[0], &_bc[0], ix);
 
 			if ( mode_ == construction_mode::reconstitute )
 			{
-				_bc[ix].reconstitute(av_);
+				reconstitute.push_back(&_bc[ix]);
 			}
 		}
 
@@ -94,7 +117,7 @@ template <
 
 			if ( mode_ == construction_mode::reconstitute )
 			{
-				_bc[ix].reconstitute(av_);
+				reconstitute.push_back(&_bc[ix]);
 			}
 		}
 		hop_hash_log<HSTORE_TRACE_MANY>::write(LOG_LOCATION, " segment_count ", this->persist_map_controller_t::segment_count_actual().value_not_stable()
@@ -104,10 +127,10 @@ template <
 		hop_hash_log<TEST_HSTORE_PERISHABLE>::write(LOG_LOCATION, "HopHash base constructor: "
 			, (this->is_size_stable() ? "stable" : "unstable"), " segment_count ", this->segment_count_actual().value_not_stable());
 
-		if ( ! this->persist_map_controller_t::segment_count_actual().is_stable() )
+		if ( is_resize_moving() )
 		{
-			/* ERROR: reconstruction code for resize state not written. */
-			const auto ix = this->persist_map_controller_t::segment_count_actual().value_not_stable();
+			/* A resize was moving content. The junior segment is part of the table. */
+			const auto ix = segment_count_not_stable();
 			bucket_control_t &junior_bucket_control = _bc[ix];
 
 			junior_bucket_control.extend(
@@ -116,16 +139,14 @@ template <
 				, &_bc[0]
 				, ix
 			);
+			_bc[ix-1]._next = &junior_bucket_control;
+			_bc[0]._prev = &junior_bucket_control;
 
-			junior_bucket_control.reconstitute(av_);
-
-			hop_hash_log<HSTORE_TRACE_RESIZE>::write(LOG_LOCATION
-				, " finishing resize in constructor"
-			);
-			resize_pass2();
-			this->persist_map_controller_t::resize_epilog();
+			reconstitute.push_back(&junior_bucket_control);
 		}
 
+		reconstitute_segments(av_, reconstitute);
+
 		hop_hash_log<TEST_HSTORE_PERISHABLE>::write(LOG_LOCATION, "HopHash base constructor: "
 			, (this->persist_map_controller_t::is_size_stable() ? "stable" : "unstable"), " size ", this->persist_map_controller_t::size_unstable());
 
@@ -172,6 +193,17 @@ template <
 			hop_hash_log<HSTORE_TRACE_MANY>::write(LOG_LOCATION, "Restored size ", size());
 
 		}
+
+		if ( is_resize_moving() )
+		{
+			/* Repeat the move step which may have been interrupted. Moves are idempotent.
+			 * The remaining steps follow emplace and erase operations, as before the restart.
+			 */
+			hop_hash_log<HSTORE_TRACE_RESIZE>::write(LOG_LOCATION
+				, " continuing resize in constructor at ", resize_moved()
+			);
+			resize_step();
+		}
 		check_consistency();
 	}
 
@@ -184,6 +216,172 @@ template <
 		perishable::report();
 	}
 
+/*
+ * Reconstitute in two phases:
+ * 1. Threads take chunks of the segments, restore the key and value
+ *    allocators, and collect (sorted) the outline data they refer to.
+ * 2. The collections are merged. Each distinct datum, however many keys
+ *    and values refer to it, has its header restored once, and the
+ *    allocator takes the lot in one (address-ordered) batch. With
+ *    HSTORE_RECONSTITUTE_LAZY, the allocator does that in the background
+ *    and the table serves lookups meanwhile; allocator calls wait for it.
+ */
+template <
+	typename Key, typename T, typename Hash, typename Pred
+	, typename Allocator, typename SharedMutex
+>
+	void impl::hop_hash_base<Key, T, Hash, Pred, Allocator, SharedMutex>::reconstitute_segments(
+		const Allocator &av_
+		, const std::vector<bucket_control_t *> &segments_
+	)
+	{
+		struct chunk
+		{
+			bucket_control_t *bc;
+			bix_t first;
+			bix_t last;
+		};
+		/* enough buckets per chunk to amortize the scheduling, few enough to balance */
+		constexpr bix_t chunk_size = bix_t(1) << 16U;
+		std::vector<chunk> chunks;
+		for ( auto bc : segments_ )
+		{
+			for ( bix_t first = 0; first < bc->segment_size(); first += chunk_size )
+			{
+				chunks.push_back(chunk{bc, first, std::min(first + chunk_size, bc->segment_size())});
+			}
+		}
+
+		const auto thread_count =
+			unsigned(std::max(std::size_t(1), std::min(chunks.size(), std::size_t(hstore_reconstitute_threads()))));
+
+		/* Run f(0) .. f(thread_count-1), all but the first on threads of their own */
+		const auto run =
+			[thread_count] (auto f)
+			{
+				std::vector<std::exception_ptr> errors(thread_count);
+				const auto guarded =
+					[&errors, &f] (unsigned t)
+					{
+						try
+						{
+							f(t);
+						}
+						catch ( ... )
+						{
+							errors[t] = std::current_exception();
+						}
+					};
+				std::vector<std::thread> threads;
+				for ( unsigned t = 1U; t != thread_count; ++t )
+				{
+					threads.emplace_back(guarded, t);
+				}
+				guarded(0U);
+				for ( auto &th : threads )
+				{
+					th.join();
+				}
+				for ( auto &e : errors )
+				{
+					if ( e )
+					{
+						std::rethrow_exception(e);
+					}
+				}
+			};
+
+		const auto by_address =
+			[] (const reconstitute_ref &a, const reconstitute_ref &b)
+			{
+				return a.p < b.p;
+			};
+
+		std::vector<std::vector<reconstitute_ref>> refs(thread_count);
+		{
+			std::atomic<std::size_t> next_chunk{0};
+			run(
+				[&] (unsigned t)
+				{
+					for ( auto c = next_chunk++; c < chunks.size(); c = next_chunk++ )
+					{
+						chunks[c].bc->reconstitute_local(av_, chunks[c].first, chunks[c].last, refs[t]);
+					}
+					std::sort(refs[t].begin(), refs[t].end(), by_address);
+				}
+			);
+		}
+
+		/* merge the per-thread collections, pairwise */
+		while ( 1U < refs.size() )
+		{
+			std::vector<std::vector<reconstitute_ref>> merged;
+			for ( std::size_t i = 0; i + 1U < refs.size(); i += 2U )
+			{
+				merged.emplace_back();
+				merged.back().reserve(refs[i].size() + refs[i+1U].size());
+				std::merge(
+					refs[i].begin(), refs[i].end()
+					, refs[i+1U].begin(), refs[i+1U].end()
+					, std::back_inserter(merged.back())
+					, by_address
+				);
+			}
+			if ( refs.size() % 2U )
+			{
+				merged.emplace_back(std::move(refs.back()));
+			}
+			refs.swap(merged);
+		}
+
+		if ( refs.empty() || refs.front().empty() )
+		{
+			/* nothing (or, for a crash-consistent allocator, nothing more) to do */
+			return;
+		}
+
+		/* Restore the data headers, each thread starting at a distinct datum */
+		const auto &all = refs.front();
+		std::vector<std::vector<common::byte_span>> spans(thread_count);
+		run(
+			[&] (unsigned t)
+			{
+				const auto distinct_start =
+					[&all, this_count = thread_count] (unsigned u)
+					{
+						auto it = all.begin() + std::ptrdiff_t(all.size() * u / this_count);
+						while ( it != all.begin() && it != all.end() && it->p == (it-1)->p )
+						{
+							++it;
+						}
+						return it;
+					};
+				const auto last = distinct_start(t+1U);
+				for ( auto it = distinct_start(t); it != last; )
+				{
+					auto jt = std::find_if(it, last, [it] (const reconstitute_ref &r) { return r.p != it->p; });
+					spans[t].push_back(it->restore(it->p, unsigned(jt - it)));
+					it = jt;
+				}
+			}
+		);
+
+		std::vector<common::byte_span> all_spans;
+		for ( auto &s : spans )
+		{
+			all_spans.insert(all_spans.end(), s.begin(), s.end());
+		}
+
+		const auto lazy = hstore_reconstitute_lazy();
+		hop_hash_log<HSTORE_TRACE_MANY>::write(LOG_LOCATION, " threads ", thread_count
+			, " chunks ", chunks.size(), " references ", all.size(), " allocations ", all_spans.size(), " lazy ", lazy);
+
+		using reallocator_char_type =
+			typename std::allocator_traits<Allocator>::template rebind_alloc<char>;
+		auto alr = reallocator_char_type(av_);
+		alr.reconstitute_batch(std::move(all_spans), lazy);
+	}
+
 /*
  * Return a bit mask describing which contents are owned by the owner at a_.
  * bit 0 (LSB) is 1 iff the owner at a_ owns the content at a_, bit n is 1 iff
@@ -235,26 +433,6 @@ template <
 		return h_ & mask();
 	}
 
-/* From a hash, return the index of the bucket (in seg_entry) to which it maps,
- * including a single new segment not in count.
- * For use when "resizeing" the hash table to double its pervious size.
- */
-template <
-	typename Key, typename T, typename Hash, typename Pred
-	, typename Allocator, typename SharedMutex
->
-	auto impl::hop_hash_base<
-		Key, T, Hash, Pred, Allocator, SharedMutex
-	>::bucket_expanded_ix(
-		const hash_result_t h_
-	) const -> bix_t
-	{
-		auto mask_expanded = (mask() << 1U) + 1;
-		hop_hash_log<HSTORE_TRACE_BUCKET_IX>::write(LOG_LOCATION, "h_ ", h_
-			, " mask ", mask_expanded, " -> ", ( h_ & mask_expanded ));
-		return h_ & mask_expanded;
-	}
-
 /*
  * Starting at bucket bi_, scan forward to find the next free bucket.
  8 Throws hop_hash_full is there in free bucket.
@@ -474,7 +652,7 @@ template <
 				assert(!is_in_use(b_dst_lock_.sb()));
 
 				b_dst_lock_.ref().content_share(b_src_lock.ref());
-				b_dst_lock_.owner_ref().set_adjacent_content_in_use(true);
+				b_dst_lock_.owner_ref().set_adjacent_content_in_use(b_src_lock.owner_ref().adjacent_content_fingerprint());
 
 				this->persist_map_controller_t::persist_content(b_src_lock.ref(), "content free");
 				this->persist_map_controller_t::persist_content(b_dst_lock_.ref(), "content in use");
@@ -599,9 +777,10 @@ template <
 			TM_ACTUAL
 			Lock &bi_
 			, const K &k_
+			, const owner::fingerprint_type fp_
 		) const -> segment_and_bucket_t
 		{
-			return locate_key_inner(TM_REF bi_.ref().ownership_bits(bi_), bi_.sb(), common::string_view(k_.data(), k_.size()));
+			return locate_key_inner(TM_REF bi_.ref().ownership_bits(bi_), bi_.sb(), common::string_view(k_.data(), k_.size()), fp_);
 		}
 
 template <
@@ -613,10 +792,14 @@ template <
 		owner::value_type ownership_bits_
 		, segment_and_bucket_t sb_
 		, const common::string_view k_
+		, const owner::fingerprint_type fp_
 	) const -> segment_and_bucket_t
 	{
 		TM_SCOPE()
-		/* Use the ownership bits to filter key checks, a performance aid to reduce the number of key compares. */
+		/* Use the ownership bits, and then the fingerprints, to filter key checks,
+		 * a performance aid to reduce the number of key compares (and, for keys
+		 * not stored inline, the dereferences which they require).
+		 */
 		auto distance_to_end = owner::size;
 
 		while ( ownership_bits_ )
@@ -627,7 +810,7 @@ template <
 #pragma GCC diagnostic pop
 			sb_.add_small(distance);
 			distance_to_end -= distance;
-			if ( key_equal()(sb_.deref().key(), k_) )
+			if ( sb_.deref().adjacent_content_fingerprint() == fp_ && key_equal()(sb_.deref().key(), k_) )
 			{
 				hop_hash_log<HSTORE_TRACE_MANY>::write(LOG_LOCATION, " returns (success) ", sb_.index());
 				return sb_;
@@ -639,6 +822,153 @@ template <
 		return sb_;
 	}
 
+template <
+	typename Key, typename T, typename Hash, typename Pred
+	, typename Allocator, typename SharedMutex
+>
+	template <typename Lock, typename K>
+		auto impl::hop_hash_base<Key, T, Hash, Pred, Allocator, SharedMutex>::locate_owner_and_key(
+			TM_ACTUAL
+			Lock &owner_lk_
+			, const hash_result_t h_
+			, const K &k_
+		) const -> segment_and_bucket_t
+		{
+			auto key_sb = locate_key(TM_REF owner_lk_, k_, fingerprint(h_));
+			if ( distance_small(owner_lk_.sb(), key_sb) == owner::size )
+			{
+				/* Not found. While a resize is moving content the key may
+				 * still be owned by its owner in the senior table.
+				 */
+				const auto ix_senior_owner = resize_senior_owner(h_, owner_lk_.index());
+				if ( ix_senior_owner != bucket_count() )
+				{
+					const auto sb = make_segment_and_bucket(ix_senior_owner);
+					Lock senior_owner_lk(sb.deref(), sb, locate_bucket_mutexes(sb)._m_owner);
+					const auto senior_key_sb = locate_key(TM_REF senior_owner_lk, k_, fingerprint(h_));
+					if ( distance_small(senior_owner_lk.sb(), senior_key_sb) != owner::size )
+					{
+						owner_lk_ = std::move(senior_owner_lk);
+						return senior_key_sb;
+					}
+				}
+			}
+			return key_sb;
+		}
+
+template <
+	typename Key, typename T, typename Hash, typename Pred
+	, typename Allocator, typename SharedMutex
+>
+	template <typename K>
+		auto impl::hop_hash_base<Key, T, Hash, Pred, Allocator, SharedMutex>::locate_owner_and_key_optimistic(
+			TM_ACTUAL
+			const hash_result_t h_
+			, const K &k_
+		) const -> std::pair<segment_and_bucket_t, segment_and_bucket_t>
+		{
+			/* A seqlock read. Every change to the content owned by an owner, and
+			 * to the owner bits, is made under the owner's unique lock, which
+			 * advances the owner mutex version. A search is accepted only if the
+			 * version of each owner searched did not change during the search.
+			 *
+			 * A search is also rejected if a resize step was in progress or
+			 * intervened: layout_changes() is odd while a step runs.
+			 *
+			 * An unaccepted search may have compared a key against a stale key
+			 * pointer. That reads pool memory which remains mapped, and the result
+			 * is discarded.
+			 */
+			for ( unsigned i = 0; i != optimistic_read_attempts; ++i )
+			{
+				if ( i != 0 )
+				{
+					cpu_relax();
+				}
+				/* A resize step may change bucket_count() and move keys between owners */
+				const auto layout = layout_changes();
+				if ( layout % 2U != 0U )
+				{
+					continue;
+				}
+				const auto sb = make_segment_and_bucket(bucket_ix(h_));
+				owner_optimistic_lock_t owner_lk(sb.deref(), sb, locate_bucket_mutexes(sb)._m_owner);
+				if ( ! owner_lk.readable() )
+				{
+					continue;
+				}
+				const auto key_sb = locate_key(TM_REF owner_lk, k_, fingerprint(h_));
+				if ( distance_small(sb, key_sb) == owner::size )
+				{
+					/* As locate_owner_and_key: the key may still be owned in the senior table */
+					const auto ix_senior_owner = resize_senior_owner(h_, owner_lk.index());
+					if ( ix_senior_owner != bucket_count() )
+					{
+						const auto senior_sb = make_segment_and_bucket(ix_senior_owner);
+						owner_optimistic_lock_t senior_owner_lk(senior_sb.deref(), senior_sb, locate_bucket_mutexes(senior_sb)._m_owner);
+						if ( ! senior_owner_lk.readable() )
+						{
+							continue;
+						}
+						const auto senior_key_sb = locate_key(TM_REF senior_owner_lk, k_, fingerprint(h_));
+						const bool found = distance_small(senior_sb, senior_key_sb) != owner::size;
+						if ( ! senior_owner_lk.validate() || layout != layout_changes() )
+						{
+							continue;
+						}
+						if ( found )
+						{
+							return { senior_sb, senior_key_sb };
+						}
+					}
+				}
+				if ( owner_lk.validate() && layout == layout_changes() )
+				{
+					return { sb, key_sb };
+				}
+			}
+
+			/* The same search under shared locks. A key is found wherever it is
+			 * seen, but a miss stands only if no resize step intervened. The two
+			 * owners are locked in turn, not together: a resize move locks the
+			 * senior owner, then the junior owner.
+			 */
+			for ( ;; )
+			{
+				const auto layout = layout_changes();
+				if ( layout % 2U != 0U )
+				{
+					cpu_relax();
+					continue;
+				}
+				const auto sb = make_segment_and_bucket(bucket_ix(h_));
+				auto key_sb = sb;
+				{
+					auto owner_lk = make_owner_shared_lock(sb);
+					key_sb = locate_key(TM_REF owner_lk, k_, fingerprint(h_));
+				}
+				if ( distance_small(sb, key_sb) == owner::size )
+				{
+					const auto ix_senior_owner = resize_senior_owner(h_, sb.index());
+					if ( ix_senior_owner != bucket_count() )
+					{
+						const auto senior_sb = make_segment_and_bucket(ix_senior_owner);
+						auto senior_owner_lk = make_owner_shared_lock(senior_sb);
+						const auto senior_key_sb = locate_key(TM_REF senior_owner_lk, k_, fingerprint(h_));
+						if ( distance_small(senior_sb, senior_key_sb) != owner::size )
+						{
+							return { senior_sb, senior_key_sb };
+						}
+					}
+					if ( layout != layout_changes() )
+					{
+						continue;
+					}
+				}
+				return { sb, key_sb };
+			}
+		}
+
 template <
 	typename Key, typename T, typename Hash, typename Pred
 	, typename Allocator, typename SharedMutex
@@ -658,22 +988,39 @@ template <
 				, LOG_LOCATION, " END LIST"
 			);
 
-		RETRY:
 			/* convert the args to a value_type */
 			value_type v(std::forward<Args>(args)...);
+			const auto hash = _hasher.hf(v.first);
+
+		RETRY:
+			/* Advance a resize in progress, or begin one if the table is filling up */
+			if ( is_resizing() )
+			{
+				TM_SCOPE(resize_step)
+				resize_step();
+			}
+			else if (
+				_auto_resize
+				&& segment_count() < _segment_capacity
+				&& bucket_count() * resize_load_256 / 256U <= this->persist_map_controller_t::size()
+			)
+			{
+				TM_SCOPE(resize_begin)
+				resize_begin(AK_REF0);
+			}
 
 			/* The bucket in which to place the new entry */
-			auto sbw = make_segment_and_bucket(bucket(v.first));
+			auto sbw = make_segment_and_bucket(bucket_ix(hash));
 			auto owner_lk = make_owner_unique_lock(sbw);
 
 			TM_SCOPE(check_exists)
-			auto key_bi = locate_key(TM_REF owner_lk, v.first);
 			/* If the key is found, refuse to emplace */
 			{
-				auto content_offset = distance_small(sbw, key_bi);
+				auto key_bi = locate_owner_and_key(TM_REF owner_lk, hash, v.first);
+				auto content_offset = distance_small(owner_lk.sb(), key_bi);
 				if ( content_offset != owner::size )
 				{
-					return {iterator{sbw, content_offset}, false};
+					return {iterator{owner_lk.sb(), content_offset}, false};
 				}
 			}
 
@@ -682,6 +1029,34 @@ template <
 			{
 				TM_SCOPE(nearest_free)
 				auto b_dst = nearest_free_bucket(sbw);
+				if ( is_resize_moving() && ! resize_is_moved(owner_lk.index(), b_dst.index()) )
+				{
+					/* The range from owner to free bucket includes content which has not
+					 * moved. Insert as in the senior table if the range from the senior
+					 * owner to its nearest free bucket has not moved at all. Otherwise,
+					 * move more content and try again.
+					 */
+					const auto senior_count = bucket_count() / 2U;
+					const auto ix_senior_owner = hash & (senior_count - 1U);
+					if ( ix_senior_owner != owner_lk.index() && resize_moved() <= ix_senior_owner )
+					{
+						b_dst.unlock();
+						owner_lk = make_owner_unique_lock(make_segment_and_bucket(ix_senior_owner));
+						b_dst = nearest_free_bucket(owner_lk.sb());
+					}
+					if (
+						! (
+							resize_moved() <= owner_lk.index()
+							&& owner_lk.index() <= b_dst.index()
+							&& b_dst.index() < senior_count
+						)
+					)
+					{
+						b_dst.unlock();
+						owner_lk.unlock();
+						goto RETRY;
+					}
+				}
 				TM_SCOPE(make_space)
 				b_dst = make_space_for_insert(owner_lk.index(), std::move(b_dst));
 
@@ -706,12 +1081,12 @@ template <
 					b_dst.ref().content_construct(owner_lk.index(), std::move(v));
 					if ( owner_lk.index() == b_dst.index() )
 					{
-						owner_lk.ref().set_adjacent_content_in_use();
+						owner_lk.ref().set_adjacent_content_in_use(fingerprint(hash));
 					}
 					else
 					{
 						auto adjacent_owner_lk = make_owner_unique_lock(b_dst.sb());
-						adjacent_owner_lk.ref().set_adjacent_content_in_use();
+						adjacent_owner_lk.ref().set_adjacent_content_in_use(fingerprint(hash));
 					}
 					this->persist_map_controller_t::persist_content(b_dst.ref(), "content in use");
 					owner_lk.ref().insert(
@@ -731,7 +1106,7 @@ template <
 				 * Throw the exception here.
 				 */
 				perishable::test();
-				return {iterator{sbw, content_index}, true};
+				return {iterator{owner_lk.sb(), content_index}, true};
 			}
 			catch ( const no_near_empty_bucket &e )
 			{
@@ -742,8 +1117,9 @@ template <
 
 					hop_hash_log<HSTORE_TRACE_MANY>::write(LOG_LOCATION, "1. before resize\n", dump<HSTORE_TRACE_MANY>::make_hop_hash_dump(*this));
 
-					if ( segment_count() < _segment_capacity )
+					if ( is_resizing() || segment_count() < _segment_capacity )
 					{
+						/* finish the resize in progress, or resize now */
 						resize(AK_REF0);
 						hop_hash_log<HSTORE_TRACE_MANY>::write(LOG_LOCATION, "2. after resize\n", dump<HSTORE_TRACE_MANY>::make_hop_hash_dump(*this));
 						goto RETRY;
@@ -779,157 +1155,253 @@ template <
 	typename Key, typename T, typename Hash, typename Pred
 	, typename Allocator, typename SharedMutex
 >
-	void impl::hop_hash_base<Key, T, Hash, Pred, Allocator, SharedMutex>::resize(AK_ACTUAL0)
+	auto impl::hop_hash_base<Key, T, Hash, Pred, Allocator, SharedMutex>::resize_senior_owner(
+		const hash_result_t h_
+		, const bix_t ix_owner_
+	) const -> bix_t
 	{
-		hop_hash_log<HSTORE_TRACE_RESIZE>::write(LOG_LOCATION
-			, " capacity ", bucket_count()
-			, " size ", size()
-		);
+		if ( is_resize_moving() )
 		{
-#if 0
-			monitor_extend<Allocator> m{bucket_allocator_t(av)};
-#endif
-			_bc[segment_count()].extend(
-				this->persist_map_controller_t::resize_prolog(AK_REF0)
-				, &_bc[segment_count()-1]
-				, &_bc[0]
-				, segment_count()
-			);
+			const auto ix_senior_owner = h_ & (bucket_count() / 2U - 1U);
+			/* The senior owner may own content at [ix_senior_owner, ix_senior_owner + owner::size),
+			 * unless all of that content has moved.
+			 */
+			if ( ix_senior_owner != ix_owner_ && resize_moved() < ix_senior_owner + owner::size )
+			{
+				return ix_senior_owner;
+			}
 		}
+		return bucket_count();
+	}
 
-		/* adjust count and everything which depends on it (size, mask) */
-
-		/* PASS 1: copy content */
+template <
+	typename Key, typename T, typename Hash, typename Pred
+	, typename Allocator, typename SharedMutex
+>
+	bool impl::hop_hash_base<Key, T, Hash, Pred, Allocator, SharedMutex>::resize_is_moved(
+		const bix_t first_
+		, const bix_t last_
+	) const
+	{
+		/* moved buckets are [0, moved) in the senior segments and the same offsets in the junior segment */
+		const auto senior_count = bucket_count() / 2U;
+		return
+			first_ <= last_
+			&& ( first_ < senior_count ) == ( last_ < senior_count )
+			&& ( last_ & (senior_count - 1U) ) < resize_moved()
+			;
+	}
 
-		hop_hash_log<HSTORE_TRACE_RESIZE>::write(LOG_LOCATION, "before pass 1"
-			, "\n", dump<HSTORE_TRACE_RESIZE>::make_hop_hash_dump(*this));
+/* Double the table before returning (finishing a resize in progress, if any) */
+template <
+	typename Key, typename T, typename Hash, typename Pred
+	, typename Allocator, typename SharedMutex
+>
+	void impl::hop_hash_base<Key, T, Hash, Pred, Allocator, SharedMutex>::resize(AK_ACTUAL0)
+	{
+		if ( ! is_resizing() )
+		{
+			resize_begin(AK_REF0);
+		}
+		while ( is_resizing() )
+		{
+			resize_step();
+		}
+	}
 
-		resize_pass1();
+template <
+	typename Key, typename T, typename Hash, typename Pred
+	, typename Allocator, typename SharedMutex
+>
+	void impl::hop_hash_base<Key, T, Hash, Pred, Allocator, SharedMutex>::resize_begin(AK_ACTUAL0)
+	{
+		hop_hash_log<HSTORE_TRACE_RESIZE>::write(LOG_LOCATION
+			, " capacity ", bucket_count()
+			, " size ", this->persist_map_controller_t::size()
+		);
+		const auto ix = segment_count();
+		/* The junior segment is not linked into the list of segments
+		 * until its buckets are constructed.
+		 */
+		_bc[ix].extend(
+			this->persist_map_controller_t::resize_prolog(AK_REF0)
+			, &_bc[ix-1]
+			, &_bc[0]
+			, ix
+		);
+		_resize_constructing = true;
+		_resize_constructed = 0U;
+	}
 
-		hop_hash_log<HSTORE_TRACE_RESIZE>::write(LOG_LOCATION, "after pass 1"
-			, "\n", dump<HSTORE_TRACE_RESIZE>::make_hop_hash_dump(*this));
+template <
+	typename Key, typename T, typename Hash, typename Pred
+	, typename Allocator, typename SharedMutex
+>
+	void impl::hop_hash_base<Key, T, Hash, Pred, Allocator, SharedMutex>::resize_step()
+	{
+		if ( _resize_constructing )
+		{
+			const auto ix = segment_count();
+			bucket_control_t &junior_bucket_control = _bc[ix];
+			const auto first = _resize_constructed;
+			const auto last = std::min(first + resize_step_buckets, bucket_count());
+			for ( auto jx = first; jx != last; ++jx )
+			{
+				new (&junior_bucket_control.buckets()[jx]) bucket_aligned_t;
+			}
+			this->persist_map_controller_t::persist_new_segment(first, last, "resize construct");
+			_resize_constructed = last;
+			if ( last != bucket_count() )
+			{
+				return;
+			}
+		}
 
-		/*
-		 * Crash-consistency notes.
-		 *
-		 * Until the start of pass 2, there is no need (for crash-consistency purposes)
-		 * to remember that we are in a resize operation. The need for resize can be
-		 * rediscovered and the operations through pass1 can be re-executed.
-		 *
-		 * Pass2 will update owners, so during that pass we must recognize that
-		 * a restart must not re-excute pass1.
-		 *
-		 * Starting with Pass2, the "junior content" (the allocated but not live segment)
-		 * must be scanned and its contents reconstituted by the allocator.
-		 *
-		 * Exactly when the "actual size" changes to encompass the junior content,
-		 * the junior content scan must no longer be performed. Therefore the "actual size"
-		 * and the "need to scan junior content bit" must be updated together.
+		/* Lookups wait out the step. Until the first move step is done, content
+		 * wrapped past the end of the senior table is not where the doubled
+		 * table places it, and moving it changes no owner (and takes no owner lock).
 		 */
+		layout_change lc(_layout_changes);
+		if ( _resize_constructing )
+		{
+			const auto ix = segment_count();
+			bucket_control_t &junior_bucket_control = _bc[ix];
+			/*
+			 * Crash-consistency notes.
+			 *
+			 * Until now, there is no need (for crash-consistency purposes)
+			 * to remember that we are in a resize operation. The need for resize can be
+			 * rediscovered and the junior segment constructed again.
+			 *
+			 * Moves update owners, so from here on a restart must recognize
+			 * the resize and continue moving from the persisted move count.
+			 * Each move is idempotent, so that the step interrupted by a crash
+			 * can be repeated.
+			 *
+			 * Starting with the moves, the junior content must be scanned and
+			 * its contents reconstituted by the allocator.
+			 */
+			_resize_constructing = false;
+			this->persist_map_controller_t::resize_interlog();
 
-		this->persist_map_controller_t::resize_interlog();
+			/* link in new segment in non-persistent circular list of segments */
+			_bc[ix-1]._next = &junior_bucket_control;
+			_bc[0]._prev = &junior_bucket_control;
 
-		/* PASS 2: remove old content, update owners. Some old content mave have been
-		 * removed if pass 2 was restarted, so use the new (junior) content to drive
-		 * the operations.
-		 */
-		resize_pass2();
+			hop_hash_log<HSTORE_TRACE_RESIZE>::write(LOG_LOCATION, "constructed"
+				, "\n", dump<HSTORE_TRACE_RESIZE>::make_hop_hash_dump(*this));
+			/* The first move step must precede any other use of the doubled table. */
+		}
 
-		this->persist_map_controller_t::resize_epilog();
+		const auto senior_count = bucket_count() / 2U;
+		const auto first = resize_moved();
+		const auto last = std::min(first + resize_step_buckets, senior_count);
+		for ( auto ix = first; ix != last; ++ix )
+		{
+			resize_move(ix, senior_count);
+		}
+		this->persist_map_controller_t::resize_moved_set(last);
+
+		if ( last == senior_count )
+		{
+			this->persist_map_controller_t::resize_epilog();
+			hop_hash_log<HSTORE_TRACE_RESIZE>::write(LOG_LOCATION, "moved"
+				, "\n", dump<HSTORE_TRACE_RESIZE>::make_hop_hash_dump(*this));
+		}
 	}
 
+/* Move the content of one senior bucket to its place in the doubled table:
+ * either the same index or the junior bucket at the same offset.
+ */
 template <
 	typename Key, typename T, typename Hash, typename Pred
 	, typename Allocator, typename SharedMutex
 >
-	void impl::hop_hash_base<Key, T, Hash, Pred, Allocator, SharedMutex>::resize_pass1()
+	void impl::hop_hash_base<Key, T, Hash, Pred, Allocator, SharedMutex>::resize_move(
+		const bix_t ix_senior
+		, const bix_t senior_count
+	)
 	{
-		/* PASS 1: copy content */
-
-		bix_t ix_senior = 0U;
-		const auto sb_senior_end =
-			make_segment_and_bucket_at_end();
-
-			hop_hash_log<HSTORE_TRACE_MANY>::write(LOG_LOCATION
-				, " bucket_count ", bucket_count()
-				, " sb_senior_end ", sb_senior_end.si(), ",", sb_senior_end.bi()
-			);
+		bucket_control_t &junior_bucket_control = _bc[segment_count_not_stable()];
+		const auto sb_senior = make_segment_and_bucket(ix_senior);
+		const segment_and_bucket_t sb_junior(&junior_bucket_control, ix_senior);
+		auto senior_content_lk = make_content_unique_lock(sb_senior);
+		auto junior_content_lk = make_content_unique_lock(sb_junior);
 
-		for (
-			auto sb_senior = make_segment_and_bucket(0U)
-			; sb_senior != sb_senior_end
-			; sb_senior.incr_without_wrap(), ++ix_senior
-		)
+		if ( is_in_use(sb_senior) )
 		{
-			auto senior_content_lk = make_content_unique_lock(sb_senior);
-
-			/* special locate, used to access junior new buckets */
-			content<value_type> &junior_content = _bc[segment_count()].buckets()[ix_senior];
-			owner &junior_owner = _bc[segment_count()]._buckets[ix_senior];
-			if ( is_in_use(senior_content_lk.sb()) )
+			/* examine hash(key) to determine whether to move content */
+			auto hash = _hasher.hf(senior_content_lk.ref().key());
+			auto ix_owner = hash & (senior_count * 2U - 1U);
+			/*
+			 * [ix_owner, ix_owner + owner::size) is permissible range for content
+			 */
+			if ( ix_owner <= ix_senior && ix_senior < ix_owner + owner::size )
 			{
-				/* examine hash(key) to determine whether to copy content */
-				auto hash = _hasher.hf(senior_content_lk.ref().key());
-				auto ix_owner = bucket_expanded_ix(hash);
 				/*
-				 * [ix_owner, ix_owner + owner::size) is permissible range for content
+				 * content can stay where it is because bucket index index MSB is 0
 				 */
-				if ( ix_owner <= ix_senior && ix_senior < ix_owner + owner::size )
-				{
-					/*
-					 * content can stay where it is because bucket index index MSB is 0
-					 */
-
-					hop_hash_log<HSTORE_TRACE_MANY>::write(LOG_LOCATION
-						, " ", ix_senior, " 1a no-relocate, owner ", bucket_ix(hash)
-						, " -> ", ix_owner, ": content ", ix_senior
-					);
-
-				}
-				else if (
-					ix_senior < owner::size
-					&&
-					bucket_count()*2U < ix_owner + owner::size
-				)
-				{
-					/* content can stay where it is because the owner wraps
-					 * NOTE: this test is not exact, but is close enough if owner::size
-					 * is equal to or less than half the minimum table size.
-					 */
-
-					hop_hash_log<HSTORE_TRACE_MANY>::write(LOG_LOCATION
-						, " ", ix_senior, " 1b no-relocate, owner ", bucket_ix(hash)
-						, " -> ", ix_owner, ": content ", ix_senior);
-
-				}
-				else
+				hop_hash_log<HSTORE_TRACE_MANY>::write(LOG_LOCATION
+					, " ", ix_senior, " 1a no-relocate, owner ", ix_owner, ": content ", ix_senior
+				);
+				resize_move_adjust_owner(ix_senior, senior_count, senior_content_lk);
+			}
+			else if (
+				ix_senior < owner::size
+				&&
+				senior_count*2U < ix_owner + owner::size
+			)
+			{
+				/* content can stay where it is because the owner wraps
+				 * NOTE: this test is not exact, but is close enough if owner::size
+				 * is equal to or less than half the minimum table size.
+				 */
+				hop_hash_log<HSTORE_TRACE_MANY>::write(LOG_LOCATION
+					, " ", ix_senior, " 1b no-relocate, owner ", ix_owner, ": content ", ix_senior
+				);
+				auto wrapped_owner = resize_move_adjust_owner(ix_senior, senior_count, senior_content_lk);
+				if ( wrapped_owner )
 				{
-					/* content must move */
-					junior_content.content_share(senior_content_lk.ref(), ix_owner);
-					junior_owner.set_adjacent_content_in_use();
-
-					hop_hash_log<HSTORE_TRACE_MANY>::write(LOG_LOCATION
-						, " ", ix_senior, " 1c relocate, owner ", bucket_ix(hash), " -> ", ix_owner
-						, ": content ", ix_senior, " -> "
-						, ix_senior + bucket_count());
-
+					hop_hash_log<TRACK_OWNER>::write(LOG_LOCATION, ".2b content at "
+						, ix_senior, " wrapped owner adjustment");
+#if TRACK_OWNER
+					senior_content_lk.ref().owner_update(senior_count);
+#endif
 				}
 			}
 			else
 			{
-				hop_hash_log<HSTORE_TRACE_MANY>::write(LOG_LOCATION, " ", ix_senior, " 1d empty");
+				/* content must move. The junior bucket is already in use
+				 * if this move was interrupted by a crash.
+				 */
+				if ( ! is_in_use(sb_junior) )
+				{
+					junior_content_lk.ref().content_share(senior_content_lk.ref(), ix_owner);
+					junior_content_lk.owner_ref().set_adjacent_content_in_use(fingerprint(hash));
+					this->persist_map_controller_t::persist_content(junior_content_lk.ref(), "resize junior content");
+				}
+				hop_hash_log<HSTORE_TRACE_MANY>::write(LOG_LOCATION
+					, " ", ix_senior, " 1c relocate, owner ", ix_owner
+					, ": content ", ix_senior, " -> ", ix_senior + senior_count);
+
+				resize_move_adjust_owner(ix_senior, senior_count, junior_content_lk);
+				senior_content_lk.ref().content_erase();
+				senior_content_lk.owner_ref().set_adjacent_content_in_use(false);
+				this->persist_map_controller_t::persist_content(senior_content_lk.ref(), "resize senior content free");
 			}
 		}
-
-		/* persist new content */
-		this->persist_map_controller_t::persist_new_segment("pass 1 copied content");
+		else if ( is_in_use(sb_junior) )
+		{
+			/* The content moved before a crash. Its owner might not have. */
+			resize_move_adjust_owner(ix_senior, senior_count, junior_content_lk);
+		}
 	}
 
 /* Returns true iff ownership wraps the table, i.e. the owner is near the end of the table
  * and the content index is near the beginning.
  *
  * ix_senior: index of content before move
- * junior_bucket_control: access to the new "junior" segment, to which content may move
+ * senior_count: bucket count before the resize
  * populated_content_lk: lock providing access to the new location for the content (which
  *   may be the same as the old location).
  *
@@ -939,27 +1411,29 @@ template <
 	typename Key, typename T, typename Hash, typename Pred
 	, typename Allocator, typename SharedMutex
 >
-	bool impl::hop_hash_base<Key, T, Hash, Pred, Allocator, SharedMutex>::resize_pass2_adjust_owner(
-		bix_t ix_senior
-		, bucket_control_t &junior_bucket_control
+	bool impl::hop_hash_base<Key, T, Hash, Pred, Allocator, SharedMutex>::resize_move_adjust_owner(
+		const bix_t ix_senior
+		, const bix_t senior_count
 		, content_unique_lock_t &populated_content_lk
 	)
 	{
 		/* examine the key to locate old and new owners (owners) */
 		auto hash = _hasher.hf(populated_content_lk.ref().key());
 		/* Note: the owner needs to be changed iff the ownership range
-		 * of ix_senior_owner + bucket_count() includes populated_content_lk.
+		 * of ix_senior_owner + senior_count includes populated_content_lk.
 		 */
-		auto ix_senior_owner = bucket_ix(hash);
-		if ( ! ( distance_wrapped(ix_senior_owner, ix_senior) < owner::size) )
+		const auto ix_senior_owner = hash & (senior_count - 1U);
+		const auto ix_junior_owner = hash & (senior_count * 2U - 1U);
+		/* owner to content distance in the senior table */
+		const auto owner_pos = unsigned((ix_senior + senior_count - ix_senior_owner) & (senior_count - 1U));
+		if ( ! ( owner_pos < owner::size) )
 		{
 			hop_hash_log<true>::write(LOG_LOCATION, "senior owner ", ix_senior_owner
 				, " cannot reach senior content ", ix_senior
 				, ", which is more than ", owner::size, " entries away. "
-				, "Buchet bucket count is ", bucket_count());
+				, "Senior bucket count is ", senior_count);
 		}
-		assert(distance_wrapped(ix_senior_owner, ix_senior) < owner::size);
-		auto ix_junior_owner = bucket_expanded_ix(hash);
+		assert(owner_pos < owner::size);
 
 		hop_hash_log<HSTORE_TRACE_MANY>::write(LOG_LOCATION, ".2 content "
 			, ix_senior, " -> ? "
@@ -968,29 +1442,12 @@ template <
 
 		if ( ix_senior_owner != ix_junior_owner )
 		{
-			auto senior_owner_sb = make_segment_and_bucket(ix_senior_owner);
-			auto senior_owner_lk = make_owner_unique_lock(senior_owner_sb);
-			owner_unique_lock_t
-				junior_owner_lk(
-					junior_bucket_control.buckets()[ix_senior_owner]
-					, segment_and_bucket_t(&junior_bucket_control, ix_senior_owner)
-					, junior_bucket_control._bucket_mutexes[ix_senior_owner]._m_owner
-				);
+			/* The junior segment is linked into the table, so the junior owner has an ordinary index */
+			auto senior_owner_lk = make_owner_unique_lock(make_segment_and_bucket(ix_senior_owner));
+			auto junior_owner_lk = make_owner_unique_lock(make_segment_and_bucket(ix_junior_owner));
 
-			/*
-			 * special locate, used before size has been updated,
-			 * to access junior buckets
-			 */
-			auto &junior_owner = junior_bucket_control.buckets()[ix_senior_owner];
-			auto owner_pos = distance_wrapped(ix_senior_owner, ix_senior);
-			if ( ! ( owner_pos < owner::size) )
-			{
-				hop_hash_log<true>::write(LOG_LOCATION, "senior owner ", ix_senior_owner
-					, " at invalid distance from senior content ", ix_senior
-					, " with bucket count ", bucket_count());
-			}
-			assert(owner_pos < owner::size);
-			junior_owner.insert(
+			/* Both updates are idempotent, as a move may be repeated after a crash */
+			junior_owner_lk.ref().insert(
 				ix_junior_owner
 				, owner_pos
 				, junior_owner_lk
@@ -1002,8 +1459,8 @@ template <
 				, senior_owner_lk
 				, gsl::not_null<persist_map_controller_t *>(this)
 			);
-			this->persist_map_controller_t::persist_owner(junior_owner_lk.ref(), "pass 2 junior owner");
-			this->persist_map_controller_t::persist_owner(senior_owner_lk.ref(), "pass 2 senior owner");
+			this->persist_map_controller_t::persist_owner(junior_owner_lk.ref(), "move junior owner");
+			this->persist_map_controller_t::persist_owner(senior_owner_lk.ref(), "move senior owner");
 			/*
 			 * If the owner index exceeds the content index (which can only happen due to wrap)
 			 * the owner needs to change (be incremented by the bucket count).
@@ -1013,126 +1470,6 @@ template <
 		return false;
 	}
 
-template <
-	typename Key, typename T, typename Hash, typename Pred
-	, typename Allocator, typename SharedMutex
->
-	void impl::hop_hash_base<Key, T, Hash, Pred, Allocator, SharedMutex>::resize_pass2()
-	{
-
-		hop_hash_log<HSTORE_TRACE_RESIZE>::write(LOG_LOCATION, "entering pass 2"
-			, "\n", dump<HSTORE_TRACE_RESIZE>::make_hop_hash_dump(*this));
-		/* PASS 2: remove old content, update owners. Some old content mave have been
-		 * removed if pass 2 was restarted, so use the new (junior) content to drive
-		 * the operations.
-		 */
-		const auto old_segment_count = this->persist_map_controller_t::segment_count_actual().value_not_stable();
-		bucket_control_t &junior_bucket_control = _bc[old_segment_count];
-
-		bix_t ix_senior = 0U;
-		const auto sb_senior_end = make_segment_and_bucket_at_end();
-		for (
-			auto sb_senior = make_segment_and_bucket(0U)
-			; sb_senior != sb_senior_end
-			; sb_senior.incr_without_wrap(), ++ix_senior
-		)
-		{
-			/* get segment count before it was made unstable */
-			/* special locate, used before size has been updated
-			 * to access junior buckets
-			 */
-			content_unique_lock_t
-				junior_content_lk(
-					junior_bucket_control.buckets()[ix_senior]
-					, segment_and_bucket_t(&junior_bucket_control, ix_senior)
-					, junior_bucket_control._bucket_mutexes[ix_senior]._m_content
-				);
-
-			const bool is_junior_in_use =
-				owner_shared_lock_t(
-					junior_bucket_control._buckets[ix_senior]
-					, segment_and_bucket_t(&junior_bucket_control, ix_senior)
-					, junior_bucket_control._bucket_mutexes[ix_senior]._m_owner
-				).ref().is_adjacent_content_in_use();
-
-			auto senior_content_lk = make_content_unique_lock(sb_senior);
-
-			if ( is_junior_in_use )
-			{
-				/* The content has moved. */
-				resize_pass2_adjust_owner(ix_senior, junior_bucket_control, junior_content_lk);
-				senior_content_lk.ref().content_erase();
-				make_owner_unique_lock(sb_senior).ref().set_adjacent_content_in_use(false);
-			}
-			else if ( make_owner_shared_lock(sb_senior).ref().is_adjacent_content_in_use() )
-			{
-				/* The content has not moved, but it might need a new owner */
-				auto wrapped_owner = resize_pass2_adjust_owner(ix_senior, junior_bucket_control, senior_content_lk);
-				if ( wrapped_owner )
-				{
-					hop_hash_log<TRACK_OWNER>::write(LOG_LOCATION, ".2b content at "
-						, ix_senior, " wrapped owner adjustment");
-#if TRACK_OWNER
-					senior_content_lk.ref().owner_update(bucket_count());
-#endif
-				}
-			}
-			else
-			{
-			}
-		}
-
-		/* flush for state_set bucket_t::FREE in loop above. */
-		this->persist_map_controller_t::persist_existing_segments("pass 2 senior content");
-		/* flush for state_set owner::LIVE in loop above. */
-		this->persist_map_controller_t::persist_new_segment("pass 2 junior owner");
-
-		/* link in new segment in non-persistent circular list of segments */
-		_bc[old_segment_count-1]._next = &junior_bucket_control;
-		_bc[0]._prev = &junior_bucket_control;
-	}
-
-template <
-	typename Key, typename T, typename Hash, typename Pred
-	, typename Allocator, typename SharedMutex
->
-	auto impl::hop_hash_base<
-		Key, T, Hash, Pred, Allocator, SharedMutex
-	>::make_segment_and_bucket_unsafe(
-		bix_t ix_
-	) const -> segment_and_bucket_t
-	{
-/* Similar to make_segment_and_bucket_for_iterator, but uses unsafe segment_count
- * Since this may refrences buckets entering through a "junior" segment, the
- * bucekt index is up to twice the bucket count.
- */
-		assert( ix_ < bucket_count() * 2 );
-
-		auto si =
-			__builtin_expect((segment_layout::ix_high(ix_) == 0),false)
-			? 0
-			: segment_layout::log2(ix_high(ix_))
-			;
-		auto bi =
-			(
-				__builtin_expect((segment_layout::ix_high(ix_) == 0),false)
-				? 0
-				: ix_high(ix_) % (bix_t(1U) << (si-1))
-			)
-			*
-			segment_layout::base_segment_size + segment_layout::ix_low(ix_)
-			;
-
-#pragma GCC diagnostic push
-#pragma GCC diagnostic ignored "-Warray-bounds"
-		return
-			si == segment_count_not_stable()
-			? segment_and_bucket_t(&_bc[si-1], _bc[si-1].segment_size() ) /* end iterator */
-			: segment_and_bucket_t(&_bc[si], bi)
-			;
-#pragma GCC diagnostic pop
-	}
-
 template <
 	typename Key, typename T, typename Hash, typename Pred
 	, typename Allocator, typename SharedMutex
@@ -1373,10 +1710,10 @@ template <
 		) -> iterator
 		{
 			TM_SCOPE()
-			auto bi_lk = make_owner_shared_lock(k_);
-			auto key_bi = locate_key(TM_REF bi_lk, k_);
-			auto content_ix = distance_small(bi_lk.sb(), key_bi);
-			return content_ix == owner::size ? end() : iterator{bi_lk.sb(), content_ix};
+			const auto hash = _hasher.hf(k_);
+			const auto owner_key = locate_owner_and_key_optimistic(TM_REF hash, k_);
+			auto content_ix = distance_small(owner_key.first, owner_key.second);
+			return content_ix == owner::size ? end() : iterator{owner_key.first, content_ix};
 		}
 
 template <
@@ -1390,9 +1727,80 @@ template <
 		) const -> const_iterator
 		{
 			TM_SCOPE()
-			auto bi_lk = make_owner_shared_lock(k_);
-			auto key_bi = locate_key(TM_REF bi_lk, k_);
-			return distance_small(bi_lk.si(), key_bi.si()) == owner::size ? end() : key_bi;
+			const auto hash = _hasher.hf(k_);
+			const auto owner_key = locate_owner_and_key_optimistic(TM_REF hash, k_);
+			auto content_ix = distance_small(owner_key.first, owner_key.second);
+			return content_ix == owner::size ? end() : const_iterator{owner_key.first, content_ix};
+		}
+
+template <
+	typename Key, typename T, typename Hash, typename Pred
+	, typename Allocator, typename SharedMutex
+>
+	template <typename KIT, typename F>
+		void impl::hop_hash_base<Key, T, Hash, Pred, Allocator, SharedMutex>::find_n(
+			TM_ACTUAL
+			KIT first_
+			, const KIT last_
+			, F f_
+		) const
+		{
+			TM_SCOPE()
+			std::array<hash_result_t, find_group_size> hash;
+			while ( first_ != last_ )
+			{
+				std::size_t n = 0;
+				for ( auto k = first_; k != last_ && n != hash.size(); ++k, ++n )
+				{
+					hash[n] = _hasher.hf(*k);
+				}
+				for ( std::size_t i = 0; i != n; ++i )
+				{
+					prefetch_owner<0>(make_segment_and_bucket(bucket_ix(hash[i])));
+				}
+				/* as find. The owner is located anew: a prefetch is only a hint */
+				for ( std::size_t i = 0; i != n; ++i, ++first_ )
+				{
+					const auto owner_key = locate_owner_and_key_optimistic(TM_REF hash[i], *first_);
+					auto content_ix = distance_small(owner_key.first, owner_key.second);
+					f_(content_ix == owner::size ? end() : const_iterator{owner_key.first, content_ix});
+				}
+			}
+		}
+
+template <
+	typename Key, typename T, typename Hash, typename Pred
+	, typename Allocator, typename SharedMutex
+>
+	template <typename F>
+		auto impl::hop_hash_base<Key, T, Hash, Pred, Allocator, SharedMutex>::for_each_owned(
+			const bix_t first_
+			, const bix_t last_
+			, F f_
+		) const -> bix_t
+		{
+			assert(first_ <= last_);
+			assert(last_ <= bucket_count());
+			auto ix = first_;
+			if ( ix != last_ )
+			{
+				bool more = true;
+				for ( auto sb = make_segment_and_bucket_for_iterator(ix); more && ix != last_; ++ix, sb.incr_without_wrap() )
+				{
+					auto owner_lk = make_owner_shared_lock(sb);
+					const auto in_use = locate_owner(sb).ownership_bits(owner_lk);
+					for ( owner::index_type i = 0; i != owner::size; ++i )
+					{
+						if ( (in_use >> i) & 1U )
+						{
+							auto sb_content = sb;
+							sb_content.add_small(i);
+							more = f_(static_cast<const value_type &>(sb_content.deref().template content<value_type>::value())) && more;
+						}
+					}
+				}
+			}
+			return ix;
 		}
 
 template <
@@ -1425,7 +1833,7 @@ template <
 		{
 			persist_size_change<Allocator, size_decr> s(*this);
 			owner_lk.ref().erase(
-				static_cast<unsigned>(erase_src_lk.index()-owner_lk.index())
+				distance_small(owner_lk.sb(), erase_src_lk.sb())
 				, owner_lk
 				, gsl::not_null<persist_map_controller_t *>(this)
 			);
@@ -1460,6 +1868,11 @@ template <
 		try
 		{
 			consistency_guard<impl::hop_hash_base<Key, T, Hash, Pred, Allocator, SharedMutex>> g(this);
+			/* Advance a resize in progress */
+			if ( is_resizing() )
+			{
+				resize_step();
+			}
 			auto it = find(TM_REF k_);
 			return
 				it == end()
@@ -1484,9 +1897,9 @@ template <
 			const K &k_
 		) const -> size_type
 		{
-			auto bi_lk = make_owner_shared_lock(k_);
-			auto key_bi = locate_key(TM_REF bi_lk, k_);
-			return distance_small(bi_lk.sb(), key_bi.sb()) == owner::size ? 0U : 1U;
+			const auto hash = _hasher.hf(k_);
+			const auto owner_key = locate_owner_and_key_optimistic(TM_REF hash, k_);
+			return distance_small(owner_key.first, owner_key.second) == owner::size ? 0U : 1U;
 		}
 
 template <
@@ -1501,15 +1914,15 @@ template <
 		{
 			TM_SCOPE()
 			/* The bucket which owns the entry */
-			auto bi_lk = make_owner_shared_lock(k_);
-			const auto key_bi = locate_key(TM_REF bi_lk, k_);
-			if ( distance_small(bi_lk.sb(), key_bi) == owner::size )
+			const auto hash = _hasher.hf(k_);
+			const auto owner_key = locate_owner_and_key_optimistic(TM_REF hash, k_);
+			if ( distance_small(owner_key.first, owner_key.second) == owner::size )
 			{
 				/* no such element */
 				throw impl::key_not_found{};
 			}
 			/* element found at bf */
-			return static_cast<bucket_t &>(key_bi.deref()).mapped();
+			return static_cast<bucket_t &>(owner_key.second.deref()).mapped();
 		}
 
 template <
@@ -1523,16 +1936,16 @@ template <
 		) -> mapped_type &
 		{
 			TM_SCOPE()
-			/* Lock the entry owner */
-			auto bi_lk = make_owner_shared_lock(k_);
-			const auto key_bi = locate_key(TM_REF bi_lk, k_);
-			if ( distance_small(bi_lk.sb(), key_bi) == owner::size )
+			/* The bucket which owns the entry */
+			const auto hash = _hasher.hf(k_);
+			const auto owner_key = locate_owner_and_key_optimistic(TM_REF hash, k_);
+			if ( distance_small(owner_key.first, owner_key.second) == owner::size )
 			{
 				/* no such element */
 				throw impl::key_not_found{};
 			}
 			/* element found at bf */
-			return static_cast<bucket_t &>(key_bi.deref()).mapped();
+			return static_cast<bucket_t &>(owner_key.second.deref()).mapped();
 		}
 
 template <
@@ -217,36 +217,8 @@ template <typename TableBase>
 
 		if ( ! tbl_base.segment_count_actual().is_stable() )
 		{
-			auto &loc = tbl_base._bc[tbl_base.segment_count_not_stable()];
-			if ( loc._buckets )
-			{
-				o_ << "Pending buckets\n";
-				for ( std::size_t ks = 0; ks != tbl_base.bucket_count(); ++ks )
-				{
-					const auto kj = tbl_base.bucket_count() + ks;
-					const auto sbj = tbl_base.make_segment_and_bucket_unsafe(kj);
-					bypass_lock<typename TableBase::bucket_t, const owner> owner_lk(loc._buckets[ks], sbj);
-					bypass_lock<typename TableBase::bucket_t, const content<typename TableBase::value_type>>
-						content_lk(
-							loc._buckets[ks]
-							, sbj
-						);
-					if (
-						owner_lk.ref().ownership_bits(owner_lk) != 0
-						||
-						owner_lk.ref().is_adjacent_content_in_use()
-					)
-					{
-						o_ << kj << ": "
-							<< make_bucket_print(tbl_base.bucket_count(), owner_lk, content_lk)
-							<< "\n";
-					}
-				}
-			}
-			else
-			{
-				o_ << "Resize in progress but no pending buckets\n";
-			}
+			/* The junior segment is part of the table (and of the dump above) while a resize moves content */
+			o_ << "Resize in progress, senior buckets moved " << tbl_base.resize_moved() << " of " << tbl_base.bucket_count()/2U << "\n";
 		}
 		return o_;
 	}
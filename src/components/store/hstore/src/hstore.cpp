@@ -30,6 +30,7 @@
 #include <common/exceptions.h>
 #include <common/logging.h> /* format */
 #include <common/perf/tm.h>
+#include <common/pointer_cast.h>
 #include <common/utils.h>
 
 #include <city.h>
@@ -51,6 +52,12 @@ struct alloc_key {};
 
 thread_local std::map<void *, hstore::open_pool_type *> tls_cache = {};
 
+/* IKVStore presents keys as byte views; the session takes char views */
+common::string_view to_string_view(const component::IKVStore::string_view_key k)
+{
+	return common::string_view(common::pointer_cast<char>(k.data()), k.size());
+}
+
 /* forced because pool_t is an integral type, not a pointer */
 void *to_ptr(component::IKVStore::pool_t p) { return reinterpret_cast<void *>(p); }
 
@@ -199,7 +206,7 @@ catch ( const pool_error &e )
 {
   return e.value() != int(pool_ec::region_fail) || flags_ & FLAGS_CREATE_ONLY
     ? static_cast<IKVStore::pool_t>((FLOGM("POOL_ERROR: {}", e.message())), POOL_ERROR)
-    : open_pool(name_, flags_ & ~FLAGS_SET_SIZE, base_addr_unused)
+    : open_pool(name_, flags_ & ~(FLAGS_SET_SIZE|FLAGS_HASH_MASK), base_addr_unused)
     ;
 }
 catch ( const std::bad_alloc &e )
@@ -234,7 +241,8 @@ auto hstore::open_pool(const std::string &name_,
       else
       {
         /* no session yet, create one */
-        auto s = _pool_manager->pool_open_2(AK_INSTANCE v, flags);
+        /* hash flags are ignored: the pool keeps the algorithm it was created with */
+        auto s = _pool_manager->pool_open_2(AK_INSTANCE v, flags & ~FLAGS_HASH_MASK);
         /* explicit conversion to shared_ptr fpr g++ 5 */
         _pools.emplace(::base(v.address_map().front()), std::shared_ptr<open_pool_type>(s.release()));
       }
@@ -339,18 +347,30 @@ auto hstore::grow_pool( //
   return S_OK;
 }
 
+/* The std::string forms forward to the string_view_key forms */
 auto hstore::put(const pool_t pool,
                  const std::string &key,
                  const void * value,
                  const std::size_t value_len,
                  flags_t flags) -> status_t
+{
+  return put(pool, to_key_view(key), value, value_len, flags);
+}
+
+auto hstore::put(const pool_t pool,
+                 const string_view_key key_,
+                 const void * value,
+                 const std::size_t value_len,
+                 flags_t flags) -> status_t
 {
   TM_ROOT()
+  const auto key = to_string_view(key_);
   CPLOG(
     1
-    , PREFIX "(key=%s) (value=%.*s)"
+    , PREFIX "(key=%.*s) (value=%.*s)"
     , LOCATION
-    , key.c_str()
+    , int(key.size())
+    , key.data()
     , int(value_len)
     , static_cast<const char*>(value)
   );
@@ -435,6 +455,16 @@ auto hstore::put_direct(const pool_t pool,
                         const std::size_t value_len,
                         memory_handle_t,
                         flags_t flags) -> status_t
+{
+  return put(pool, to_key_view(key), value, value_len, flags);
+}
+
+auto hstore::put_direct(const pool_t pool,
+                        const string_view_key key,
+                        const void * value,
+                        const std::size_t value_len,
+                        memory_handle_t,
+                        flags_t flags) -> status_t
 {
   return put(pool, key, value, value_len, flags);
 }
@@ -443,8 +473,17 @@ auto hstore::get(const pool_t pool,
                  const std::string &key,
                  void*& out_value,
                  std::size_t& out_value_len) -> status_t
+{
+  return get(pool, to_key_view(key), out_value, out_value_len);
+}
+
+auto hstore::get(const pool_t pool,
+                 const string_view_key key_,
+                 void*& out_value,
+                 std::size_t& out_value_len) -> status_t
 {
   TM_ROOT()
+  const auto key = to_string_view(key_);
   const auto session = static_cast<const session_type *>(locate_session(pool));
   if ( ! session )
   {
@@ -499,9 +538,19 @@ auto hstore::get_direct(const pool_t pool,
                         const std::string & key,
                         void* out_value,
                         std::size_t& out_value_len,
+                        memory_handle_t handle) -> status_t
+{
+  return get_direct(pool, to_key_view(key), out_value, out_value_len, handle);
+}
+
+auto hstore::get_direct(const pool_t pool,
+                        const string_view_key key_,
+                        void* out_value,
+                        std::size_t& out_value_len,
                         memory_handle_t) -> status_t
 {
   TM_ROOT()
+  const auto key = to_string_view(key_);
   const auto session = static_cast<const session_type *>(locate_session(pool));
   if ( ! session )
   {
@@ -530,8 +579,19 @@ auto hstore::get_attribute(
   const Attribute attr,
   std::vector<uint64_t>& out_attr,
   const std::string* key) -> status_t
+{
+  return get_attribute(pool, attr, out_attr, key ? to_key_view(*key) : string_view_key());
+}
+
+/* A key with null data is no key */
+auto hstore::get_attribute(
+  const pool_t pool,
+  const Attribute attr,
+  std::vector<uint64_t>& out_attr,
+  const string_view_key key_) -> status_t
 {
   out_attr.clear();
+  const auto key = to_string_view(key_);
 
   const auto session = static_cast<const session_type *>(locate_session(pool));
   if ( ! session )
@@ -547,7 +607,7 @@ auto hstore::get_attribute(
       return S_OK;
     }
   case VALUE_LEN:
-    if ( ! key )
+    if ( key.data() == nullptr )
     {
       return E_INVAL;
     }
@@ -556,7 +616,7 @@ auto hstore::get_attribute(
       /* interface does not say what we do to the out_attr vector;
        * push_back is at least non-destructive.
        */
-      out_attr.push_back(session->get_value_len(*key));
+      out_attr.push_back(session->get_value_len(key));
       return S_OK;
     }
     catch ( const impl::key_not_found &e )
@@ -588,13 +648,13 @@ auto hstore::get_attribute(
     break;
 #if ENABLE_TIMESTAMPS
   case IKVStore::Attribute::WRITE_EPOCH_TIME:
-    if ( ! key )
+    if ( key.data() == nullptr )
     {
       return E_INVAL;
     }
     try
     {
-      out_attr.push_back(session->get_write_epoch_time(*key));
+      out_attr.push_back(session->get_write_epoch_time(key));
       return S_OK;
     }
     catch ( const impl::key_not_found &e )
@@ -644,8 +704,19 @@ auto hstore::resize_value(
   , const std::size_t new_value_len
   , const std::size_t alignment
 ) -> status_t
+{
+  return resize_value(pool, to_key_view(key), new_value_len, alignment);
+}
+
+auto hstore::resize_value(
+  const pool_t pool
+  , const string_view_key key_
+  , const std::size_t new_value_len
+  , const std::size_t alignment
+) -> status_t
 {
   TM_ROOT()
+  const auto key = to_string_view(key_);
   const auto session = static_cast<session_type *>(locate_session(pool));
   try
   {
@@ -688,9 +759,24 @@ auto hstore::lock(
   , key_t& out_key
   , const char ** out_key_ptr
 ) -> status_t
+{
+  return lock(pool, to_key_view(key), type, out_value, out_value_len, alignment, out_key, out_key_ptr);
+}
+
+auto hstore::lock(
+  const pool_t pool
+  , const string_view_key key_
+  , lock_type_t type
+  , void *& out_value
+  , std::size_t & out_value_len
+  , std::size_t alignment
+  , key_t& out_key
+  , const char ** out_key_ptr
+) -> status_t
 try
 {
   TM_ROOT()
+  const auto key = to_string_view(key_);
   const auto session = static_cast<session_type *>(locate_session(pool));
   if(!session) return E_FAIL;
 	/* 0 probably means that alignment is a don't care, which is the same as alignment 1 */
@@ -757,15 +843,108 @@ auto hstore::unlock(const pool_t pool,
 auto hstore::erase(const pool_t pool,
                    const std::string &key
                    ) -> status_t
+{
+  return erase(pool, to_key_view(key));
+}
+
+auto hstore::erase(const pool_t pool,
+                   const string_view_key key
+                   ) -> status_t
 {
   TM_ROOT()
   const auto session = static_cast<session_type *>(locate_session(pool));
   return session
-    ? session->erase(TM_REF key)
+    ? session->erase(TM_REF to_string_view(key))
     : E_POOL_NOT_FOUND
     ;
 }
 
+auto hstore::multi_get(const pool_t pool,
+                       const gsl::span<const string_view_key> keys,
+                       const gsl::span<::iovec> inout_values,
+                       const gsl::span<status_t> out_status) -> status_t
+{
+  TM_ROOT()
+  if ( keys.size() != inout_values.size() || keys.size() != out_status.size() )
+  {
+    return E_INVAL;
+  }
+  const auto session = static_cast<const session_type *>(locate_session(pool));
+  if ( ! session )
+  {
+    return E_POOL_NOT_FOUND;
+  }
+  session->multi_get(TM_REF keys, inout_values, out_status);
+  return S_OK;
+}
+
+/* put and lock emplace and pin one key at a time, but the owner buckets of
+ * a group of keys are prefetched before the first is updated.
+ */
+auto hstore::multi_put(const pool_t pool,
+                       const gsl::span<const string_view_key> keys,
+                       const gsl::span<const string_view_value> values,
+                       const flags_t flags,
+                       const gsl::span<status_t> out_status) -> status_t
+{
+  if ( keys.size() != values.size() || keys.size() != out_status.size() )
+  {
+    return E_INVAL;
+  }
+  const auto session = static_cast<const session_type *>(locate_session(pool));
+  if ( ! session )
+  {
+    return E_POOL_NOT_FOUND;
+  }
+  auto k = keys.begin();
+  auto v = values.begin();
+  auto s = out_status.begin();
+  while ( k != keys.end() )
+  {
+    const auto group_end = k + std::min(std::ptrdiff_t(session_type::multi_group_size), keys.end() - k);
+    std::for_each(k, group_end, [session] (const string_view_key key) { session->prefetch(to_string_view(key)); });
+    for ( ; k != group_end; ++k, ++v, ++s )
+    {
+      *s = put(pool, *k, v->data(), v->size(), flags);
+    }
+  }
+  return S_OK;
+}
+
+auto hstore::multi_lock(const pool_t pool,
+                        const gsl::span<const string_view_key> keys,
+                        const lock_type_t type,
+                        const gsl::span<::iovec> inout_values,
+                        const std::size_t alignment,
+                        const gsl::span<key_t> out_key_handles,
+                        const gsl::span<status_t> out_status) -> status_t
+{
+  if ( keys.size() != inout_values.size() || keys.size() != out_key_handles.size() || keys.size() != out_status.size() )
+  {
+    return E_INVAL;
+  }
+  const auto session = static_cast<const session_type *>(locate_session(pool));
+  if ( ! session )
+  {
+    return E_POOL_NOT_FOUND;
+  }
+  auto k = keys.begin();
+  auto v = inout_values.begin();
+  auto h = out_key_handles.begin();
+  auto s = out_status.begin();
+  while ( k != keys.end() )
+  {
+    const auto group_end = k + std::min(std::ptrdiff_t(session_type::multi_group_size), keys.end() - k);
+    std::for_each(k, group_end, [session] (const string_view_key key) { session->prefetch(to_string_view(key)); });
+    for ( ; k != group_end; ++k, ++v, ++h, ++s )
+    {
+      *h = KEY_NONE;
+      *s = lock(pool, *k, type, v->iov_base, v->iov_len, alignment, *h, nullptr);
+    }
+  }
+  return S_OK;
+}
+
 std::size_t hstore::count(const pool_t pool)
 {
   const auto session = static_cast<session_type *>(locate_session(pool));
@@ -857,6 +1036,69 @@ auto hstore::map_keys(
     ;
 }
 
+auto hstore::map_partition(
+  const pool_t pool_
+  , const unsigned partition_
+  , const unsigned partition_count_
+  , map_cursor_t &cursor_
+  , const std::size_t max_objects_
+  , std::function
+  <
+    int(const void * key, std::size_t key_len,
+        const void * val, std::size_t val_len)
+  > f_
+) -> status_t
+{
+  const auto session = static_cast<session_type *>(locate_session(pool_));
+
+  return session
+    ? session->map_partition(partition_, partition_count_, cursor_, max_objects_, f_)
+    : int(E_POOL_NOT_FOUND)
+    ;
+}
+
+auto hstore::map_parallel(
+  const pool_t pool_
+  , const unsigned partition_count_
+  , std::function
+  <
+    int(unsigned partition,
+        const void * key, std::size_t key_len,
+        const void * val, std::size_t val_len)
+  > f_
+  , std::function<void(unsigned partition)> merge_
+  , const bool ordered_
+  , executor_t executor_
+) -> status_t
+{
+  const auto session = static_cast<session_type *>(locate_session(pool_));
+
+  return session
+    ? session->map_parallel(partition_count_, f_, merge_, ordered_, executor_)
+    : int(E_POOL_NOT_FOUND)
+    ;
+}
+
+auto hstore::group_commit_begin(const pool_t pool_) -> status_t
+{
+  const auto session = static_cast<session_type *>(locate_session(pool_));
+
+  return session
+    ? session->group_commit_begin()
+    : int(E_POOL_NOT_FOUND)
+    ;
+}
+
+auto hstore::group_commit_end(const pool_t pool_) -> status_t
+{
+  const auto session = static_cast<session_type *>(locate_session(pool_));
+
+  return session
+    ? session->group_commit_end()
+    : int(E_POOL_NOT_FOUND)
+    ;
+}
+
 auto hstore::free_memory(void * p) -> status_t
 {
   ::free(p);
@@ -868,6 +1110,15 @@ auto hstore::atomic_update(
     , const std::string& key
     , const std::vector<IKVStore::Operation *> &op_vector
     , const bool take_lock) -> status_t
+{
+  return atomic_update(pool, to_key_view(key), op_vector, take_lock);
+}
+
+auto hstore::atomic_update(
+    const pool_t pool
+    , const string_view_key key
+    , const std::vector<IKVStore::Operation *> &op_vector
+    , const bool take_lock) -> status_t
 try
 {
   TM_ROOT(hs_atomic_update)
@@ -880,7 +1131,7 @@ try
   const auto session = static_cast<session_type *>(locate_session(pool));
   return
     session
-    ? ( (session->*update_method)(AK_INSTANCE TM_REF key, op_vector.begin(), op_vector.end()), S_OK )
+    ? ( (session->*update_method)(AK_INSTANCE TM_REF to_string_view(key), op_vector.begin(), op_vector.end()), S_OK )
     : int(E_POOL_NOT_FOUND)
     ;
 }
@@ -178,6 +178,12 @@ public:
                std::size_t value_len,
                flags_t flags) override;
 
+  status_t put(pool_t pool,
+               string_view_key key,
+               const void * value,
+               std::size_t value_len,
+               flags_t flags) override;
+
   status_t put_direct(pool_t pool,
                       const std::string& key,
                       const void * value,
@@ -185,22 +191,45 @@ public:
                       memory_handle_t handle,
                       flags_t flags) override;
 
+  status_t put_direct(pool_t pool,
+                      string_view_key key,
+                      const void * value,
+                      std::size_t value_len,
+                      memory_handle_t handle,
+                      flags_t flags) override;
+
   status_t get(pool_t pool,
                const std::string &key,
                void*& out_value,
                std::size_t& out_value_len) override;
 
+  status_t get(pool_t pool,
+               string_view_key key,
+               void*& out_value,
+               std::size_t& out_value_len) override;
+
   status_t get_direct(pool_t pool,
                       const std::string &key,
                       void* out_value,
                       std::size_t& out_value_len,
                       memory_handle_t handle) override;
 
+  status_t get_direct(pool_t pool,
+                      string_view_key key,
+                      void* out_value,
+                      std::size_t& out_value_len,
+                      memory_handle_t handle) override;
+
   status_t get_attribute(pool_t pool,
                                  Attribute attr,
                                  std::vector<uint64_t>& out_attr,
                                  const std::string* key) override;
 
+  status_t get_attribute(pool_t pool,
+                                 Attribute attr,
+                                 std::vector<uint64_t>& out_attr,
+                                 string_view_key key) override;
+
   status_t set_attribute(const pool_t pool,
                                  Attribute attr,
                                  const std::vector<uint64_t>& value,
@@ -215,11 +244,25 @@ public:
                 key_t& out_key,
                 const char ** out_key_ptr) override;
 
+  status_t lock(const pool_t pool,
+                string_view_key key,
+                lock_type_t type,
+                void*& out_value,
+                std::size_t& inout_value_len,
+                std::size_t value_alignment,
+                key_t& out_key,
+                const char ** out_key_ptr) override;
+
   status_t resize_value(pool_t pool
                         , const std::string& key
                         , std::size_t        new_value_len
                         , std::size_t        alignment) override;
 
+  status_t resize_value(pool_t pool
+                        , string_view_key    key
+                        , std::size_t        new_value_len
+                        , std::size_t        alignment) override;
+
   status_t unlock(pool_t pool,
                   key_t key_handle,
                   unlock_flags_t flags) override;
@@ -233,6 +276,28 @@ public:
   status_t erase(pool_t pool,
                  const std::string &key) override;
 
+  status_t erase(pool_t pool,
+                 string_view_key key) override;
+
+  status_t multi_get(pool_t pool,
+                     gsl::span<const string_view_key> keys,
+                     gsl::span<::iovec> inout_values,
+                     gsl::span<status_t> out_status) override;
+
+  status_t multi_put(pool_t pool,
+                     gsl::span<const string_view_key> keys,
+                     gsl::span<const string_view_value> values,
+                     flags_t flags,
+                     gsl::span<status_t> out_status) override;
+
+  status_t multi_lock(pool_t pool,
+                      gsl::span<const string_view_key> keys,
+                      lock_type_t type,
+                      gsl::span<::iovec> inout_values,
+                      std::size_t alignment,
+                      gsl::span<key_t> out_key_handles,
+                      gsl::span<status_t> out_status) override;
+
   std::size_t count(pool_t pool) override;
 
   status_t map(pool_t pool,
@@ -253,6 +318,31 @@ public:
   status_t map_keys(pool_t pool,
                std::function<int(const std::string& key)> function) override;
 
+  status_t map_partition(pool_t pool,
+                         unsigned partition,
+                         unsigned partition_count,
+                         map_cursor_t &cursor,
+                         std::size_t max_objects,
+                         std::function<int(const void * key,
+                                           std::size_t key_len,
+                                           const void * value,
+                                           std::size_t value_len)> function) override;
+
+  status_t map_parallel(pool_t pool,
+                        unsigned partition_count,
+                        std::function<int(unsigned partition,
+                                          const void * key,
+                                          std::size_t key_len,
+                                          const void * value,
+                                          std::size_t value_len)> function,
+                        std::function<void(unsigned partition)> merge,
+                        bool ordered,
+                        executor_t executor) override;
+
+  status_t group_commit_begin(pool_t pool) override;
+
+  status_t group_commit_end(pool_t pool) override;
+
   status_t free_memory(void * p) override;
 
   void debug(pool_t pool, unsigned cmd, uint64_t arg) override;
@@ -263,6 +353,12 @@ public:
     const std::vector<Operation *> &op_vector,
     bool take_lock) override;
 
+  status_t atomic_update(
+    pool_t pool,
+    string_view_key key,
+    const std::vector<Operation *> &op_vector,
+    bool take_lock) override;
+
   /* Unfortunately, swap_keys uses the notion of a "lock", which makes it
    * significantly more complex than if it were simply swapping keys.
    * Since small keys cannot be locked in place, they must first be moved,
@@ -153,7 +153,9 @@ template <typename Region, typename Table, typename Allocator, typename LockType
     , std::size_t expected_obj_count_
   ) -> std::unique_ptr<open_pool_handle>
   {
-    if ( flags_ != 0 )
+    using IKVStore = component::IKVStore;
+    const auto hash_algorithm = (flags_ & IKVStore::FLAGS_HASH_MASK) >> IKVStore::FLAGS_HASH_SHIFT;
+    if ( ( flags_ & ~IKVStore::FLAGS_HASH_MASK ) != 0 || unsigned(common::key_hash_t::KEY_HASH_CRC32C) < hash_algorithm )
     {
       throw pool_error("unsupported flags " + std::to_string(flags_), pool_ec::pool_unsupported_mode);
     }
@@ -172,6 +174,7 @@ template <typename Region, typename Table, typename Allocator, typename LockType
           , CityHash64(rac_.id().data(), rac_.id().size())
           , ::size(rac_.address_map().front())
           , expected_obj_count_
+          , common::key_hash_t(hash_algorithm)
           , _numa_node
           , rac_.id() // backing file
           , rac_.data_file() // backing file
@@ -228,6 +231,10 @@ template <typename Region, typename Table, typename Allocator, typename LockType
     auto iov_first = ra_.address_map().begin();
     const auto iov_last = ra_.address_map().end();
     assert(iov_first != iov_last);
+    if ( ! region_type::is_region_at(::base(ra_.address_map().front())) )
+    {
+      throw pool_error(common::format("pool {}: not a region of this heap type and layout version", ra_.id()), pool_ec::region_layout_mismatch);
+    }
     ++iov_first;
     open_pool_handle
       h(
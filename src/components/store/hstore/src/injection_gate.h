@@ -0,0 +1,105 @@
+/*
+   Copyright [2021] [IBM Corporation]
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+       http://www.apache.org/licenses/LICENSE-2.0
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+
+#ifndef MCAS_HSTORE_INJECTION_GATE_H
+#define MCAS_HSTORE_INJECTION_GATE_H
+
+#include <atomic>
+#include <exception> /* exception_ptr */
+#include <mutex>
+#include <thread>
+#include <utility> /* move */
+
+/*
+ * Runs a batch injection of allocations into a reconstituting heap, either
+ * now or on a thread of its own ("lazy" reconstitution). Until a background
+ * batch finishes, the gate is closed: every other use of the heap must first
+ * wait(), as the heap allocator state is incomplete.
+ *
+ * A gate is owned by the ephemeral heap state, and must be destroyed (joining
+ * any background batch) before the rest of that state.
+ */
+struct injection_gate
+{
+private:
+	std::atomic<bool> _closed;
+	std::mutex _m;
+	std::thread _batch;
+	std::exception_ptr _error;
+public:
+	injection_gate()
+		: _closed(false)
+		, _m()
+		, _batch()
+		, _error()
+	{}
+	injection_gate(const injection_gate &) = delete;
+	injection_gate &operator=(const injection_gate &) = delete;
+	~injection_gate()
+	{
+		if ( _batch.joinable() )
+		{
+			_batch.join();
+		}
+	}
+
+	/* Run f, a batch injection, now or (if background) on a thread of its own */
+	template <typename F>
+		void run(F f, bool background)
+		{
+			wait();
+			if ( background )
+			{
+				_closed.store(true, std::memory_order_release);
+				_batch =
+					std::thread(
+						[this, f = std::move(f)] () mutable
+						{
+							try
+							{
+								f();
+							}
+							catch ( ... )
+							{
+								_error = std::current_exception();
+							}
+						}
+					);
+			}
+			else
+			{
+				f();
+			}
+		}
+
+	/* Wait for a background batch, rethrowing any exception which it threw */
+	void wait()
+	{
+		if ( _closed.load(std::memory_order_acquire) )
+		{
+			std::lock_guard<std::mutex> g(_m);
+			if ( _batch.joinable() )
+			{
+				_batch.join();
+			}
+			_closed.store(false, std::memory_order_release);
+			if ( _error )
+			{
+				std::rethrow_exception(std::exchange(_error, nullptr));
+			}
+		}
+	}
+};
+
+#endif
@@ -72,8 +72,16 @@ namespace impl
 		: public pos_trace<TRACED_OWNER>
 	{
 		using index_type = unsigned;
-		static constexpr index_type size = 63U;
+		/* The owner word holds, from the low bit:
+		 *  size ownership bits,
+		 *  the "in use" bit of the adjacent content,
+		 *  a fingerprint (hash bits) of the adjacent content key, which lets
+		 *  a probe skip most non-matching keys without comparing them.
+		 */
+		static constexpr index_type size = 55U;
 		using value_type = std::uint64_t; /* sufficient for size not over 64U */
+		using fingerprint_type = std::uint8_t;
+		static constexpr unsigned fingerprint_bits = 8U;
 		static constexpr auto pos_undefined = std::numeric_limits<std::size_t>::max();
 		static constexpr char lock_id = 'w';
 	private:
@@ -88,6 +96,13 @@ namespace impl
 			_value |= mask_from_pos(p_);
 		}
 		void set_adjacent_content_free() { _value &= ~ adjacent_content_in_use_mask(); }
+		void set_adjacent_content_in_use() { _value |= adjacent_content_in_use_mask(); }
+		static constexpr unsigned fingerprint_shift = size + 1U;
+		static_assert(
+			fingerprint_shift + fingerprint_bits <= std::numeric_limits<value_type>::digits
+			, "owner bits, in use bit and fingerprint exceed the owner word"
+		);
+		static constexpr value_type fingerprint_mask() { return value_type(std::numeric_limits<fingerprint_type>::max()) << fingerprint_shift; }
 	public:
 		explicit owner()
 			: _value(0)
@@ -146,6 +161,7 @@ namespace impl
 			}
 
 		bool is_adjacent_content_in_use() const { return _value & adjacent_content_in_use_mask(); }
+		/* Changes only the "in use" bit. Content placed in use must set the fingerprint as well. */
 		void set_adjacent_content_in_use(bool in_use)
 		{
 			if ( in_use )
@@ -157,7 +173,11 @@ namespace impl
 				set_adjacent_content_free();
 			}
 		}
-		void set_adjacent_content_in_use() { _value |= adjacent_content_in_use_mask(); }
+		void set_adjacent_content_in_use(fingerprint_type fp)
+		{
+			_value = ( _value & ~fingerprint_mask() ) | ( value_type(fp) << fingerprint_shift ) | adjacent_content_in_use_mask();
+		}
+		fingerprint_type adjacent_content_fingerprint() const { return fingerprint_type(_value >> fingerprint_shift); }
 
 		template <typename Lock>
 			auto ownership_bits(Lock &) const -> value_type { return _value & ownership_bit_mask(); }
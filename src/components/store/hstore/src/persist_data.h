@@ -48,13 +48,14 @@ namespace impl
 			persist_data(
 				AK_ACTUAL
 				std::size_t n
+				, common::key_hash_t hash_algorithm
 				, const AllocatorSegment &av
 			)
 				: _ase{}
 				, _aspd{}
 				, _aspk{}
 				, _asx{}
-				, _persist_map(AK_REF n, av, &_ase, &_aspd, &_aspk, &_asx)
+				, _persist_map(AK_REF n, hash_algorithm, av, &_ase, &_aspd, &_aspk, &_asx)
 				, _persist_atomic(&_ase)
 			{
 			}
@@ -22,6 +22,7 @@
 #include "lock_state.h"
 #include "persistent.h"
 #include "perishable_expiry.h"
+#include <common/byte_span.h>
 #include <common/pointer_cast.h>
 #include <common/perf/tm.h>
 
@@ -160,9 +161,9 @@ template <typename T, typename AllocatorChar, typename PtrT, typename Cptr, type
 					, alignment_
 				);
 				new (ptr())
-					element_type(first_, last_, fill_len_, alignment_, lock_);
+					element_type(std::size_t(last_ - first_) + fill_len_, alignment_, lock_);
 				new (&al()) allocator_char_type(al_);
-				ptr()->persist_this(al_);
+				ptr()->assign_persist(first_, last_, fill_len_, al_);
 			}
 
 		void clear()
@@ -307,8 +308,8 @@ template <typename T, std::size_t SmallLimit, typename Allocator>
 						, alignment_
 					);
 					new (_outline.ptr())
-						element_type(first_, last_, fill_len_, alignment_, lock_);
-					_outline.ptr()->persist_this(al_);
+						element_type(std::size_t(last_ - first_) + fill_len_, alignment_, lock_);
+					_outline.ptr()->assign_persist(first_, last_, fill_len_, al_);
 				}
 			}
 
@@ -697,6 +698,44 @@ template <typename T, std::size_t SmallLimit, typename Allocator>
 				}
 			}
 
+		/* First half of a reconstitute which may run in parallel with others.
+		 * Restores the allocator only. Returns the outline data which must be
+		 * passed, once per distinct address, to reconstitute_element, or
+		 * nullptr if there is nothing to reconstitute.
+		 */
+		template <typename AL>
+			void *reconstitute_local(AL al_)
+			{
+				if ( is_inline() )
+				{
+					return nullptr;
+				}
+				new (&_outline.al()) allocator_char_type(al_);
+				if ( al_.pool()->can_reconstitute() )
+				{
+					return static_cast<void *>(_outline.ptr());
+				}
+				reset_lock_with_pending_retries();
+				return nullptr;
+			}
+
+		/* Second half of a reconstitute: rebuilds the outline data header for
+		 * ref_count references. Returns the extent to be injected into the allocator.
+		 */
+		static common::byte_span reconstitute_element(void *p_, unsigned ref_count_)
+		{
+			const auto e = static_cast<element_type *>(p_);
+			const auto bytes = e->alloc_element_count() * sizeof(T);
+			const auto data_size = e->size();
+			const auto alignment = e->alignment();
+			auto n = new (p_) element_type(data_size, alignment, lock_state::free);
+			for ( ; 1U < ref_count_; --ref_count_ )
+			{
+				n->inc_ref(__LINE__, "reconstitute");
+			}
+			return common::make_byte_span(p_, bytes);
+		}
+
 		bool is_inline() const
 		{
 			return _inline.is_inline();
@@ -25,7 +25,9 @@
 #include "segment_layout.h"
 #include "size_control.h"
 
+#include <common/key_hash.h>
 #include <cstddef> /* size_t */
+#include <cstdint> /* uint64_t */
 
 /* Persistent data for hstore.
  */
@@ -78,6 +80,9 @@ namespace impl
 
 			segment_count _segment_count;
 
+			/* key hash algorithm, chosen at pool creation. Never changes: it places every key. */
+			common::key_hash_t _hash_algorithm;
+
 			segment_control _sc[_segment_capacity];
 
 			/* Four types of allocation states at the moment. At most one at a time is "active" */
@@ -86,9 +91,18 @@ namespace impl
 			allocation_state_pin *_aspk;
 			allocation_state_extend *_asx;
 		public:
+			/* Version of the persistent layout of the map and its buckets, folded
+			 * into the region magic so that a pool of another layout fails to open.
+			 * Bump it with every change to the persistent layout.
+			 *   1: segment_count records the buckets moved by an incremental resize
+			 *   2: the owner word holds a key fingerprint, the neighbourhood is 55 wide
+			 *   3: _hash_algorithm, ahead of the segment controls
+			 */
+			static constexpr std::uint64_t layout_version = 3;
 			persist_map(
 				AK_ACTUAL
 				std::size_t n
+				, common::key_hash_t hash_algorithm
 				, Allocator av
 				, allocation_state_emplace *ase_
 				, allocation_state_pin *aspd_
@@ -30,7 +30,7 @@
 template <typename Allocator>
 	impl::persist_map<Allocator>::persist_map(
 		AK_ACTUAL
-		std::size_t n, Allocator av_
+		std::size_t n, common::key_hash_t hash_algorithm_, Allocator av_
 		, allocation_state_emplace *ase_
 		, allocation_state_pin *aspd_
 		, allocation_state_pin *aspk_
@@ -43,6 +43,7 @@ template <typename Allocator>
 			 */
 			((n*3U)/base_segment_size == 0 ? 1U : segment_layout::log2((3U * n)/base_segment_size))
 		)
+		, _hash_algorithm(hash_algorithm_)
 		, _sc{}
 		, _ase{ase_}
 		, _aspd{aspd_}
@@ -84,6 +84,10 @@ namespace impl
 			using bucket_allocator_t = typename persist_data_t::bucket_allocator_t;
 			persist_data_t *_persist;
 			std::size_t _bucket_count_cached;
+			/* A group commit is open: the size stays unstable (so that a restart
+			 * recounts) and size changes are not persisted one by one.
+			 */
+			bool _size_group;
 
 			void persist_segment_table(); /* Flush the bucket pointers (*_b) */
 			void persist_internal(
@@ -91,9 +95,13 @@ namespace impl
 				, const void *last
 				, const char *what
 			);
+			/* While a resize is moving content (segment count unstable) the
+			 * junior segment is part of the table.
+			 */
 			auto bucket_count_uncached() -> size_type
 			{
-				return base_segment_size << (segment_count_actual().value_not_stable() - 1U);
+				const auto sc = segment_count_actual();
+				return base_segment_size << (sc.value_not_stable() - ( sc.is_stable() ? 1U : 0U ));
 			}
 
 		public:
@@ -111,10 +119,25 @@ namespace impl
 			auto resize_restart_prolog() -> bucket_aligned_t *;
 			void resize_interlog();
 			void resize_epilog();
+			/* Count of senior buckets whose content has been moved, valid while
+			 * the segment count is unstable.
+			 */
+			auto resize_moved() const -> bix_t
+			{
+				return _persist->_segment_count.moved();
+			}
+			void resize_moved_set(bix_t n);
 
 			void size_stabilize();
 			void size_destabilize();
 
+			/* Open and close a group commit, which defers the size persists of
+			 * the inserts and erases within the group to its end.
+			 */
+			void group_commit_begin();
+			void group_commit_end();
+			bool in_group_commit() const { return _size_group; }
+
 			void persist_owner(
 				const owner &b
 				, const char *what = "bucket_owner"
@@ -125,8 +148,12 @@ namespace impl
 			);
 			void persist_segment_count(); /* Flush the bucket pointer count (_count) */
 			void persist_size();
-			void persist_existing_segments(const char *what = "old segments");
-			void persist_new_segment(const char *what = "new segments");
+			/* Flush buckets [first, last) of the segment being added by resize */
+			void persist_new_segment(
+				bix_t first
+				, bix_t last
+				, const char *what = "new segment"
+			);
 			void em_record_owner_addr_and_bitmask(
 				persistent_atomic_t<owner::value_type> *pmask_
 				, owner::value_type mask_
@@ -181,6 +208,11 @@ namespace impl
 				return _persist->_segment_count.specified();
 			}
 
+			common::key_hash_t hash_algorithm() const
+			{
+				return _persist->_hash_algorithm;
+			}
+
 			auto size_unstable() const /* debugging only */
 			{
 				return _persist->_size_control.value_not_stable();
@@ -188,7 +220,12 @@ namespace impl
 
 			std::size_t size() const
 			{
-				return _persist->_size_control.value();
+				/* Within a group commit the value is current, but not stable */
+				return
+					_size_group
+					? _persist->_size_control.value_not_stable()
+					: _persist->_size_control.value()
+					;
 			}
 
 			size_control &get_size_control()
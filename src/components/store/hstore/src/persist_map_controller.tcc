@@ -43,6 +43,7 @@ template <typename Allocator>
 		: Allocator(av_)
 		, _persist(persist_)
 		, _bucket_count_cached(bucket_count_uncached())
+		, _size_group(false)
 	{
 		assert(_persist->_segment_count.specified() <= _segment_capacity);
 		assert(1U <= _persist->_segment_count.specified());
@@ -107,25 +108,11 @@ template <typename Allocator>
 	}
 
 template <typename Allocator>
-	void impl::persist_map_controller<Allocator>::persist_existing_segments(const char *)
-	{
-/* This persist goes through pmemobj address translation to find the addresses.
- * That is unecessary, as the virtual addresses are kept (in a separate table).
- */
-		auto sc = &*_persist->_sc;
-		{
-			auto bp = &*sc[0].bp;
-			persist_internal(&bp[0], &bp[base_segment_size], "segment 0");
-		}
-		for ( segment_layout::six_t i = 1U; i != segment_count_actual().value_not_stable(); ++i )
-		{
-			auto bp = &*sc[i].bp;
-			persist_internal(&bp[0], &bp[base_segment_size<<(i-1U)], "segment N");
-		}
-	}
-
-template <typename Allocator>
-	void impl::persist_map_controller<Allocator>::persist_new_segment(const char *)
+	void impl::persist_map_controller<Allocator>::persist_new_segment(
+		bix_t first_
+		, bix_t last_
+		, const char *what_
+	)
 	{
 /* This persist goes through pmemobj address translation to find the addresses.
  * That is unnecessary, as the virtual addresses are kept (in a separate table).
@@ -133,11 +120,8 @@ template <typename Allocator>
 		auto sc = &*_persist->_sc;
 		auto ct = segment_count_actual().value_not_stable();
 		auto bp = &*sc[ct].bp;
-		persist_internal(
-			&bp[0]
-			, &bp[base_segment_size<<(ct-1U)]
-			, "segment new"
-		);
+		assert(last_ <= (base_segment_size<<(ct-1U)));
+		persist_internal(&bp[first_], &bp[last_], what_);
 	}
 
 template <typename Allocator>
@@ -177,14 +161,37 @@ template <typename Allocator>
 	void impl::persist_map_controller<Allocator>::size_destabilize()
 	{
 		_persist->_size_control.destabilize();
-		persist_size();
+		if ( ! _size_group )
+		{
+			persist_size();
+		}
 	}
 
 template <typename Allocator>
 	void impl::persist_map_controller<Allocator>::size_stabilize()
 	{
 		_persist->_size_control.stabilize();
-		persist_size();
+		if ( ! _size_group )
+		{
+			persist_size();
+		}
+	}
+
+template <typename Allocator>
+	void impl::persist_map_controller<Allocator>::group_commit_begin()
+	{
+		assert( ! _size_group );
+		/* Any image of the size persisted during the group is unstable */
+		size_destabilize();
+		_size_group = true;
+	}
+
+template <typename Allocator>
+	void impl::persist_map_controller<Allocator>::group_commit_end()
+	{
+		assert( _size_group );
+		_size_group = false;
+		size_stabilize();
 	}
 
 template <typename Allocator>
@@ -206,7 +213,7 @@ template <typename Allocator>
 			);
 		}
 
-		new (&*ptr) typename persist_data_t::bucket_aligned_t[bucket_count()];
+		/* The junior buckets are constructed, a few at a time, by the caller */
 		_persist->_sc[_persist->_segment_count.actual().value()].bp = ptr;
 		auto sc = &*_persist->_sc;
 		return &*(sc[segment_count_actual().value()].bp);
@@ -229,8 +236,18 @@ template <typename Allocator>
 	void impl::persist_map_controller<Allocator>::resize_interlog()
 	{
 		persist_segment_table();
+		_persist->_segment_count.moved_set(0U);
+		persist_segment_count();
 		_persist->_segment_count.actual_destabilize();
 		persist_segment_count();
+		_bucket_count_cached = bucket_count_uncached();
+	}
+
+template <typename Allocator>
+	void impl::persist_map_controller<Allocator>::resize_moved_set(bix_t n_)
+	{
+		_persist->_segment_count.moved_set(n_);
+		persist_segment_count();
 	}
 
 template <typename Allocator>
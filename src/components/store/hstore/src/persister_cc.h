@@ -16,12 +16,14 @@
 #define MCAS_HSTORE_PERSISTER_H
 
 #include <cstddef> /* size_t */
+#include <cstring> /* memcpy */
 
 /* default "persister" for persistent memory: a no-op.
  */
 struct persister
 {
   void persist(const void *, std::size_t) {}
+  static void memcpy_persist(void *dst, const void *src, std::size_t sz) { std::memcpy(dst, src, sz); }
 };
 
 #endif
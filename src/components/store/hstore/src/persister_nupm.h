@@ -23,6 +23,7 @@
 #include <libpmem.h>
 #pragma GCC diagnostic pop
 
+#include <nupm/memcpy_persist.h>
 #include <cstddef>
 
 struct persister_nupm
@@ -31,6 +32,12 @@ struct persister_nupm
 	{
 		pmem_persist(a,sz);
 	}
+
+	/* copy to and persist; non-temporal above nupm's size threshold */
+	static void memcpy_persist(void *dst, const void *src, std::size_t sz)
+	{
+		nupm::memcpy_persist(dst, src, sz);
+	}
 };
 
 #endif
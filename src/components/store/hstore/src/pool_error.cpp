@@ -29,6 +29,8 @@ std::string pool_category::message( int condition ) const noexcept
 		return "region-backed pool failure (General_exception)";
 	case int(pool_ec::region_fail_api_exception):
 		return "region-backed pool failure (API_exception)";
+	case int(pool_ec::region_layout_mismatch):
+		return "region-backed pool failure (type or layout mismatch)";
 	default:
 		return "unknown pool failure";
 	}
@@ -26,6 +26,7 @@ enum class pool_ec
   region_fail,
   region_fail_general_exception,
   region_fail_api_exception,
+  region_layout_mismatch,
 };
 
 struct pool_category
@@ -15,17 +15,40 @@
 #define _MCAS_PSTR_HASH_H_
 
 #include <city.h>
+#include <common/key_hash.h>
+#include <common/string_view.h>
 #include <cstdint>
 #include <string>
 
+/* The algorithm is fixed when the pool is created, and is kept in the
+ * persist_map: the position of every key in the table depends on it.
+ */
 template <typename Key>
   struct pstr_hash
   {
     using argument_type = Key;
     using result_type = std::uint64_t;
-    static result_type hf(const argument_type &s)
+  private:
+    common::key_hash_t _algorithm;
+    result_type hf(const void *p, std::size_t n) const
     {
-      return CityHash64(s.data(), s.size());
+      switch ( _algorithm )
+      {
+      case common::key_hash_t::KEY_HASH_WY:
+        return common::wyhash64(p, n);
+      case common::key_hash_t::KEY_HASH_CRC32C:
+        return common::crc32c_hash64(p, n);
+      default:
+        return CityHash64(static_cast<const char *>(p), n);
+      }
+    }
+  public:
+    explicit pstr_hash(common::key_hash_t algorithm_ = common::key_hash_t::KEY_HASH_CITY)
+      : _algorithm(algorithm_)
+    {}
+    result_type hf(const argument_type &s) const
+    {
+      return hf(s.data(), s.size());
     }
     /* Note: pstr_hash knows how to hash a std::string
      * even when it is not specialized for a string.
@@ -33,10 +56,16 @@ template <typename Key>
      * if it is to compute a hash on a string?
      * Where do we require this special case?
      */
-    static result_type hf(const std::string &s)
+    result_type hf(const std::string &s) const
+    {
+      return hf(s.data(), s.size());
+    }
+    /* ... and a key presented as a view, without a copy */
+    result_type hf(common::string_view s) const
     {
-      return CityHash64(s.data(), s.size());
+      return hf(s.data(), s.size());
     }
+    common::key_hash_t algorithm() const { return _algorithm; }
   };
 
 #endif
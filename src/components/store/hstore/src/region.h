@@ -44,7 +44,8 @@ template <
   {
     using heap_access_t = heap_access<Heap>;
   private:
-    static constexpr std::uint64_t magic_value = Heap::magic_value(); // 0xc74892d72eed493a;
+    /* the heap type and the persist_map layout version both distinguish the region */
+    static constexpr std::uint64_t magic_value = Heap::magic_value() ^ PersistData::pm_type::layout_version; // 0xc74892d72eed493a;
     using byte_span = common::byte_span;
     using string_view = common::string_view;
   public:
@@ -81,6 +82,7 @@ template <
       , std::uint64_t uuid_
       , std::size_t size_
       , std::size_t expected_obj_count
+      , common::key_hash_t hash_algorithm_
       , unsigned numa_node_
       , string_view id_
       , string_view backing_file_
@@ -105,6 +107,7 @@ template <
       , _persist_data(
         AK_REF
         expected_obj_count
+        , hash_algorithm_
         , typename persist_data_type::allocator_type(make_heap_access())
     )
     {
@@ -173,6 +176,14 @@ template <
       return sz_ - sizeof *this;
     }
 
+    /* True if the memory at base_ holds a region of this type and layout.
+     * Checked before the "reanimate" constructor, which overwrites magic.
+     */
+    static bool is_region_at(const void *base_) noexcept
+    {
+      return static_cast<const region *>(base_)->magic == magic_value;
+    }
+
     heap_access_t make_heap_access() { return heap_access_t(&_heap); }
     persist_data_type &persist_data() { return _persist_data; }
     bool is_initialized() const noexcept { return magic == magic_value; }
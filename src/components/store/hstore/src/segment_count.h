@@ -35,16 +35,21 @@ namespace impl
 		segment_count_actual_t _actual;
 		/* desired segment count */
 		persistent_atomic_t<segment_layout::six_t> _specified;
+		/* while actual is unstable, the number of senior buckets already moved */
+		persistent_atomic_t<segment_layout::bix_t> _moved;
 	public:
 		segment_count(segment_layout::six_t specified_)
 			: _actual(0)
 			, _specified(specified_)
+			, _moved(0)
 		{}
 		segment_count_actual_t actual() const { return _actual; }
 		auto specified() const { return _specified; }
 		void actual_destabilize() { _actual.destabilize(); }
 		void actual_incr() { _actual.incr(); }
 		void actual_value_set_stable(segment_layout::six_t v) { _actual.value_set_stable(v); }
+		segment_layout::bix_t moved() const { return _moved; }
+		void moved_set(segment_layout::bix_t v) { _moved = v; }
 	};
 }
 
@@ -25,6 +25,8 @@
 
 #include <common/string_view.h>
 #include <common/time.h> /* tsc_time_t, epoch_time_t */
+#include <gsl/span>
+#include <sys/uio.h> /* iovec */
 #include <cstddef>
 #include <cstdint>
 #include <functional>
@@ -126,7 +128,7 @@ template <typename Handle, typename Allocator, typename Table, typename LockType
 		auto insert(
 			AK_FORMAL
 			TM_FORMAL
-			const std::string & key,
+			const string_view key,
 			const void * value,
 			const std::size_t value_len
 		) -> std::pair<typename table_type::iterator, bool>;
@@ -134,7 +136,7 @@ template <typename Handle, typename Allocator, typename Table, typename LockType
 		void update_by_issue_41(
 			AK_FORMAL
 			TM_FORMAL
-			const std::string & key,
+			const string_view key,
 			const void * value,
 			const std::size_t value_len,
 			void * /* old_value */,
@@ -143,22 +145,40 @@ template <typename Handle, typename Allocator, typename Table, typename LockType
 
 		auto get(
 			TM_FORMAL
-			const std::string & key,
+			const string_view key,
 			void* buffer,
 			std::size_t buffer_size
 		) const -> std::size_t;
 
 		auto get_alloc(
-			const std::string & key
+			const string_view key
 		) const -> std::tuple<void *, std::size_t>;
 
+		/* keys handled together by multi_get, and by the multi_put and
+		 * multi_lock loops in hstore
+		 */
+		static constexpr std::size_t multi_group_size = 16;
+
+		/* get for each key. The lookups of a group of keys are interleaved
+		 * (see hop_hash find_n), and then the fetches of their values.
+		 */
+		void multi_get(
+			TM_FORMAL
+			gsl::span<const component::IKVStore::string_view_key> keys
+			, gsl::span<::iovec> inout_values
+			, gsl::span<status_t> out_status
+		) const;
+
+		/* Start fetching the table entry for key, ahead of a put or lock */
+		void prefetch(const string_view key) const;
+
 		auto get_value_len(
-			const std::string & key
+			const string_view key
 		) const -> std::size_t;
 
 #if ENABLE_TIMESTAMPS
 		auto get_write_epoch_time(
-			const std::string & key
+			const string_view key
 		) const -> std::size_t;
 #endif
 
@@ -170,7 +190,7 @@ template <typename Handle, typename Allocator, typename Table, typename LockType
 		void resize_mapped(
 			AK_FORMAL
 			TM_FORMAL
-			const std::string & key
+			const string_view key
 			, std::size_t new_mapped_len
 			, std::size_t alignment
 		);
@@ -178,7 +198,7 @@ template <typename Handle, typename Allocator, typename Table, typename LockType
 		auto lock(
 			AK_FORMAL
 			TM_FORMAL
-			const std::string & key
+			const string_view key
 			, lock_type type
 			, void *value
 			, std::size_t value_len
@@ -197,7 +217,7 @@ template <typename Handle, typename Allocator, typename Table, typename LockType
 
 		auto erase(
 			TM_FORMAL
-			const std::string & key
+			const string_view key
 		) -> status_t;
 
 		auto count() const -> std::size_t;
@@ -226,6 +246,34 @@ template <typename Handle, typename Allocator, typename Table, typename LockType
 			, common::epoch_time_t t_end
 		) -> status_t;
 
+		auto map_partition(
+			unsigned partition
+			, unsigned partition_count
+			, component::IKVStore::map_cursor_t &cursor
+			, std::size_t max_objects
+			, std::function
+			<
+				int(const void * key, std::size_t key_len,
+				const void * val, std::size_t val_len)
+			> function_
+		) const -> status_t;
+
+		auto map_parallel(
+			unsigned partition_count
+			, std::function
+			<
+				int(unsigned partition
+				, const void * key, std::size_t key_len
+				, const void * val, std::size_t val_len)
+			> function_
+			, std::function<void(unsigned partition)> merge_
+			, bool ordered
+			, component::IKVStore::executor_t executor
+		) const -> status_t;
+
+		auto group_commit_begin() -> status_t;
+		auto group_commit_end() -> status_t;
+
 		template <typename IT> /* *IT shall be a const component::IKVStore::Operation *const */
 			void atomic_update_inner(
 				AK_FORMAL
@@ -241,7 +289,7 @@ template <typename Handle, typename Allocator, typename Table, typename LockType
 			void atomic_update(
 				AK_FORMAL
 				TM_FORMAL
-				const std::string & key
+				const string_view key
 				, IT first
 				, IT last
 			);
@@ -250,7 +298,7 @@ template <typename Handle, typename Allocator, typename Table, typename LockType
 			void lock_and_atomic_update(
 				AK_FORMAL
 				TM_FORMAL
-				const std::string & key
+				const string_view key
 				, IT first
 				, IT last
 		);
@@ -276,8 +324,8 @@ template <typename Handle, typename Allocator, typename Table, typename LockType
 		auto swap_keys(
 			AK_FORMAL
 			TM_FORMAL
-			const std::string & key0
-			, const std::string & key1
+			const string_view key0
+			, const string_view key1
 		) -> status_t;
 
 		auto open_iterator() -> component::IKVStore::pool_iterator_t;
@@ -22,15 +22,23 @@
 #include "monitor_emplace.h"
 #include "monitor_pin.h"
 #include <common/perf/tm.h>
+#include <common/pointer_cast.h>
 
 #include <algorithm> /* min, max, transform */
+#include <array>
+#include <atomic>
+#include <condition_variable>
 #include <cstddef> /* size_t */
 #include <cstdlib> /* getenv */
 #include <cstring> /* memcpy */
+#include <exception> /* exception_ptr */
 #include <limits> /* numeric_limits */
 #include <memory> /* make_shared */
+#include <mutex>
 #include <new> /* bad_alloc */
 #include <stdexcept> /* bad_alloc, domain_error, out_of_range, range_error */
+#include <system_error>
+#include <thread>
 #include <type_traits> /* remove_const */
 #include <tuple>
 #include <vector>
@@ -93,6 +101,10 @@ template <typename Handle, typename Allocator, typename Table, typename LockType
 template <typename Handle, typename Allocator, typename Table, typename LockType>
 	session<Handle, Allocator, Table, LockType>::~session()
 	{
+		if ( _map.in_group_commit() )
+		{
+			_map.group_commit_end();
+		}
 #if ! HEAP_OID
 		this->pool()->quiesce();
 #endif
@@ -212,7 +224,7 @@ template <typename Handle, typename Allocator, typename Table, typename LockType
 	auto session<Handle, Allocator, Table, LockType>::insert(
 		AK_ACTUAL
 		TM_ACTUAL
-		const std::string & key,
+		const string_view key,
 		const void * value,
 		const std::size_t value_len
 	) -> std::pair<typename table_type::iterator, bool>
@@ -253,7 +265,7 @@ template <typename Handle, typename Allocator, typename Table, typename LockType
 	void session<Handle, Allocator, Table, LockType>::update_by_issue_41(
 		AK_ACTUAL
 		TM_ACTUAL
-		const std::string & key,
+		const string_view key,
 		const void * value,
 		const std::size_t value_len,
 		void * /* old_value */,
@@ -294,7 +306,7 @@ template <typename Handle, typename Allocator, typename Table, typename LockType
 template <typename Handle, typename Allocator, typename Table, typename LockType>
 	auto session<Handle, Allocator, Table, LockType>::get(
 		TM_ACTUAL
-		const std::string & key,
+		const string_view key,
 		void* buffer,
 		std::size_t buffer_size
 	) const -> std::size_t
@@ -313,7 +325,7 @@ template <typename Handle, typename Allocator, typename Table, typename LockType
 
 template <typename Handle, typename Allocator, typename Table, typename LockType>
 	auto session<Handle, Allocator, Table, LockType>::get_alloc(
-		const std::string & key
+		const string_view key
 	) const -> std::tuple<void *, std::size_t>
 	{
 		TM_ROOT()
@@ -331,9 +343,82 @@ template <typename Handle, typename Allocator, typename Table, typename LockType
 		return std::pair<void *, std::size_t>(value, value_len);
 	}
 
+template <typename Handle, typename Allocator, typename Table, typename LockType>
+	void session<Handle, Allocator, Table, LockType>::multi_get(
+		TM_ACTUAL
+		const gsl::span<const component::IKVStore::string_view_key> keys_
+		, const gsl::span<::iovec> inout_values_
+		, const gsl::span<status_t> out_status_
+	) const
+	{
+		TM_SCOPE()
+		const auto count = std::size_t(keys_.size());
+		std::array<string_view, multi_group_size> k;
+		std::array<const mapped_type *, multi_group_size> m;
+		for ( std::size_t i = 0; i < count; i += k.size() )
+		{
+			const auto n = std::min(k.size(), count - i);
+			auto kk = keys_.begin() + std::ptrdiff_t(i);
+			for ( std::size_t j = 0; j != n; ++j, ++kk )
+			{
+				k[j] = string_view(common::pointer_cast<char>(kk->data()), kk->size());
+			}
+			/* all keys of the group are in one map (see locate_map) */
+			auto & map = locate_map(k[0]);
+			auto mi = m.begin();
+			map.find_n(
+				TM_REF k.begin(), k.begin() + std::ptrdiff_t(n)
+				, [&mi, &map] (const typename table_type::const_iterator &f) { *mi++ = f == map.end() ? nullptr : &f->second; }
+			);
+
+			/* Values may be out of line: start fetching all of them before copying any */
+			for ( std::size_t j = 0; j != n; ++j )
+			{
+				if ( m[j] )
+				{
+					__builtin_prefetch(std::get<0>(*m[j]).data());
+				}
+			}
+
+			auto v = inout_values_.begin() + std::ptrdiff_t(i);
+			auto s = out_status_.begin() + std::ptrdiff_t(i);
+			for ( std::size_t j = 0; j != n; ++j, ++v, ++s )
+			{
+				if ( ! m[j] )
+				{
+					*s = component::IKVStore::E_KEY_NOT_FOUND;
+				}
+				else
+				{
+					/* as hstore::get_direct */
+					const auto &d = std::get<0>(*m[j]);
+					const auto buffer_size = v->iov_len;
+					v->iov_len = d.size();
+					if ( d.size() <= buffer_size )
+					{
+						std::memcpy(v->iov_base, d.data(), d.size());
+						*s = S_OK;
+					}
+					else
+					{
+						*s = E_INSUFFICIENT_BUFFER;
+					}
+				}
+			}
+		}
+	}
+
+template <typename Handle, typename Allocator, typename Table, typename LockType>
+	void session<Handle, Allocator, Table, LockType>::prefetch(
+		const string_view key
+	) const
+	{
+		locate_map(key).prefetch(key);
+	}
+
 template <typename Handle, typename Allocator, typename Table, typename LockType>
 	auto session<Handle, Allocator, Table, LockType>::get_value_len(
-		const std::string & key
+		const string_view key
 	) const -> std::size_t
 	{
 		TM_ROOT()
@@ -345,7 +430,7 @@ template <typename Handle, typename Allocator, typename Table, typename LockType
 #if ENABLE_TIMESTAMPS
 template <typename Handle, typename Allocator, typename Table, typename LockType>
 	auto session<Handle, Allocator, Table, LockType>::get_write_epoch_time(
-		const std::string & key
+		const string_view key
 	) const -> std::size_t
 	{
 		TM_ROOT()
@@ -370,7 +455,7 @@ template <typename Handle, typename Allocator, typename Table, typename LockType
 	void session<Handle, Allocator, Table, LockType>::resize_mapped(
 		AK_ACTUAL
 		TM_ACTUAL
-		const std::string & key
+		const string_view key
 		, std::size_t new_mapped_len
 		, std::size_t alignment_
 	)
@@ -407,7 +492,7 @@ template <typename Handle, typename Allocator, typename Table, typename LockType
 	auto session<Handle, Allocator, Table, LockType>::lock(
 		AK_ACTUAL
 		TM_ACTUAL
-		const std::string & key
+		const string_view key
 		, lock_type type
 		, void *const value
 		, const std::size_t value_len
@@ -587,7 +672,7 @@ template <typename Handle, typename Allocator, typename Table, typename LockType
 template <typename Handle, typename Allocator, typename Table, typename LockType>
 	auto session<Handle, Allocator, Table, LockType>::erase(
 		TM_ACTUAL
-		const std::string & key
+		const string_view key
 	) -> status_t
 	{
 		TM_SCOPE()
@@ -728,6 +813,219 @@ template <typename Handle, typename Allocator, typename Table, typename LockType
 #endif
 	}
 
+/* Partitions are contiguous ranges of owner buckets, so that a partition
+ * is a few segment ranges and the content of an owner is visited once.
+ */
+template <typename Handle, typename Allocator, typename Table, typename LockType>
+	auto session<Handle, Allocator, Table, LockType>::map_partition(
+		const unsigned partition_
+		, const unsigned partition_count_
+		, component::IKVStore::map_cursor_t &cursor_
+		, const std::size_t max_objects_
+		, std::function
+		<
+			int(const void * key, std::size_t key_len,
+			const void * val, std::size_t val_len)
+		> function_
+	) const -> status_t
+	{
+		if ( partition_count_ <= partition_ )
+		{
+			return E_INVAL;
+		}
+		const string_view key{};
+		auto & map = locate_map(key);
+		const std::size_t bucket_count = map.bucket_count();
+		const auto first = bucket_count * partition_ / partition_count_;
+		const auto last = bucket_count * (partition_ + 1U) / partition_count_;
+
+		if ( ! cursor_.started )
+		{
+			cursor_.started = true;
+			cursor_.position = first;
+			cursor_.mark = map.layout_changes();
+		}
+		else if ( cursor_.mark != map.layout_changes() )
+		{
+			return E_ITERATOR_DISTURBED;
+		}
+		else if ( cursor_.position < first || last < cursor_.position )
+		{
+			return E_INVAL;
+		}
+
+		std::size_t visited = 0;
+		bool aborted = false;
+		cursor_.position =
+			map.for_each_owned(
+				cursor_.position
+				, last
+				, [&function_, &visited, &aborted, max_objects_] (const typename table_type::value_type &mt) -> bool
+				{
+					const auto &pstring = mt.first;
+					const auto &d = std::get<0>(mt.second);
+					aborted = function_(pstring.data(), pstring.size(), d.data(), d.size()) < 0 || aborted;
+					return ++visited < max_objects_ && ! aborted;
+				}
+			);
+
+		if ( aborted )
+		{
+			cursor_.position = last;
+		}
+		return cursor_.position == last ? S_OK : status_t(component::IKVStore::S_MORE);
+	}
+
+template <typename Handle, typename Allocator, typename Table, typename LockType>
+	auto session<Handle, Allocator, Table, LockType>::map_parallel(
+		const unsigned partition_count_
+		, std::function
+		<
+			int(unsigned partition
+			, const void * key, std::size_t key_len
+			, const void * val, std::size_t val_len)
+		> function_
+		, std::function<void(unsigned partition)> merge_
+		, const bool ordered_
+		, component::IKVStore::executor_t executor_
+	) const -> status_t
+	{
+		if ( partition_count_ == 0 )
+		{
+			return E_INVAL;
+		}
+		const string_view key{};
+		auto & map = locate_map(key);
+		const std::size_t bucket_count = map.bucket_count();
+
+		std::atomic<bool> aborted{false};
+		std::mutex m;
+		std::condition_variable cv;
+		/* partitions in order of completion, and the first exception */
+		std::vector<unsigned> done;
+		std::vector<bool> is_done(partition_count_);
+		std::exception_ptr error;
+
+		auto run =
+			[&] (const unsigned p) -> void
+			{
+				try
+				{
+					map.for_each_owned(
+						bucket_count * p / partition_count_
+						, bucket_count * (p + 1U) / partition_count_
+						, [&function_, &aborted, p] (const typename table_type::value_type &mt) -> bool
+						{
+							const auto &pstring = mt.first;
+							const auto &d = std::get<0>(mt.second);
+							if ( function_(p, pstring.data(), pstring.size(), d.data(), d.size()) < 0 )
+							{
+								aborted.store(true, std::memory_order_relaxed);
+							}
+							return ! aborted.load(std::memory_order_relaxed);
+						}
+					);
+				}
+				catch ( ... )
+				{
+					aborted = true;
+					std::lock_guard<std::mutex> g(m);
+					if ( ! error ) { error = std::current_exception(); }
+				}
+				{
+					std::lock_guard<std::mutex> g(m);
+					done.push_back(p);
+					is_done[p] = true;
+				}
+				cv.notify_one();
+			};
+
+		std::vector<std::thread> threads;
+		if ( executor_ )
+		{
+			for ( unsigned p = 0; p != partition_count_; ++p )
+			{
+				executor_([&run, p] { run(p); });
+			}
+		}
+		else
+		{
+			threads.reserve(partition_count_ - 1U);
+			for ( unsigned p = 1; p != partition_count_; ++p )
+			{
+				try
+				{
+					threads.emplace_back(run, p);
+				}
+				catch ( const std::system_error & )
+				{
+					run(p); /* no thread to spare: map the partition here */
+				}
+			}
+			run(0);
+		}
+
+		/* merge on this thread, as partitions complete */
+		{
+			std::unique_lock<std::mutex> lk(m);
+			for ( unsigned merged = 0; merged != partition_count_; ++merged )
+			{
+				cv.wait(lk, [&] { return ordered_ ? bool(is_done[merged]) : merged < done.size(); });
+				const auto p = ordered_ ? merged : done[merged];
+				const bool skip = bool(error);
+				lk.unlock();
+				try
+				{
+					if ( merge_ && ! skip ) { merge_(p); }
+				}
+				catch ( ... )
+				{
+					aborted = true;
+					lk.lock();
+					if ( ! error ) { error = std::current_exception(); }
+					lk.unlock();
+				}
+				lk.lock();
+			}
+		}
+
+		for ( auto &t : threads )
+		{
+			t.join();
+		}
+		if ( error )
+		{
+			std::rethrow_exception(error);
+		}
+		return S_OK;
+	}
+
+/* Within a group commit, inserts and erases leave the (persisted) table
+ * size unstable, saving two persists each; the group end persists it once.
+ * A restart within the group recounts the size.
+ */
+template <typename Handle, typename Allocator, typename Table, typename LockType>
+	auto session<Handle, Allocator, Table, LockType>::group_commit_begin() -> status_t
+	{
+		if ( _map.in_group_commit() )
+		{
+			return E_BUSY;
+		}
+		_map.group_commit_begin();
+		return S_OK;
+	}
+
+template <typename Handle, typename Allocator, typename Table, typename LockType>
+	auto session<Handle, Allocator, Table, LockType>::group_commit_end() -> status_t
+	{
+		if ( ! _map.in_group_commit() )
+		{
+			return E_INVAL;
+		}
+		_map.group_commit_end();
+		return S_OK;
+	}
+
 template <typename Handle, typename Allocator, typename Table, typename LockType>
 	template <typename IT>
 		void session<Handle, Allocator, Table, LockType>::atomic_update_inner(
@@ -748,7 +1046,7 @@ template <typename Handle, typename Allocator, typename Table, typename LockType
 		void session<Handle, Allocator, Table, LockType>::atomic_update(
 			AK_ACTUAL
 			TM_ACTUAL
-			const std::string& key
+			const string_view key
 			, IT first
 			, IT last
 		)
@@ -762,7 +1060,7 @@ template <typename Handle, typename Allocator, typename Table, typename LockType
 		void session<Handle, Allocator, Table, LockType>::lock_and_atomic_update(
 			AK_ACTUAL
 			TM_ACTUAL
-			const std::string& key
+			const string_view key
 			, IT first
 			, IT last
 		)
@@ -824,8 +1122,8 @@ template <typename Handle, typename Allocator, typename Table, typename LockType
 	auto session<Handle, Allocator, Table, LockType>::swap_keys(
 		AK_ACTUAL
 		TM_ACTUAL
-		const std::string & key0
-		, const std::string & key1
+		const string_view key0
+		, const string_view key1
 	) -> status_t
 	try
 	{
@@ -0,0 +1,86 @@
+/*
+   Copyright [2021] [IBM Corporation]
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+       http://www.apache.org/licenses/LICENSE-2.0
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#ifndef _MCAS_HSTORE_VERSIONED_SHARED_MUTEX_H
+#define _MCAS_HSTORE_VERSIONED_SHARED_MUTEX_H
+
+#include <atomic>
+
+namespace impl
+{
+	/*
+	 * A shared mutex with a sequence count, for optimistic readers.
+	 * Each exclusive lock and unlock advances the count, so it is odd
+	 * while a writer holds the mutex. A reader which sees the same even
+	 * count before and after its reads saw no concurrent write.
+	 *
+	 * Only the exclusive holder writes the count, so the increments need
+	 * not be atomic read-modify-writes.
+	 */
+	template <typename SharedMutex>
+		struct versioned_shared_mutex
+			: public SharedMutex
+		{
+			using version_type = unsigned;
+		private:
+			std::atomic<version_type> _version;
+			void advance(std::memory_order o_)
+			{
+				_version.store(_version.load(std::memory_order_relaxed) + 1U, o_);
+			}
+		public:
+			versioned_shared_mutex()
+				: SharedMutex{}
+				, _version(0)
+			{}
+			/* BasicLockable */
+			void lock()
+			{
+				SharedMutex::lock();
+				advance(std::memory_order_relaxed);
+				/* the odd count precedes the writer's stores */
+				std::atomic_thread_fence(std::memory_order_release);
+			}
+			void unlock()
+			{
+				advance(std::memory_order_release);
+				SharedMutex::unlock();
+			}
+			/* Lockable */
+			bool try_lock()
+			{
+				if ( SharedMutex::try_lock() )
+				{
+					advance(std::memory_order_relaxed);
+					std::atomic_thread_fence(std::memory_order_release);
+					return true;
+				}
+				return false;
+			}
+			/* SharedMutex functions are inherited: shared holders do not write */
+
+			/* Begin an optimistic read */
+			version_type read_begin() const
+			{
+				return _version.load(std::memory_order_acquire);
+			}
+			/* true iff no writer held or took the mutex since read_begin returned v_ */
+			bool read_validate(version_type v_) const
+			{
+				std::atomic_thread_fence(std::memory_order_acquire);
+				return (v_ & 1U) == 0 && _version.load(std::memory_order_relaxed) == v_;
+			}
+		};
+}
+
+#endif
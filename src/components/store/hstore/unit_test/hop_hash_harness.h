@@ -0,0 +1,149 @@
+/*
+   Copyright [2017-2021] [IBM Corporation]
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+       http://www.apache.org/licenses/LICENSE-2.0
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#ifndef MCAS_HSTORE_HOP_HASH_HARNESS_H
+#define MCAS_HSTORE_HOP_HASH_HARNESS_H
+
+/*
+ * A hop_hash on DRAM, for tests of the table itself: the allocator is
+ * malloc, persists are counted but do nothing, and keys and values are
+ * fixed-size types with no out-of-line storage.
+ */
+
+#include "hstore_config.h"
+#include "persist_map.h"
+#include "as_emplace.h"
+#include "as_pin.h"
+#include "as_extend.h"
+#include "hop_hash.h"
+#include "pstr_hash.h"
+#include "pstr_equal.h"
+#include "perishable.h"
+
+#include <common/byte_span.h>
+#include <cstdint>
+#include <cstdlib> /* malloc, posix_memalign */
+#include <cstring> /* memcpy */
+#include <new> /* bad_alloc */
+#include <string>
+#include <tuple>
+#include <utility> /* pair */
+#include <vector>
+
+namespace harness
+{
+	struct pool_type
+	{
+		bool _reconstitute = false;
+		bool is_crash_consistent() const { return false; }
+		bool can_reconstitute() const { return _reconstitute; }
+	};
+
+	inline pool_type &the_pool() { static pool_type p; return p; }
+
+	template <typename T>
+		struct allocator
+		{
+			using value_type = T;
+			using pointer = T *;
+			using const_pointer = const T *;
+			using pointer_type = T *;
+			template <typename U>
+				struct rebind { using other = allocator<U>; };
+			allocator() {}
+			template <typename U>
+				allocator(const allocator<U> &) {}
+			void persist(const void *, std::size_t) const {}
+			const pool_type *pool() const { return &the_pool(); }
+			void allocate(persistent_t<T *> &p, std::size_t n, std::size_t align)
+			{
+				void *v = nullptr;
+				if ( ::posix_memalign(&v, align < alignof(void *) ? alignof(void *) : align, n * sizeof(T)) != 0 )
+				{
+					throw std::bad_alloc();
+				}
+				p = static_cast<T *>(v);
+			}
+			T *allocate(std::size_t n) { return static_cast<T *>(std::malloc(n * sizeof(T))); }
+			void deallocate(T *p, std::size_t) { std::free(p); }
+			void extend_arm() {}
+			void extend_disarm() {}
+			void emplace_disarm() {}
+			void reconstitute(std::size_t, T *) {}
+			void reconstitute_batch(std::vector<common::byte_span> &&, bool) {}
+		};
+
+	template <typename T, typename U>
+		bool operator==(const allocator<T> &, const allocator<U> &) { return true; }
+	template <typename T, typename U>
+		bool operator!=(const allocator<T> &, const allocator<U> &) { return false; }
+
+	/* a key of up to 22 bytes, held inline */
+	struct key
+	{
+		char _s[22];
+		unsigned char _n;
+		key() : _s{}, _n(0) {}
+		key(const std::string &k) : _s{}, _n(static_cast<unsigned char>(k.size())) { std::memcpy(_s, k.data(), k.size()); }
+		const char *data() const { return _s; }
+		std::size_t size() const { return _n; }
+		template <typename A>
+			void reconstitute(A) {}
+		template <typename A>
+			void *reconstitute_local(A) { return nullptr; }
+		static common::byte_span reconstitute_element(void *p, unsigned) { return common::make_byte_span(p, 0); }
+		void deconstitute() const {}
+	};
+
+	struct value
+	{
+		std::uint64_t _v;
+		value() : _v(0) {}
+		value(std::uint64_t v_) : _v(v_) {}
+		template <typename A>
+			void reconstitute(A) {}
+		template <typename A>
+			void *reconstitute_local(A) { return nullptr; }
+		static common::byte_span reconstitute_element(void *p, unsigned) { return common::make_byte_span(p, 0); }
+		void deconstitute() {}
+	};
+
+	template <typename Mutex>
+		using table = hop_hash<key, std::tuple<value>, pstr_hash<key>, pstr_equal<key>, allocator<std::pair<const key, std::tuple<value>>>, Mutex>;
+
+	/* persistent data for a table, and the allocation states it refers to */
+	template <typename Table>
+		struct table_data
+		{
+			impl::allocation_state_emplace _ase;
+			impl::allocation_state_pin _aspd;
+			impl::allocation_state_pin _aspk;
+			impl::allocation_state_extend _asx;
+			typename Table::persist_data_type _pd;
+			table_data(common::key_hash_t h_ = common::key_hash_t(0))
+				: _ase{}
+				, _aspd{}
+				, _aspk{}
+				, _asx{}
+				, _pd(1, h_, typename Table::allocator_type(), &_ase, &_aspd, &_aspk, &_asx)
+			{}
+		};
+
+	template <typename Table>
+		auto emplace(Table &t, const std::string &k, std::uint64_t v)
+		{
+			return t.emplace(std::piecewise_construct, std::forward_as_tuple(k), std::forward_as_tuple(v));
+		}
+}
+
+#endif
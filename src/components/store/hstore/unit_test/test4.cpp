@@ -27,10 +27,13 @@
 #include <api/kvstore_itf.h>
 
 #include <algorithm>
+#include <array>
 #include <chrono>
 #include <cstdlib> /* getenv */
+#include <cstring> /* memcmp */
 #include <future>
 #include <iostream>
+#include <numeric> /* accumulate */
 #include <string>
 #include <random>
 #include <sstream>
@@ -139,6 +142,13 @@ class KVStore_test
     , const std::string &descr
   );
   static void get_many_threaded(const kvv_t &kvv, const std::string &descr);
+  static constexpr std::size_t multi_get_batch = 64;
+  static void multi_get_many(
+    component::IKVStore::pool_t pool
+    , const kvv_t &kv
+    , const std::string &descr
+  );
+  static void multi_get_many_threaded(const kvv_t &kvv, const std::string &descr);
 
   std::string pool_name(std::size_t i) const
   {
@@ -185,6 +195,7 @@ constexpr unsigned KVStore_test::many_key_length_short;
 constexpr unsigned KVStore_test::many_key_length_long;
 constexpr unsigned KVStore_test::many_value_length_short;
 constexpr unsigned KVStore_test::many_value_length_long;
+constexpr std::size_t KVStore_test::multi_get_batch;
 KVStore_test::kvv_t KVStore_test::kvv_short_short;
 KVStore_test::kvv_t KVStore_test::kvv_short_long;
 KVStore_test::kvv_t KVStore_test::kvv_long_long;
@@ -545,6 +556,198 @@ TEST_F(KVStore_test, GetManyLongLong)
   get_many_threaded(kvv_long_long, "long_long");
 }
 
+void KVStore_test::multi_get_many(
+  component::IKVStore::pool_t pool_
+  , const kvv_t &kvv
+  , const std::string &descr
+)
+{
+  std::vector<component::IKVStore::string_view_key> keys;
+  for ( auto &kv : kvv )
+  {
+    keys.push_back(component::IKVStore::to_key_view(std::get<0>(kv)));
+  }
+  std::vector<std::vector<char>> buffers(multi_get_batch);
+  std::vector<::iovec> values(multi_get_batch);
+  std::vector<status_t> status(multi_get_batch);
+  {
+  auto ct = get_expand * kvv.size();
+    timer t(
+      [&descr,ct] (timer::duration_t d) {
+        auto seconds = std::chrono::duration<double>(d).count();
+        std::cerr << descr << " " << ct
+               << " in " << seconds << " => "
+               << double(ct) / seconds << " per second (multi_get)\n";
+      }
+    );
+    for ( auto i = 0; i != get_expand; ++i )
+    {
+      for ( std::size_t b = 0; b < keys.size(); b += multi_get_batch )
+      {
+        const auto n = std::min(multi_get_batch, keys.size() - b);
+        for ( std::size_t j = 0; j != n; ++j )
+        {
+          buffers[j].resize(std::get<1>(kvv[b+j]).size());
+          values[j] = ::iovec{buffers[j].data(), buffers[j].size()};
+        }
+        auto r =
+          _kvstore->multi_get(
+            pool_
+            , gsl::span<const component::IKVStore::string_view_key>(&keys[b], n)
+            , gsl::span<::iovec>(values.data(), n)
+            , gsl::span<status_t>(status.data(), n)
+          );
+        EXPECT_EQ(S_OK, r);
+        for ( std::size_t j = 0; j != n; ++j )
+        {
+          EXPECT_EQ(S_OK, status[j]);
+          if ( S_OK == status[j] )
+          {
+            EXPECT_EQ(std::get<1>(kvv[b+j]).size(), values[j].iov_len);
+            EXPECT_EQ(0, std::memcmp(std::get<1>(kvv[b+j]).data(), buffers[j].data(), values[j].iov_len));
+          }
+        }
+      }
+    }
+  }
+}
+
+void KVStore_test::multi_get_many_threaded(const kvv_t &kvv, const std::string &descr)
+{
+  std::vector<std::future<void>> v;
+  for ( auto p : pool )
+  {
+    v.emplace_back(std::async(std::launch::async, multi_get_many, p, kvv, descr));
+  }
+  for ( auto &e : v ) { e.get(); }
+}
+
+TEST_F(KVStore_test, MultiGetManyShortShort)
+{
+  ASSERT_NE(nullptr, _kvstore);
+  ASSERT_EQ(short_short_put, true);
+  for ( auto p : pool ) { ASSERT_LT(0, int64_t(p)); }
+
+  multi_get_many_threaded(kvv_short_short, "short_short");
+}
+
+TEST_F(KVStore_test, MultiGetManyShortLong)
+{
+  ASSERT_NE(nullptr, _kvstore);
+  ASSERT_EQ(short_long_put, true);
+  for ( auto p : pool ) { ASSERT_LT(0, int64_t(p)); }
+
+  multi_get_many_threaded(kvv_short_long, "short_long");
+}
+
+TEST_F(KVStore_test, MultiGetManyLongLong)
+{
+  ASSERT_NE(nullptr, _kvstore);
+  ASSERT_EQ(long_long_put, true);
+  for ( auto p : pool ) { ASSERT_LT(0, int64_t(p)); }
+
+  multi_get_many_threaded(kvv_long_long, "long_long");
+}
+
+TEST_F(KVStore_test, MapParallel)
+{
+  ASSERT_NE(nullptr, _kvstore);
+  for ( auto p : pool ) { ASSERT_LT(0, int64_t(p)); }
+
+  constexpr unsigned partition_count = 4;
+  for ( auto p : pool )
+  {
+    const auto count = _kvstore->count(p);
+
+    /* parallel, with ordered merge */
+    {
+      std::array<std::size_t, partition_count> visited{};
+      std::vector<unsigned> merged;
+      timer t(
+        [count] (timer::duration_t d) {
+          auto seconds = std::chrono::duration<double>(d).count();
+          std::cerr << "map_parallel " << count
+                 << " in " << seconds << " => "
+                 << double(count) / seconds << " per second\n";
+        }
+      );
+      auto r =
+        _kvstore->map_parallel(
+          p
+          , partition_count
+          , [&visited] (unsigned partition, const void *, std::size_t, const void *, std::size_t) -> int
+            {
+              ++visited[partition];
+              return 0;
+            }
+          , [&merged] (unsigned partition) { merged.push_back(partition); }
+          , true
+        );
+      EXPECT_EQ(S_OK, r);
+      EXPECT_EQ(count, std::accumulate(visited.begin(), visited.end(), std::size_t(0)));
+      EXPECT_EQ((std::vector<unsigned>{0, 1, 2, 3}), merged);
+    }
+
+    /* chunked: a partition at a time, a few objects per call */
+    {
+      std::size_t visited = 0;
+      for ( unsigned partition = 0; partition != partition_count; ++partition )
+      {
+        component::IKVStore::map_cursor_t cursor;
+        status_t r;
+        while (
+          ( r =
+            _kvstore->map_partition(
+              p, partition, partition_count, cursor, 100
+              , [&visited] (const void *, std::size_t, const void *, std::size_t) -> int
+                {
+                  ++visited;
+                  return 0;
+                }
+            )
+          ) == component::IKVStore::S_MORE
+        )
+        {}
+        EXPECT_EQ(S_OK, r);
+      }
+      EXPECT_EQ(count, visited);
+    }
+  }
+}
+
+TEST_F(KVStore_test, GroupCommit)
+{
+  ASSERT_NE(nullptr, _kvstore);
+  for ( auto p : pool ) { ASSERT_LT(0, int64_t(p)); }
+
+  constexpr unsigned group_size = 100;
+  const std::string value("group commit value");
+  for ( auto p : pool )
+  {
+    const auto count = _kvstore->count(p);
+    EXPECT_EQ(E_INVAL, _kvstore->group_commit_end(p));
+    EXPECT_EQ(S_OK, _kvstore->group_commit_begin(p));
+    EXPECT_EQ(E_BUSY, _kvstore->group_commit_begin(p));
+    for ( unsigned i = 0; i != group_size; ++i )
+    {
+      EXPECT_EQ(S_OK, _kvstore->put(p, "group-" + std::to_string(i), value.data(), value.length()));
+    }
+    /* the count is current within the group */
+    EXPECT_EQ(count + group_size, _kvstore->count(p));
+    for ( unsigned i = 0; i != group_size; i += 2 )
+    {
+      EXPECT_EQ(S_OK, _kvstore->erase(p, "group-" + std::to_string(i)));
+    }
+    EXPECT_EQ(S_OK, _kvstore->group_commit_end(p));
+    EXPECT_EQ(count + group_size / 2, _kvstore->count(p));
+    for ( unsigned i = 1; i < group_size; i += 2 )
+    {
+      EXPECT_EQ(S_OK, _kvstore->erase(p, "group-" + std::to_string(i)));
+    }
+    EXPECT_EQ(count, _kvstore->count(p));
+  }
+}
+
 TEST_F(KVStore_test, ClosePool)
 {
   timer t(
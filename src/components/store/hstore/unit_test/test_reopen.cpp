@@ -0,0 +1,250 @@
+/*
+   Copyright [2017-2021] [IBM Corporation]
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+       http://www.apache.org/licenses/LICENSE-2.0
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+/*
+ * Reopen of a populated pool, with the table reconstituted on several
+ * threads (HSTORE_RECONSTITUTE_THREADS) and, optionally, the allocator
+ * reconstituted in the background (HSTORE_RECONSTITUTE_LAZY).
+ *
+ * Each cycle reopens the pool and, before anything else, allocates and
+ * fills pool memory. An allocation which did not wait for the allocator
+ * to take back the values would be given value memory, and the fill
+ * would show in the values read next. The cycle then replaces every
+ * value with one of another size and erases some keys. The old values
+ * are freed only if their reference counts were restored correctly, so
+ * a bad count shows as pool use which grows from cycle to cycle.
+ */
+
+#include "pool_open.h"
+#include "store_map.h"
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Weffc++"
+#pragma GCC diagnostic ignored "-Wconversion"
+#pragma GCC diagnostic ignored "-Wsign-compare"
+#include <gtest/gtest.h>
+#pragma GCC diagnostic pop
+
+#include <api/components.h>
+/* note: we do not include component source, only the API definition */
+#include <api/kvstore_itf.h>
+#include <common/env.h>
+#include <common/utils.h> /* MiB */
+
+#include <cstdlib> /* setenv */
+#include <cstring> /* memcmp, memset */
+#include <string>
+#include <vector>
+
+using namespace component;
+
+namespace {
+
+struct reopen_mode
+{
+	const char *threads; /* HSTORE_RECONSTITUTE_THREADS */
+	const char *lazy; /* HSTORE_RECONSTITUTE_LAZY */
+};
+
+std::ostream &operator<<(std::ostream &o_, const reopen_mode &m_)
+{
+	return o_ << "threads " << m_.threads << " lazy " << m_.lazy;
+}
+
+class Reopen_test
+	: public ::testing::TestWithParam<reopen_mode>
+{
+protected:
+	static constexpr unsigned key_count = 4000;
+	static constexpr unsigned cycle_count = 8;
+	/* outline values: several thousand of them, a fair share of the pool */
+	static constexpr std::size_t value_length_base = 3000;
+	static constexpr std::size_t fill_length = 4096;
+};
+
+constexpr unsigned Reopen_test::key_count;
+constexpr unsigned Reopen_test::cycle_count;
+constexpr std::size_t Reopen_test::value_length_base;
+constexpr std::size_t Reopen_test::fill_length;
+
+std::string debug_level()
+{
+	return std::getenv("DEBUG") ? std::getenv("DEBUG") : "0";
+}
+
+Itf_ref<IKVStore_factory> load_component()
+{
+	/* load factory */
+	auto link_library = "libcomponent-" + store_map::impl->name + ".so";
+	auto comp = component::load_component(link_library, store_map::impl->factory_id);
+	return component::make_itf_ref(static_cast<IKVStore_factory *>(comp ? comp->query_interface(IKVStore_factory::iid()) : nullptr));
+}
+
+component::IKVStore *make_store(Itf_ref<IKVStore_factory> &factory)
+{
+	return
+		factory->create(
+			0
+			, {
+				{ +component::IKVStore_factory::k_name, "numa0"}
+				, { +component::IKVStore_factory::k_dax_config, store_map::location }
+				, { +component::IKVStore_factory::k_debug, debug_level() }
+				, { +component::IKVStore_factory::k_mm_plugin_path, common::env_value<const char *>("MM_PLUGIN_PATH", "no_plugin_path") }
+			}
+		);
+}
+
+std::string key_of(unsigned i)
+{
+	return "reopen-key-" + std::to_string(i);
+}
+
+/* The value of key i in cycle c, or empty if the key is erased in that cycle.
+ * Lengths alternate by cycle, so that each put replaces (frees) the old value.
+ */
+std::string value_of(unsigned i, unsigned c, std::size_t length_base)
+{
+	if ( (i + c) % 5 == 0 )
+	{
+		return std::string();
+	}
+	auto v = std::to_string(c) + ":" + std::to_string(i) + ":";
+	v.resize(length_base + (c % 2) * 1000, char('a' + (i + c) % 26));
+	return v;
+}
+
+std::uint64_t percent_used(component::IKVStore *kvstore_, IKVStore::pool_t pool_)
+{
+	std::vector<std::uint64_t> v;
+	EXPECT_EQ(S_OK, kvstore_->get_attribute(pool_, IKVStore::PERCENT_USED, v));
+	return v.empty() ? 0 : v.front();
+}
+
+TEST_P(Reopen_test, ValuesAndCountsSurviveReopen)
+{
+	::setenv("HSTORE_RECONSTITUTE_THREADS", GetParam().threads, 1);
+	::setenv("HSTORE_RECONSTITUTE_LAZY", GetParam().lazy, 1);
+
+	auto factory = load_component();
+	ASSERT_NE(nullptr, factory);
+	std::unique_ptr<component::IKVStore> kvstore(make_store(factory));
+	ASSERT_NE(nullptr, kvstore);
+
+	const std::string poolname = "pool/" + store_map::numa_zone() + "/test-reopen-" + store_map::impl->name;
+	try
+	{
+		kvstore->delete_pool(poolname);
+	}
+	catch ( Exception & )
+	{
+	}
+
+	{
+		const auto id = kvstore->create_pool(poolname, MiB(128), 0, key_count);
+		ASSERT_NE(+IKVStore::POOL_ERROR, id);
+		for ( unsigned i = 0; i != key_count; ++i )
+		{
+			const auto v = value_of(i, 0, value_length_base);
+			if ( ! v.empty() )
+			{
+				ASSERT_EQ(S_OK, kvstore->put(id, key_of(i), v.data(), v.size()));
+			}
+		}
+		ASSERT_EQ(S_OK, kvstore->close_pool(id));
+	}
+
+	std::uint64_t first_used = 0;
+	for ( unsigned c = 0; c != cycle_count; ++c )
+	{
+		pool_open p(kvstore.get(), poolname);
+		ASSERT_NE(+IKVStore::POOL_ERROR, p.id());
+
+		/* Allocate first: with a lazy reopen this waits for the allocator */
+		void *fill = nullptr;
+		ASSERT_EQ(S_OK, kvstore->allocate_pool_memory(p.id(), fill_length, 8, fill));
+		std::memset(fill, 0xa5, fill_length);
+
+		std::size_t present = 0;
+		for ( unsigned i = 0; i != key_count; ++i )
+		{
+			const auto ev = value_of(i, c, value_length_base);
+			void *value = nullptr;
+			std::size_t value_len = 0;
+			const auto r = kvstore->get(p.id(), key_of(i), value, value_len);
+			if ( ev.empty() )
+			{
+				EXPECT_EQ(+IKVStore::E_KEY_NOT_FOUND, r) << key_of(i) << " cycle " << c;
+			}
+			else
+			{
+				ASSERT_EQ(S_OK, r) << key_of(i) << " cycle " << c;
+				EXPECT_EQ(ev.size(), value_len);
+				EXPECT_TRUE(ev.size() == value_len && 0 == std::memcmp(ev.data(), value, value_len)) << key_of(i) << " cycle " << c;
+				++present;
+			}
+			if ( r == S_OK )
+			{
+				kvstore->free_memory(value);
+			}
+		}
+		EXPECT_EQ(present, kvstore->count(p.id()));
+
+		ASSERT_EQ(S_OK, kvstore->free_pool_memory(p.id(), fill, fill_length));
+
+		/* Replace every value (with one of another length), erase some keys, restore others */
+		for ( unsigned i = 0; i != key_count; ++i )
+		{
+			const auto v = value_of(i, c + 1, value_length_base);
+			if ( v.empty() )
+			{
+				EXPECT_EQ(S_OK, kvstore->erase(p.id(), key_of(i)));
+			}
+			else
+			{
+				ASSERT_EQ(S_OK, kvstore->put(p.id(), key_of(i), v.data(), v.size())) << key_of(i) << " cycle " << c;
+			}
+		}
+
+		/* Pool use is the same in every cycle of the same value lengths, unless freed values leaked */
+		const auto used = percent_used(kvstore.get(), p.id());
+		if ( c == 1 )
+		{
+			first_used = used;
+		}
+		else if ( 1 < c && c % 2 == 1 )
+		{
+			EXPECT_LE(used, first_used + 2) << "cycle " << c;
+		}
+	}
+
+	EXPECT_EQ(S_OK, kvstore->delete_pool(poolname));
+}
+
+INSTANTIATE_TEST_CASE_P(
+	Reconstitute
+	, Reopen_test
+	, ::testing::Values(
+		reopen_mode{"4", "0"} /* parallel */
+		, reopen_mode{"4", "1"} /* parallel, allocator in the background */
+	)
+);
+
+} // namespace
+
+int main(int argc, char **argv)
+{
+	::testing::InitGoogleTest(&argc, argv);
+	auto r = RUN_ALL_TESTS();
+
+	return r;
+}
@@ -0,0 +1,171 @@
+/*
+   Copyright [2017-2021] [IBM Corporation]
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+       http://www.apache.org/licenses/LICENSE-2.0
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+/*
+ * Incremental resize of the hop_hash table: random emplace, erase and find,
+ * across many resizes, agree with std::map. Iteration midway through a
+ * resize sees each key once, and a table reopened (reconstituted) while a
+ * resize is moving content finishes the resize without losing keys.
+ */
+
+#include "hop_hash_harness.h"
+
+#include "dummy_shared_mutex.h"
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Weffc++"
+#pragma GCC diagnostic ignored "-Wconversion"
+#pragma GCC diagnostic ignored "-Wsign-compare"
+#include <gtest/gtest.h>
+#pragma GCC diagnostic pop
+
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <random>
+#include <string>
+
+namespace {
+
+using table_t = harness::table<dummy::shared_mutex>;
+using data_t = harness::table_data<table_t>;
+
+std::string key_string(const table_t::value_type &v)
+{
+  return std::string(v.first.data(), v.first.size());
+}
+
+template <typename Iterator>
+  std::uint64_t value_of(Iterator it)
+{
+  return std::get<0>(it->second)._v;
+}
+
+void check_against(const table_t &t, const std::map<std::string, std::uint64_t> &model)
+{
+  ASSERT_EQ(model.size(), t.size());
+  std::map<std::string, unsigned> seen;
+  for ( auto it = t.begin(); it != t.end(); ++it )
+  {
+    ++seen[key_string(*it)];
+  }
+  ASSERT_EQ(model.size(), seen.size());
+  for ( const auto &e : seen )
+  {
+    EXPECT_EQ(1U, e.second) << e.first << " visited more than once";
+    EXPECT_EQ(1U, model.count(e.first)) << e.first << " is not in the model";
+  }
+  for ( const auto &m : model )
+  {
+    auto it = t.find(harness::key(m.first));
+    ASSERT_NE(t.end(), it) << m.first << " lost";
+    EXPECT_EQ(m.second, value_of(it));
+  }
+}
+
+class Resize_test
+  : public ::testing::TestWithParam<unsigned>
+{
+};
+
+TEST_P(Resize_test, MatchesStdMap)
+{
+  const unsigned n = 200000;
+  data_t d{common::key_hash_t(GetParam())};
+  table_t t(&d._pd, construction_mode::create, table_t::allocator_type());
+  std::map<std::string, std::uint64_t> model;
+  std::mt19937_64 r(GetParam() + 1);
+  std::size_t resizes = 0;
+  auto buckets = t.bucket_count();
+
+  for ( unsigned i = 0; i != n; ++i )
+  {
+    const auto op = r() % 10;
+    const std::string k = "k" + std::to_string(r() % n);
+    if ( op < 6 )
+    {
+      const auto v = std::hash<std::string>()(k);
+      const auto res = harness::emplace(t, k, v);
+      EXPECT_EQ(model.emplace(k, v).second, res.second) << "emplace " << k;
+    }
+    else if ( op < 8 )
+    {
+      EXPECT_EQ(model.erase(k), t.erase(harness::key(k))) << "erase " << k;
+    }
+    else
+    {
+      auto it = t.find(harness::key(k));
+      const auto m = model.find(k);
+      ASSERT_EQ(m != model.end(), it != t.end()) << "find " << k << " at " << i;
+      if ( m != model.end() )
+      {
+        EXPECT_EQ(m->second, value_of(it));
+      }
+    }
+
+    /* iterate now and then, including while a resize is moving content */
+    if ( i % (n / 16) == 0 || t.bucket_count() != buckets )
+    {
+      std::size_t c = 0;
+      for ( auto it = t.begin(); it != t.end(); ++it ) { ++c; }
+      ASSERT_EQ(model.size(), c) << "iteration at " << i;
+      if ( t.bucket_count() != buckets )
+      {
+        ++resizes;
+        buckets = t.bucket_count();
+      }
+    }
+  }
+  EXPECT_LT(3U, resizes);
+  check_against(t, model);
+}
+
+TEST_P(Resize_test, ReopenDuringResize)
+{
+  data_t d{common::key_hash_t(GetParam())};
+  std::map<std::string, std::uint64_t> model;
+  {
+    table_t t(&d._pd, construction_mode::create, table_t::allocator_type());
+    const auto buckets = t.bucket_count();
+    /* fill until a resize starts moving (the table has doubled), then a few more steps */
+    for ( unsigned i = 0; t.bucket_count() == buckets || i % 100 != 0; ++i )
+    {
+      const std::string k = "k" + std::to_string(i);
+      harness::emplace(t, k, i);
+      model.emplace(k, i);
+    }
+    /* the table is abandoned, without a close, as in a crash */
+  }
+
+  table_t t(&d._pd, construction_mode::reconstitute, table_t::allocator_type());
+  check_against(t, model);
+
+  /* later emplaces finish the resize */
+  for ( unsigned i = 0; i != 50000; ++i )
+  {
+    const std::string k = "r" + std::to_string(i);
+    harness::emplace(t, k, i);
+    model.emplace(k, i);
+  }
+  check_against(t, model);
+}
+
+INSTANTIATE_TEST_CASE_P(KeyHash, Resize_test, ::testing::Values(0U, 1U, 2U));
+
+} // namespace
+
+int main(int argc, char **argv)
+{
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,134 @@
+/*
+   Copyright [2017-2021] [IBM Corporation]
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+       http://www.apache.org/licenses/LICENSE-2.0
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+/*
+ * Lookups concurrent with resize (built with THREAD_SAFE_HASH): three
+ * readers find a fixed set of keys while a writer emplaces and erases
+ * other keys, doubling the table several times. No lookup may miss a
+ * fixed key, and none may hang.
+ *
+ * The readers check presence only. find returns an iterator without a
+ * lock, so content it refers to may be displaced before it is read.
+ */
+
+#include "hop_hash_harness.h"
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Weffc++"
+#pragma GCC diagnostic ignored "-Wconversion"
+#pragma GCC diagnostic ignored "-Wsign-compare"
+#include <gtest/gtest.h>
+#pragma GCC diagnostic pop
+
+#include <atomic>
+#include <cstdint>
+#include <random>
+#include <shared_mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+using table_t = harness::table<std::shared_timed_mutex>;
+using data_t = harness::table_data<table_t>;
+
+class Resize_mt_test
+  : public ::testing::Test
+{
+protected:
+  static constexpr unsigned fixed_count = 2000;
+  static constexpr unsigned reader_count = 3;
+  static constexpr unsigned writer_ops = 400000;
+};
+
+constexpr unsigned Resize_mt_test::fixed_count;
+constexpr unsigned Resize_mt_test::reader_count;
+constexpr unsigned Resize_mt_test::writer_ops;
+
+TEST_F(Resize_mt_test, FindDuringResize)
+{
+  data_t d;
+  table_t t(&d._pd, construction_mode::create, table_t::allocator_type());
+  for ( unsigned i = 0; i != fixed_count; ++i )
+  {
+    harness::emplace(t, "s" + std::to_string(i), i);
+  }
+  const auto initial_buckets = t.bucket_count();
+
+  std::atomic<bool> done{false};
+  std::atomic<std::uint64_t> finds{0};
+  std::atomic<std::uint64_t> misses{0};
+  std::vector<std::thread> readers;
+  for ( unsigned r = 0; r != reader_count; ++r )
+  {
+    readers.emplace_back(
+      [&t, &done, &finds, &misses, r] ()
+      {
+        std::mt19937 g(r);
+        std::uint64_t f = 0;
+        std::uint64_t m = 0;
+        while ( ! done )
+        {
+          const auto i = g() % fixed_count;
+          if ( t.find(harness::key("s" + std::to_string(i))) == t.end() )
+          {
+            ++m;
+          }
+          ++f;
+        }
+        finds += f;
+        misses += m;
+      }
+    );
+  }
+
+  /* Churn keys four times as numerous as the fixed keys: several resizes */
+  std::mt19937 g(9);
+  for ( unsigned i = 0; i != writer_ops; ++i )
+  {
+    const auto k = "v" + std::to_string(g() % (fixed_count * 4));
+    auto it = t.find(harness::key(k));
+    if ( it == t.end() )
+    {
+      harness::emplace(t, k, 7);
+    }
+    else
+    {
+      t.erase(it);
+    }
+  }
+  done = true;
+  for ( auto &th : readers )
+  {
+    th.join();
+  }
+
+  EXPECT_LT(initial_buckets, t.bucket_count());
+  EXPECT_LT(0U, finds.load());
+  EXPECT_EQ(0U, misses.load());
+  for ( unsigned i = 0; i != fixed_count; ++i )
+  {
+    auto it = t.find(harness::key("s" + std::to_string(i)));
+    ASSERT_NE(t.end(), it);
+    EXPECT_EQ(i, std::get<0>(it->second)._v);
+  }
+}
+
+} // namespace
+
+int main(int argc, char **argv)
+{
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -87,6 +87,22 @@ std::set<std::unique_ptr<pool_session>, common::less_getter<std::unique_ptr<pool
 
     return session;
   }
+
+  /* existing pool, or a restartable pool reopened from its image; caller holds _pool_sessions_lock */
+  pools_type::iterator find_or_reopen(const unsigned debug_level,
+                                      const std::string &mm_plugin_path,
+                                      const std::string &name,
+                                      const bitmask *numa_node_mask)
+  {
+    auto it = _pools.find(name);
+    if (it == _pools.end()) {
+      if (auto p = Pool_instance::reopen(debug_level, mm_plugin_path, name, numa_node_mask)) {
+        it = _pools.insert(pools_type::value_type(name, p)).first;
+        FINF("reopened pool instance {}", name);
+      }
+    }
+    return it;
+  }
 }
 
 /** Main class */
@@ -125,7 +141,7 @@ auto Map_store::create_pool(const std::string &name_,
 
   Std_lock_guard g(_pool_sessions_lock);
 
-  auto iter = _pools.find(name_);
+  auto iter = find_or_reopen(debug_level(), _mm_plugin_path, name_, _numa_node_mask.get());
 
   if (flags & FLAGS_CREATE_ONLY) {
     if (iter != _pools.end()) {
@@ -159,7 +175,7 @@ auto Map_store::open_pool(const std::string &name,
   std::shared_ptr<Pool_instance> ph;
   Std_lock_guard g(_pool_sessions_lock);
   /* see if a pool exists that matches the key */
-  auto it = _pools.find(name);
+  auto it = find_or_reopen(debug_level(), _mm_plugin_path, name, _numa_node_mask.get());
 
   if (it == _pools.end())
     return POOL_ERROR;
@@ -198,6 +214,9 @@ status_t Map_store::delete_pool(const std::string &poolname_)
   auto it = _pools.find(poolname_);
 
   if (it == _pools.end()) {
+    /* a restartable pool which has not been reopened */
+    if (Pool_instance::delete_image(poolname_))
+      return S_OK;
     CFWRNM(1, "({}) pool not found", poolname_);
     return E_POOL_NOT_FOUND;
   }
@@ -210,6 +229,7 @@ status_t Map_store::delete_pool(const std::string &poolname_)
     }
   }
 
+  it->second->mark_deleted();
   _pools.erase(it);
 
   return S_OK;
@@ -224,49 +244,68 @@ status_t Map_store::get_pool_names(std::list<std::string>& inout_pool_names)
   return S_OK;
 }
 
-namespace
+/* The std::string forms forward to the string_view_key forms, which the pool implements */
+status_t Map_store::put(pool_t pid, const std::string &key,
+                        const void *value, size_t value_len,
+                        const flags_t flags)
 {
-	using string_view_key = component::IKVStore::string_view_key;
-
-	string_view_key to_string_view_key(const std::string &key)
-	{
-		return string_view_key(static_cast<string_view_key::const_pointer>(static_cast<const void *>(key.data())), key.size());
-	}
+  return put(pid, to_key_view(key), value, value_len, flags);
 }
 
-status_t Map_store::put(pool_t pid, const std::string &key,
+status_t Map_store::put(pool_t pid, const string_view_key key,
                         const void *value, size_t value_len,
                         const flags_t flags)
 {
   auto session = get_session(pid);
   if (!session) return E_POOL_NOT_FOUND;
 
-  return session->pool->put(to_string_view_key(key), value, value_len, flags);
+  return session->pool->put(key, value, value_len, flags);
 }
 
 status_t Map_store::get(const pool_t pid, const std::string &key,
                         void *&out_value, size_t &out_value_len)
+{
+  return get(pid, to_key_view(key), out_value, out_value_len);
+}
+
+status_t Map_store::get(const pool_t pid, const string_view_key key,
+                        void *&out_value, size_t &out_value_len)
 {
   auto session = get_session(pid);
   if (!session) return E_POOL_NOT_FOUND;
 
-  return session->pool->get(to_string_view_key(key), out_value, out_value_len);
+  return session->pool->get(key, out_value, out_value_len);
 }
 
 status_t Map_store::get_direct(const pool_t pid, const std::string &key,
+                               void *out_value, size_t &out_value_len,
+                               memory_handle_t handle)
+{
+  return get_direct(pid, to_key_view(key), out_value, out_value_len, handle);
+}
+
+status_t Map_store::get_direct(const pool_t pid, const string_view_key key,
                                void *out_value, size_t &out_value_len,
                                memory_handle_t /*handle*/)
 {
   auto session = get_session(pid);
   if (!session) return E_POOL_NOT_FOUND;
 
-  return session->pool->get_direct(to_string_view_key(key), out_value, out_value_len);
+  return session->pool->get_direct(key, out_value, out_value_len);
 }
 
 status_t Map_store::put_direct(const pool_t pid, const std::string &key,
                                const void *value, const size_t value_len,
                                memory_handle_t /*memory_handle*/,
                                const flags_t flags)
+{
+  return Map_store::put(pid, to_key_view(key), value, value_len, flags);
+}
+
+status_t Map_store::put_direct(const pool_t pid, const string_view_key key,
+                               const void *value, const size_t value_len,
+                               memory_handle_t /*memory_handle*/,
+                               const flags_t flags)
 {
   return Map_store::put(pid, key, value, value_len, flags);
 }
@@ -275,11 +314,19 @@ status_t Map_store::resize_value(const pool_t pool,
                                  const std::string &key,
                                  const size_t new_size,
                                  const size_t alignment)
+{
+  return resize_value(pool, to_key_view(key), new_size, alignment);
+}
+
+status_t Map_store::resize_value(const pool_t pool,
+                                 const string_view_key key,
+                                 const size_t new_size,
+                                 const size_t alignment)
 {
   auto session = get_session(pool);
   if (!session) return E_POOL_NOT_FOUND;
 
-  return session->pool->resize_value(to_string_view_key(key), new_size, alignment);
+  return session->pool->resize_value(key, new_size, alignment);
 }
 
 status_t Map_store::get_attribute(const pool_t pool,
@@ -290,7 +337,18 @@ status_t Map_store::get_attribute(const pool_t pool,
   auto session = get_session(pool);
   if (!session) return E_POOL_NOT_FOUND;
 
-  return session->pool->get_attribute(attr, out_attr, key ? to_string_view_key(*key) : string_view_key());
+  return session->pool->get_attribute(attr, out_attr, key ? to_key_view(*key) : string_view_key());
+}
+
+status_t Map_store::get_attribute(const pool_t pool,
+                                  const Attribute attr,
+                                  std::vector<uint64_t> &out_attr,
+                                  const string_view_key key)
+{
+  auto session = get_session(pool);
+  if (!session) return E_POOL_NOT_FOUND;
+
+  return session->pool->get_attribute(attr, out_attr, key);
 }
 
 status_t Map_store::swap_keys(const pool_t           pool,
@@ -300,7 +358,7 @@ status_t Map_store::swap_keys(const pool_t           pool,
   auto session = get_session(pool);
   if (!session) return E_POOL_NOT_FOUND;
 
-  return session->pool->swap_keys(to_string_view_key(key0), to_string_view_key(key1));
+  return session->pool->swap_keys(to_key_view(key0), to_key_view(key1));
 }
 
 
@@ -312,6 +370,18 @@ status_t Map_store::lock(const pool_t pid,
                          size_t alignment,
                          key_t &out_key,
                          const char ** out_key_ptr)
+{
+  return lock(pid, to_key_view(key), type, out_value, inout_value_len, alignment, out_key, out_key_ptr);
+}
+
+status_t Map_store::lock(const pool_t pid,
+                         const string_view_key key,
+                         lock_type_t type,
+                         void *&out_value,
+                         size_t &inout_value_len,
+                         size_t alignment,
+                         key_t &out_key,
+                         const char ** out_key_ptr)
 {
   auto session = get_session(pid);
   if (!session) {
@@ -320,9 +390,9 @@ status_t Map_store::lock(const pool_t pid,
     return E_FAIL; /* same as hstore, but should be E_INVAL; */
   }
 
-  auto rc = session->pool->lock(to_string_view_key(key), type, out_value, inout_value_len, alignment, out_key, out_key_ptr);
+  auto rc = session->pool->lock(key, type, out_value, inout_value_len, alignment, out_key, out_key_ptr);
 
-  CFLOGM(1, "({}, {}) rc={}", key, reinterpret_cast<void*>(out_key), rc);
+  CFLOGM(1, "({}, {}) rc={}", common::string_view(common::pointer_cast<char>(key.data()), key.size()), reinterpret_cast<void*>(out_key), rc);
 
   return rc;
 }
@@ -341,11 +411,16 @@ status_t Map_store::unlock(const pool_t pid,
 }
 
 status_t Map_store::erase(const pool_t pid, const std::string &key)
+{
+  return erase(pid, to_key_view(key));
+}
+
+status_t Map_store::erase(const pool_t pid, const string_view_key key)
 {
   auto session = get_session(pid);
   if (!session) return E_POOL_NOT_FOUND;
 
-  return session->pool->erase(to_string_view_key(key));
+  return session->pool->erase(key);
 }
 
 size_t Map_store::count(const pool_t pid)
@@ -371,8 +446,8 @@ int Map_store::get_capability(Capability cap) const
     return 1;
   case Capability::POOL_THREAD_SAFE:
     return 1;
-  case Capability::RWLOCK_PER_POOL:
-    return 1;
+  case Capability::RWLOCK_PER_POOL: /* locks are per key map partition */
+    return 0;
   case Capability::WRITE_TIMESTAMPS:
     return 1;
   default:
@@ -467,6 +542,22 @@ status_t Map_store::map_keys(const pool_t pool, std::function<int(const std::str
     );
 }
 
+status_t Map_store::map_partition(const pool_t pool,
+                                  const unsigned partition,
+                                  const unsigned partition_count,
+                                  map_cursor_t &cursor,
+                                  const size_t max_objects,
+                                  std::function<int(const void *key,
+                                                    const size_t key_len,
+                                                    const void *value,
+                                                    const size_t value_len)> function)
+{
+  auto session = get_session(pool);
+  if (!session) return E_POOL_NOT_FOUND;
+
+  return session->pool->map_partition(partition, partition_count, cursor, max_objects, function);
+}
+
 status_t Map_store::get_pool_regions(const pool_t pool,
                                      nupm::region_descriptor &out_regions)
 {
@@ -103,7 +103,7 @@ public:
 
 public:
   /* IKVStore */
-  virtual int thread_safety() const override { return THREAD_MODEL_RWLOCK_PER_POOL; }
+  virtual int thread_safety() const override { return THREAD_MODEL_MULTI_PER_POOL; }
 
   virtual int get_capability(Capability cap) const override;
 
@@ -126,26 +126,50 @@ public:
                        const void *value, const size_t value_len,
                        flags_t flags = FLAGS_NONE) override;
 
+  virtual status_t put(const pool_t pool, const string_view_key key,
+                       const void *value, const size_t value_len,
+                       flags_t flags = FLAGS_NONE) override;
+
   virtual status_t get(const pool_t pool, const std::string &key,
                        void *&out_value, size_t &out_value_len) override;
 
+  virtual status_t get(const pool_t pool, const string_view_key key,
+                       void *&out_value, size_t &out_value_len) override;
+
   virtual status_t get_direct(const pool_t pool, const std::string &key, void *out_value,
                               size_t &out_value_len,
                               memory_handle_t handle) override;
 
+  virtual status_t get_direct(const pool_t pool, const string_view_key key, void *out_value,
+                              size_t &out_value_len,
+                              memory_handle_t handle) override;
+
   virtual status_t put_direct(const pool_t pool, const std::string &key,
                               const void *value, const size_t value_len,
                               memory_handle_t handle = HANDLE_NONE,
                               flags_t flags = FLAGS_NONE) override;
 
+  virtual status_t put_direct(const pool_t pool, const string_view_key key,
+                              const void *value, const size_t value_len,
+                              memory_handle_t handle = HANDLE_NONE,
+                              flags_t flags = FLAGS_NONE) override;
+
   virtual status_t resize_value(const pool_t pool, const std::string &key,
                                 const size_t new_size,
                                 const size_t alignment) override;
 
+  virtual status_t resize_value(const pool_t pool, const string_view_key key,
+                                const size_t new_size,
+                                const size_t alignment) override;
+
   virtual status_t get_attribute(const pool_t pool, const Attribute attr,
                                  std::vector<uint64_t> &out_attr,
                                  const std::string *key = nullptr) override;
 
+  virtual status_t get_attribute(const pool_t pool, const Attribute attr,
+                                 std::vector<uint64_t> &out_attr,
+                                 const string_view_key key) override;
+
   virtual status_t swap_keys(const pool_t pool,
                              const std::string key0,
                              const std::string key1) override;
@@ -159,12 +183,23 @@ public:
                         key_t &out_key,
                         const char ** out_key_ptr) override;
 
+  virtual status_t lock(const pool_t pool,
+                        const string_view_key key,
+                        lock_type_t type,
+                        void *&out_value,
+                        size_t &inout_value_len,
+                        size_t alignment,
+                        key_t &out_key,
+                        const char ** out_key_ptr) override;
+
   virtual status_t unlock(const pool_t pool,
                           key_t key,
                           unlock_flags_t flags) override;
 
   virtual status_t erase(const pool_t pool, const std::string &key) override;
 
+  virtual status_t erase(const pool_t pool, const string_view_key key) override;
+
   virtual size_t count(const pool_t pool) override;
 
   virtual status_t free_memory(void *p) override;
@@ -187,6 +222,16 @@ public:
   virtual status_t map_keys(const pool_t pool,
                             std::function<int(const std::string &key)> function) override;
 
+  virtual status_t map_partition(const pool_t pool,
+                                 const unsigned partition,
+                                 const unsigned partition_count,
+                                 map_cursor_t &cursor,
+                                 const size_t max_objects,
+                                 std::function<int(const void *key,
+                                                   const size_t key_len,
+                                                   const void *value,
+                                                   const size_t value_len)> function) override;
+
   virtual void debug(const pool_t pool, unsigned cmd, uint64_t arg) override;
 
   virtual status_t get_pool_regions(const pool_t pool,
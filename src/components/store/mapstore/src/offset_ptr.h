@@ -0,0 +1,54 @@
+/*
+  Copyright [2017-2021] [IBM Corporation]
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+  http://www.apache.org/licenses/LICENSE-2.0
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+#ifndef _MCAS_MAPSTORE_OFFSET_PTR_H_
+#define _MCAS_MAPSTORE_OFFSET_PTR_H_
+
+#include <cstddef> /* nullptr_t */
+#include <cstdint>
+
+/**
+ * Self-relative pointer: holds the distance from itself to its target.
+ * A structure of offset_ptrs which lies within one mapping, with the
+ * targets, means the same wherever the mapping is placed (see
+ * Pool_image). Copying and moving recompute the distance.
+ *
+ * 0 is null (an offset_ptr never points to itself).
+ */
+template <typename T>
+  class offset_ptr {
+    std::intptr_t _offset;
+
+    static std::intptr_t offset(const void *from, const void *to)
+    {
+      return to ? reinterpret_cast<std::intptr_t>(to) - reinterpret_cast<std::intptr_t>(from) : 0;
+    }
+
+  public:
+    offset_ptr() noexcept : _offset(0) {}
+    offset_ptr(std::nullptr_t) noexcept : _offset(0) {}
+    offset_ptr(T *p) noexcept : _offset(offset(this, p)) {}
+    offset_ptr(const offset_ptr &o) noexcept : _offset(offset(this, o.get())) {}
+    offset_ptr &operator=(const offset_ptr &o) noexcept { _offset = offset(this, o.get()); return *this; }
+    offset_ptr &operator=(T *p) noexcept { _offset = offset(this, p); return *this; }
+
+    T *get() const noexcept
+    {
+      return _offset ? reinterpret_cast<T *>(reinterpret_cast<std::intptr_t>(this) + _offset) : nullptr;
+    }
+    operator T *() const noexcept { return get(); }
+    T *operator->() const noexcept { return get(); }
+    explicit operator bool() const noexcept { return _offset != 0; }
+  };
+
+#endif
@@ -0,0 +1,287 @@
+/*
+  Copyright [2017-2021] [IBM Corporation]
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+  http://www.apache.org/licenses/LICENSE-2.0
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+#include "partitioned_map.h"
+
+#include <common/exceptions.h>
+#include <common/rwlock.h> /* RWLock_guard */
+#include <algorithm> /* max, min */
+#include <cstring> /* memcmp, memcpy */
+#include <new> /* bad_alloc, placement new */
+
+namespace
+{
+  /* initial slot count of a partition; slots are allocated on first insert */
+  constexpr std::size_t initial_capacity = 16;
+  constexpr unsigned max_partitions = 1U << 16;
+
+  unsigned log2_ceil(unsigned n)
+  {
+    unsigned l = 0;
+    while ( (1U << l) < n ) ++l;
+    return l;
+  }
+}
+
+void *Allocator_handle::allocate(const std::size_t n, const std::size_t alignment) const
+{
+  void *p = nullptr;
+  std::lock_guard g{*_heap_mutex};
+  const auto rc =
+    alignment <= 1
+    ? _heap->allocate(size(n), &p)
+    : _heap->aligned_allocate(size(n), alignment, &p)
+    ;
+  if ( rc != S_OK || p == nullptr )
+    throw std::bad_alloc();
+  return p;
+}
+
+void Allocator_handle::deallocate(void *p, const std::size_t n) const
+{
+  std::lock_guard g{*_heap_mutex};
+  _heap->deallocate(&p, size(n));
+}
+
+void Allocator_handle::inject(void *p, const std::size_t n) const
+{
+  std::lock_guard g{*_heap_mutex};
+  if ( _heap->inject_allocation(p, size(n)) != S_OK )
+    throw General_exception("%s: inject_allocation failed (%p, %zu)", __func__, p, n);
+}
+
+Partitioned_map::partition::~partition()
+{
+  if ( _slots )
+  {
+    for ( std::size_t i = 0; i != _slot_count; ++i )
+    {
+      auto &s = _slots[i];
+      if ( s.in_use() )
+        free_key_block(s);
+      s.~slot();
+    }
+    _heap.deallocate(_slots, slot_array_size(_slot_count));
+  }
+}
+
+auto Partitioned_map::partition::find(const std::uint64_t hash, const string_view_key key) const -> slot *
+{
+  /* the run from the home slot is in hash order: stop at an empty slot or a greater hash */
+  for ( auto i = _slots ? home(hash) : _slot_count; i != _slot_count && _slots[i].in_use() && _slots[i]._hash <= hash; ++i )
+  {
+    auto &s = _slots[i];
+    if ( s._hash == hash && s._key_len == key.size() && std::memcmp(s.key_ptr(), key.data(), key.size()) == 0 )
+    {
+      _hits.fetch_add(1, std::memory_order_relaxed);
+      return &s;
+    }
+  }
+  return nullptr;
+}
+
+std::size_t Partitioned_map::partition::lower_bound(const std::uint64_t hash) const
+{
+  auto i = _slots ? home(hash) : _slot_count;
+  while ( i != _slot_count && _slots[i].in_use() && _slots[i]._hash < hash ) ++i;
+  return i;
+}
+
+auto Partitioned_map::partition::save(const common::byte *base) const -> partition_image
+{
+  return
+    partition_image{
+      _slots ? std::uint64_t(common::pointer_cast<common::byte>(_slots) - base) : 0
+      , _slot_count
+      , size()
+      , _capacity_bits
+      , 0
+    };
+}
+
+void Partitioned_map::partition::release()
+{
+  _slots = nullptr;
+  _capacity_bits = 0;
+  _slot_count = 0;
+  _count.store(0, std::memory_order_relaxed);
+}
+
+void Partitioned_map::partition::restore(const partition_image &image, common::byte *base)
+{
+  _slots = image._slots ? common::pointer_cast<slot>(base + image._slots) : nullptr;
+  _capacity_bits = image._capacity_bits;
+  _slot_count = image._slot_count;
+  _count.store(image._count, std::memory_order_relaxed);
+
+  if ( _slots )
+  {
+    _heap.inject(_slots, slot_array_size(_slot_count));
+    for ( std::size_t i = 0; i != _slot_count; ++i )
+    {
+      auto &s = _slots[i];
+      if ( s.in_use() )
+      {
+        _heap.inject(s._key_block, key_block::size(s._key_len));
+        /* value locks do not survive the process which held them */
+        new (s._key_block.get()) key_block();
+      }
+    }
+  }
+}
+
+void Partitioned_map::partition::free_key_block(slot &s)
+{
+  s._key_block->~key_block();
+  _heap.deallocate(s._key_block, key_block::size(s._key_len));
+}
+
+void Partitioned_map::partition::grow()
+{
+  const auto old_slots = _slots;
+  const auto old_slot_count = _slot_count;
+
+  /* The old slots are in hash order, and so in order of new home slot:
+   * each goes to its home slot or, if that is taken, just after its
+   * predecessor. Choose a capacity at which they all land before the end
+   * of the slack (almost always double the old capacity).
+   */
+  auto new_bits = _slots ? _capacity_bits + 1 : log2_ceil(initial_capacity);
+  for ( ; ; ++new_bits )
+  {
+    const auto new_capacity = std::size_t(1) << new_bits;
+    std::size_t next = 0;
+    for ( std::size_t i = 0; next <= new_capacity + slack(new_capacity) && i != old_slot_count; ++i )
+    {
+      if ( old_slots[i].in_use() )
+        next = std::max(home(old_slots[i]._hash, new_bits), next) + 1;
+    }
+    if ( next <= new_capacity + slack(new_capacity) ) break;
+  }
+
+  const auto new_capacity = std::size_t(1) << new_bits;
+  const auto new_slot_count = new_capacity + slack(new_capacity);
+  auto new_slots = static_cast<slot *>(_heap.allocate(slot_array_size(new_slot_count), slot_array_alignment));
+  for ( std::size_t i = 0; i != new_slot_count; ++i )
+    new (&new_slots[i]) slot{0, 0, nullptr, 0, value_type()};
+
+  std::size_t next = 0;
+  for ( std::size_t i = 0; i != old_slot_count; ++i )
+  {
+    auto &s = old_slots[i];
+    if ( s.in_use() )
+    {
+      const auto j = std::max(home(s._hash, new_bits), next);
+      new_slots[j] = std::move(s);
+      next = j + 1;
+    }
+    s.~slot();
+  }
+
+  if ( old_slots )
+    _heap.deallocate(old_slots, slot_array_size(old_slot_count));
+
+  _slots = new_slots;
+  _capacity_bits = new_bits;
+  _slot_count = new_slot_count;
+}
+
+auto Partitioned_map::partition::emplace(const std::uint64_t hash, const string_view_key key, value_type &&value, const std::uint64_t version) -> slot &
+{
+  /* load factor limit 3/4 */
+  if ( (size() + 1) * 4 > capacity() * 3 )
+    grow();
+
+  auto kb = new (_heap.allocate(key_block::size(key.size()), alignof(key_block))) key_block();
+  std::memcpy(kb->key(), key.data(), key.size());
+
+  for ( ;; )
+  {
+    /* the insertion point keeps the slots in hash order (equal hashes in insertion order) */
+    auto i = home(hash);
+    while ( i != _slot_count && _slots[i].in_use() && _slots[i]._hash <= hash ) ++i;
+
+    auto e = i;
+    while ( e != _slot_count && _slots[e].in_use() ) ++e;
+
+    if ( e == _slot_count )
+    {
+      /* no free slot before the end of the slack */
+      grow();
+      continue;
+    }
+
+    /* open slot i by shifting the run [i, e) up by one */
+    for ( ; e != i; --e )
+      _slots[e] = std::move(_slots[e - 1]);
+
+    _slots[i] = slot{hash, version, kb, key.size(), std::move(value)};
+    _count.fetch_add(1, std::memory_order_relaxed);
+    return _slots[i];
+  }
+}
+
+void Partitioned_map::partition::erase(slot &s)
+{
+  free_key_block(s);
+
+  /* close the hole by shifting the rest of the run down by one, up to an
+   * empty slot or an entry which is in its home slot
+   */
+  auto hole = std::size_t(&s - _slots);
+  for ( auto j = hole + 1; j != _slot_count && _slots[j].in_use() && home(_slots[j]._hash) < j; ++j )
+  {
+    _slots[hole] = std::move(_slots[j]);
+    hole = j;
+  }
+  _slots[hole]._key_block = nullptr;
+  _slots[hole]._key_len = 0;
+  _count.fetch_sub(1, std::memory_order_relaxed);
+}
+
+Partitioned_map::Partitioned_map(const Key_hash &hasher_,
+                                 const unsigned partition_count_,
+                                 const std::vector<Allocator_handle> &heaps_)
+  : _hasher(hasher_)
+  , _shift(64U - log2_ceil(std::max(unsigned(heaps_.size()), std::min(partition_count_, max_partitions))))
+  , _heap_count(unsigned(heaps_.size()))
+  , _version(0)
+  , _partitions()
+{
+  if ( heaps_.empty() || max_partitions < heaps_.size() )
+    throw Logic_exception("%s: bad heap count %zu", __func__, heaps_.size());
+
+  _partitions.reserve(partition_count());
+  for ( unsigned i = 0; i != partition_count(); ++i )
+    _partitions.emplace_back(std::make_unique<partition>(heaps_[heap_index(i)], 64U - _shift));
+}
+
+void Partitioned_map::save(partition_image *table, const common::byte *base) const
+{
+  for ( unsigned p = 0; p != partition_count(); ++p )
+    table[p] = at(p).save(base);
+}
+
+void Partitioned_map::release()
+{
+  for ( auto &p : _partitions )
+    p->release();
+}
+
+std::size_t Partitioned_map::size() const
+{
+  std::size_t n = 0;
+  for ( const auto &p : _partitions )
+    n += p->size();
+  return n;
+}
@@ -0,0 +1,317 @@
+/*
+  Copyright [2017-2021] [IBM Corporation]
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+  http://www.apache.org/licenses/LICENSE-2.0
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+#ifndef _MCAS_MAPSTORE_PARTITIONED_MAP_H_
+#define _MCAS_MAPSTORE_PARTITIONED_MAP_H_
+
+#include "mm_plugin_itf.h"
+#include "offset_ptr.h"
+#include "value_lock.h"
+
+#include <api/kvstore_itf.h> /* string_view_key */
+#include <common/byte.h>
+#include <common/key_hash.h>
+#include <common/rwlock.h>
+#include <common/time.h> /* tsc_time_t */
+#include <common/utils.h> /* round_up_t */
+#include <city.h> /* CityHash64 */
+#include <algorithm> /* max, min */
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+struct value_type {
+  value_type() : _ptr(nullptr), _length(0), _tsc() {
+  }
+
+  value_type(void* ptr, size_t length) :
+    _ptr(ptr), _length(length), _tsc() {
+  }
+
+  value_type(const value_type &) = delete;
+  value_type &operator=(const value_type &) = delete;
+  /* entries move within a partition on insert, erase and growth */
+  value_type(value_type &&) noexcept = default;
+  value_type &operator=(value_type &&) noexcept = default;
+  offset_ptr<void> _ptr;
+  size_t _length;
+  common::tsc_time_t _tsc;
+};
+
+/* The algorithm is chosen by the create_pool flags (FLAGS_HASH_*) */
+class Key_hash {
+public:
+  explicit Key_hash(common::key_hash_t algorithm = common::key_hash_t::KEY_HASH_CITY) : _algorithm(algorithm) {}
+
+  size_t operator()(component::IKVStore::string_view_key k) const {
+    switch ( _algorithm ) {
+    case common::key_hash_t::KEY_HASH_WY:
+      return common::wyhash64(k.data(), k.size());
+    case common::key_hash_t::KEY_HASH_CRC32C:
+      return common::crc32c_hash64(k.data(), k.size());
+    default:
+      return CityHash64(common::pointer_cast<char>(k.data()), k.size());
+    }
+  }
+
+  common::key_hash_t algorithm() const { return _algorithm; }
+
+private:
+  common::key_hash_t _algorithm;
+};
+
+/**
+ * Handle on a pool heap, as used by one partition. The MM plugin heap
+ * is not thread safe, so each call is serialised by the (shared) plugin
+ * mutex; the mutex is held only for the duration of the plugin call.
+ */
+class Allocator_handle {
+public:
+  Allocator_handle(MM_plugin_wrapper &heap, std::mutex &heap_mutex)
+    : _heap(&heap), _heap_mutex(&heap_mutex)
+  {}
+
+  /* throws std::bad_alloc on failure */
+  void *allocate(std::size_t n, std::size_t alignment) const;
+  void deallocate(void *p, std::size_t n) const;
+  /* mark p, of size n, as allocated (on reopening a pool image); throws General_exception on failure */
+  void inject(void *p, std::size_t n) const;
+
+private:
+  /* the least size the plugins accept (rcalb rejects smaller objects); smaller
+   * requests are rounded up, in deallocate and inject as in allocate */
+  static constexpr std::size_t min_size = 8;
+  static std::size_t size(std::size_t n) { return std::max(n, min_size); }
+
+  MM_plugin_wrapper *_heap;
+  std::mutex        *_heap_mutex;
+};
+
+/**
+ * Key-value index of a pool. Keys are split over a power-of-two number of
+ * partitions by the high bits of their hash; each partition is an
+ * open-addressing table with its own reader/writer lock, so that
+ * operations on keys in different partitions do not contend.
+ *
+ * Within a partition, slots are kept in hash order: the home slot of a
+ * hash is taken from its bits below the partition bits, and linear
+ * probing inserts in order (shifting later entries up) rather than at the
+ * first free slot. The slot array has some slack past its capacity in
+ * place of wrap-around. So the whole map is ordered by hash, and a hash
+ * is a position which survives inserts, erases and growth: iteration
+ * resumes from "the first hash not yet visited".
+ *
+ * Partitions are assigned to heaps (one per NUMA node, in a NUMA
+ * partitioned pool) in contiguous blocks, so each heap holds a contiguous
+ * hash range.
+ *
+ * Key blocks and slot arrays are allocated from the partition's heap: key
+ * pointers handed out by lock() and the pool iterator must be valid in
+ * the ADO. Slots move on insert, erase and growth, so a slot pointer is
+ * valid only while the partition lock is held. Key blocks do not move,
+ * which is why the value lock lives there. Slots refer to key blocks and
+ * values by offset_ptr, so that the slot arrays of a pool image may be
+ * mapped at any address.
+ */
+class Partitioned_map {
+public:
+  using string_view_key = component::IKVStore::string_view_key;
+
+  /* Per-key allocation: the value lock, followed by the key bytes. Its
+   * address is the key handle returned by lock().
+   */
+  struct key_block {
+    Value_lock _lock;
+
+    key_block() : _lock() {}
+    /* rounded up, because an aligned allocation must be a multiple of its alignment */
+    static std::size_t size(std::size_t key_len) { return round_up_t(sizeof(key_block) + key_len, alignof(key_block)); }
+    common::byte *key() { return reinterpret_cast<common::byte *>(this + 1); }
+  };
+
+  struct slot {
+    std::uint64_t   _hash;
+    std::uint64_t   _version; /*< map version at which the key was created */
+    offset_ptr<key_block> _key_block; /*< null: slot is empty */
+    std::size_t     _key_len;
+    value_type      _value;
+
+    common::byte *key_ptr() const { return _key_block->key(); }
+    string_view_key key() const { return string_view_key(key_ptr(), _key_len); }
+    Value_lock &lock() const { return _key_block->_lock; }
+    bool in_use() const { return bool(_key_block); }
+  };
+
+  /* A partition as recorded in a pool image: offsets are from the image base */
+  struct partition_image {
+    std::uint64_t _slots; /*< 0: no slot array */
+    std::uint64_t _slot_count;
+    std::uint64_t _count;
+    std::uint32_t _capacity_bits;
+    std::uint32_t _reserved;
+  };
+
+  class partition {
+  public:
+    partition(const Allocator_handle &heap, unsigned partition_bits)
+      : _lock{}, _heap(heap), _partition_bits(partition_bits)
+      , _slots(nullptr), _capacity_bits(0), _slot_count(0), _count(0), _hits(0)
+    {}
+    partition(const partition &) = delete;
+    partition &operator=(const partition &) = delete;
+    ~partition();
+
+    /* caller holds lock(); a successful find counts as a hit */
+    slot *find(std::uint64_t hash, string_view_key key) const;
+    /* caller holds lock() for WRITE; key must not be present */
+    slot &emplace(std::uint64_t hash, string_view_key key, value_type &&value, std::uint64_t version);
+    /* caller holds lock() for WRITE; frees the key block, not the value */
+    void erase(slot &s);
+    /* caller holds lock(); index of the first slot which is empty or has a hash >= hash */
+    std::size_t lower_bound(std::uint64_t hash) const;
+
+    /* pool images; the caller ensures that there are no other users */
+    partition_image save(const common::byte *base) const;
+    /* forget the entries, without freeing them: their memory belongs to the image */
+    void release();
+    /* adopt the entries of an image, injecting the slot array and key blocks into the heap */
+    void restore(const partition_image &image, common::byte *base);
+
+    common::RWLock &lock() const { return _lock; }
+    /* the heap for values of keys in this partition */
+    const Allocator_handle &heap() const { return _heap; }
+    std::size_t size() const { return _count.load(std::memory_order_relaxed); }
+    std::uint64_t hits() const { return _hits.load(std::memory_order_relaxed); }
+    /* caller holds lock() */
+    std::size_t slot_count() const { return _slot_count; }
+    /* caller holds lock() */
+    slot &at(std::size_t i) const { return _slots[i]; }
+
+  private:
+    /* home slot: the hash bits just below the partition bits */
+    std::size_t home(std::uint64_t hash, unsigned capacity_bits) const
+    {
+      return std::size_t((hash << _partition_bits) >> (64U - capacity_bits));
+    }
+    std::size_t home(std::uint64_t hash) const { return home(hash, _capacity_bits); }
+    std::size_t capacity() const { return _slots ? std::size_t(1) << _capacity_bits : 0; }
+    /* slots past the capacity, in place of wrap-around */
+    static std::size_t slack(std::size_t capacity) { return std::min(capacity, std::size_t(64)); }
+    /* slot arrays are cache line aligned, and an aligned allocation must be a multiple of its alignment */
+    static constexpr std::size_t slot_array_alignment = alignof(slot) < 64 ? 64 : alignof(slot);
+    static std::size_t slot_array_size(std::size_t slot_count) { return round_up_t(slot_count * sizeof(slot), slot_array_alignment); }
+    void grow();
+    void free_key_block(slot &s);
+
+    mutable common::RWLock   _lock;
+    Allocator_handle         _heap;
+    unsigned                 _partition_bits;
+    slot *                   _slots;
+    unsigned                 _capacity_bits;
+    std::size_t              _slot_count; /*< capacity + slack */
+    std::atomic<std::size_t> _count;
+    mutable std::atomic<std::uint64_t> _hits;
+  } __attribute__((aligned(64))); /* partitions should not share cache lines */
+
+  /* partition_count is rounded up to a power of 2, and to at least the number of heaps */
+  Partitioned_map(const Key_hash &hasher,
+                  unsigned partition_count,
+                  const std::vector<Allocator_handle> &heaps);
+
+  std::uint64_t hash(string_view_key key) const { return _hasher(key); }
+
+  partition &locate(std::uint64_t hash) const { return *_partitions[partition_index(hash)]; }
+  unsigned partition_index(std::uint64_t hash) const { return _shift == 64 ? 0 : unsigned(hash >> _shift); }
+  unsigned partition_count() const { return 1U << (64U - _shift); }
+  partition &at(unsigned i) const { return *_partitions[i]; }
+  /* the partitions of heap h are [first_partition(h), first_partition(h+1)) */
+  unsigned heap_count() const { return _heap_count; }
+  unsigned heap_index(unsigned partition_ix) const { return unsigned(std::uint64_t(partition_ix) * _heap_count / partition_count()); }
+  unsigned first_partition(unsigned heap) const { return unsigned((std::uint64_t(heap) * partition_count() + _heap_count - 1) / _heap_count); }
+
+  /* sum of the partition sizes; not a snapshot while writers are active */
+  std::size_t size() const;
+
+  /* pool images (see partition); the caller ensures that there are no other users */
+  void save(partition_image *table, const common::byte *base) const;
+  void release();
+  /* restore from table, passing each value to adopt_value (for injection into its heap) */
+  template <typename F>
+    void restore(const partition_image *table, common::byte *base, std::uint64_t version, F adopt_value)
+    {
+      for ( unsigned p = 0; p != partition_count(); ++p )
+      {
+        auto &part = at(p);
+        part.restore(table[p], base);
+        for ( std::size_t i = 0; i != part.slot_count(); ++i )
+        {
+          if ( part.at(i).in_use() )
+            adopt_value(part.at(i)._value);
+        }
+      }
+      _version.store(version, std::memory_order_release);
+    }
+
+  /* versions order key creation; a snapshot is the current version */
+  std::uint64_t version() const { return _version.load(std::memory_order_acquire); }
+  std::uint64_t next_version() { return _version.fetch_add(1, std::memory_order_acq_rel) + 1; }
+
+  /**
+   * Visit, in hash order, the entries with hashes in [first, last] which
+   * were created at or before version snapshot. Each partition is locked
+   * (READ) while it is visited. Entries with equal hashes are visited in
+   * one lock hold, so that a hash is a complete position.
+   *
+   * f(const slot &) returns false to stop; the entries with the same hash
+   * as the stopping entry are still visited.
+   *
+   * @return true, with resume set to the first hash not visited, if
+   *   stopped before last; false if [first, last] has been visited
+   */
+  template <typename F>
+    bool visit(std::uint64_t first, std::uint64_t last, std::uint64_t snapshot, std::uint64_t &resume, F f) const
+    {
+      bool stop = false;
+      std::uint64_t stop_hash = 0;
+      for ( auto p = partition_index(first); ; ++p )
+      {
+        const auto &part = at(p);
+        common::RWLock_guard g(part.lock());
+        for ( auto i = part.lower_bound(first); i != part.slot_count(); ++i )
+        {
+          const auto &s = part.at(i);
+          if ( ! s.in_use() ) continue;
+          if ( last < s._hash ) return false;
+          if ( stop && s._hash != stop_hash ) { resume = s._hash; return true; }
+          if ( s._version <= snapshot && ! f(s) && ! stop ) { stop = true; stop_hash = s._hash; }
+        }
+        if ( p == partition_index(last) ) return false;
+        first = std::uint64_t(p + 1) << _shift; /* start of the next partition */
+        if ( stop ) { resume = first; return true; }
+      }
+    }
+
+  const Key_hash &hasher() const { return _hasher; }
+
+private:
+  Key_hash                     _hasher;
+  unsigned                     _shift; /*< 64 - log2(partition count) */
+  unsigned                     _heap_count;
+  std::atomic<std::uint64_t>   _version;
+  std::vector<std::unique_ptr<partition>> _partitions;
+};
+
+#endif
@@ -0,0 +1,207 @@
+/*
+  Copyright [2017-2021] [IBM Corporation]
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+  http://www.apache.org/licenses/LICENSE-2.0
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+#include "pool_image.h"
+
+#include <common/exceptions.h>
+#include <common/logging.h>
+#include <common/utils.h> /* round_up_page */
+#include <sys/mman.h> /* mmap, msync, madvise */
+#include <sys/stat.h> /* fstat */
+#include <unistd.h> /* ftruncate, pread */
+#include <algorithm> /* max */
+#include <cerrno>
+#include <cstring> /* strerror */
+#include <new> /* placement new */
+
+namespace
+{
+  std::size_t header_size(unsigned partition_count)
+  {
+    return
+      round_up_page(sizeof(Pool_image::header) + partition_count * sizeof(Partitioned_map::partition_image));
+  }
+}
+
+common::byte *Pool_image::reserve(const std::size_t size)
+{
+  auto p = ::mmap(nullptr, size, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+  if ( p == MAP_FAILED )
+  {
+    auto e = errno;
+    throw General_exception("%s: cannot reserve %zu bytes for pool image: %s", __func__, size, strerror(e));
+  }
+  return static_cast<common::byte *>(p);
+}
+
+Pool_image::Pool_image(const unsigned debug_level_, const int fd_, common::byte *const base_, const std::size_t reserved_)
+  : _debug_level(debug_level_)
+  , _fd(fd_)
+  , _base(base_)
+  , _reserved(reserved_)
+{
+}
+
+Pool_image::Pool_image(const unsigned debug_level_,
+                       const int fd_,
+                       const std::size_t reserve_,
+                       const unsigned flags_,
+                       const unsigned partition_count_,
+                       const unsigned heap_count_)
+  : Pool_image(debug_level_, fd_, reserve(reserve_), reserve_)
+{
+  const auto size = header_size(partition_count_);
+  /* (the delegated constructor has completed, so the destructor releases the reservation) */
+  if ( size > _reserved || ::ftruncate(_fd, off_t(size)) != 0 || ! map(0, size) )
+  {
+    throw General_exception("%s: cannot create pool image header", __func__);
+  }
+
+  auto &h = *new (_base) header{};
+  h._magic = MAGIC;
+  h._format = FORMAT;
+  h._clean = 0;
+  h._slot_size = sizeof(Partitioned_map::slot);
+  h._header_size = size;
+  h._file_size = size;
+  h._map_version = 0;
+  h._flags = flags_;
+  h._partition_count = partition_count_;
+  h._heap_count = heap_count_;
+  h._region_count = 0;
+  sync(0, size);
+  CFLOGM(1, "new pool image base {} header {} partitions {}", common::p_fmt(_base), size, partition_count_);
+}
+
+Pool_image::~Pool_image()
+{
+  ::munmap(_base, _reserved);
+}
+
+auto Pool_image::open(const unsigned debug_level, const int fd, const std::size_t reserve_) -> std::unique_ptr<Pool_image>
+{
+  struct ::stat st;
+  header h;
+  if ( ::fstat(fd, &st) != 0 || std::size_t(st.st_size) < sizeof h || ::pread(fd, &h, sizeof h, 0) != ssize_t(sizeof h) )
+  {
+    return nullptr;
+  }
+
+  const auto file_size = std::size_t(st.st_size);
+  const char *problem =
+    h._magic != MAGIC ? "not a pool image"
+    : h._format != FORMAT ? "unknown image format"
+    : h._clean == 0 ? "image was not closed"
+    : h._slot_size != sizeof(Partitioned_map::slot) ? "slot layout differs"
+    : h._partition_count == 0 || (h._partition_count & (h._partition_count - 1)) != 0 ? "bad partition count"
+    : h._header_size != header_size(h._partition_count) ? "bad header size"
+    : h._file_size != file_size ? "file size differs"
+    : h._region_count > max_regions || h._heap_count == 0 ? "bad region table"
+    : nullptr
+    ;
+
+  for ( unsigned i = 0; ! problem && i != h._region_count; ++i )
+  {
+    const auto &r = h._regions[i];
+    if ( r._offset < h._header_size || file_size < r._offset + r._length || h._heap_count <= r._heap )
+      problem = "bad region";
+  }
+
+  if ( problem )
+  {
+    FWRN("not reopening pool image: {}", problem);
+    return nullptr;
+  }
+
+  /* leave room to grow */
+  const auto reserved = std::max(reserve_, 2 * file_size);
+  std::unique_ptr<Pool_image> image(new Pool_image(debug_level, fd, reserve(reserved), reserved));
+  if ( ! image->map(0, file_size) )
+  {
+    FWRN("not reopening pool image: cannot map {} bytes", file_size);
+    return nullptr;
+  }
+
+  for ( unsigned p = 0; p != h._partition_count; ++p )
+  {
+    const auto &pi = image->partitions()[p];
+    if ( pi._slots && ( pi._slots < h._header_size || file_size < pi._slots + pi._slot_count * sizeof(Partitioned_map::slot) ) )
+    {
+      FWRN("not reopening pool image: bad partition {}", p);
+      return nullptr;
+    }
+  }
+
+  if ( 1 < debug_level )
+  {
+    FLOG("reopened pool image base {} size {}", common::p_fmt(image->base()), file_size);
+  }
+  return image;
+}
+
+bool Pool_image::map(const std::size_t offset, const std::size_t size)
+{
+  auto p = ::mmap(_base + offset, size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_FIXED, _fd, off_t(offset));
+  return p != MAP_FAILED;
+}
+
+void *Pool_image::extend(const std::size_t size)
+{
+  const auto offset = hdr()._file_size;
+  if ( _reserved < offset + size || ::ftruncate(_fd, off_t(offset + size)) != 0 || ! map(offset, size) )
+  {
+    return nullptr;
+  }
+  hdr()._file_size = offset + size;
+  return _base + offset;
+}
+
+void Pool_image::add_region(const void *p, const std::size_t length, const unsigned heap)
+{
+  auto &h = hdr();
+  if ( max_regions <= h._region_count )
+    throw Logic_exception("%s: region table full", __func__);
+  h._regions[h._region_count] = region{std::uint64_t(static_cast<const common::byte *>(p) - _base), length, heap, 0};
+  ++h._region_count;
+}
+
+void Pool_image::prefetch() const
+{
+  /* readahead is asynchronous */
+  if ( ::madvise(_base, hdr()._file_size, MADV_WILLNEED) != 0 )
+  {
+    CFLOGM(1, "pool image prefetch failed: {}", errno);
+  }
+}
+
+void Pool_image::sync(const std::size_t offset, const std::size_t size)
+{
+  if ( ::msync(_base + offset, size, MS_SYNC) != 0 )
+  {
+    FWRNM("pool image msync failed: {}", errno);
+  }
+}
+
+void Pool_image::set_dirty()
+{
+  hdr()._clean = 0;
+  sync(0, hdr()._header_size);
+}
+
+void Pool_image::close()
+{
+  /* contents first, so that a clean image is complete */
+  sync(0, hdr()._file_size);
+  hdr()._clean = 1;
+  sync(0, hdr()._header_size);
+}
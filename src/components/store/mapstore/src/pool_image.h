@@ -0,0 +1,116 @@
+/*
+  Copyright [2017-2021] [IBM Corporation]
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+  http://www.apache.org/licenses/LICENSE-2.0
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+#ifndef _MCAS_MAPSTORE_POOL_IMAGE_H_
+#define _MCAS_MAPSTORE_POOL_IMAGE_H_
+
+#include "partitioned_map.h"
+
+#include <common/byte.h>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+/**
+ * Pool image: the backing file of a restartable pool (MAPSTORE_RESTARTABLE),
+ * which holds the pool's key map as well as its values, so that the pool
+ * can be reopened by a later process without reloading it.
+ *
+ * The file is a header followed by the heap regions, and is always mapped
+ * as one contiguous range within an address space reservation (so that
+ * regions added by grow_pool follow on). Slot arrays refer to key blocks
+ * and values by offset_ptr, and the header to slot arrays and regions by
+ * file offset, so the image may be mapped at any address.
+ *
+ * The MM plugin heaps are not part of the image: on reopen, the regions
+ * are added to fresh heaps and every allocation reachable from the key map
+ * is injected (so the plugin must support inject_allocation). Memory from
+ * allocate_pool_memory is not reachable, and is not preserved.
+ *
+ * The image is valid only after an orderly close (the header is marked
+ * clean); mapstore is not crash consistent.
+ */
+class Pool_image {
+public:
+  static constexpr std::uint64_t MAGIC = 0x31474d4950414d4dULL; /* "MMAPIMG1" */
+  static constexpr std::uint32_t FORMAT = 1;
+  static constexpr unsigned max_regions = 1024;
+
+  struct region {
+    std::uint64_t _offset; /*< in the file */
+    std::uint64_t _length;
+    std::uint32_t _heap;
+    std::uint32_t _reserved;
+  };
+
+  struct header {
+    std::uint64_t _magic;
+    std::uint32_t _format;
+    std::uint32_t _clean; /*< nonzero after an orderly close */
+    std::uint64_t _slot_size; /*< sizeof(Partitioned_map::slot), for the slot layout */
+    std::uint64_t _header_size; /*< offset of the first region */
+    std::uint64_t _file_size;
+    std::uint64_t _map_version;
+    std::uint32_t _flags; /*< create_pool flags */
+    std::uint32_t _partition_count;
+    std::uint32_t _heap_count;
+    std::uint32_t _region_count;
+    region        _regions[max_regions];
+    /* followed by _partition_count Partitioned_map::partition_image */
+  };
+
+  /* new image in file fd, which is empty */
+  Pool_image(unsigned debug_level, int fd, std::size_t reserve,
+             unsigned flags, unsigned partition_count, unsigned heap_count);
+  Pool_image(const Pool_image &) = delete;
+  Pool_image &operator=(const Pool_image &) = delete;
+  ~Pool_image();
+
+  /* existing image in file fd; nullptr if the file does not hold a valid, clean image */
+  static std::unique_ptr<Pool_image> open(unsigned debug_level, int fd, std::size_t reserve);
+
+  common::byte *base() const { return _base; }
+  header &hdr() const { return *reinterpret_cast<header *>(_base); }
+  Partitioned_map::partition_image *partitions() const
+  {
+    return reinterpret_cast<Partitioned_map::partition_image *>(&hdr() + 1);
+  }
+
+  bool can_add_regions(unsigned n) const { return hdr()._region_count + n <= max_regions; }
+  /* extend the file by size bytes, mapped after the current end; nullptr on failure */
+  void *extend(std::size_t size);
+  /* record memory returned by extend as a region of heap */
+  void add_region(const void *p, std::size_t length, unsigned heap);
+
+  /* start reading the whole image, asynchronously */
+  void prefetch() const;
+  /* mark the image as in use (not clean) */
+  void set_dirty();
+  /* write the image back and mark it clean */
+  void close();
+
+private:
+  Pool_image(unsigned debug_level, int fd, common::byte *base, std::size_t reserved);
+
+  static common::byte *reserve(std::size_t size);
+  bool map(std::size_t offset, std::size_t size);
+  void sync(std::size_t offset, std::size_t size);
+  unsigned debug_level() const { return _debug_level; }
+
+  unsigned      _debug_level;
+  int           _fd;
+  common::byte *_base;
+  std::size_t   _reserved; /*< size of the address space reservation at _base */
+};
+
+#endif
@@ -13,6 +13,7 @@
 
 #include "pool_instance.h"
 
+#include "region_memory_image.h"
 #include "region_memory_mmap.h"
 #include "region_memory_numa.h"
 
@@ -25,37 +26,44 @@
 #include <sys/types.h> /* open */
 #include <sys/stat.h> /* open stat */
 #include <fcntl.h> /* open */
+#include <numa.h> /* numa_node_of_cpu, numa_tonode_memory */
+#include <sched.h> /* sched_getcpu */
 #include <unistd.h> /* ftruncate, syncfs */
+#include <limits> /* numeric_limits */
 #include <numeric> /* accumulate */
 
 #define DEFAULT_ALIGNMENT 8
-#define SINGLE_THREADED
 #define MIN_POOL (1ULL << DM_REGION_LOG_GRAIN_SIZE)
 
-/*
- * There is one use of new (but not delete): RWLock.
- *  - RWLock used placement new and custom allocator/deallocator
- */
 namespace
 {
-  int open_region_file(const common::string_view pool_name)
+  /* empty if there is no backing store directory */
+  std::string backing_file_name(const common::string_view pool_name)
   {
     char * backing_store_dir = ::getenv("MAPSTORE_BACKING_STORE_DIR");
     if ( backing_store_dir )
     {
-      /* create file */
       struct stat st;
       if (::stat(backing_store_dir,&st) == 0) {
-        if (st.st_mode & (S_IFDIR != 0)) {
+        if (S_ISDIR(st.st_mode)) {
           using namespace std::string_literals;
-          std::string filename = backing_store_dir + "/mapstore_backing_"s + std::string(pool_name) + ".dat";
-
-          ::mode_t mode = S_IRUSR | S_IWUSR | S_IRGRP | S_IROTH;
-          FINF("backing file ({}))", filename);
-          return ::open(filename.c_str(), O_RDWR | O_CREAT | O_TRUNC, mode);
+          return backing_store_dir + "/mapstore_backing_"s + std::string(pool_name) + ".dat";
         }
       }
     }
+    return std::string();
+  }
+
+  /* create (truncate) the backing file, or open an existing one */
+  int open_region_file(const common::string_view pool_name, bool create = true)
+  {
+    const auto filename = backing_file_name(pool_name);
+    if ( ! filename.empty() )
+    {
+      ::mode_t mode = S_IRUSR | S_IWUSR | S_IRGRP | S_IROTH;
+      FINF("backing file ({}))", filename);
+      return ::open(filename.c_str(), O_RDWR | (create ? O_CREAT | O_TRUNC : 0), mode);
+    }
     return -1;
   }
 
@@ -69,53 +77,266 @@ namespace
     return 1;
   }
 
-  const bool needs_pinned_pages = ! common::env_value("USE_ODP", true);
+  /* floor(p * 2^64 / n) for p <= n, without 128-bit arithmetic: with
+   * 2^64 = n * q + r1, it is p * q + p * r1 / n, where p * r1 <= n * n.
+   * For p == n the result wraps to 0, so that the last hash of partition
+   * n - 1 (one less) is the maximum hash.
+   */
+  std::uint64_t hash_range_start(const unsigned p, const unsigned n)
+  {
+    const auto q = std::numeric_limits<std::uint64_t>::max() / n;
+    const auto r1 = std::numeric_limits<std::uint64_t>::max() % n + 1U;
+    return std::uint64_t(p) * q + std::uint64_t(p) * r1 / n;
+  }
 
-  struct dummy_guard /* dummy guard */
+  common::key_hash_t hash_algorithm(unsigned flags)
   {
-    dummy_guard(common::RWLock &, int = common::RWLock_guard::READ) {}
-  };
+    using IKVStore = component::IKVStore;
+    const auto h = (flags & IKVStore::FLAGS_HASH_MASK) >> IKVStore::FLAGS_HASH_SHIFT;
+    if ( h > unsigned(common::key_hash_t::KEY_HASH_CRC32C) )
+      throw API_exception("create_pool: unknown hash flags 0x%x", flags & IKVStore::FLAGS_HASH_MASK);
+    return common::key_hash_t(h);
+  }
+
+  const bool needs_pinned_pages = ! common::env_value("USE_ODP", true);
+
+  /* key map partitions per pool (rounded up to a power of 2) */
+  const unsigned map_partitions = common::env_value("MAPSTORE_PARTITIONS", 64U);
+
+  /* split pools with a multi-node NUMA mask into one heap (and hash range) per node */
+  const bool numa_partitioned = common::env_value("MAPSTORE_NUMA_PARTITIONED", false);
+
+  /* keep pools in the backing store across restarts (see Pool_image) */
+  const bool restartable = common::env_value("MAPSTORE_RESTARTABLE", false);
+  /* on reopen, start reading the pool image in the background */
+  const bool prefetch_image = common::env_value("MAPSTORE_PREFETCH", false);
+  /* address space reserved for a pool image, which bounds its growth */
+  const std::size_t image_reserve = common::env_value<std::size_t>("MAPSTORE_IMAGE_RESERVE", std::size_t(1) << 40);
 
-#ifdef SINGLE_THREADED
-  using RWLock_guard = dummy_guard;
-#else /* real guard */
   using RWLock_guard = common::RWLock_guard;
-#endif
 }
 
 Pool_instance::Pool_instance(const unsigned debug_level,
                 common::string_view mm_plugin_path,
                 common::string_view name_,
-                size_t nsize,
                 const bitmask *numa_node_mask_,
-                unsigned flags_)
+                unsigned flags_,
+                int fd_,
+                unsigned partition_count_)
     : _debug_level(debug_level),
       _ref_mutex{},
       _nsize(0),
       _numa_node_mask(numa_node_mask_),
       _name(name_),
-      _fdout(open_region_file(_name)),
-      _regions{},
-      _mm_plugin_mutex{},
-      _mm_plugin(std::string(mm_plugin_path)), /* plugin path for heap allocator */
-      _map_lock{},
-      _map(std::make_unique<map_t>(aam_t(_mm_plugin))),
+      _fdout(fd_),
+      _image(),
+      _retain_image(false),
+      _reopened(false),
+      _deleted(false),
+      _heaps(make_heaps(std::string(mm_plugin_path), numa_node_mask_)), /* plugin path for heap allocator */
+      _map(Key_hash(hash_algorithm(flags_)), partition_count_, handles(_heaps)),
       _flags{flags_},
-      _iterators{},
-      _writes{}
+      _iterators_mutex{},
+      _iterators{}
 {
+}
+
+Pool_instance::Pool_instance(const unsigned debug_level,
+                common::string_view mm_plugin_path,
+                common::string_view name_,
+                size_t nsize,
+                const bitmask *numa_node_mask_,
+                unsigned flags_)
+    : Pool_instance(debug_level, mm_plugin_path, name_, numa_node_mask_, flags_, open_region_file(name_), map_partitions)
+{
+  if ( restartable && 0 <= _fdout )
+  {
+    _image = std::make_unique<Pool_image>(debug_level, _fdout, image_reserve, _flags, _map.partition_count(), unsigned(_heaps.size()));
+  }
   grow_pool(nsize < MIN_POOL ? MIN_POOL : nsize, _nsize);
+  _retain_image = bool(_image);
   CFLOGM(1, "new pool instance {}", name_);
 }
 
+Pool_instance::Pool_instance(const unsigned debug_level,
+                common::string_view mm_plugin_path,
+                common::string_view name_,
+                const bitmask *numa_node_mask_,
+                int fd_,
+                std::unique_ptr<Pool_image> image_)
+    : Pool_instance(debug_level, mm_plugin_path, name_, numa_node_mask_, image_->hdr()._flags, fd_, image_->hdr()._partition_count)
+{
+  _image = std::move(image_);
+  /* if restore_image throws, the destructor runs: it must leave the image as it found it */
+  _reopened = true;
+  restore_image();
+  CFLOGM(1, "reopened pool instance {} ({} keys)", name_, _map.size());
+}
+
+auto Pool_instance::reopen(const unsigned debug_level,
+                           const common::string_view mm_plugin_path,
+                           const common::string_view name,
+                           const bitmask *numa_node_mask) -> std::shared_ptr<Pool_instance>
+{
+  if ( ! restartable ) return nullptr;
+
+  const auto fd = open_region_file(name, false);
+  if ( fd < 0 ) return nullptr;
+
+  auto image = Pool_image::open(debug_level, fd, image_reserve);
+  if ( ! image )
+  {
+    ::close(fd);
+    return nullptr;
+  }
+
+  try
+  {
+    /* on failure the partly constructed pool instance closes fd, leaving the image in place */
+    return std::make_shared<Pool_instance>(debug_level, mm_plugin_path, name, numa_node_mask, fd, std::move(image));
+  }
+  catch ( const General_exception &e )
+  {
+    FWRN("cannot reopen pool {}: {}", name, e.cause());
+    return nullptr;
+  }
+}
+
+bool Pool_instance::delete_image(const common::string_view name)
+{
+  if ( ! restartable ) return false;
+  const auto filename = backing_file_name(name);
+  return ! filename.empty() && ::unlink(filename.c_str()) == 0;
+}
+
+void Pool_instance::restore_image()
+{
+  if ( prefetch_image )
+    _image->prefetch();
+
+  const auto &hdr = _image->hdr();
+  if ( hdr._heap_count != _heaps.size() )
+    throw General_exception("pool image has %u heaps, NUMA mask gives %zu", unsigned(hdr._heap_count), _heaps.size());
+  for ( const auto &h : _heaps )
+  {
+    if ( ! h->_plugin.can_inject_allocation() )
+      throw General_exception("MM plugin cannot inject allocations, required to reopen a pool image");
+  }
+
+  for ( unsigned i = 0; i != hdr._region_count; ++i )
+  {
+    const auto &r = hdr._regions[i];
+    auto &h = *_heaps[r._heap];
+    auto p = _image->base() + r._offset;
+    std::lock_guard g{h._mutex};
+    h._plugin.add_managed_region(p, r._length);
+    h._regions.push_back(std::make_unique<region_memory_image>(debug_level(), p, r._length));
+    _nsize += r._length;
+  }
+
+  _map.restore(_image->partitions(), _image->base(), hdr._map_version,
+               [this] (value_type &v)
+               {
+                 value_heap(v._ptr).inject(v._ptr, v._length);
+               });
+
+  /* from here on the image changes with the pool; it is valid again after save_image */
+  _image->set_dirty();
+  _retain_image = true;
+}
+
+void Pool_instance::save_image()
+{
+  _map.save(_image->partitions(), _image->base());
+  _image->hdr()._map_version = _map.version();
+  _image->close();
+  CFLOGM(1, "saved pool image {} ({} keys)", _name, _map.size());
+}
+
+auto Pool_instance::make_heaps(const std::string &plugin_path, const bitmask *node_mask) -> std::vector<std::unique_ptr<heap>>
+{
+  std::vector<std::unique_ptr<heap>> heaps;
+  if ( numa_partitioned && 1 < numa_bitmask_weight(node_mask) )
+  {
+    for ( unsigned n = 0; n != node_mask->size; ++n )
+    {
+      if ( numa_bitmask_isbitset(node_mask, n) )
+      {
+        numa_node_mask m(std::to_string(n));
+        heaps.emplace_back(std::make_unique<heap>(plugin_path, m.get(), int(n)));
+      }
+    }
+  }
+  else
+  {
+    heaps.emplace_back(std::make_unique<heap>(plugin_path, node_mask, -1));
+  }
+  return heaps;
+}
+
+Pool_instance::heap::heap(const std::string &plugin_path, const bitmask *node_mask, int node)
+  : _node(node), _node_mask(node_mask), _mutex{}, _plugin(plugin_path), _regions{}, _handle(_plugin, _mutex)
+{
+}
+
+Pool_instance::heap::~heap()
+{
+}
+
+std::vector<Allocator_handle> Pool_instance::handles(const std::vector<std::unique_ptr<heap>> &heaps)
+{
+  std::vector<Allocator_handle> v;
+  for ( const auto &h : heaps )
+    v.push_back(h->_handle);
+  return v;
+}
+
+unsigned Pool_instance::local_heap() const
+{
+  if ( _heaps.size() == 1 ) return 0;
+
+  const auto cpu = ::sched_getcpu();
+  const auto node = cpu < 0 ? -1 : numa_node_of_cpu(cpu);
+  for ( unsigned i = 0; i != _heaps.size(); ++i )
+    if ( _heaps[i]->_node == node ) return i;
+  return 0;
+}
+
+auto Pool_instance::heap_containing(const void *p) const -> heap &
+{
+  if ( _heaps.size() != 1 )
+  {
+    const auto c = static_cast<const char *>(p);
+    for ( const auto &h : _heaps )
+    {
+      std::lock_guard g{h->_mutex};
+      for ( const auto &r : h->_regions )
+      {
+        const auto base = static_cast<const char *>(r->iov_base);
+        if ( base <= c && c < base + r->iov_len ) return *h;
+      }
+    }
+  }
+  return *_heaps.front();
+}
+
 Pool_instance::~Pool_instance()
 {
   CFLOGM(1, "freeing regions for pool ({})", _name);
 
+  if ( _image )
+  {
+    if ( _retain_image && ! _deleted )
+      save_image();
+    /* the key map memory belongs to the image, as does that of partitions
+     * restored before a failed reopen: forget it rather than free it */
+    _map.release();
+  }
+
   if ( 0 <= _fdout )
   {
-    /* github 185: clear memory on pool deletion */
-    if ( 0 != ::ftruncate(_fdout, 0) )
+    /* github 185: clear memory on pool deletion (a retained or reopened image is not deleted) */
+    if ( ( _deleted || ! ( _retain_image || _reopened ) ) && 0 != ::ftruncate(_fdout, 0) )
     {
       FWRNM("error {} truncating backing file, data may leak", errno);
     }
@@ -137,76 +358,76 @@ status_t Pool_instance::put(string_view_key key,
   common::string_view key_svc(common::pointer_cast<char>(key.data()), key.size());
   CFLOGM(2, "({}) {}", key_svc, common::string_view(static_cast<const char *>(value), value_len));
 
-  RWLock_guard guard(_map_lock, common::RWLock_guard::WRITE);
-
-  write_touch(); /* this could be early, but over-conservative is ok */
+  const auto h = _map.hash(key);
+  auto &part = _map.locate(h);
+  RWLock_guard guard(part.lock(), common::RWLock_guard::WRITE);
 
-  std::lock_guard g{_mm_plugin_mutex}; /* aac, _mm_plugin.aligned_allocate, aal */
-  string_t k(key.data(), key.length(), aac);
+  auto i = part.find(h, key);
 
-  auto i = _map->find(k);
-
-  if (i != _map->end()) {
+  if (i) {
 
     if (flags & IKVStore::FLAGS_DONT_STOMP) {
       PWRN("put refuses to stomp (%*.s)", int(key.size()), common::pointer_cast<char>(common::pointer_cast<char>(key.data())));
       return IKVStore::E_KEY_EXISTS;
     }
 
+    auto &p = i->_value;
+    auto &value_lock = i->lock();
+
     /* take lock */
     int rc;
-    if((rc = (*_map)[k]._value_lock->write_trylock()) != 0) {
+    if((rc = value_lock.write_trylock()) != 0) {
       PWRN("put refuses, already locked (%d)",rc);
       assert(rc == EBUSY);
       return E_LOCKED;
     }
 
-    auto &p = i->second;
-
     if (p._length == value_len) {
       memcpy(p._ptr, value, value_len);
     }
     else {
       /* different size, reallocate */
-      auto p_to_free = p._ptr;
+      void *p_to_free = p._ptr;
       auto len_to_free = p._length;
 
       CFLOGM(3, "allocating {} bytes alignment {}", value_len, choose_alignment(value_len));
 
-      if(_mm_plugin.aligned_allocate(value_len, choose_alignment(value_len),&p._ptr) != S_OK)
+      void *buffer;
+      try { buffer = part.heap().allocate(value_len, choose_alignment(value_len)); }
+      catch(const std::bad_alloc &) {
+        value_lock.unlock();
         throw General_exception("plugin aligned_allocate failed");
+      }
 
-      memcpy(p._ptr, value, value_len);
+      memcpy(buffer, value, value_len);
 
       /* update entry */
-      i->second._length = value_len;
-      i->second._ptr = p._ptr;
+      p._length = value_len;
+      p._ptr = buffer;
 
       /* release old memory*/
-      try {  _mm_plugin.deallocate(&p_to_free, len_to_free);      }
+      try {  value_heap(p_to_free).deallocate(p_to_free, len_to_free);      }
       catch(...) {  throw Logic_exception("unable to release old value memory");   }
     }
 
     wmb();
-    i->second._tsc.update(); /* update timestamp */
+    p._tsc.update(); /* update timestamp */
 
     /* release lock */
-    (*_map)[k]._value_lock->unlock();
+    value_lock.unlock();
   }
   else { /* key does not already exist */
 
     CFLOGM(3, "allocating {} bytes alignment {}", value_len, choose_alignment(value_len));
 
     void * buffer = nullptr;
-    if(_mm_plugin.aligned_allocate(value_len, choose_alignment(value_len), &buffer) != S_OK)
-      throw General_exception("memory plugin aligned_allocate failed");
+    try { buffer = part.heap().allocate(value_len, choose_alignment(value_len)); }
+    catch(const std::bad_alloc &) { throw General_exception("memory plugin aligned_allocate failed"); }
 
     memcpy(buffer, value, value_len);
-    //    common::RWLock * p = new (aal.allocate(1, DEFAULT_ALIGNMENT)) common::RWLock();
-    common::RWLock * p = new (aal.allocate(1)) common::RWLock();
 
     /* create map entry */
-    _map->try_emplace(k, buffer, value_len, p);
+    part.emplace(h, key, value_type(buffer, value_len), _map.next_version());
   }
 
   return S_OK;
@@ -219,23 +440,23 @@ status_t Pool_instance::get(const string_view_key key,
   common::string_view key_svc(common::pointer_cast<char>(key.data()), key.size());
   CFLOGM(1, "get({},{},{})", key_svc, out_value, out_value_len);
 
-  RWLock_guard guard(_map_lock);
+  const auto h = _map.hash(key);
+  auto &part = _map.locate(h);
+  RWLock_guard guard(part.lock());
 
-  std::lock_guard g{_mm_plugin_mutex}; /* aac */
-  string_t k(key.data(), aac);
-  auto i = _map->find(k);
+  auto i = part.find(h, key);
 
-  if (i == _map->end()) return IKVStore::E_KEY_NOT_FOUND;
+  if (! i) return IKVStore::E_KEY_NOT_FOUND;
 
   /* if out_value is provided as non-NULL, and its large enough
      then use it. If it is not large enough, then send back
      the size needed.
   */
-  auto buffer_len = i->second._length;
-  out_value_len = i->second._length;
+  auto buffer_len = i->_value._length;
+  out_value_len = i->_value._length;
 
   if(out_value) {
-    if(buffer_len < i->second._length) return E_INSUFFICIENT_BUFFER;
+    if(buffer_len < i->_value._length) return E_INSUFFICIENT_BUFFER;
   }
   else {
     /* result memory allocated with ::malloc */
@@ -247,7 +468,7 @@ status_t Pool_instance::get(const string_view_key key,
     return E_NO_MEM;
   }
 
-  memcpy(out_value, i->second._ptr, i->second._length);
+  memcpy(out_value, i->_value._ptr, i->_value._length);
   return S_OK;
 }
 
@@ -261,24 +482,24 @@ status_t Pool_instance::get_direct(const string_view_key key,
   if (out_value == nullptr || out_value_len == 0)
     throw API_exception("invalid parameter");
 
-  RWLock_guard guard(_map_lock);
-  std::lock_guard g{_mm_plugin_mutex}; /* aac */
-  string_t k(key.data(), key.size(), aac);
-  auto i = _map->find(k);
+  const auto h = _map.hash(key);
+  auto &part = _map.locate(h);
+  RWLock_guard guard(part.lock());
+  auto i = part.find(h, key);
 
-  if (i == _map->end()) {
+  if (! i) {
     if (debug_level()) PERR("Map_store: error key not found");
     return IKVStore::E_KEY_NOT_FOUND;
   }
 
-  if (out_value_len < i->second._length) {
+  if (out_value_len < i->_value._length) {
     if (debug_level()) PERR("Map_store: error insufficient buffer");
 
     return E_INSUFFICIENT_BUFFER;
   }
 
-  out_value_len = i->second._length; /* update length */
-  memcpy(out_value, i->second._ptr, i->second._length);
+  out_value_len = i->_value._length; /* update length */
+  memcpy(out_value, i->_value._ptr, i->_value._length);
 
   return S_OK;
 }
@@ -294,25 +515,25 @@ status_t Pool_instance::get_attribute(const IKVStore::Attribute attr,
   }
   case IKVStore::Attribute::VALUE_LEN: {
     if (key.data() == nullptr) return E_INVAL;
-    RWLock_guard guard(_map_lock);
-    std::lock_guard g{_mm_plugin_mutex}; /* aac */
-    string_t k(key.data(), key.size(), aac);
-    auto i = _map->find(k);
-    if (i == _map->end()) return IKVStore::E_KEY_NOT_FOUND;
-    out_attr.push_back(i->second._length);
+    const auto h = _map.hash(key);
+    auto &part = _map.locate(h);
+    RWLock_guard guard(part.lock());
+    auto i = part.find(h, key);
+    if (! i) return IKVStore::E_KEY_NOT_FOUND;
+    out_attr.push_back(i->_value._length);
     break;
   }
   case IKVStore::Attribute::WRITE_EPOCH_TIME: {
-    RWLock_guard guard(_map_lock);
-    std::lock_guard g{_mm_plugin_mutex}; /* aac */
-    string_t k(key.data(), key.size(), aac);
-    auto i = _map->find(k);
-    if (i == _map->end()) return IKVStore::E_KEY_NOT_FOUND;
-    out_attr.push_back(boost::numeric_cast<uint64_t>(i->second._tsc.to_epoch().seconds()));
+    const auto h = _map.hash(key);
+    auto &part = _map.locate(h);
+    RWLock_guard guard(part.lock());
+    auto i = part.find(h, key);
+    if (! i) return IKVStore::E_KEY_NOT_FOUND;
+    out_attr.push_back(boost::numeric_cast<uint64_t>(i->_value._tsc.to_epoch().seconds()));
     break;
   }
   case IKVStore::Attribute::COUNT: {
-    out_attr.push_back(_map->size());
+    out_attr.push_back(_map.size());
     break;
   }
   case IKVStore::Attribute::PERCENT_USED: {
@@ -323,6 +544,16 @@ status_t Pool_instance::get_attribute(const IKVStore::Attribute attr,
     out_attr.push_back(_numa_node_mask.get64());
     break;
   }
+  case IKVStore::Attribute::NUMA_HITS: {
+    if (_heaps.size() == 1) return E_NOT_SUPPORTED;
+    for (unsigned h = 0; h != _heaps.size(); ++h) {
+      std::uint64_t hits = 0;
+      for (auto p = _map.first_partition(h); p != _map.first_partition(h + 1); ++p)
+        hits += _map.at(p).hits();
+      out_attr.push_back(hits);
+    }
+    break;
+  }
   default:
     return E_NOT_SUPPORTED;
   }
@@ -333,28 +564,36 @@ status_t Pool_instance::get_attribute(const IKVStore::Attribute attr,
 status_t Pool_instance::swap_keys(const string_view_key key0,
                                   const string_view_key key1)
 {
-  std::lock_guard g{_mm_plugin_mutex}; /* aac, twice */
-  string_t k0(key0.data(), key0.length(), aac);
-  auto i0 = _map->find(k0);
-  if(i0 == _map->end()) return IKVStore::E_KEY_NOT_FOUND;
+  const auto h0 = _map.hash(key0);
+  const auto h1 = _map.hash(key1);
+  const auto p0 = _map.partition_index(h0);
+  const auto p1 = _map.partition_index(h1);
+
+  /* take the partition locks in index order, once if they are the same */
+  std::unique_ptr<RWLock_guard> g_first, g_second;
+  g_first = std::make_unique<RWLock_guard>(_map.at(std::min(p0, p1)).lock(), common::RWLock_guard::WRITE);
+  if ( p0 != p1 )
+    g_second = std::make_unique<RWLock_guard>(_map.at(std::max(p0, p1)).lock(), common::RWLock_guard::WRITE);
+
+  auto i0 = _map.at(p0).find(h0, key0);
+  if(! i0) return IKVStore::E_KEY_NOT_FOUND;
 
-  string_t k1(key1.data(), key1.length(), aac);
-  auto i1 = _map->find(k1);
-  if(i1 == _map->end()) return IKVStore::E_KEY_NOT_FOUND;
+  auto i1 = _map.at(p1).find(h1, key1);
+  if(! i1) return IKVStore::E_KEY_NOT_FOUND;
 
   /* lock both k-v pairs */
-  auto& left = i0->second;
-  if(left._value_lock->write_trylock() != 0)
+  auto& left = i0->_value;
+  if(i0->lock().write_trylock() != 0)
     return E_LOCKED;
 
-  auto& right = i1->second;
-  if(right._value_lock->write_trylock() != 0) {
-    left._value_lock->unlock();
+  auto& right = i1->_value;
+  if(i1->lock().write_trylock() != 0) {
+    i0->lock().unlock();
     return E_LOCKED;
   }
 
   /* swap keys */
-  auto tmp_ptr = left._ptr;
+  void *tmp_ptr = left._ptr;
   auto tmp_len = left._length;
   left._ptr = right._ptr;
   left._length = right._length;
@@ -367,13 +606,14 @@ status_t Pool_instance::swap_keys(const string_view_key key0,
   right._tsc.update();
 
   /* release locks */
-  left._value_lock->unlock();
-  right._value_lock->unlock();
+  i0->lock().unlock();
+  i1->lock().unlock();
 
   return S_OK;
 }
 
-status_t Pool_instance::lock_unguarded(const std::lock_guard<std::mutex> &
+status_t Pool_instance::lock_unguarded(map_t::partition &part
+  , const std::uint64_t h
   , const string_view_key key,
                              IKVStore::lock_type_t type,
                              void *&out_value,
@@ -383,16 +623,14 @@ status_t Pool_instance::lock_unguarded(const std::lock_guard<std::mutex> &
                              const char ** out_key_ptr)
 {
 
-  void *buffer = nullptr;
-  string_t k(key.data(), key.size(), aac);
   bool created = false;
   common::string_view key_svc(common::pointer_cast<char>(key.data()), key.size());
 
-  auto i = _map->find(k);
+  auto i = part.find(h, key);
 
   CFLOGM(1, "lock looking for key:({})", key_svc);
 
-  if (i == _map->end()) { /* create value */
+  if (! i) { /* create value */
 
     /* lock API has semantics of create on demand */
     if (inout_value_len == 0) {
@@ -401,34 +639,30 @@ status_t Pool_instance::lock_unguarded(const std::lock_guard<std::mutex> &
       return IKVStore::E_KEY_NOT_FOUND;
     }
 
-    write_touch();
-
     CFLOGM(1, "is on-demand allocating:({}) {}", key_svc, inout_value_len);
 
     if(alignment == 0)
       alignment = choose_alignment(inout_value_len);
 
-    if(_mm_plugin.aligned_allocate(inout_value_len, alignment, &buffer) != S_OK)
-      throw General_exception("memory plugin alloc failed");
-
-    if (buffer == nullptr)
+    void *buffer = nullptr;
+    try { buffer = part.heap().allocate(inout_value_len, alignment); }
+    catch(const std::bad_alloc &) {
       throw General_exception("Pool_instance::lock on-demand create allocate_memory failed (len=%lu)",
                               inout_value_len);
+    }
     created = true;
 
     CFLOGM(1, "creating on demand key=({}) len={}",
           key_svc, inout_value_len);
 
-    common::RWLock * p = new (aal.allocate(1)) common::RWLock();
-
-    CFLOGM(2, "created RWLock at {}", p);
-    _map->try_emplace(k, buffer, inout_value_len, p);
+    i = &part.emplace(h, key, value_type(buffer, inout_value_len), _map.next_version());
   }
 
   CFLOGM(1, "lock call has got key {}", key_svc);
 
+  auto &v = i->_value;
   if (type == IKVStore::STORE_LOCK_READ) {
-    if((*_map)[k]._value_lock->read_trylock() != 0) {
+    if(i->lock().read_trylock() != 0) {
       if(debug_level())
         FWRNM("key ({}) unable to take read lock", key_svc);
 
@@ -438,9 +672,7 @@ status_t Pool_instance::lock_unguarded(const std::lock_guard<std::mutex> &
   }
   else if (type == IKVStore::STORE_LOCK_WRITE) {
 
-    write_touch();
-
-    if((*_map)[k]._value_lock->write_trylock() != 0) {
+    if(i->lock().write_trylock() != 0) {
       if(debug_level())
         FWRNM("Map_store: key ({}) unable to take write lock", key_svc);
 
@@ -451,27 +683,16 @@ status_t Pool_instance::lock_unguarded(const std::lock_guard<std::mutex> &
   }
   else throw API_exception("invalid lock type");
 
-  out_value = (*_map)[k]._ptr;
-  inout_value_len = (*_map)[k]._length;
-
-  out_key = reinterpret_cast<IKVStore::key_t>((*_map)[k]._value_lock);
+  out_value = v._ptr;
+  inout_value_len = v._length;
 
-  /* C++11 standard: § 23.2.5/8
+  /* Slots move within the partition, but the key block (lock and key
+   * bytes) is allocated separately and does not move while the key exists.
+   */
+  out_key = reinterpret_cast<IKVStore::key_t>(&i->lock());
 
-     The elements of an unordered associative container are organized
-     into buckets. Keys with the same hash code appear in the same
-     bucket. The number of buckets is automatically increased as
-     elements are added to an unordered associative container, so that
-     the average number of elements per bucket is kept below a
-     bound. Rehashing invalidates iterators, changes ordering between
-     elements, and changes which buckets elements appear in, but does
-     not invalidate pointers or references to elements. For
-     unordered_multiset and unordered_multimap, rehashing preserves
-     the relative ordering of equivalent elements.
-  */
   if(out_key_ptr) {
-    auto element = _map->find(k);
-    *out_key_ptr = common::pointer_cast<char>(element->first.data());
+    *out_key_ptr = common::pointer_cast<char>(i->key_ptr());
   }
 
   return created ? S_OK_CREATED : S_OK;
@@ -485,8 +706,10 @@ status_t Pool_instance::lock(const string_view_key key,
                              IKVStore::key_t& out_key,
                              const char ** out_key_ptr)
 {
-  std::lock_guard g{_mm_plugin_mutex}; /* aac, and later _mm_plugin.aligned_allocate, aal */
-  return lock_unguarded(g, key, type, out_value, inout_value_len, alignment, out_key, out_key_ptr);
+  const auto h = _map.hash(key);
+  auto &part = _map.locate(h);
+  RWLock_guard guard(part.lock(), common::RWLock_guard::WRITE); /* may create */
+  return lock_unguarded(part, h, key, type, out_value, inout_value_len, alignment, out_key, out_key_ptr);
 }
 
 status_t Pool_instance::unlock(IKVStore::key_t key_handle)
@@ -498,7 +721,7 @@ status_t Pool_instance::unlock(IKVStore::key_t key_handle)
   }
 
   /* TODO: how do we know key_handle is valid? */
-  if(reinterpret_cast<common::RWLock *>(key_handle)->unlock() != 0) {
+  if(reinterpret_cast<Value_lock *>(key_handle)->unlock() != 0) {
     PWRN("Map_store: bad parameter to unlock");
     return E_INVAL;
   }
@@ -510,44 +733,48 @@ status_t Pool_instance::unlock(IKVStore::key_t key_handle)
 status_t Pool_instance::erase(const string_view_key key)
 {
   const common::string_view key_svc(common::pointer_cast<char>(key.data()), key.size());
-  RWLock_guard guard(_map_lock, common::RWLock_guard::WRITE);
-  std::lock_guard g{_mm_plugin_mutex}; /* aac, _mm_plugin.deallocate, aal */
-  string_t k(key.data(), key.size(), aac);
-  auto i = _map->find(k);
+  const auto h = _map.hash(key);
+  auto &part = _map.locate(h);
+  RWLock_guard guard(part.lock(), common::RWLock_guard::WRITE);
+  auto i = part.find(h, key);
 
-  if (i == _map->end()) return IKVStore::E_KEY_NOT_FOUND;
+  if (! i) return IKVStore::E_KEY_NOT_FOUND;
 
-  if ( i->second._value_lock->write_trylock() != 0 ) { /* check pair is not locked */
+  if ( i->lock().write_trylock() != 0 ) { /* check pair is not locked */
     if(debug_level())
       FWRNM("key ({}) unable to take write lock", key_svc);
 
     return E_LOCKED;
   }
 
-  write_touch();
-  _map->erase(i);
+  value_type v(std::move(i->_value));
+  part.erase(*i); /* frees the key block, including the (held) value lock */
 
-  _mm_plugin.deallocate(&i->second._ptr, i->second._length);
-  i->second._value_lock->unlock();
-  i->second._value_lock->~RWLock();
-  aal.deallocate(i->second._value_lock, 1); //, DEFAULT_ALIGNMENT);
+  value_heap(v._ptr).deallocate(v._ptr, v._length);
 
   return S_OK;
 }
 
 size_t Pool_instance::count() {
-  RWLock_guard guard(_map_lock);
-  return _map->size();
+  return _map.size();
 }
 
 status_t Pool_instance::map(std::function<int(const string_view_key key,
                                               string_view_value value)> function)
 {
-  RWLock_guard guard(_map_lock);
-
-  for (auto &pair : *_map) {
-    const auto &val = pair.second;
-    function(pair.first, string_view_value(static_cast<string_view_value::value_type *>(val._ptr), val._length));
+  /* start with the partitions on the caller's node */
+  const auto first = _map.first_partition(local_heap());
+  for ( unsigned k = 0; k != _map.partition_count(); ++k ) {
+    auto &part = _map.at((first + k) % _map.partition_count());
+    RWLock_guard guard(part.lock());
+
+    for ( std::size_t s = 0; s != part.slot_count(); ++s ) {
+      const auto &e = part.at(s);
+      if ( e.in_use() ) {
+        const auto &val = e._value;
+        function(e.key(), string_view_value(static_cast<string_view_value::value_type *>(val._ptr.get()), val._length));
+      }
+    }
   }
 
   return S_OK;
@@ -559,19 +786,26 @@ status_t Pool_instance::map(std::function<int(string_view_key key,
                                               const common::epoch_time_t t_begin,
                                               const common::epoch_time_t t_end)
 {
-  RWLock_guard guard(_map_lock);
-
   common::tsc_time_t begin_tsc(t_begin);
   common::tsc_time_t end_tsc(t_end);
 
-  for (auto &pair : *_map) {
-    const auto &val = pair.second;
-
-    if(val._tsc >= begin_tsc && (end_tsc == 0 || val._tsc <= end_tsc)) {
-      if(function(pair.first,
-                  string_view_value(static_cast<string_view_value::value_type *>(val._ptr), val._length),
-                  val._tsc) < 0) {
-        return S_MORE; /* break out of the loop if function returns < 0 */
+  /* start with the partitions on the caller's node */
+  const auto first = _map.first_partition(local_heap());
+  for ( unsigned k = 0; k != _map.partition_count(); ++k ) {
+    auto &part = _map.at((first + k) % _map.partition_count());
+    RWLock_guard guard(part.lock());
+
+    for ( std::size_t s = 0; s != part.slot_count(); ++s ) {
+      const auto &e = part.at(s);
+      if ( ! e.in_use() ) continue;
+      const auto &val = e._value;
+
+      if(val._tsc >= begin_tsc && (end_tsc == 0 || val._tsc <= end_tsc)) {
+        if(function(e.key(),
+                    string_view_value(static_cast<string_view_value::value_type *>(val._ptr.get()), val._length),
+                    val._tsc) < 0) {
+          return S_MORE; /* break out of the loop if function returns < 0 */
+        }
       }
     }
   }
@@ -582,10 +816,58 @@ status_t Pool_instance::map(std::function<int(string_view_key key,
 
 status_t Pool_instance::map_keys(std::function<int(string_view_key key)> function)
 {
-  RWLock_guard guard(_map_lock);
+  /* start with the partitions on the caller's node */
+  const auto first = _map.first_partition(local_heap());
+  for ( unsigned k = 0; k != _map.partition_count(); ++k ) {
+    auto &part = _map.at((first + k) % _map.partition_count());
+    RWLock_guard guard(part.lock());
+
+    for ( std::size_t s = 0; s != part.slot_count(); ++s ) {
+      const auto &e = part.at(s);
+      if ( e.in_use() ) function(e.key());
+    }
+  }
+
+  return S_OK;
+}
 
-  for (auto &pair : *_map) function(pair.first);
+status_t Pool_instance::map_partition(const unsigned partition,
+                                      const unsigned partition_count,
+                                      IKVStore::map_cursor_t &cursor,
+                                      const size_t max_objects,
+                                      std::function<int(const void *key, size_t key_len,
+                                                        const void *value, size_t value_len)> function)
+{
+  if (partition_count <= partition) return E_INVAL;
+
+  /* partition p of n is the hash range [p * 2^64 / n, (p+1) * 2^64 / n) */
+  const auto first = hash_range_start(partition, partition_count);
+  const auto last = hash_range_start(partition + 1U, partition_count) - 1U;
+
+  /* the cursor position is the first hash not yet visited, the mark the snapshot version */
+  if (! cursor.started) {
+    cursor.started = true;
+    cursor.position = first;
+    cursor.mark = _map.version();
+  }
+  else if (cursor.position < first || last < cursor.position) {
+    return E_INVAL;
+  }
 
+  size_t visited = 0;
+  bool aborted = false;
+  const bool more =
+    _map.visit(cursor.position, last, cursor.mark, cursor.position,
+               [&function, &visited, &aborted, max_objects] (const map_t::slot &s) -> bool
+               {
+                 /* entries sharing the hash of the last one are still offered, so
+                  * max_objects may be exceeded by (rare) hash collisions */
+                 if ( aborted ) return false;
+                 aborted = function(s.key_ptr(), s._key_len, s._value._ptr, s._value._length) < 0;
+                 return ++visited < max_objects && ! aborted;
+               });
+
+  if (more && ! aborted) return IKVStore::S_MORE;
   return S_OK;
 }
 
@@ -600,19 +882,18 @@ status_t Pool_instance::resize_value(const string_view_key key,
 
   if (new_size == 0) return E_INVAL;
 
-  RWLock_guard guard(_map_lock);
-
-  std::lock_guard g{_mm_plugin_mutex}; /* aac, _mm_plugin.aligned_allocate */
-  auto i = _map->find(string_t(key.data(), key.size(), aac));
+  const auto h = _map.hash(key);
+  auto &part = _map.locate(h);
+  RWLock_guard guard(part.lock(), common::RWLock_guard::WRITE);
 
-  if (i == _map->end()) return IKVStore::E_KEY_NOT_FOUND;
+  if (! part.find(h, key)) return IKVStore::E_KEY_NOT_FOUND;
 
   /* lock KV-pair */
   void *out_value;
   size_t inout_value_len;
   IKVStore::key_t out_key_handle = IKVStore::KEY_NONE;
 
-  status_t s = lock_unguarded(g, key,
+  status_t s = lock_unguarded(part, h, key,
                     IKVStore::STORE_LOCK_WRITE,
                     out_value,
                     inout_value_len,
@@ -625,11 +906,14 @@ status_t Pool_instance::resize_value(const string_view_key key,
     return E_LOCKED;
   }
 
+  /* the partition write lock is held: the slot has not moved */
+  auto &v = part.find(h, key)->_value;
+
   /* It seems unfair to complain about an invalid argument on a condition which
    * cannot be checked in advance, but that is how mapstore handles same-size
    * resize.
    */
-  if (i->second._length == new_size) {
+  if (v._length == new_size) {
     (void) unlock(out_key_handle);
     CFLOGM(2, "resize_value request for same size! {}", new_size);
     return E_INVAL;
@@ -637,25 +921,24 @@ status_t Pool_instance::resize_value(const string_view_key key,
 
   CFLOGM(2, "resize_value locked key-value pair", 0);
 
-  size_t size_to_copy = std::min<size_t>(new_size, boost::numeric_cast<size_t>(i->second._length));
+  size_t size_to_copy = std::min<size_t>(new_size, boost::numeric_cast<size_t>(v._length));
 
   /* perform resize */
   void * buffer = nullptr;
-  if(_mm_plugin.aligned_allocate(new_size, alignment, &buffer) != S_OK)
+  try { buffer = part.heap().allocate(new_size, alignment); }
+  catch(const std::bad_alloc &)
   {
     (void) unlock(out_key_handle);
     throw General_exception("memory plugin aligned_allocate failed");
   }
 
-  write_touch();
-
-  memcpy(buffer, i->second._ptr, size_to_copy);
+  memcpy(buffer, v._ptr, size_to_copy);
 
   /* free previous memory */
-  _mm_plugin.deallocate(&i->second._ptr, i->second._length);
+  value_heap(v._ptr).deallocate(v._ptr, v._length);
 
-  i->second._ptr = buffer;
-  i->second._length = new_size;
+  v._ptr = buffer;
+  v._length = new_size;
 
   /* release lock */
   if(unlock(out_key_handle) != S_OK)
@@ -667,12 +950,15 @@ status_t Pool_instance::resize_value(const string_view_key key,
 
 status_t Pool_instance::get_pool_regions(nupm::region_descriptor::address_map_t &out_regions) const
 {
-  if (_regions.empty())
+  if (_nsize == 0)
     return E_INVAL;
 
-  for (const auto &region : _regions)
-    out_regions.push_back(nupm::region_descriptor::address_map_t::value_type
-                          (common::make_byte_span(region->iov_base, region->iov_len)));
+  for (const auto &h : _heaps) {
+    std::lock_guard g{h->_mutex};
+    for (const auto &region : h->_regions)
+      out_regions.push_back(nupm::region_descriptor::address_map_t::value_type
+                            (common::make_byte_span(region->iov_base, region->iov_len)));
+  }
   return S_OK;
 }
 
@@ -682,26 +968,38 @@ status_t Pool_instance::grow_pool(const size_t increment_size,
   if (increment_size <= 0)
     return E_INVAL;
 
-  size_t rounded_increment_size = round_up_page(increment_size);
+  /* each heap (NUMA node) grows by an equal share */
+  size_t rounded_increment_size = round_up_page((increment_size + _heaps.size() - 1) / _heaps.size());
+
+  if (_image && ! _image->can_add_regions(unsigned(_heaps.size()))) {
+    PWRN("Map_store: pool image region table is full");
+    return E_FULL;
+  }
 
-  auto new_region = allocate_region_memory(rounded_increment_size);
-  std::lock_guard g{_mm_plugin_mutex};
-  _mm_plugin.add_managed_region(new_region->iov_base, new_region->iov_len);
-  _regions.push_back(std::move(new_region));
+  for (unsigned i = 0; i != _heaps.size(); ++i) {
+    auto &h = _heaps[i];
+    auto new_region = allocate_region_memory(rounded_increment_size, *h);
+    std::lock_guard g{h->_mutex};
+    h->_plugin.add_managed_region(new_region->iov_base, new_region->iov_len);
+    if (_image)
+      _image->add_region(new_region->iov_base, new_region->iov_len, i);
+    h->_regions.push_back(std::move(new_region));
+  }
   reconfigured_size = _nsize;
   return S_OK;
 }
 
 status_t Pool_instance::free_pool_memory(const void *addr, const size_t size) {
 
-  if (!addr || _regions.empty())
+  if (!addr || _nsize == 0)
     return E_INVAL;
 
-  std::lock_guard g{_mm_plugin_mutex};
+  auto &h = heap_containing(addr);
+  std::lock_guard g{h._mutex};
   if(size)
-    _mm_plugin.deallocate(const_cast<void **>(&addr), size);
+    h._plugin.deallocate(const_cast<void **>(&addr), size);
   else
-    _mm_plugin.deallocate_without_size(const_cast<void **>(&addr));
+    h._plugin.deallocate_without_size(const_cast<void **>(&addr));
 
   /* the region memory is not freed, only memory in region */
   return S_OK;
@@ -711,7 +1009,7 @@ status_t Pool_instance::allocate_pool_memory(const size_t size,
                                              const size_t alignment,
                                              void *&out_addr) {
 
-  if (size == 0 || size > _nsize || _regions.empty()) {
+  if (size == 0 || size > _nsize || _nsize == 0) {
     PWRN("Map_store: invalid %s request", __func__);
     return E_INVAL;
   }
@@ -726,8 +1024,10 @@ status_t Pool_instance::allocate_pool_memory(const size_t size,
     /* we can't fully support alignment choice */
     out_addr = 0;
 
-    std::lock_guard g{_mm_plugin_mutex};
-    auto rc = _mm_plugin.aligned_allocate(size, (alignment > 0) && (size % alignment == 0) ? alignment : choose_alignment(size), &out_addr);
+    /* memory on the caller's node */
+    auto &h = *_heaps[local_heap()];
+    std::lock_guard g{h._mutex};
+    auto rc = h._plugin.aligned_allocate(size, (alignment > 0) && (size % alignment == 0) ? alignment : choose_alignment(size), &out_addr);
     CFLOGM(1, "allocated pool memory ({} {})", out_addr, size);
     switch ( rc )
     {
@@ -747,10 +1047,31 @@ status_t Pool_instance::allocate_pool_memory(const size_t size,
 
 auto Pool_instance::open_pool_iterator() -> IKVStore::pool_iterator_t
 {
+  std::lock_guard g{_iterators_mutex};
   auto it = _iterators.insert(std::make_unique<Iterator>(this));
   return reinterpret_cast<IKVStore::pool_iterator_t>(it.first->get());
 }
 
+bool Pool_instance::Iterator::fetch()
+{
+  _more =
+    _more &&
+    _pool->_map.visit(_next, ~std::uint64_t(0), _snapshot, _next,
+                      [this] (const map_t::slot &s) -> bool
+                      {
+                        element e{};
+                        e.ref.key = s.key_ptr();
+                        e.ref.key_len = s._key_len;
+                        e.ref.value = s._value._ptr;
+                        e.ref.value_len = s._value._length;
+                        e.ref.timestamp = s._value._tsc.to_epoch();
+                        e.tsc = s._value._tsc;
+                        _fetched.push_back(e);
+                        return false; /* one hash at a time */
+                      });
+  return ! _fetched.empty();
+}
+
 status_t Pool_instance::deref_pool_iterator(IKVStore::pool_iterator_t iter,
                                             const common::epoch_time_t t_begin,
                                             const common::epoch_time_t t_end,
@@ -759,24 +1080,21 @@ status_t Pool_instance::deref_pool_iterator(IKVStore::pool_iterator_t iter,
                                             bool increment)
 {
   const auto i = reinterpret_cast<Iterator*>(iter);
-  if(_iterators.count(i) != 1) return E_INVAL;
-  if(i->is_end()) return E_OUT_OF_BOUNDS;
-  if(!i->check_mark(_writes)) return E_ITERATOR_DISTURBED;
+  {
+    std::lock_guard g{_iterators_mutex};
+    if(_iterators.count(i) != 1) return E_INVAL;
+  }
+  if(i->_fetched.empty() && ! i->fetch()) return E_OUT_OF_BOUNDS;
 
   common::tsc_time_t begin_tsc(t_begin);
   common::tsc_time_t end_tsc(t_end);
 
-  auto r = i->_iter;
-  ref.key = r->first.data();
-  ref.key_len = r->first.length();
-  ref.value = r->second._ptr;
-  ref.value_len = r->second._length;
-
-  ref.timestamp = r->second._tsc.to_epoch();
+  const auto &r = i->_fetched.front();
+  ref = r.ref;
 
   /* leave condition in timestamp cycles for better accuracy */
   try {
-    time_match = (r->second._tsc >= begin_tsc) && (end_tsc == 0 || r->second._tsc <= end_tsc);
+    time_match = (r.tsc >= begin_tsc) && (end_tsc == 0 || r.tsc <= end_tsc);
   }
   catch(...) {
     PWRN("bad time parameter");
@@ -784,12 +1102,7 @@ status_t Pool_instance::deref_pool_iterator(IKVStore::pool_iterator_t iter,
   }
 
   if(increment) {
-    try {
-      i->_iter++;
-    }
-    catch(...) {
-      return E_ITERATOR_DISTURBED;
-    }
+    i->increment();
   }
 
   return S_OK;
@@ -797,13 +1110,14 @@ status_t Pool_instance::deref_pool_iterator(IKVStore::pool_iterator_t iter,
 
 status_t Pool_instance::close_pool_iterator(IKVStore::pool_iterator_t iter)
 {
+  std::lock_guard g{_iterators_mutex};
   const auto it = _iterators.find(reinterpret_cast<Iterator *>(iter));
   if (it == _iterators.end()) return E_INVAL;
   _iterators.erase(it);
   return S_OK;
 }
 
-std::unique_ptr<region_memory> Pool_instance::allocate_region_memory(size_t size)
+std::unique_ptr<region_memory> Pool_instance::allocate_region_memory(size_t size, heap &h)
 {
   std::unique_ptr<region_memory> rm;
   assert(size > 0);
@@ -812,8 +1126,18 @@ std::unique_ptr<region_memory> Pool_instance::allocate_region_memory(size_t size
 
   auto prot = PROT_READ | PROT_WRITE;
   auto flags = MAP_SHARED;
+  if ( _image )
+  {
+    /* space in the image, which follows on from the existing regions */
+    auto p = _image->extend(size);
+    if ( ! p )
+      throw General_exception("%s: cannot extend pool image by %zu bytes", __func__, size);
+    if ( 0 <= h._node )
+      numa_tonode_memory(p, size, h._node);
+    rm = std::make_unique<region_memory_image>(debug_level(), p, size);
+  }
   /* create space in file */
-  if ( 0 <= _fdout && ftruncate(_fdout, _nsize + size) == 0 )
+  else if ( 0 <= _fdout && ftruncate(_fdout, _nsize + size) == 0 )
   {
     auto p = mmap(reinterpret_cast<char *>(0xff00000000) + _nsize, /* help debugging */
              size,
@@ -824,12 +1148,15 @@ std::unique_ptr<region_memory> Pool_instance::allocate_region_memory(size_t size
     if (p != MAP_FAILED)
     {
       FINF("using backing file for {} MiB", REDUCE_MB(size));
+      /* a NUMA partitioned heap's pages go to its node */
+      if ( 0 <= h._node )
+        numa_tonode_memory(p, size, h._node);
       rm = std::make_unique<region_memory_mmap>(debug_level(), p, size);
     }
   }
 
   if (! rm) {
-    if ( numa_bitmask_weight(_numa_node_mask.get()) == 0 )
+    if ( numa_bitmask_weight(h._node_mask.get()) == 0 )
     {
       auto addr = reinterpret_cast<char *>(0x800000000) + _nsize; /* help debugging */
       /* memory to be freed with munmap */
@@ -851,7 +1178,7 @@ std::unique_ptr<region_memory> Pool_instance::allocate_region_memory(size_t size
     }
     else
     {
-      rm = std::make_unique<memory_pin<region_memory_numa>>(needs_pinned_pages, debug_level(), size, _numa_node_mask.get());
+      rm = std::make_unique<memory_pin<region_memory_numa>>(needs_pinned_pages, debug_level(), size, h._node_mask.get());
     }
   }
 
@@ -883,9 +1210,14 @@ std::size_t Pool_instance::capacity() const
 
 std::size_t Pool_instance::allocated() const
 {
-	std::size_t r;
-	auto rc = _mm_plugin.bytes_remaining(&r);
-	return capacity() - (rc == S_OK ? r : 0);
+	std::size_t remaining = 0;
+	for ( const auto &h : _heaps )
+	{
+		std::size_t r;
+		auto rc = h->_plugin.bytes_remaining(&r);
+		remaining += (rc == S_OK ? r : 0);
+	}
+	return capacity() - remaining;
 }
 
 unsigned Pool_instance::percent_used() const
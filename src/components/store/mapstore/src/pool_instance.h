@@ -16,6 +16,8 @@
 
 #include "numa_node_mask.h"
 #include "mm_plugin_itf.h"
+#include "partitioned_map.h"
+#include "pool_image.h"
 
 #include <api/kvstore_itf.h> /* string_view_key, string_view_value */
 #include <common/less_getter.h>
@@ -23,37 +25,13 @@
 #include <common/time.h> /* tsc_time_t */
 #include <nupm/region_descriptor.h>
 #include <common/logging.h>
-#include <city.h> /* CityHash64 */
 #include <memory>
 #include <mutex>
 #include <set>
-#include <unordered_map>
+#include <deque>
 
 struct bitmask;
 
-struct value_type {
-  value_type() : _ptr(nullptr), _length(0), _value_lock(), _tsc() {
-  }
-
-  value_type(void* ptr, size_t length, common::RWLock * value_lock) :
-    _ptr(ptr), _length(length), _value_lock(value_lock), _tsc() {
-  }
-
-  value_type(const value_type &) = delete;
-  value_type &operator=(const value_type &) = delete;
-  void * _ptr;
-  size_t _length;
-  common::RWLock * _value_lock; /*< read write lock */
-  common::tsc_time_t _tsc;
-};
-
-class Key_hash {
-public:
-  size_t operator()(component::IKVStore::string_view_key k) const {
-    return CityHash64(common::pointer_cast<char>(k.data()), k.size());
-  }
-};
-
 struct region_memory;
 
 /**
@@ -63,14 +41,41 @@ struct region_memory;
 class Pool_instance {
 
 private:
-  using aac_t = MM_plugin_cxx_allocator<char>;
-  using string_t = std::basic_string<common::byte, std::char_traits<common::byte>, aac_t>;
-  using aam_t = MM_plugin_cxx_allocator<std::pair<string_t, value_type>>;
-  using map_t = std::unordered_map<string_t, value_type, Key_hash, std::equal_to<string_t>, aam_t>;
+  using map_t = Partitioned_map;
+  using IKVStore = component::IKVStore;
+  using string_view = common::string_view;
+  using string_view_key = IKVStore::string_view_key;
+  using string_view_value = IKVStore::string_view_value;
 
   unsigned debug_level() const { return _debug_level; }
 
-  std::unique_ptr<region_memory> allocate_region_memory(size_t size);
+  /*
+    A heap of the pool: the whole pool or, in a NUMA partitioned pool,
+    the part on one node. Regions are allocated on the heap's nodes.
+  */
+  struct heap {
+    /* constructor and destructor out of line: region_memory is incomplete here */
+    heap(const std::string &plugin_path, const bitmask *node_mask, int node);
+    heap(const heap &) = delete;
+    heap &operator=(const heap &) = delete;
+    ~heap();
+    int                        _node; /*< -1: not partitioned */
+    numa_node_mask             _node_mask;
+    std::mutex                 _mutex;
+    MM_plugin_wrapper          _plugin;
+    std::vector<std::unique_ptr<region_memory>> _regions; /*< regions supporting the heap */
+    Allocator_handle           _handle;
+  };
+
+  static std::vector<std::unique_ptr<heap>> make_heaps(const std::string &plugin_path, const bitmask *node_mask);
+  static std::vector<Allocator_handle> handles(const std::vector<std::unique_ptr<heap>> &heaps);
+
+  /* heap of the calling thread's NUMA node, if any, else the first heap */
+  unsigned local_heap() const;
+  /* heap from which p was allocated */
+  heap &heap_containing(const void *p) const;
+
+  std::unique_ptr<region_memory> allocate_region_memory(size_t size, heap &h);
 
   static const Pool_instance *checked_pool(const Pool_instance * pool)
   {
@@ -80,28 +85,52 @@ private:
     return pool;
   }
 
+  /*
+    Iterates over the keys which existed when it was opened (the snapshot
+    version), in hash order. The position is the first hash not yet
+    fetched, which is unaffected by concurrent writes, so the iterator is
+    not disturbed by them. Keys erased before they are reached are not
+    visited; values are as of the time they are fetched.
+  */
   class Iterator {
   public:
+    struct element {
+      IKVStore::pool_reference_t ref;
+      common::tsc_time_t         tsc;
+    };
+
     explicit Iterator(const Pool_instance * pool)
       : _pool(checked_pool(pool)),
-        _mark(_pool->writes()),
-        _iter(_pool->_map->begin()),
-        _end(_pool->_map->end())
+        _snapshot(_pool->_map.version()),
+        _next(0),
+        _more(true),
+        _fetched()
     {}
+    Iterator(const Iterator &) = delete;
+    Iterator &operator=(const Iterator &) = delete;
 
-    bool is_end() const { return _iter == _end; }
-    bool check_mark(uint32_t writes) const { return _mark == writes; }
+    /* fetch the entries at the next hash, if any */
+    bool fetch();
+    void increment() { _fetched.pop_front(); }
 
     const Pool_instance * _pool;
-    uint32_t              _mark;
-    map_t::const_iterator _iter;
-    map_t::const_iterator _end;
+    std::uint64_t         _snapshot;
+    std::uint64_t         _next; /*< first hash not yet fetched */
+    bool                  _more; /*< hashes from _next on are not yet fetched */
+    std::deque<element>   _fetched;
   };
 
-  using IKVStore = component::IKVStore;
-  using string_view = common::string_view;
-  using string_view_key = IKVStore::string_view_key;
-  using string_view_value = IKVStore::string_view_value;
+  Pool_instance(const unsigned debug_level,
+                const common::string_view mm_plugin_path,
+                const common::string_view name_,
+                const bitmask *numa_node_mask_,
+                unsigned flags_,
+                int fd,
+                unsigned partition_count);
+
+  void save_image();
+  void restore_image();
+
 public:
   Pool_instance(const unsigned debug_level,
                 const common::string_view mm_plugin_path,
@@ -109,12 +138,29 @@ public:
                 size_t nsize,
                 const bitmask *numa_node_mask_,
                 unsigned flags_);
+  /* reopen from a pool image; use reopen() */
+  Pool_instance(const unsigned debug_level,
+                const common::string_view mm_plugin_path,
+                const common::string_view name_,
+                const bitmask *numa_node_mask_,
+                int fd,
+                std::unique_ptr<Pool_image> image);
   Pool_instance(const Pool_instance &) = delete;
   Pool_instance &operator=(const Pool_instance &) = delete;
 
   ~Pool_instance();
   const std::string& name() const { return _name; }
 
+  /* pool from its image in the backing store, if restartable pools are enabled and there is a valid image */
+  static std::shared_ptr<Pool_instance> reopen(const unsigned debug_level,
+                                               const common::string_view mm_plugin_path,
+                                               const common::string_view name,
+                                               const bitmask *numa_node_mask);
+  /* remove the image of a pool which is not open; false if there was none */
+  static bool delete_image(const common::string_view name);
+  /* the pool is being deleted: on destruction, discard rather than save its image */
+  void mark_deleted() { _deleted = true; }
+
 private:
 
   unsigned                   _debug_level;
@@ -123,34 +169,24 @@ private:
   numa_node_mask             _numa_node_mask;
   std::string                _name; /*< pool name */
   int                        _fdout;
-  std::vector<std::unique_ptr<region_memory>> _regions; /*< regions supporting pool */
-  std::mutex                 _mm_plugin_mutex;
-  MM_plugin_wrapper          _mm_plugin;
-  /* use a pointer so we can make sure it gets stored before memory is freed */
-  common::RWLock             _map_lock; /*< read write lock */
-  std::unique_ptr<map_t>     _map; /*< hash table based map */
+  std::unique_ptr<Pool_image> _image; /*< restartable pools only; declared before _heaps, whose regions it maps */
+  bool                       _retain_image; /*< image is consistent with the pool, save it on destruction */
+  bool                       _reopened; /*< the backing file held an image before this instance; never clear it, except on delete */
+  bool                       _deleted;
+  std::vector<std::unique_ptr<heap>> _heaps; /*< one per NUMA node if partitioned, else one */
+  map_t                      _map; /*< partitioned hash table; declared after _heaps, which it uses */
   unsigned int               _flags;
+  std::mutex                 _iterators_mutex;
   /* Note: Using Iterator * as a comparable is a slight cheat, because pointers
    * from separate allocations are, strictly speaking, not comparable.
    */
   std::set<std::unique_ptr<Iterator>, common::less_getter<std::unique_ptr<Iterator>>> _iterators;
-  /*
-    We use this counter to see if new writes have come in
-    during an iteration.  This is essentially an optmistic
-    locking strategy.
-  */
-  uint32_t _writes __attribute__((aligned(4)));
 
-  inline void write_touch() { _writes++; }
-  inline uint32_t writes() const { return _writes; }
+  /* values are allocated from the heap of their key's partition, and freed to the heap which contains them */
+  const Allocator_handle &value_heap(const void *p) const { return heap_containing(p)._handle; }
 
-  /* allocator adapters over reconstituting allocator */
-  aac_t aac{_mm_plugin}; /* for keys */
-  using aal_t = MM_plugin_cxx_allocator<common::RWLock>;
-  aal_t aal{_mm_plugin}; /* for locks */
-
-  /* unguarded inner lock function (caller must hold _mm_plugin_mutex) */
-  status_t lock_unguarded(const std::lock_guard<std::mutex> &, string_view_key key,
+  /* unguarded inner lock function (caller must hold the partition lock for WRITE) */
+  status_t lock_unguarded(map_t::partition &part, std::uint64_t hash, string_view_key key,
                 IKVStore::lock_type_t type,
                 void *&out_value,
                 size_t &inout_value_len,
@@ -205,6 +241,13 @@ public:
 
   status_t map_keys(std::function<int(string_view_key key)> function);
 
+  status_t map_partition(unsigned partition,
+                         unsigned partition_count,
+                         IKVStore::map_cursor_t &cursor,
+                         size_t max_objects,
+                         std::function<int(const void *key, size_t key_len,
+                                           const void *value, size_t value_len)> function);
+
   status_t get_pool_regions(nupm::region_descriptor::address_map_t &out_regions) const;
 
   status_t grow_pool(const size_t increment_size, size_t &reconfigured_size);
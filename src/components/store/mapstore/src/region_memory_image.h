@@ -0,0 +1,35 @@
+/*
+  Copyright [2017-2021] [IBM Corporation]
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+  http://www.apache.org/licenses/LICENSE-2.0
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+#ifndef _MCAS_REGION_MEMORY_IMAGE_H_
+#define _MCAS_REGION_MEMORY_IMAGE_H_
+
+#include "region_memory.h"
+
+#include <cstddef> /* size_t */
+
+/* A region of a pool image. The mapping belongs to the Pool_image, and
+ * is not cleared: the contents outlive the pool instance.
+ */
+struct region_memory_image
+	: public region_memory
+{
+	region_memory_image(unsigned debug_level_, void *p, std::size_t size)
+		: region_memory(debug_level_, nullptr, 0)
+	{
+		iov_base = p;
+		iov_len = size;
+	}
+};
+
+#endif
@@ -0,0 +1,66 @@
+/*
+  Copyright [2017-2021] [IBM Corporation]
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+  http://www.apache.org/licenses/LICENSE-2.0
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+#ifndef _MCAS_MAPSTORE_VALUE_LOCK_H_
+#define _MCAS_MAPSTORE_VALUE_LOCK_H_
+
+#include <atomic>
+#include <cerrno> /* EBUSY, EPERM */
+#include <cstdint>
+
+/**
+ * Compact (4 byte) reader/writer lock for a key-value pair.
+ *
+ * Mapstore never waits for a value lock: lock, put, erase and swap_keys
+ * fail with E_LOCKED instead. So only the try operations are provided,
+ * with the return conventions of common::RWLock (0, or an errno value).
+ */
+class Value_lock {
+  static constexpr std::uint32_t WRITER = 1U << 31; /* else: count of readers */
+
+  std::atomic<std::uint32_t> _state;
+
+public:
+  Value_lock() : _state(0) {}
+  Value_lock(const Value_lock &) = delete;
+  Value_lock &operator=(const Value_lock &) = delete;
+
+  int read_trylock()
+  {
+    auto s = _state.load(std::memory_order_relaxed);
+    do {
+      if ( s & WRITER ) return EBUSY;
+    } while ( ! _state.compare_exchange_weak(s, s + 1, std::memory_order_acquire, std::memory_order_relaxed) );
+    return 0;
+  }
+
+  int write_trylock()
+  {
+    std::uint32_t s = 0;
+    return _state.compare_exchange_strong(s, WRITER, std::memory_order_acquire, std::memory_order_relaxed) ? 0 : EBUSY;
+  }
+
+  /* releases a write lock, or one read lock */
+  int unlock()
+  {
+    auto s = _state.load(std::memory_order_relaxed);
+    do {
+      if ( s == 0 ) return EPERM; /* not locked */
+    } while ( ! _state.compare_exchange_weak(s, s == WRITER ? 0 : s - 1, std::memory_order_release, std::memory_order_relaxed) );
+    return 0;
+  }
+};
+
+static_assert(sizeof(Value_lock) == 4, "Value_lock is meant to be compact");
+
+#endif
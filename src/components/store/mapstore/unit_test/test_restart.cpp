@@ -0,0 +1,198 @@
+/*
+   Copyright [2017-2021] [IBM Corporation]
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+       http://www.apache.org/licenses/LICENSE-2.0
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+/*
+ * Restartable pools (MAPSTORE_RESTARTABLE): a pool written by one process
+ * is reopened from its backing file by the next, and a reopen which fails
+ * leaves the file as it was.
+ *
+ * Pool instances last until process exit, which is when the image is
+ * written back, so each pool is written by a child process.
+ */
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Weffc++"
+#pragma GCC diagnostic ignored "-Wconversion"
+#pragma GCC diagnostic ignored "-Wsign-compare"
+#include <gtest/gtest.h>
+#pragma GCC diagnostic pop
+
+#include <api/components.h>
+#include <api/kvstore_itf.h>
+#include <common/utils.h> /* MiB */
+
+#include <fcntl.h> /* open */
+#include <sys/stat.h> /* stat */
+#include <sys/wait.h> /* waitpid */
+#include <unistd.h> /* fork, pread, rmdir, unlink */
+
+#include <algorithm> /* max */
+#include <cstdlib> /* exit, mkdtemp, setenv */
+#include <cstring> /* memcmp */
+#include <memory>
+#include <string>
+#include <utility> /* pair */
+#include <vector>
+
+using namespace component;
+
+namespace {
+
+std::string backing_dir;
+
+constexpr unsigned key_count = 1000;
+
+std::unique_ptr<IKVStore> make_store(const IKVStore_factory::map_create &mc_ = {})
+{
+  auto comp = component::load_component("libcomponent-mapstore.so", component::mapstore_factory);
+  if ( ! comp ) return nullptr;
+  auto fact = make_itf_ref(static_cast<IKVStore_factory *>(comp->query_interface(IKVStore_factory::iid())));
+  return std::unique_ptr<IKVStore>(fact->create(0, mc_));
+}
+
+std::string key_of(unsigned i)
+{
+  return "restart-key-" + std::to_string(i);
+}
+
+std::string value_of(unsigned i)
+{
+  /* some values inline-sized, some large */
+  return std::string(i % 7 == 0 ? 5000 : 20, char('a' + i % 26)) + std::to_string(i);
+}
+
+std::string backing_file(const std::string &pool_name_)
+{
+  return backing_dir + "/mapstore_backing_" + pool_name_ + ".dat";
+}
+
+/* In a child process: create the pool, put the keys and exit, which writes the image */
+int write_pool(const std::string &pool_name_)
+{
+  const auto pid = ::fork();
+  if ( pid == 0 )
+  {
+    int rc = 0;
+    {
+      auto kvstore = make_store();
+      if ( ! kvstore ) std::exit(2);
+      const auto id = kvstore->create_pool(pool_name_, MiB(32), 0, key_count);
+      if ( id == IKVStore::POOL_ERROR ) std::exit(3);
+      for ( unsigned i = 0; i != key_count; ++i )
+      {
+        const auto v = value_of(i);
+        if ( kvstore->put(id, key_of(i), v.data(), v.size()) != S_OK ) rc = 4;
+      }
+      if ( kvstore->close_pool(id) != S_OK ) rc = 5;
+    }
+    /* exit, not _exit: the pool instances are written back by static destructors */
+    std::exit(rc);
+  }
+  int status = -1;
+  if ( pid < 0 || ::waitpid(pid, &status, 0) != pid || ! WIFEXITED(status) ) return -1;
+  return WEXITSTATUS(status);
+}
+
+void check_keys(IKVStore *kvstore_, IKVStore::pool_t id_)
+{
+  EXPECT_EQ(key_count, kvstore_->count(id_));
+  for ( unsigned i = 0; i != key_count; ++i )
+  {
+    const auto ev = value_of(i);
+    void *value = nullptr;
+    std::size_t value_len = 0;
+    ASSERT_EQ(S_OK, kvstore_->get(id_, key_of(i), value, value_len)) << key_of(i);
+    EXPECT_EQ(ev.size(), value_len);
+    EXPECT_TRUE(ev.size() == value_len && 0 == std::memcmp(ev.data(), value, value_len)) << key_of(i);
+    kvstore_->free_memory(value);
+  }
+}
+
+/* size and leading bytes (the image header) of a file */
+std::pair<off_t, std::vector<char>> file_state(const std::string &path_)
+{
+  struct ::stat st;
+  std::vector<char> head(4096);
+  const int fd = ::open(path_.c_str(), O_RDONLY);
+  EXPECT_LE(0, fd) << path_;
+  EXPECT_EQ(0, ::fstat(fd, &st));
+  head.resize(std::size_t(std::max(::pread(fd, head.data(), head.size(), 0), ssize_t(0))));
+  ::close(fd);
+  return { st.st_size, head };
+}
+
+TEST(Restart_test, KeysSurviveRestart)
+{
+  const std::string pool_name = "test-restart";
+  ASSERT_EQ(0, write_pool(pool_name));
+
+  auto kvstore = make_store();
+  ASSERT_NE(nullptr, kvstore);
+  const auto id = kvstore->open_pool(pool_name);
+  ASSERT_NE(+IKVStore::POOL_ERROR, id);
+  check_keys(kvstore.get(), id);
+  EXPECT_EQ(S_OK, kvstore->close_pool(id));
+  EXPECT_EQ(S_OK, kvstore->delete_pool(pool_name));
+  ::unlink(backing_file(pool_name).c_str());
+}
+
+TEST(Restart_test, FailedReopenKeepsImage)
+{
+  const std::string pool_name = "test-restart-mismatch";
+  ASSERT_EQ(0, write_pool(pool_name));
+  const auto before = file_state(backing_file(pool_name));
+  ASSERT_LT(0, before.first);
+
+  /* a plugin which cannot inject allocations cannot reopen the image */
+  {
+    auto kvstore = make_store({{+IKVStore_factory::k_mm_plugin_path, "libmm-plugin-jemalloc.so"}});
+    ASSERT_NE(nullptr, kvstore);
+    EXPECT_EQ(+IKVStore::POOL_ERROR, kvstore->open_pool(pool_name));
+  }
+
+  const auto after = file_state(backing_file(pool_name));
+  EXPECT_EQ(before.first, after.first);
+  EXPECT_TRUE(before.second == after.second);
+
+  /* the image is still good */
+  auto kvstore = make_store();
+  ASSERT_NE(nullptr, kvstore);
+  const auto id = kvstore->open_pool(pool_name);
+  ASSERT_NE(+IKVStore::POOL_ERROR, id);
+  check_keys(kvstore.get(), id);
+  EXPECT_EQ(S_OK, kvstore->close_pool(id));
+  EXPECT_EQ(S_OK, kvstore->delete_pool(pool_name));
+  ::unlink(backing_file(pool_name).c_str());
+}
+
+} // namespace
+
+int main(int argc, char **argv)
+{
+  ::testing::InitGoogleTest(&argc, argv);
+
+  /* before the component loads: it reads MAPSTORE_RESTARTABLE once */
+  char dir[] = "/tmp/mapstore-restart-XXXXXX";
+  if ( ! ::mkdtemp(dir) )
+  {
+    return 1;
+  }
+  backing_dir = dir;
+  ::setenv("MAPSTORE_BACKING_STORE_DIR", dir, 1);
+  ::setenv("MAPSTORE_RESTARTABLE", "1", 1);
+
+  auto r = RUN_ALL_TESTS();
+
+  ::rmdir(dir);
+  return r;
+}
@@ -25,6 +25,8 @@ namespace
 		virtual status_t rc_attribute_numa_mask() const { return S_OK; }
 		virtual status_t rc_attribute_hashtable_expansion() const { return S_OK; }
 		virtual status_t rc_atomic_update() const { return S_OK; }
+		/* result of an iteration during which a key was added */
+		virtual status_t rc_disturbed_iteration() const { return E_ITERATOR_DISTURBED; }
 	};
 
 	struct custom_mapstore
@@ -38,6 +40,7 @@ namespace
 		bool swap_updates_timestamp() const override { return true; }
 
 		status_t rc_attribute_hashtable_expansion() const override { return E_NOT_SUPPORTED; }
+		status_t rc_disturbed_iteration() const override { return E_OUT_OF_BOUNDS; } /* snapshot iteration */
 		status_t rc_atomic_update() const override { return E_NOT_SUPPORTED; }
 	};
 
@@ -296,6 +296,19 @@ public:
 			return _kvstore->map_keys(_pool, std::forward<Args>(args) ...);
 		}
 
+	/**
+	 * Apply functor to part of one partition of the pool.
+	 *
+	 * @param args see IKVStore::map_partition
+	 *
+	 * @return see IKVStore::map_partition
+	 */
+	template <typename ... Args>
+		auto map_partition(Args && ... args)
+		{
+			return _kvstore->map_partition(_pool, std::forward<Args>(args) ...);
+		}
+
 	/**
 	 * Open pool iterator to iterate over objects in pool.
 	 *
@@ -32,8 +32,11 @@
 #include <nupm/region_descriptor.h>
 #include <cstddef> /* size_t */
 #include <iostream> /* cerr, cout */
+#include <map>
+#include <numeric> /* accumulate */
 #include <random>
 #include <string>
+#include <thread>
 
 #define ASSERT_OK(X) ASSERT_EQ(S_OK, (X))
 
@@ -750,7 +753,7 @@ TEST_F(KVStore_test, Iterator)
 				pool.put(key, value.c_str(), value.size());
 			}
 		}
-		EXPECT_EQ(E_ITERATOR_DISTURBED, rc);
+		EXPECT_EQ(cs->rc_disturbed_iteration(), rc);
 	}
 
 	PLOG("Closing pool.");
@@ -1881,6 +1884,110 @@ TEST_F(KVStore_test, EraseMany)
 	EXPECT_EQ(0, pool.count());
 }
 
+/* Puts, gets and erases from several threads to one pool (thread-safe pools only) */
+TEST_F(KVStore_test, ConcurrentPutGetErase)
+{
+	if ( _kvstore->thread_safety() != IKVStore::THREAD_MODEL_MULTI_PER_POOL )
+	{
+		PINF("%s: pools are not multi-thread safe, skipping", __func__);
+		return;
+	}
+
+	auto pool = create_pool("concurrent.pool", MiB(32));
+	ASSERT_LT(IKVStore::POOL_ERROR, pool.handle());
+
+	constexpr unsigned thread_count = 4;
+	constexpr unsigned key_count = 10000;
+	std::vector<std::thread> threads;
+	std::vector<unsigned> failures(thread_count);
+	for ( unsigned t = 0; t != thread_count; ++t )
+	{
+		threads.emplace_back(
+			[&pool, &failures, t] ()
+			{
+				for ( unsigned i = 0; i != key_count; ++i )
+				{
+					const auto key = common::format("t{}-{}", t, i);
+					const auto value = std::to_string(i);
+					if ( pool.put(key, value.data(), value.size()) != S_OK ) { ++failures[t]; }
+					char buffer[16];
+					std::size_t buffer_len = sizeof buffer;
+					if ( pool.get_direct(key, buffer, buffer_len) != S_OK || std::string(buffer, buffer_len) != value ) { ++failures[t]; }
+					/* erase every other key, leaving half */
+					if ( i % 2 && pool.erase(key) != S_OK ) { ++failures[t]; }
+				}
+			}
+		);
+	}
+	for ( auto &th : threads )
+	{
+		th.join();
+	}
+
+	for ( auto f : failures )
+	{
+		EXPECT_EQ(0, f);
+	}
+	EXPECT_EQ(thread_count * key_count / 2, pool.count());
+}
+
+/* Chunked map of a pool which is written between chunks (snapshot-iterating stores only) */
+TEST_F(KVStore_test, MapPartitionWhileWriting)
+{
+	if ( cs->rc_disturbed_iteration() == E_ITERATOR_DISTURBED )
+	{
+		PINF("%s: writes disturb iteration, skipping", __func__);
+		return;
+	}
+
+	auto pool = create_pool("map_partition.pool", MiB(32));
+	ASSERT_LT(IKVStore::POOL_ERROR, pool.handle());
+
+	constexpr unsigned key_count = 5000;
+	for ( unsigned i = 0; i != key_count; ++i )
+	{
+		const auto key = common::format("k{}", i);
+		ASSERT_OK(pool.put(key, key.data(), key.size()));
+	}
+
+	constexpr unsigned partition_count = 3;
+	std::map<std::string, unsigned> visits;
+	unsigned added = 0;
+	for ( unsigned partition = 0; partition != partition_count; ++partition )
+	{
+		IKVStore::map_cursor_t cursor;
+		status_t rc;
+		while (
+			( rc =
+				pool.map_partition(
+					partition, partition_count, cursor, 10
+					, [&visits] (const void *key, std::size_t key_len, const void *, std::size_t) -> int
+						{
+							++visits[std::string(static_cast<const char *>(key), key_len)];
+							return 0;
+						}
+				)
+			) == IKVStore::S_MORE
+		)
+		{
+			/* keys added after a partition map began are not visited in that partition */
+			const auto key = common::format("n{}", added++);
+			ASSERT_OK(pool.put(key, key.data(), key.size()));
+		}
+		ASSERT_OK(rc);
+	}
+
+	EXPECT_LT(0, added);
+	unsigned original = 0;
+	for ( const auto &v : visits )
+	{
+		original += v.first[0] == 'k';
+		EXPECT_EQ(1, v.second);
+	}
+	EXPECT_EQ(key_count, original);
+	EXPECT_EQ(S_OK, pool.close());
+}
+
 TEST_F(KVStore_test, AllocDealloc4K)
 {
 	auto pool = create_pool_sized(
@@ -2059,6 +2166,37 @@ TEST_F(KVStore_test, NumaMask)
 	}
 }
 
+/* Per-node hit counts (NUMA partitioned pools only) */
+TEST_F(KVStore_test, NumaHits)
+{
+	auto pool = create_pool("numaHits", MiB(8));
+
+	std::string key = "key";
+	ASSERT_OK(pool.put(key, key.data(), key.size()));
+	std::vector<uint64_t> hits;
+	auto r = pool.get_attribute(IKVStore::NUMA_HITS, hits);
+	if ( r == E_NOT_SUPPORTED )
+	{
+		PINF("%s: pool is not NUMA partitioned, skipping", __func__);
+		return;
+	}
+	ASSERT_OK(r);
+
+	std::vector<uint64_t> numa_mask;
+	ASSERT_OK(pool.get_attribute(IKVStore::NUMA_MASK, numa_mask));
+	ASSERT_EQ(1, numa_mask.size());
+	EXPECT_EQ(__builtin_popcountll(numa_mask[0]), hits.size());
+
+	/* a lookup which finds the key is a hit on (exactly) one node */
+	const auto before = std::accumulate(hits.begin(), hits.end(), uint64_t(0));
+	std::vector<uint64_t> value_len;
+	ASSERT_OK(pool.get_attribute(IKVStore::VALUE_LEN, value_len, &key));
+	hits.clear();
+	ASSERT_OK(pool.get_attribute(IKVStore::NUMA_HITS, hits));
+	EXPECT_EQ(before + 1, std::accumulate(hits.begin(), hits.end(), uint64_t(0)));
+	EXPECT_EQ(S_OK, pool.close());
+}
+
 } // namespace
 
 namespace c_json = common::json;
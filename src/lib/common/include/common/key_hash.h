@@ -0,0 +1,129 @@
+/*
+   Copyright [2021] [IBM Corporation]
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+       http://www.apache.org/licenses/LICENSE-2.0
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#ifndef __COMMON_KEY_HASH_H__
+#define __COMMON_KEY_HASH_H__
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+namespace common
+{
+/**
+ * Hash algorithms for store keys.  A store records the algorithm with
+ * the pool, because the layout of a persistent table depends on it; the
+ * values must therefore never change.  KEY_HASH_CITY (CityHash64) is
+ * computed by the stores, which already link cityhash.
+ */
+enum class key_hash_t : std::uint8_t {
+  KEY_HASH_CITY   = 0,
+  KEY_HASH_WY     = 1, /*< wyhash: two 64x64->128 multiplies for keys up to 16 bytes */
+  KEY_HASH_CRC32C = 2, /*< CRC32C, two lanes widened to 64 bits; SSE4.2 where available */
+};
+
+const char *key_hash_name(key_hash_t algorithm);
+
+namespace key_hash_detail
+{
+__extension__ typedef unsigned __int128 uint128_t;
+
+inline std::uint64_t mix(std::uint64_t a, std::uint64_t b)
+{
+  const auto r = static_cast<uint128_t>(a) * b;
+  return static_cast<std::uint64_t>(r) ^ static_cast<std::uint64_t>(r >> 64);
+}
+
+inline std::uint64_t read8(const std::uint8_t *p)
+{
+  std::uint64_t v;
+  std::memcpy(&v, p, sizeof v);
+  return v;
+}
+
+inline std::uint64_t read4(const std::uint8_t *p)
+{
+  std::uint32_t v;
+  std::memcpy(&v, p, sizeof v);
+  return v;
+}
+
+constexpr std::uint64_t wy_secret[4] = {0x2d358dccaa6c78a5ULL, 0x8bb84b93962eacc9ULL, 0x4b33a62ed433d4a3ULL,
+                                        0x4d5a2da51de1aa47ULL};
+}  // namespace key_hash_detail
+
+/**
+ * wyhash (final version 4), inline since most keys are short
+ */
+inline std::uint64_t wyhash64(const void *key, std::size_t len, std::uint64_t seed = 0)
+{
+  using namespace key_hash_detail;
+  auto        p = static_cast<const std::uint8_t *>(key);
+  const auto &s = wy_secret;
+  seed ^= mix(seed ^ s[0], s[1]);
+  std::uint64_t a, b;
+  if (len <= 16) {
+    if (len >= 4) {
+      const auto d = (len >> 3) << 2;
+      a            = (read4(p) << 32) | read4(p + d);
+      b            = (read4(p + len - 4) << 32) | read4(p + len - 4 - d);
+    }
+    else if (len > 0) {
+      a = (std::uint64_t(p[0]) << 16) | (std::uint64_t(p[len >> 1]) << 8) | p[len - 1];
+      b = 0;
+    }
+    else {
+      a = b = 0;
+    }
+  }
+  else {
+    auto i = len;
+    if (i > 48) {
+      auto see1 = seed, see2 = seed;
+      do {
+        seed = mix(read8(p) ^ s[1], read8(p + 8) ^ seed);
+        see1 = mix(read8(p + 16) ^ s[2], read8(p + 24) ^ see1);
+        see2 = mix(read8(p + 32) ^ s[3], read8(p + 40) ^ see2);
+        p += 48;
+        i -= 48;
+      } while (i > 48);
+      seed ^= see1 ^ see2;
+    }
+    while (i > 16) {
+      seed = mix(read8(p) ^ s[1], read8(p + 8) ^ seed);
+      i -= 16;
+      p += 16;
+    }
+    a = read8(p + i - 16);
+    b = read8(p + i - 8);
+  }
+  a ^= s[1];
+  b ^= seed;
+  const auto r = static_cast<uint128_t>(a) * b;
+  a            = static_cast<std::uint64_t>(r);
+  b            = static_cast<std::uint64_t>(r >> 64);
+  return mix(a ^ s[0] ^ len, b ^ s[1]);
+}
+
+/**
+ * CRC32C of the key in two lanes with different seeds, so that all 64
+ * bits of the result vary (hstore takes the bucket from the low bits and
+ * a fingerprint from the high bits).  Uses the crc32 instruction when
+ * built for SSE4.2, as common is on x86_64, else a table; both give the
+ * same value.
+ */
+std::uint64_t crc32c_hash64(const void *key, std::size_t len);
+
+}  // namespace common
+
+#endif  // __COMMON_KEY_HASH_H__
@@ -0,0 +1,80 @@
+/*
+   Copyright [2021] [IBM Corporation]
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+       http://www.apache.org/licenses/LICENSE-2.0
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#ifndef __COMMON_KEY_MATCHER_H__
+#define __COMMON_KEY_MATCHER_H__
+
+#include <memory>
+#include <string>
+
+namespace common
+{
+/**
+ * Compiled regular expression for key search.  Matching is whole-key,
+ * as std::regex_match with ECMAScript syntax.
+ *
+ * ENGINE_DFA simulates the expression as a DFA built lazily from a
+ * Thompson NFA, so matching is linear in the key length and does not
+ * backtrack.  It accepts literals, escapes (\d \w \s and their negations),
+ * '.', bracket classes, groups, alternation, the quantifiers * + ? {n,m}
+ * (lazy forms are equivalent for a whole-key match) and ^ and $ at the
+ * ends of the expression.  Other syntax (back references, assertions)
+ * falls back to ENGINE_STD, which is std::regex.
+ */
+class Key_matcher {
+ public:
+  enum engine_t {
+    ENGINE_DFA, /*< linear time; falls back to ENGINE_STD if unsupported */
+    ENGINE_STD, /*< std::regex */
+  };
+
+  /**
+   * Compile an expression
+   *
+   * @param expression ECMAScript regular expression
+   * @param engine Preferred engine
+   *
+   * @return Matcher; throws std::regex_error on an invalid expression
+   */
+  static std::unique_ptr<Key_matcher> create(const std::string &expression, engine_t engine = ENGINE_DFA);
+
+  virtual ~Key_matcher() {}
+
+  /**
+   * Match a whole key (not const: the DFA is built as keys are matched)
+   */
+  virtual bool match(const std::string &key) = 0;
+
+  virtual engine_t engine() const = 0;
+
+  const std::string &expression() const { return _expression; }
+
+  /**
+   * Literal which every matching key begins with, possibly empty, so
+   * that an ordered index can seek to it rather than scan
+   */
+  const std::string &literal_prefix() const { return _literal_prefix; }
+
+ protected:
+  Key_matcher(const std::string &expression, const std::string &literal_prefix)
+      : _expression(expression), _literal_prefix(literal_prefix)
+  {
+  }
+
+ private:
+  const std::string _expression;
+  const std::string _literal_prefix;
+};
+}  // namespace common
+
+#endif  // __COMMON_KEY_MATCHER_H__
@@ -0,0 +1,118 @@
+/*
+   Copyright [2021] [IBM Corporation]
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+       http://www.apache.org/licenses/LICENSE-2.0
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#include <common/key_hash.h>
+
+#include <array>
+#include <cstdint>
+
+#if defined(__SSE4_2__)
+#include <nmmintrin.h> /* _mm_crc32_u64 */
+#endif
+
+namespace common
+{
+namespace
+{
+/* lane seeds, and the multiplier which spreads the two lanes over 64 bits */
+constexpr std::uint32_t seed_lo = 0xffffffffU;
+constexpr std::uint32_t seed_hi = 0x9e3779b9U;
+constexpr std::uint64_t spread  = 0x9e3779b97f4a7c15ULL;
+
+#if defined(__SSE4_2__)
+inline std::uint32_t crc32c_u64(std::uint32_t crc, std::uint64_t v)
+{
+  return static_cast<std::uint32_t>(_mm_crc32_u64(crc, v));
+}
+#else
+/* reflected Castagnoli polynomial, as used by the SSE4.2 crc32 instruction */
+constexpr std::uint32_t crc32c_poly = 0x82f63b78U;
+
+constexpr std::array<std::uint32_t, 256> make_crc32c_table()
+{
+  std::array<std::uint32_t, 256> t{};
+  for (std::uint32_t i = 0; i != 256; ++i) {
+    auto c = i;
+    for (unsigned k = 0; k != 8; ++k) c = c & 1U ? (c >> 1) ^ crc32c_poly : c >> 1;
+    t[i] = c;
+  }
+  return t;
+}
+
+constexpr auto crc32c_table = make_crc32c_table();
+
+/* one byte at a time, as the crc32 instruction: no pre or post inversion */
+inline std::uint32_t crc32c_u64(std::uint32_t crc, std::uint64_t v)
+{
+  for (unsigned k = 0; k != 8; ++k) {
+    crc = crc32c_table[(crc ^ static_cast<std::uint32_t>(v)) & 0xffU] ^ (crc >> 8);
+    v >>= 8;
+  }
+  return crc;
+}
+#endif
+}  // namespace
+
+/*
+ * The lanes take alternate words, so each crc32 chain is half the key
+ * long and the two overlap.  Like wyhash, the last (or only) 16 bytes are
+ * read as two words which may overlap the ones before, rather than a
+ * zero-padded tail: that avoids a variable-length copy, and the length
+ * is part of the result.
+ */
+std::uint64_t crc32c_hash64(const void *key, std::size_t len)
+{
+  using key_hash_detail::read4;
+  using key_hash_detail::read8;
+  auto          p  = static_cast<const std::uint8_t *>(key);
+  std::uint32_t lo = seed_lo;
+  std::uint32_t hi = seed_hi;
+  if (len > 16) {
+    auto i = len;
+    for (; i > 16; i -= 16, p += 16) {
+      lo = crc32c_u64(lo, read8(p));
+      hi = crc32c_u64(hi, read8(p + 8));
+    }
+    lo = crc32c_u64(lo, read8(p + i - 16));
+    hi = crc32c_u64(hi, read8(p + i - 8));
+  }
+  else if (len >= 8) {
+    lo = crc32c_u64(lo, read8(p));
+    hi = crc32c_u64(hi, read8(p + len - 8));
+  }
+  else if (len >= 4) {
+    const auto v = read4(p) << 32 | read4(p + len - 4);
+    lo           = crc32c_u64(lo, v);
+    hi           = crc32c_u64(hi, v);
+  }
+  else if (len > 0) {
+    const auto v = std::uint64_t(p[0]) << 16 | std::uint64_t(p[len >> 1]) << 8 | p[len - 1];
+    lo           = crc32c_u64(lo, v);
+    hi           = crc32c_u64(hi, v);
+  }
+  return key_hash_detail::mix((std::uint64_t(hi) << 32 | lo) ^ len, spread);
+}
+
+const char *key_hash_name(key_hash_t algorithm)
+{
+  switch (algorithm) {
+    case key_hash_t::KEY_HASH_CITY:
+      return "city";
+    case key_hash_t::KEY_HASH_WY:
+      return "wyhash";
+    case key_hash_t::KEY_HASH_CRC32C:
+      return "crc32c";
+  }
+  return "unknown";
+}
+}  // namespace common
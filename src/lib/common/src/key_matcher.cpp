@@ -0,0 +1,561 @@
+/*
+   Copyright [2021] [IBM Corporation]
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+       http://www.apache.org/licenses/LICENSE-2.0
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#include <common/key_matcher.h>
+
+#include <algorithm> /* min */
+#include <bitset>
+#include <cctype> /* isdigit, isalnum */
+#include <cstdint>
+#include <map>
+#include <regex>
+#include <vector>
+
+namespace common
+{
+namespace
+{
+using byte_set = std::bitset<256>;
+
+/* syntax the DFA engine does not handle; the expression goes to std::regex */
+struct unsupported {
+};
+
+struct node {
+  enum kind_t { EMPTY, SET, CAT, ALT, REPEAT } kind;
+  unsigned          set; /* SET: index into the parser's sets */
+  unsigned          min; /* REPEAT */
+  unsigned          max; /* REPEAT: UNBOUNDED for no limit */
+  std::vector<node> kids;
+
+  static constexpr unsigned UNBOUNDED = ~0U;
+
+  explicit node(kind_t k) : kind(k), set(0), min(0), max(0), kids() {}
+};
+
+/**
+ * Recursive descent parser for the ECMAScript subset described in
+ * key_matcher.h
+ */
+class parser {
+  static constexpr unsigned MAX_REPEAT = 1000;
+
+  const std::string &_expr;
+  std::size_t        _pos;
+  unsigned           _depth;
+
+ public:
+  std::vector<byte_set> sets;
+
+  explicit parser(const std::string &expr) : _expr(expr), _pos(0), _depth(0), sets() {}
+
+  node parse()
+  {
+    auto n = parse_alt();
+    if (_pos != _expr.size()) throw unsupported{};
+    return n;
+  }
+
+ private:
+  bool at_end() const { return _pos == _expr.size(); }
+  char peek() const { return _expr[_pos]; }
+
+  node make_set(const byte_set &s)
+  {
+    node n(node::SET);
+    n.set = unsigned(sets.size());
+    sets.push_back(s);
+    return n;
+  }
+
+  node parse_alt()
+  {
+    node first = parse_cat();
+    if (at_end() || peek() != '|') return first;
+
+    node alt(node::ALT);
+    alt.kids.push_back(std::move(first));
+    while (!at_end() && peek() == '|') {
+      ++_pos;
+      alt.kids.push_back(parse_cat());
+    }
+    return alt;
+  }
+
+  node parse_cat()
+  {
+    node cat(node::CAT);
+    while (!at_end() && peek() != '|' && peek() != ')') {
+      cat.kids.push_back(parse_repeat());
+    }
+    return cat;
+  }
+
+  node parse_repeat()
+  {
+    const bool anchor = peek() == '^' || peek() == '$';
+    node       n      = parse_atom();
+
+    if (at_end()) return n;
+
+    unsigned min, max;
+    switch (peek()) {
+    case '*': min = 0, max = node::UNBOUNDED, ++_pos; break;
+    case '+': min = 1, max = node::UNBOUNDED, ++_pos; break;
+    case '?': min = 0, max = 1, ++_pos; break;
+    case '{': parse_braces(min, max); break;
+    default: return n;
+    }
+    if (anchor) throw unsupported{};
+    /* lazy: same language, and whole-key matching has no submatches */
+    if (!at_end() && peek() == '?') ++_pos;
+
+    node r(node::REPEAT);
+    r.min = min;
+    r.max = max;
+    r.kids.push_back(std::move(n));
+    return r;
+  }
+
+  unsigned parse_number()
+  {
+    if (at_end() || !std::isdigit(static_cast<unsigned char>(peek()))) throw unsupported{};
+    unsigned v = 0;
+    while (!at_end() && std::isdigit(static_cast<unsigned char>(peek()))) {
+      v = v * 10 + unsigned(peek() - '0');
+      if (v > MAX_REPEAT) throw unsupported{};
+      ++_pos;
+    }
+    return v;
+  }
+
+  void parse_braces(unsigned &min, unsigned &max)
+  {
+    ++_pos; /* { */
+    min = max = parse_number();
+    if (!at_end() && peek() == ',') {
+      ++_pos;
+      max = (!at_end() && peek() == '}') ? node::UNBOUNDED : parse_number();
+    }
+    if (at_end() || peek() != '}' || max < min) throw unsupported{};
+    ++_pos;
+  }
+
+  node parse_atom()
+  {
+    const char c = peek();
+    switch (c) {
+    case '(': {
+      ++_pos;
+      if (_expr.compare(_pos, 2, "?:") == 0)
+        _pos += 2;
+      else if (!at_end() && peek() == '?')
+        throw unsupported{}; /* assertion */
+      ++_depth;
+      node n = parse_alt();
+      --_depth;
+      if (at_end() || peek() != ')') throw unsupported{};
+      ++_pos;
+      return n;
+    }
+    case '[':
+      return make_set(parse_class());
+    case '.': {
+      ++_pos;
+      byte_set s;
+      s.set();
+      s.reset('\n');
+      s.reset('\r');
+      return make_set(s);
+    }
+    case '\\':
+      ++_pos;
+      return make_set(parse_escape());
+    case '^':
+      /* a no-op for a whole-key match, but only at the very start */
+      if (_pos != 0) throw unsupported{};
+      ++_pos;
+      return node(node::EMPTY);
+    case '$':
+      if (_pos + 1 != _expr.size() || _depth != 0) throw unsupported{};
+      ++_pos;
+      return node(node::EMPTY);
+    case '*':
+    case '+':
+    case '?':
+    case '{':
+      throw unsupported{}; /* quantifier without an atom */
+    default: {
+      ++_pos;
+      byte_set s;
+      s.set(static_cast<unsigned char>(c));
+      return make_set(s);
+    }
+    }
+  }
+
+  static byte_set range(unsigned char from, unsigned char to)
+  {
+    byte_set s;
+    for (unsigned i = from; i <= to; ++i) s.set(i);
+    return s;
+  }
+
+  byte_set parse_escape()
+  {
+    if (at_end()) throw unsupported{};
+    const char c = _expr[_pos++];
+    byte_set   s;
+    switch (c) {
+    case 'd': return range('0', '9');
+    case 'D': return ~range('0', '9');
+    case 'w': return range('a', 'z') | range('A', 'Z') | range('0', '9') | range('_', '_');
+    case 'W': return ~(range('a', 'z') | range('A', 'Z') | range('0', '9') | range('_', '_'));
+    case 's': return range('\t', '\r') | range(' ', ' ');
+    case 'S': return ~(range('\t', '\r') | range(' ', ' '));
+    case 't': s.set('\t'); return s;
+    case 'n': s.set('\n'); return s;
+    case 'r': s.set('\r'); return s;
+    case 'f': s.set('\f'); return s;
+    case 'v': s.set('\v'); return s;
+    default:
+      /* \b, back references, \x, \u, \c ... */
+      if (std::isalnum(static_cast<unsigned char>(c))) throw unsupported{};
+      s.set(static_cast<unsigned char>(c));
+      return s;
+    }
+  }
+
+  byte_set parse_class()
+  {
+    ++_pos; /* [ */
+    bool negate = false;
+    if (!at_end() && peek() == '^') {
+      negate = true;
+      ++_pos;
+    }
+
+    byte_set s;
+    while (!at_end() && peek() != ']') {
+      if (peek() == '[' && _pos + 1 < _expr.size() && std::string(":=.").find(_expr[_pos + 1]) != std::string::npos)
+        throw unsupported{}; /* [:alpha:] etc. */
+
+      bool          single = true;
+      unsigned char lo     = 0;
+      if (peek() == '\\') {
+        ++_pos;
+        auto e = parse_escape();
+        if (e.count() == 1) {
+          for (unsigned i = 0; i != 256; ++i)
+            if (e.test(i)) lo = static_cast<unsigned char>(i);
+        }
+        else {
+          single = false;
+          s |= e;
+        }
+      }
+      else {
+        lo = static_cast<unsigned char>(_expr[_pos++]);
+      }
+
+      if (!single) continue;
+
+      /* range, unless '-' is last */
+      if (_pos + 1 < _expr.size() && peek() == '-' && _expr[_pos + 1] != ']') {
+        ++_pos;
+        unsigned char hi;
+        if (peek() == '\\') {
+          ++_pos;
+          auto e = parse_escape();
+          if (e.count() != 1) throw unsupported{};
+          hi = 0;
+          for (unsigned i = 0; i != 256; ++i)
+            if (e.test(i)) hi = static_cast<unsigned char>(i);
+        }
+        else
+          hi = static_cast<unsigned char>(_expr[_pos++]);
+        if (hi < lo || hi > 0x7f) throw unsupported{}; /* std::regex orders chars as signed */
+        s |= range(lo, hi);
+      }
+      else
+        s.set(lo);
+    }
+    if (at_end()) throw unsupported{};
+    ++_pos; /* ] */
+    return negate ? ~s : s;
+  }
+};
+
+/* append the literal every match of n begins with; true if n is wholly that literal */
+bool prefix_of(const node &n, const std::vector<byte_set> &sets, std::string &out)
+{
+  switch (n.kind) {
+  case node::EMPTY:
+    return true;
+  case node::SET: {
+    const auto &s = sets[n.set];
+    if (s.count() != 1) return false;
+    for (unsigned i = 0; i != 256; ++i)
+      if (s.test(i)) out.push_back(char(i));
+    return true;
+  }
+  case node::CAT:
+    for (const auto &k : n.kids)
+      if (!prefix_of(k, sets, out)) return false;
+    return true;
+  case node::REPEAT:
+    for (unsigned i = 0; i != n.min; ++i)
+      if (!prefix_of(n.kids[0], sets, out)) return false;
+    return n.min == n.max;
+  case node::ALT: {
+    /* common prefix of the alternatives */
+    std::string common;
+    bool        first = true;
+    for (const auto &k : n.kids) {
+      std::string p;
+      prefix_of(k, sets, p);
+      if (first)
+        common = p;
+      else
+        common.resize(std::size_t(std::mismatch(common.begin(), common.end(), p.begin(), p.end()).first - common.begin()));
+      first = false;
+    }
+    out += common;
+    return false;
+  }
+  }
+  return false;
+}
+
+class Std_matcher : public Key_matcher {
+  std::regex _regex;
+
+ public:
+  Std_matcher(const std::string &expression, const std::string &prefix)
+      : Key_matcher(expression, prefix), _regex(expression)
+  {
+  }
+  bool     match(const std::string &key) override { return std::regex_match(key, _regex); }
+  engine_t engine() const override { return ENGINE_STD; }
+};
+
+/**
+ * Thompson NFA simulated as a DFA whose states are built on first use
+ * and cached.  Bytes which no set distinguishes share a column of the
+ * transition table.  When the cache is full it is discarded and
+ * rebuilt, so memory is bounded whatever the expression.
+ */
+class Dfa_matcher : public Key_matcher {
+  static constexpr std::size_t MAX_NFA_STATES = 100000;
+  static constexpr std::size_t MAX_DFA_STATES = 4096;
+  static constexpr int         UNKNOWN        = -1;
+
+  struct nfa_state {
+    enum kind_t { SET, SPLIT, MATCH } kind;
+    unsigned set;
+    int      out;
+    int      out1;
+  };
+
+  std::vector<byte_set>  _sets;
+  std::vector<nfa_state> _nfa;
+  int                    _nfa_start;
+
+  std::uint8_t _class_of[256]; /* byte to column */
+  unsigned     _class_count;
+
+  using state_set = std::vector<int>;
+  std::vector<state_set>    _dstates;
+  std::vector<bool>         _daccept;
+  std::vector<int>          _dtrans; /* _dstates.size() * _class_count */
+  std::map<state_set, int>  _dindex;
+  int                       _dstart;
+  std::vector<unsigned>     _mark; /* closure visit generation per NFA state */
+  unsigned                  _generation;
+
+ public:
+  Dfa_matcher(const std::string &expression, const std::string &prefix, const node &root, std::vector<byte_set> &&sets)
+      : Key_matcher(expression, prefix),
+        _sets(std::move(sets)),
+        _nfa(),
+        _nfa_start(0),
+        _class_of{},
+        _class_count(0),
+        _dstates(),
+        _daccept(),
+        _dtrans(),
+        _dindex(),
+        _dstart(0),
+        _mark(),
+        _generation(0)
+  {
+    nfa_state m{nfa_state::MATCH, 0, UNKNOWN, UNKNOWN};
+    _nfa.push_back(m);
+    _nfa_start = emit(root, 0);
+    _mark.assign(_nfa.size(), 0);
+    build_classes();
+    reset_cache();
+  }
+
+  engine_t engine() const override { return ENGINE_DFA; }
+
+  bool match(const std::string &key) override
+  {
+    int d = _dstart;
+    for (auto c : key) {
+      const auto cls = _class_of[static_cast<unsigned char>(c)];
+      int        n   = _dtrans[std::size_t(d) * _class_count + cls];
+      if (n == UNKNOWN) n = step(d, cls);
+      if (_dstates[std::size_t(n)].empty()) return false; /* dead */
+      d = n;
+    }
+    return _daccept[std::size_t(d)];
+  }
+
+ private:
+  int new_state(const nfa_state &s)
+  {
+    if (_nfa.size() == MAX_NFA_STATES) throw unsupported{};
+    _nfa.push_back(s);
+    return int(_nfa.size() - 1);
+  }
+
+  /* compile n backwards: returns the start of a fragment which continues at next */
+  int emit(const node &n, int next)
+  {
+    switch (n.kind) {
+    case node::EMPTY:
+      return next;
+    case node::SET:
+      return new_state({nfa_state::SET, n.set, next, UNKNOWN});
+    case node::CAT:
+      for (auto it = n.kids.rbegin(); it != n.kids.rend(); ++it) next = emit(*it, next);
+      return next;
+    case node::ALT: {
+      int start = emit(n.kids.back(), next);
+      for (auto it = std::next(n.kids.rbegin()); it != n.kids.rend(); ++it)
+        start = new_state({nfa_state::SPLIT, 0, emit(*it, next), start});
+      return start;
+    }
+    case node::REPEAT: {
+      const node &k    = n.kids[0];
+      int         tail = next;
+      if (n.max == node::UNBOUNDED) {
+        int loop           = new_state({nfa_state::SPLIT, 0, UNKNOWN, next});
+        _nfa[std::size_t(loop)].out = emit(k, loop);
+        tail               = loop;
+      }
+      else {
+        for (unsigned i = n.min; i != n.max; ++i) tail = new_state({nfa_state::SPLIT, 0, emit(k, tail), next});
+      }
+      for (unsigned i = 0; i != n.min; ++i) tail = emit(k, tail);
+      return tail;
+    }
+    }
+    return next;
+  }
+
+  void build_classes()
+  {
+    std::map<std::vector<bool>, std::uint8_t> columns;
+    for (unsigned b = 0; b != 256; ++b) {
+      std::vector<bool> signature;
+      signature.reserve(_sets.size());
+      for (const auto &s : _sets) signature.push_back(s.test(b));
+      auto it = columns.emplace(std::move(signature), std::uint8_t(columns.size())).first;
+      _class_of[b] = it->second;
+    }
+    _class_count = unsigned(columns.size());
+  }
+
+  void closure(int s, state_set &out)
+  {
+    if (s == UNKNOWN || _mark[std::size_t(s)] == _generation) return;
+    _mark[std::size_t(s)] = _generation;
+    const auto &st = _nfa[std::size_t(s)];
+    if (st.kind == nfa_state::SPLIT) {
+      closure(st.out, out);
+      closure(st.out1, out);
+    }
+    else
+      out.push_back(s);
+  }
+
+  int add_state(state_set &&set)
+  {
+    std::sort(set.begin(), set.end());
+    auto it = _dindex.find(set);
+    if (it != _dindex.end()) return it->second;
+
+    const int d   = int(_dstates.size());
+    bool      acc = false;
+    for (auto s : set) acc |= _nfa[std::size_t(s)].kind == nfa_state::MATCH;
+    _dindex.emplace(set, d);
+    _dstates.push_back(std::move(set));
+    _daccept.push_back(acc);
+    _dtrans.resize(_dstates.size() * _class_count, UNKNOWN);
+    return d;
+  }
+
+  void reset_cache()
+  {
+    _dstates.clear();
+    _daccept.clear();
+    _dtrans.clear();
+    _dindex.clear();
+    state_set start;
+    ++_generation;
+    closure(_nfa_start, start);
+    _dstart = add_state(std::move(start));
+  }
+
+  int step(int d, unsigned cls)
+  {
+    /* any byte of the column will do */
+    unsigned byte = 0;
+    while (_class_of[byte] != cls) ++byte;
+
+    state_set next;
+    ++_generation;
+    for (auto s : _dstates[std::size_t(d)]) {
+      const auto &st = _nfa[std::size_t(s)];
+      if (st.kind == nfa_state::SET && _sets[st.set].test(byte)) closure(st.out, next);
+    }
+    std::sort(next.begin(), next.end());
+
+    if (_dstates.size() >= MAX_DFA_STATES && _dindex.find(next) == _dindex.end()) {
+      reset_cache(); /* d is no longer valid: do not record the transition */
+      return add_state(std::move(next));
+    }
+    const int n = add_state(std::move(next));
+    _dtrans[std::size_t(d) * _class_count + cls] = n;
+    return n;
+  }
+};
+}  // namespace
+
+std::unique_ptr<Key_matcher> Key_matcher::create(const std::string &expression, engine_t engine)
+{
+  std::string prefix;
+  try {
+    parser p(expression);
+    node   root = p.parse();
+    prefix_of(root, p.sets, prefix);
+    if (engine == ENGINE_DFA) return std::unique_ptr<Key_matcher>(new Dfa_matcher(expression, prefix, root, std::move(p.sets)));
+  }
+  catch (const unsupported &) {
+    prefix.clear();
+  }
+  return std::unique_ptr<Key_matcher>(new Std_matcher(expression, prefix));
+}
+}  // namespace common
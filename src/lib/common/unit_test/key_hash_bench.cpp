@@ -0,0 +1,73 @@
+/*
+ * Compare the key hash algorithms a store pool may be created with
+ * (CityHash64, wyhash, CRC32C) over keys of 8 to 64 bytes: per key
+ * length, and over keys with lengths drawn uniformly from that range,
+ * which defeats the branch predictor as a real key mix does.
+ *
+ * usage: libcommon-key-hash-bench [key count] [rounds]
+ */
+#include <common/key_hash.h>
+#include <common/logging.h>
+#include <common/str_utils.h>
+
+#include <city.h>
+
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace
+{
+constexpr std::size_t MIN_LENGTH = 8;
+constexpr std::size_t MAX_LENGTH = 64;
+
+/* ns per key; the hashes are summed so that none are optimized away */
+template <typename Hash>
+double run(Hash hash, const std::vector<std::string> &keys, unsigned rounds, std::uint64_t &sink)
+{
+  const auto start = std::chrono::steady_clock::now();
+  for (unsigned r = 0; r != rounds; ++r) {
+    for (const auto &k : keys) sink += hash(k.data(), k.size());
+  }
+  const std::chrono::duration<double, std::nano> t = std::chrono::steady_clock::now() - start;
+  return t.count() / double(keys.size() * rounds);
+}
+
+std::vector<std::string> make_keys(std::size_t count, std::size_t min_length, std::size_t max_length)
+{
+  std::mt19937_64                            g(42);
+  std::uniform_int_distribution<std::size_t> d(min_length, max_length);
+  std::vector<std::string>                   keys;
+  keys.reserve(count);
+  for (std::size_t i = 0; i != count; ++i) keys.push_back(common::random_string(d(g)));
+  return keys;
+}
+
+void report(const char *label, const std::vector<std::string> &keys, unsigned rounds, std::uint64_t &sink)
+{
+  /* called as the stores call them: CityHash64 and crc32c_hash64 out of line, wyhash64 inline */
+  const double city   = run([](const char *p, std::size_t n) { return CityHash64(p, n); }, keys, rounds, sink);
+  const double wyhash = run([](const char *p, std::size_t n) { return common::wyhash64(p, n); }, keys, rounds, sink);
+  const double crc32c = run([](const char *p, std::size_t n) { return common::crc32c_hash64(p, n); }, keys, rounds, sink);
+  PINF("%-10s city %6.2f ns  wyhash %6.2f ns  crc32c %6.2f ns", label, city, wyhash, crc32c);
+}
+}  // namespace
+
+int main(int argc, char **argv)
+{
+  const std::size_t count  = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 4096;
+  const unsigned    rounds = argc > 2 ? unsigned(std::strtoul(argv[2], nullptr, 10)) : 1000;
+
+  std::uint64_t sink = 0;
+
+  for (std::size_t len = MIN_LENGTH; len <= MAX_LENGTH; len *= 2) {
+    report(("len " + std::to_string(len)).c_str(), make_keys(count, len, len), rounds, sink);
+  }
+  report("len 8-64", make_keys(count, MIN_LENGTH, MAX_LENGTH), rounds, sink);
+
+  PLOG("sink %lx", sink);
+  return 0;
+}
@@ -1,5 +1,7 @@
 /* note: we do not include component source, only the API definition */
 #include <common/cycles.h>
+#include <common/key_hash.h>
+#include <common/key_matcher.h>
 #include <common/mpmc_bounded_queue.h>
 #include <common/rand.h>
 #include <common/utils.h>
@@ -9,6 +11,9 @@
 #include <gtest/gtest.h>
 #pragma GCC diagnostic pop
 
+#include <regex>
+#include <set>
+#include <string>
 #include <thread>
 
 //#define TEST_MPMC
@@ -110,6 +115,65 @@ TEST_F(Libcommon_test, get_rdtsc_frequency_mhz)
   PMAJOR("Clock frequency %f MHz", common::get_rdtsc_frequency_mhz());
 }
 
+TEST_F(Libcommon_test, key_matcher)
+{
+  using common::Key_matcher;
+
+  const char *exprs[] = {"^abc.*",     "user/[0-9]+/name", "(foo|foobar)x.*", "a\\.b+?",  "ab{2,3}c",
+                         "[^a-c]*\\d$", "(?:x|y)*z",        "\\w+\\s\\w+",     ".*(ab|ba).*", "[]a]"};
+  const char *keys[]  = {"",         "abc",       "abcdef",     "user/42/name", "user//name", "foox",
+                         "foobarx1", "a.bbb",     "abbc",       "abbbbc",       "xyz1",       "xyxyz",
+                         "hello you", "hello\nyou", "cab",      "]a",           "a"};
+
+  for (auto e : exprs) {
+    auto       m = Key_matcher::create(e);
+    std::regex r(e);
+    ASSERT_EQ(Key_matcher::ENGINE_DFA, m->engine()) << e;
+    for (auto k : keys) {
+      ASSERT_EQ(std::regex_match(k, r), m->match(k)) << e << " " << k;
+    }
+  }
+
+  ASSERT_EQ("abc", Key_matcher::create("^abc.*")->literal_prefix());
+  ASSERT_EQ("user/", Key_matcher::create("user/[0-9]+/name")->literal_prefix());
+  ASSERT_EQ("foo", Key_matcher::create("(foo|foobar)x.*")->literal_prefix());
+  ASSERT_EQ("", Key_matcher::create(".*abc")->literal_prefix());
+
+  /* assertions are not DFA syntax: std::regex is used instead */
+  auto m = Key_matcher::create("(?=a)ab");
+  ASSERT_EQ(Key_matcher::ENGINE_STD, m->engine());
+  ASSERT_TRUE(m->match("ab"));
+
+  ASSERT_THROW(Key_matcher::create("(a"), std::regex_error);
+}
+
+TEST_F(Libcommon_test, key_hash)
+{
+  using common::crc32c_hash64;
+  using common::wyhash64;
+
+  std::set<std::uint64_t> wy, crc;
+  std::set<unsigned>      crc_high_byte;
+  std::string             k;
+  for (unsigned i = 0; i != 10000; ++i) {
+    k = "key/" + std::to_string(i);
+    ASSERT_EQ(wyhash64(k.data(), k.size()), wyhash64(k.data(), k.size()));
+    ASSERT_EQ(crc32c_hash64(k.data(), k.size()), crc32c_hash64(k.data(), k.size()));
+    wy.insert(wyhash64(k.data(), k.size()));
+    crc.insert(crc32c_hash64(k.data(), k.size()));
+    crc_high_byte.insert(unsigned(crc32c_hash64(k.data(), k.size()) >> 56));
+  }
+  ASSERT_EQ(10000U, wy.size());
+  ASSERT_EQ(10000U, crc.size());
+  /* both lanes reach the high bits */
+  ASSERT_EQ(256U, crc_high_byte.size());
+
+  /* the zero-padded tail does not collide with a shorter key */
+  const std::string a("ab"), b("ab\0", 3);
+  ASSERT_NE(crc32c_hash64(a.data(), a.size()), crc32c_hash64(b.data(), b.size()));
+  ASSERT_NE(wyhash64(a.data(), a.size()), wyhash64(b.data(), b.size()));
+}
+
 //-------------------------------
 
 int main(int argc, char** argv)
@@ -0,0 +1,61 @@
+/*
+   Copyright [2020] [IBM Corporation]
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+       http://www.apache.org/licenses/LICENSE-2.0
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+
+#include "memcpy_persist.h"
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wold-style-cast"
+#include <libpmem.h>
+#pragma GCC diagnostic pop
+
+#include <common/logging.h>
+#include <cstdlib> /* getenv, strtoull */
+
+namespace
+{
+  std::size_t threshold_from_env()
+  {
+    const char *env = ::getenv("NUPM_MEMCPY_NT_THRESHOLD");
+    if ( env )
+    {
+      char *end = nullptr;
+      auto t = std::strtoull(env, &end, 0);
+      if ( end != env && *end == '\0' )
+      {
+        return t;
+      }
+      PWRN("%s: ignoring malformed NUPM_MEMCPY_NT_THRESHOLD '%s'", __func__, env);
+    }
+    return nupm::MEMCPY_NT_THRESHOLD_DEFAULT;
+  }
+}
+
+std::size_t nupm::memcpy_nt_threshold()
+{
+  static const std::size_t t = threshold_from_env();
+  return t;
+}
+
+void *nupm::memcpy_persist(void *dst, const void *src, std::size_t len, std::size_t nt_threshold)
+{
+  /* libpmem selects the widest available (AVX512F, AVX, SSE2) movnt
+   * implementation at load time; the flags only choose between it and
+   * the temporal copy + flush.
+   */
+  return
+    pmem_memcpy(
+      dst, src, len
+      , len < nt_threshold ? PMEM_F_MEM_TEMPORAL : PMEM_F_MEM_NONTEMPORAL
+    );
+}
@@ -1,6 +1,7 @@
 #include "region_modifications.h"
 #include "allocator_ra.h"
 #include "rc_alloc_lb.h"
+#include "memcpy_persist.h"
 
 #pragma GCC diagnostic push
 #pragma GCC diagnostic ignored "-Weffc++"
@@ -8,7 +9,14 @@
 #include <gtest/gtest.h>
 #pragma GCC diagnostic pop
 
+#include <fcntl.h> /* open */
+#include <sys/mman.h> /* mmap */
+#include <unistd.h> /* close */
+#include <chrono>
+#include <cstdlib> /* getenv */
+#include <limits>
 #include <memory>
+#include <vector>
 
 //#define GPERF_TOOLS
 
@@ -239,6 +247,65 @@ TEST_F(Libnupm_test, RCA_LB_allocator_issue155)
 }
 
 
+TEST_F(Libnupm_test, MemcpyPersistCrossover)
+{
+  /* Compares temporal (copy and flush) and non-temporal copies, by size, to
+   * choose NUPM_MEMCPY_NT_THRESHOLD. The destination is anonymous memory
+   * unless NUPM_MEMCPY_BENCH_PATH names a file (on a DAX file system, or a
+   * devdax device) of at least ARENA_SIZE bytes. The destination address
+   * advances through the arena so that the copies do not simply hit in
+   * the cache.
+   */
+  constexpr std::size_t ARENA_SIZE = std::size_t(1) << 28;
+  constexpr std::size_t TOTAL_BYTES = std::size_t(1) << 29;
+  void *arena = nullptr;
+  if ( const char *path = ::getenv("NUPM_MEMCPY_BENCH_PATH") )
+  {
+    int fd = ::open(path, O_RDWR);
+    ASSERT_LE(0, fd);
+    arena = ::mmap(nullptr, ARENA_SIZE, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    ::close(fd);
+  }
+  else
+  {
+    arena = ::mmap(nullptr, ARENA_SIZE, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_POPULATE, -1, 0);
+  }
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wold-style-cast"
+  ASSERT_NE(MAP_FAILED, arena);
+#pragma GCC diagnostic pop
+
+  std::vector<char> src(std::size_t(1) << 22, 'x');
+  PLOG("MemcpyPersistCrossover: current threshold %zu", nupm::memcpy_nt_threshold());
+  for ( std::size_t len = 256; len <= src.size(); len *= 2 )
+  {
+    double gbps[2];
+    for ( unsigned nt = 0; nt != 2; ++nt )
+    {
+      const auto threshold = nt ? 0 : std::numeric_limits<std::size_t>::max();
+      const auto iterations = TOTAL_BYTES / len;
+      std::size_t offset = 0;
+      auto start = std::chrono::high_resolution_clock::now();
+      for ( std::size_t i = 0; i != iterations; ++i )
+      {
+        if ( ARENA_SIZE < offset + len )
+        {
+          offset = 0;
+        }
+        nupm::memcpy_persist(static_cast<char *>(arena) + offset, src.data(), len, threshold);
+        offset += len;
+      }
+      auto end = std::chrono::high_resolution_clock::now();
+      auto secs = std::chrono::duration<double>(end - start).count();
+      gbps[nt] = double(iterations * len) / secs / 1e9;
+    }
+    PINF("MemcpyPersistCrossover: %8zu bytes: temporal %6.2f GB/s, non-temporal %6.2f GB/s%s"
+         , len, gbps[0], gbps[1], gbps[0] < gbps[1] ? " *" : "");
+  }
+
+  EXPECT_EQ(0, ::munmap(arena, ARENA_SIZE));
+}
+
 int main(int argc, char **argv)
 {
   ::testing::InitGoogleTest(&argc, argv);
@@ -32,6 +32,7 @@ static PyObject * pool_get_size(Pool* self, PyObject *args, PyObject *kwds);
 static PyObject * pool_erase(Pool* self, PyObject *args, PyObject *kwds);
 static PyObject * pool_configure(Pool* self, PyObject *args, PyObject *kwds);
 static PyObject * pool_find_key(Pool* self, PyObject *args, PyObject *kwds);
+static PyObject * pool_find_keys(Pool* self, PyObject *args, PyObject *kwds);
 static PyObject * pool_get_attribute(Pool* self, PyObject* args, PyObject* kwds);
 static PyObject * pool_type(Pool* self);
 static PyObject * pool_free_direct_memory(Pool *self, PyObject* args, PyObject* kwds);
@@ -90,6 +91,7 @@ PyDoc_STRVAR(count_doc,"Pool.count() -> Get number of objects in the pool.");
 PyDoc_STRVAR(erase_doc,"Pool.erase(key) -> Erase object from the pool.");
 PyDoc_STRVAR(configure_doc,"Pool.configure(jsoncmd) -> Configure pool.");
 PyDoc_STRVAR(find_key_doc,"Pool.find(expr, [limit]) -> Find keys using expression.");
+PyDoc_STRVAR(find_keys_doc,"Pool.find_keys(expr, [offset], [limit]) -> ([keys], next offset or None when complete).");
 PyDoc_STRVAR(get_attribute_doc,"Pool.get_attribute(key, attribute_name) -> Attribute value(s).");
 PyDoc_STRVAR(free_direct_memory_doc,"Pool.free_direct_memory(val_from_get_direct) -> Release memory allocated by get_direct call.");
 
@@ -107,6 +109,7 @@ static PyMethodDef Pool_methods[] = {
                                      {"erase",(PyCFunction) pool_erase, METH_VARARGS | METH_KEYWORDS, erase_doc},
                                      {"configure",(PyCFunction) pool_configure, METH_VARARGS | METH_KEYWORDS, configure_doc},
                                      {"find_key",(PyCFunction) pool_find_key, METH_VARARGS | METH_KEYWORDS, find_key_doc},
+                                     {"find_keys",(PyCFunction) pool_find_keys, METH_VARARGS | METH_KEYWORDS, find_keys_doc},
                                      {"get_attribute",(PyCFunction) pool_get_attribute, METH_VARARGS | METH_KEYWORDS, get_attribute_doc},
                                      {"free_direct_memory", (PyCFunction) pool_free_direct_memory, METH_VARARGS | METH_KEYWORDS, free_direct_memory_doc},
                                      {NULL}
@@ -772,6 +775,63 @@ static PyObject * pool_find_key(Pool* self, PyObject *args, PyObject *kwds)
 }
 
 
+static PyObject * pool_find_keys(Pool* self, PyObject *args, PyObject *kwds)
+{
+  static const char *kwlist[] = {"expr",
+                                 "offset",
+                                 "limit",
+                                 NULL};
+
+  const char * expr_param = nullptr;
+  unsigned long offset_param = 0;
+  unsigned int limit_param = 0;
+
+  if (! PyArg_ParseTupleAndKeywords(args,
+                                    kwds,
+                                    "s|kI",
+                                    const_cast<char**>(kwlist),
+                                    &expr_param,
+                                    &offset_param,
+                                    &limit_param)) {
+    PyErr_SetString(PyExc_RuntimeError,"bad arguments");
+    return NULL;
+  }
+
+  assert(self->_pool);
+
+  std::vector<std::string> out_keys;
+  offset_t next_offset = 0;
+  auto hr = self->_mcas->find_batch(self->_pool,
+                                    std::string(expr_param),
+                                    offset_param,
+                                    limit_param,
+                                    out_keys,
+                                    next_offset);
+
+  if(hr != S_OK && hr != S_MORE) {
+    std::stringstream ss;
+    ss << "pool.find_keys [status:" << hr << "]";
+    PyErr_SetString(PyExc_RuntimeError,ss.str().c_str());
+    return NULL;
+  }
+
+  auto list = PyList_New(out_keys.size());
+  for(size_t i = 0; i < out_keys.size(); i++)
+    PyList_SetItem(list, i, PyUnicode_FromStringAndSize(out_keys[i].data(), out_keys[i].size()));
+
+  auto tuple = PyTuple_New(2);
+  PyTuple_SetItem(tuple, 0, list);
+  if(hr == S_MORE) {
+    PyTuple_SetItem(tuple, 1, PyLong_FromUnsignedLong(next_offset));
+  }
+  else {
+    Py_INCREF(Py_None);
+    PyTuple_SetItem(tuple, 1, Py_None);
+  }
+  return tuple;
+}
+
+
 static PyObject * pool_get_attribute(Pool* self, PyObject *args, PyObject *kwds)
 {
   static const char *kwlist[] = {"key",
@@ -181,7 +181,7 @@ static PyMemberDef Session_members[] = {
 PyDoc_STRVAR(open_pool_doc,"Session.open_pool(name,[readonly=True]) -> Open pool.");
 PyDoc_STRVAR(create_pool_doc,"Session.create_pool(name,pool_size,objcount) -> Create pool.");
 PyDoc_STRVAR(delete_pool_doc,"Session.delete_pool(name) -> Delete pool.");
-PyDoc_STRVAR(get_stats_doc,"Session.get_stats() -> Get shard statistics.");
+PyDoc_STRVAR(get_stats_doc,"Session.get_stats(reset=False) -> Get shard statistics, optionally clearing the latency histograms.");
 
 static PyMethodDef Session_methods[] = {
   {"open_pool",  (PyCFunction) open_pool, METH_VARARGS | METH_KEYWORDS, open_pool_doc},
@@ -357,12 +357,26 @@ static PyObject * delete_pool(Session* self, PyObject *args, PyObject *kwds)
 
 static PyObject * get_stats(Session* self, PyObject *args, PyObject *kwds)
 {
+  static const char *kwlist[] = {"reset",
+                                 NULL};
+
+  int reset = 0;
+
+  if (! PyArg_ParseTupleAndKeywords(args,
+                                    kwds,
+                                    "|p",
+                                    const_cast<char**>(kwlist),
+                                    &reset)) {
+    PyErr_SetString(PyExc_RuntimeError,"bad arguments");
+    return NULL;
+  }
+
   component::IMCAS::Shard_stats stats;
 
   if(global::debug_level > 0)
     PLOG("mcas.Session.get_statistics ");
   
-  status_t hr = self->_mcas->get_statistics(stats);
+  status_t hr = self->_mcas->get_statistics(stats, reset);
 
   if(hr != S_OK) {
     std::stringstream ss;
@@ -381,6 +395,40 @@ static PyObject * get_stats(Session* self, PyObject *args, PyObject *kwds)
   macro_add_dict_item(op_erase_count);
   macro_add_dict_item(op_failed_request_count);
   macro_add_dict_item(last_op_count_snapshot);
+  macro_add_dict_item(drain_tick_count);
+  macro_add_dict_item(drain_msg_count);
+  macro_add_dict_item(drain_max_depth);
+  macro_add_dict_item(drain_budget_count_exhausted);
+  macro_add_dict_item(drain_budget_time_exhausted);
+  macro_add_dict_item(idle_block_count);
+  macro_add_dict_item(group_commit_count);
+  macro_add_dict_item(group_commit_op_count);
+
+  /* latency summaries (ns) keyed by request class */
+  static const char *latency_op_name[] = {"put", "get", "put_direct", "get_direct", "erase",
+                                          "multi", "ado", "info", "other"};
+  PyObject* latency = PyDict_New();
+  for(unsigned i = 0; i < component::IMCAS::LATENCY_OP_COUNT; i++) {
+    const auto& l = stats.latency[i];
+    PyObject* op = PyDict_New();
+    const component::IMCAS::Latency_histogram* phase[] = {&l.wait, &l.store, &l.total};
+    const char* phase_name[] = {"wait", "store", "total"};
+    for(unsigned j = 0; j < 3; j++) {
+      PyObject* h = Py_BuildValue("{s:K,s:d,s:K,s:K,s:K,s:K}",
+                                  "count", static_cast<unsigned long long>(phase[j]->count),
+                                  "mean", phase[j]->mean(),
+                                  "p50", static_cast<unsigned long long>(phase[j]->percentile(50.0)),
+                                  "p99", static_cast<unsigned long long>(phase[j]->percentile(99.0)),
+                                  "p999", static_cast<unsigned long long>(phase[j]->percentile(99.9)),
+                                  "max", static_cast<unsigned long long>(phase[j]->max_ns));
+      PyDict_SetItemString(op, phase_name[j], h);
+      Py_DECREF(h);
+    }
+    PyDict_SetItemString(latency, latency_op_name[i], op);
+    Py_DECREF(op);
+  }
+  PyDict_SetItemString(dict, "latency", latency);
+  Py_DECREF(latency);
 
   return dict;
 }
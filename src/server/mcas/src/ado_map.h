@@ -54,6 +54,8 @@ class Ado_map {
   map_t::const_iterator end() const noexcept { return _map.end(); }
   map_t::iterator       end() noexcept { return _map.end(); }
 
+  bool empty() const noexcept { return _map.empty(); }
+
   void remove(component::IADO_proxy *proxy)
   {
     for (auto i : _map) {
@@ -12,6 +12,7 @@
 */
 
 #include "config_file.h"
+#include "mcas_config.h"
 
 #include "rapidjson/error/error.h"  // rapidjson::ParseErrorCode
 namespace mcas
@@ -340,6 +341,136 @@ auto make_schema_shard()
               )
             )
           , json::member
+          ( config::msg_budget
+            , json::object
+            ( json::member(schema::description, "Maximum number of messages drained from one client connection per shard tick, before moving on to the next connection.")
+              , json::member(schema::examples, json::array(json::number(1), json::number(32)))
+              , json::member(schema::type, schema::integer)
+              , json::member
+              ( schema::minimum
+                , json::number(1)
+                )
+              , json::member
+              ( schema::k_default /* informational only */
+                , json::number(DEFAULT_MSG_BUDGET)
+                )
+              )
+            )
+          , json::member
+          ( config::msg_budget_usec
+            , json::object
+            ( json::member(schema::description, "Maximum time, in microseconds, spent draining messages from one client connection per shard tick. 0 means no time limit.")
+              , json::member(schema::examples, json::array(json::number(0), json::number(100)))
+              , json::member(schema::type, schema::integer)
+              , json::member
+              ( schema::minimum
+                , json::number(0)
+                )
+              , json::member
+              ( schema::k_default /* informational only */
+                , json::number(DEFAULT_MSG_BUDGET_USEC)
+                )
+              )
+            )
+          , json::member
+          ( config::msg_budget_weights
+            , json::object
+            ( json::member(schema::description, "Relative shares of the message budget, keyed by client auth id (decimal). A connection with weight N may drain N times msg_budget messages per shard tick. Unlisted clients have weight 1.")
+              , json::member(schema::examples, json::array(json::object(json::member("1001", json::number(4)))))
+              , json::member(schema::type, schema::object)
+              , json::member
+              ( schema::additionalProperties
+                , json::object
+                ( json::member(schema::type, schema::integer)
+                  , json::member
+                  ( schema::minimum
+                    , json::number(1)
+                    )
+                  )
+                )
+              )
+            )
+          , json::member
+          ( config::idle_poll_count
+            , json::object
+            ( json::member(schema::description, "Number of consecutive idle iterations of the shard loop before the shard starts to spin (with pause) rather than poll.")
+              , json::member(schema::examples, json::array(json::number(0), json::number(100)))
+              , json::member(schema::type, schema::integer)
+              , json::member
+              ( schema::minimum
+                , json::number(0)
+                )
+              , json::member
+              ( schema::k_default /* informational only */
+                , json::number(DEFAULT_IDLE_POLL_COUNT)
+                )
+              )
+            )
+          , json::member
+          ( config::idle_spin_usec
+            , json::object
+            ( json::member(schema::description, "Time, in microseconds, an idle shard spins before it blocks waiting for network completions or new connections.")
+              , json::member(schema::examples, json::array(json::number(100), json::number(1000)))
+              , json::member(schema::type, schema::integer)
+              , json::member
+              ( schema::minimum
+                , json::number(0)
+                )
+              , json::member
+              ( schema::k_default /* informational only */
+                , json::number(DEFAULT_IDLE_SPIN_USEC)
+                )
+              )
+            )
+          , json::member
+          ( config::idle_block_msec
+            , json::object
+            ( json::member(schema::description, "Maximum time, in milliseconds, of a single blocking wait by an idle shard. 0 disables blocking; the shard spins while it has sessions. The wait is on one session at a time (rotating), so a request on another session, or a new connection, may wait this long.")
+              , json::member(schema::examples, json::array(json::number(0), json::number(1)))
+              , json::member(schema::type, schema::integer)
+              , json::member
+              ( schema::minimum
+                , json::number(0)
+                )
+              , json::member
+              ( schema::k_default /* informational only */
+                , json::number(DEFAULT_IDLE_BLOCK_MSEC)
+                )
+              )
+            )
+          , json::member
+          ( config::task_budget_usec
+            , json::object
+            ( json::member(schema::description, "Time, in microseconds, spent per shard tick running deferred tasks such as key find scans. At least one slice of work runs per tick; 0 means one slice per waiting task.")
+              , json::member(schema::examples, json::array(json::number(0), json::number(50)))
+              , json::member(schema::type, schema::integer)
+              , json::member
+              ( schema::minimum
+                , json::number(0)
+                )
+              , json::member
+              ( schema::k_default /* informational only */
+                , json::number(DEFAULT_TASK_BUDGET_USEC)
+                )
+              )
+            )
+          , json::member
+          ( config::group_commit
+            , json::object
+            ( json::member(schema::description, "Most puts and erases, drained from one client connection, whose persistence is completed together and which are acknowledged together. 0 disables group commit.")
+              , json::member(schema::examples, json::array(json::number(0), json::number(16)))
+              , json::member(schema::type, schema::integer)
+              , json::member
+              ( schema::minimum
+                , json::number(0)
+                )
+              , json::member
+              ( schema::k_default /* informational only */
+                , json::number(DEFAULT_GROUP_COMMIT)
+                )
+              )
+            )
+          , json::member
           ( config::default_backend
             , json::object
             ( json::member(schema::description, "Key/value store implementation to use.")
@@ -806,6 +937,69 @@ unsigned int Config_file::get_shard_security_port(rapidjson::SizeType i) const
   return m == shard.MemberEnd() ? 0 : m->value.GetUint();
 }
 
+unsigned int Config_file::get_shard_uint(const char *field, rapidjson::SizeType i, unsigned int dflt) const
+{
+  if (i > shard_count()) throw Config_exception("%s out of bounds", __func__);
+  assert(_shards[i].IsObject());
+  auto shard = _shards[i].GetObject();
+  auto m     = shard.FindMember(field);
+  return m == shard.MemberEnd() ? dflt : m->value.GetUint();
+}
+
+unsigned int Config_file::get_shard_msg_budget(rapidjson::SizeType i) const
+{
+  return std::max(1U, get_shard_uint(config::msg_budget, i, DEFAULT_MSG_BUDGET));
+}
+
+unsigned int Config_file::get_shard_msg_budget_usec(rapidjson::SizeType i) const
+{
+  return get_shard_uint(config::msg_budget_usec, i, DEFAULT_MSG_BUDGET_USEC);
+}
+
+std::map<uint64_t, unsigned> Config_file::get_shard_msg_budget_weights(rapidjson::SizeType i) const
+{
+  std::map<uint64_t, unsigned> result;
+  if (i > shard_count()) throw Config_exception("%s shard out of bounds", __func__);
+
+  auto shard = get_shard(i);
+  if (shard.HasMember(config::msg_budget_weights)) {
+    auto obj = shard[config::msg_budget_weights].GetObject();
+    for (auto itr = obj.MemberBegin(); itr != obj.MemberEnd(); ++itr) {
+      const std::string auth_id = itr->name.GetString();
+      if (auth_id.empty() || auth_id.find_first_not_of("0123456789") != std::string::npos)
+        throw Config_exception("%s: auth id (%s) is not a decimal number", config::msg_budget_weights, auth_id.c_str());
+      result[std::stoull(auth_id)] = std::max(1U, itr->value.GetUint());
+    }
+  }
+
+  return result;
+}
+
+unsigned int Config_file::get_shard_idle_poll_count(rapidjson::SizeType i) const
+{
+  return get_shard_uint(config::idle_poll_count, i, DEFAULT_IDLE_POLL_COUNT);
+}
+
+unsigned int Config_file::get_shard_idle_spin_usec(rapidjson::SizeType i) const
+{
+  return get_shard_uint(config::idle_spin_usec, i, DEFAULT_IDLE_SPIN_USEC);
+}
+
+unsigned int Config_file::get_shard_idle_block_msec(rapidjson::SizeType i) const
+{
+  return get_shard_uint(config::idle_block_msec, i, DEFAULT_IDLE_BLOCK_MSEC);
+}
+
+unsigned int Config_file::get_shard_task_budget_usec(rapidjson::SizeType i) const
+{
+  return get_shard_uint(config::task_budget_usec, i, DEFAULT_TASK_BUDGET_USEC);
+}
+
+unsigned int Config_file::get_shard_group_commit(rapidjson::SizeType i) const
+{
+  return get_shard_uint(config::group_commit, i, DEFAULT_GROUP_COMMIT);
+}
+
 boost::optional<std::string> Config_file::get_shard_optional(std::string field, rapidjson::SizeType i) const
 {
   if (field.empty()) throw Config_exception("%s invalid field", __func__);
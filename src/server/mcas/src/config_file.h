@@ -61,6 +61,14 @@ static constexpr const char *cert_path = "cert_path";
 static constexpr const char *key_path = "key_path";
 static constexpr const char *security_mode = "security_mode";
 static constexpr const char *security_port = "security_port";
+static constexpr const char *msg_budget = "msg_budget";
+static constexpr const char *msg_budget_usec = "msg_budget_usec";
+static constexpr const char *msg_budget_weights = "msg_budget_weights";
+static constexpr const char *idle_poll_count = "idle_poll_count";
+static constexpr const char *idle_spin_usec = "idle_spin_usec";
+static constexpr const char *idle_block_msec = "idle_block_msec";
+static constexpr const char *task_budget_usec = "task_budget_usec";
+static constexpr const char *group_commit = "group_commit";
 }
 
 namespace mcas
@@ -116,6 +124,22 @@ public:
 
   unsigned int get_shard_security_port(rapidjson::SizeType i) const;
 
+  unsigned int get_shard_msg_budget(rapidjson::SizeType i) const;
+
+  unsigned int get_shard_msg_budget_usec(rapidjson::SizeType i) const;
+
+  std::map<uint64_t, unsigned> get_shard_msg_budget_weights(rapidjson::SizeType i) const;
+
+  unsigned int get_shard_idle_poll_count(rapidjson::SizeType i) const;
+
+  unsigned int get_shard_idle_spin_usec(rapidjson::SizeType i) const;
+
+  unsigned int get_shard_idle_block_msec(rapidjson::SizeType i) const;
+
+  unsigned int get_shard_task_budget_usec(rapidjson::SizeType i) const;
+
+  unsigned int get_shard_group_commit(rapidjson::SizeType i) const;
+
   boost::optional<std::string> get_shard_optional(std::string field, rapidjson::SizeType i) const;
 
   std::string get_shard_required(std::string field, rapidjson::SizeType i) const;
@@ -149,6 +173,8 @@ public:
   unsigned int debug_level() const;
 
 private:
+  unsigned int get_shard_uint(const char *field, rapidjson::SizeType i, unsigned int dflt) const;
+
   rapidjson::Document          _doc;
   rapidjson::Value             _shards;
   boost::optional<std::string> _net_providers;
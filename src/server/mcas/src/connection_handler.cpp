@@ -15,8 +15,6 @@
 #include "security.h"
 #include "mcas_config.h"
 
-static constexpr unsigned EXTRA_BISCUITS = 0;
-
 namespace mcas
 {
 Connection_handler::Connection_handler(unsigned debug_level,
@@ -31,6 +29,7 @@ Connection_handler::Connection_handler(unsigned debug_level,
     _pending_msgs{},
     _pending_actions(),
     _pool_manager(),
+    _drain(),
     _stats{},
     _tls_buffer()
 {
@@ -79,10 +78,18 @@ int Connection_handler::tick()
 
   switch (_state) {
   case Connection_state::WAIT_NEW_MSG_RECV:
-    if (check_for_posted_recv_complete()) /*< check for recv completion */
+    if (!check_for_posted_recv_complete()) { /*< check for recv completion */
+      ++_stats.wait_msg_recv_misses;
+      break;
+    }
+
+    /* move every completed receive onto the pending queue, so that the
+       shard can drain a burst of pipelined requests in one tick */
+    while (response == TICK_RESPONSE_CONTINUE && check_for_posted_recv_complete())
       {
         auto iob = posted_recv();
         assert(iob);
+        const cpu_time_t arrival = rdtsc();
 
         const auto msg = protocol::message_cast(iob->base());
         msg_recv_log(msg, __func__);
@@ -92,14 +99,14 @@ int Connection_handler::tick()
         switch (msg->type_id()) {
         case MSG_TYPE::IO_REQUEST:
           if (option_DEBUG > 2) PMAJOR("Shard: IO_REQUEST");
-          _pending_msgs.push(iob);
+          _pending_msgs.push({iob, arrival});
           post_recv_buffer(allocate_recv());
           break;
 
         case MSG_TYPE::PUT_ADO_REQUEST:
         case MSG_TYPE::ADO_REQUEST:
           if (option_DEBUG > 2) PMAJOR("Shard: ADO_REQUEST");
-          _pending_msgs.push(iob);
+          _pending_msgs.push({iob, arrival});
           post_recv_buffer(allocate_recv());
           break;
 
@@ -112,13 +119,13 @@ int Connection_handler::tick()
 
         case MSG_TYPE::POOL_REQUEST:
           if (option_DEBUG > 2) PMAJOR("Shard: POOL_REQUEST");
-          _pending_msgs.push(iob);
+          _pending_msgs.push({iob, arrival});
           post_recv_buffer(allocate_recv());
           break;
 
         case MSG_TYPE::INFO_REQUEST:
           if (option_DEBUG > 2) PMAJOR("Shard: INFO_REQUEST");
-          _pending_msgs.push(iob);
+          _pending_msgs.push({iob, arrival});
           post_recv_buffer(allocate_recv());
           break;
 
@@ -131,9 +138,6 @@ int Connection_handler::tick()
         if (option_DEBUG > 2)
           PMAJOR("Shard State: %lu %p WAIT_MSG_RECV complete", _tick_count, common::p_fmt(this));
       }
-    else {
-      ++_stats.wait_msg_recv_misses;
-    }
 
     break;
 
@@ -145,8 +149,9 @@ int Connection_handler::tick()
 
 	/* fabric connection has allocated the first receive buffer */
 
-    /* allocating an extra buffer or three makes the hstore benchmark run about 10% faster */
-    for (auto i = EXTRA_BISCUITS; i != 0; --i) {
+    /* keep RECV_DEPTH receives posted (one more is posted with the
+       handshake reply) so that a client may pipeline requests */
+    for (auto i = RECV_DEPTH - 1; i != 0; --i) {
       post_recv_buffer(allocate_recv());
     }
 
@@ -244,7 +249,8 @@ void Connection_handler::respond_to_handshake(bool start_tls)
                                                                              1 /* seq */,
                                                                              max_message_size(),
                                                                              reinterpret_cast<uint64_t>(this),
-                                                                             start_tls);
+                                                                             start_tls,
+                                                                             RECV_DEPTH);
 
   /* post response */
   reply_iob->set_length(reply_msg->msg_len());
@@ -24,14 +24,17 @@
 #include "protocol_ostream.h"
 #include "region_manager.h"
 #include "connection_state.h"
+#include "drain_budget.h"
 
 #include <api/components.h>
 #include <api/fabric_itf.h>
 #include <api/kvstore_itf.h>
+#include <common/cycles.h>
 #include <common/exceptions.h>
 #include <common/logging.h>
 #include <gsl/pointers>
 
+#include <algorithm> /* max, min */
 #include <cassert>
 #include <map>
 #include <queue>
@@ -78,9 +81,14 @@ private:
 
   uint64_t                            _tick_count alignas(8);
   uint64_t                            _auth_id;
-  std::queue<buffer_t *>              _pending_msgs;
+  struct pending_msg_t {
+    buffer_t * iob;
+    cpu_time_t arrival; /*< rdtsc when the receive completion was reaped */
+  };
+  std::queue<pending_msg_t>           _pending_msgs;
   std::queue<action_t>                _pending_actions;
   Pool_manager                        _pool_manager; /* per-connection */
+  Drain_credit                        _drain;        /*< weighted share of the shard message budget */
 
   struct stats {
     uint64_t response_count;
@@ -233,7 +241,19 @@ public:
   inline mcas::protocol::Message *peek_pending_msg() const
   {
     return _pending_msgs.empty() ? nullptr
-      : static_cast<mcas::protocol::Message *>(_pending_msgs.front()->base().get());
+      : static_cast<mcas::protocol::Message *>(_pending_msgs.front().iob->base().get());
+  }
+
+  /**
+   * Time at which the message returned by peek_pending_msg was received,
+   * used to measure how long requests wait before the shard serves them
+   *
+   * @return rdtsc timestamp
+   */
+  inline cpu_time_t pending_msg_arrival() const
+  {
+    assert(!_pending_msgs.empty());
+    return _pending_msgs.front().arrival;
   }
 
   /**
@@ -247,11 +267,45 @@ public:
   inline buffer_t *pop_pending_msg()
   {
     assert(!_pending_msgs.empty());
-    auto iob = _pending_msgs.front();
+    auto iob = _pending_msgs.front().iob;
     _pending_msgs.pop();
     return iob;
   }
 
+  /**
+   * Number of received messages waiting to be processed by the shard
+   *
+   * @return Pending message count
+   */
+  inline size_t pending_msg_count() const { return _pending_msgs.size(); }
+
+  /**
+   * Weight of this connection in the shard's round-robin drain. A
+   * connection with weight N may drain N times the per-connection
+   * message budget in each shard tick. 0 until the shard assigns it.
+   */
+  inline unsigned drain_weight() const { return _drain.weight(); }
+  inline void     set_drain_weight(unsigned weight) { _drain.set_weight(weight); }
+
+  /**
+   * Credit a round of message budget and return the messages which may be
+   * drained this round. Unused credit is carried over, but never beyond a
+   * single round, so that an idle connection cannot accumulate a burst.
+   *
+   * @param quantum Per-connection message budget for one tick
+   *
+   * @return Number of messages which may be drained
+   */
+  inline unsigned drain_credit(unsigned quantum) { return _drain.credit(quantum); }
+
+  /**
+   * Charge messages drained against the current credit. If the
+   * connection has nothing more to drain, the credit is dropped.
+   *
+   * @param count Number of messages drained
+   */
+  inline void drain_charge(unsigned count) { _drain.charge(count, !_pending_msgs.empty()); }
+
   /**
    * Get deferred actions
    *
@@ -0,0 +1,83 @@
+/*
+  Copyright [2017-2021] [IBM Corporation]
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+  http://www.apache.org/licenses/LICENSE-2.0
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+#ifndef MCAS_DRAIN_BUDGET_H
+#define MCAS_DRAIN_BUDGET_H
+
+#include <common/types.h> /* cpu_time_t */
+
+#include <algorithm> /* max, min */
+
+namespace mcas
+{
+/* Weighted deficit round-robin credit of one connection. Each shard tick
+ * the connection is credited weight times the per-connection quantum.
+ * Unused credit is carried over, but never beyond a single round, so that
+ * an idle connection cannot accumulate a burst.
+ */
+class Drain_credit {
+ public:
+  Drain_credit() : _weight(0), _deficit(0) {}
+
+  /* 0 until assigned; an unassigned connection drains with weight 1 */
+  unsigned weight() const { return _weight; }
+  void     set_weight(unsigned weight) { _weight = std::max(1U, weight); }
+
+  unsigned credit(unsigned quantum)
+  {
+    const unsigned round = quantum * std::max(1U, _weight);
+    _deficit             = std::min(_deficit + round, round * 2);
+    return _deficit;
+  }
+
+  /* charge messages drained; the credit is dropped if nothing is left to drain */
+  void charge(unsigned count, bool more_pending)
+  {
+    _deficit = more_pending ? _deficit - std::min(count, _deficit) : 0;
+  }
+
+ private:
+  unsigned _weight;
+  unsigned _deficit; /*< unspent message credit */
+};
+
+/* The limits on draining one connection in one tick: its message credit
+ * and a time budget in cycles (0 is unlimited). The first message is
+ * never refused by the time budget, so a connection cannot be starved.
+ */
+class Drain_budget {
+ public:
+  enum class Limit { NONE, COUNT, TIME };
+
+  Drain_budget(unsigned credit, cpu_time_t budget_cycles, cpu_time_t start)
+    : _credit(credit), _budget_cycles(budget_cycles), _start(start)
+  {
+  }
+
+  bool timed() const { return _budget_cycles != 0; }
+
+  /* the limit, if any, reached after drained messages at time now */
+  Limit check(unsigned drained, cpu_time_t now) const
+  {
+    if (drained >= _credit) return Limit::COUNT;
+    if (drained != 0 && timed() && (now - _start) > _budget_cycles) return Limit::TIME;
+    return Limit::NONE;
+  }
+
+ private:
+  unsigned   _credit;
+  cpu_time_t _budget_cycles;
+  cpu_time_t _start;
+};
+}  // namespace mcas
+#endif
@@ -20,8 +20,10 @@
 #include <api/fabric_itf.h> /* IFabric_memory_region, IFabric_server */
 #include <gsl/pointers>
 #include <algorithm>
+#include <chrono>
 #include <list>
 #include <queue>
+#include <vector>
 
 namespace mcas
 {
@@ -272,6 +274,25 @@ private:
     return Completion_state::NONE;
   }
 
+  /**
+   * Prepare to block on network completions in the caller's poll.
+   * Failures are not reported here; they surface on the next poll.
+   *
+   * @param fds Receives the file descriptors which signal a completion
+   *
+   * @return true if the caller may block on fds
+   */
+  bool arm_completion_wait(std::vector<int> &fds)
+  {
+    try {
+      return transport()->arm_completion_wait(fds);
+    }
+    catch (const std::exception &e) {
+      CPLOG(2, "%s: %s", __func__, e.what());
+      return false;
+    }
+  }
+
   /**
    * Forwarders that allow us to avoid exposing transport() and _bm
    *
@@ -42,6 +42,11 @@ class Fabric_transport {
 
   Connection_handler *get_new_connection();
 
+  /**
+   * File descriptor which is readable while a new connection is pending
+   */
+  inline int new_connection_fd() const { return _server_factory->new_endpoint_fd(); }
+
   inline unsigned get_port() const { return _port; }
 
  private:
@@ -18,6 +18,11 @@
 /* NUM_SHARD_BUFFERS: number of buffers per connection */
 static constexpr std::size_t NUM_SHARD_BUFFERS = 128;
 
+/* RECV_DEPTH: receive buffers kept posted per connection, i.e. the number of
+   requests a client may have in flight; advertised in the handshake reply */
+static constexpr unsigned RECV_DEPTH = 32;
+static_assert(RECV_DEPTH < NUM_SHARD_BUFFERS / 2, "RECV_DEPTH leaves too few buffers for sends");
+
 /* WORK_REQUEST_ALLOCATOR_COUNT: number of work request slots for ADO
  * communications */
 static constexpr std::size_t WORK_REQUEST_ALLOCATOR_COUNT = 256;
@@ -26,6 +31,37 @@ static constexpr std::size_t WORK_REQUEST_ALLOCATOR_COUNT = 256;
    that the shard thread does not get "jammed up" scanning the index. */
 static constexpr unsigned MAX_INDEX_COMPARISONS = 10000;
 
+/* DEFAULT_MSG_BUDGET: default maximum number of messages drained from a
+   single connection per shard tick (config "msg_budget"), scaled by the
+   connection's weight (config "msg_budget_weights") */
+static constexpr unsigned DEFAULT_MSG_BUDGET = 32;
+
+/* DEFAULT_MSG_BUDGET_USEC: default maximum time spent draining a single
+   connection per shard tick, 0 is unlimited (config "msg_budget_usec") */
+static constexpr unsigned DEFAULT_MSG_BUDGET_USEC = 100;
+
+/* DEFAULT_IDLE_POLL_COUNT: idle shard loop iterations before spinning
+   (config "idle_poll_count") */
+static constexpr unsigned DEFAULT_IDLE_POLL_COUNT = 100;
+
+/* DEFAULT_IDLE_SPIN_USEC: time an idle shard spins before blocking
+   (config "idle_spin_usec") */
+static constexpr unsigned DEFAULT_IDLE_SPIN_USEC = 1000;
+
+/* DEFAULT_IDLE_BLOCK_MSEC: maximum duration of a single blocking wait,
+   0 disables blocking (config "idle_block_msec"). The wait covers all
+   sessions and new connections; a shard with an ADO attached does not
+   block. */
+static constexpr unsigned DEFAULT_IDLE_BLOCK_MSEC = 1;
+
+/* DEFAULT_TASK_BUDGET_USEC: time spent running deferred tasks per shard
+   tick, 0 is one slice per task (config "task_budget_usec") */
+static constexpr unsigned DEFAULT_TASK_BUDGET_USEC = 50;
+
+/* DEFAULT_GROUP_COMMIT: most puts and erases acknowledged by one group
+   commit, 0 disables group commit (config "group_commit") */
+static constexpr unsigned DEFAULT_GROUP_COMMIT = 0;
+
 #if defined(__powerpc64__)
 #define LIKELY(X) (X) /* TODO: fix for Power */
 #define UNLIKELY(X) (X)
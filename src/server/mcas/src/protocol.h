@@ -42,7 +42,7 @@ namespace mcas
 {
 namespace protocol
 {
-static constexpr unsigned PROTOCOL_VERSION = 0xFB;
+static constexpr unsigned PROTOCOL_VERSION = 0xFE;
 
 enum class MSG_TYPE : uint8_t {
   HANDSHAKE       = 0x1,
@@ -71,8 +71,10 @@ inline auto max<MSG_TYPE>()
 
 enum INFO_TYPE : uint32_t {
   /* must be above IKVStore::Attributes */
-  INFO_TYPE_FIND_KEY  = 0xF0,
-  INFO_TYPE_GET_STATS = 0xF1,
+  INFO_TYPE_FIND_KEY        = 0xF0,
+  INFO_TYPE_GET_STATS       = 0xF1,
+  INFO_TYPE_GET_STATS_RESET = 0xF2, /*< stats, then clear latency histograms */
+  INFO_TYPE_FIND_KEY_BATCH  = 0xF3, /*< as many matching keys as fit, with a continuation offset */
 };
 
 enum {
@@ -118,6 +120,9 @@ enum OP_TYPE : uint8_t {
   OP_LOCATE      = 19,  // locate space for DMA access
   OP_RELEASE     = 20,  // release space located for DMA access
   OP_RELEASE_WITH_FLUSH = 21,  // flush and release space located for DMA access
+  OP_MULTI_PUT   = 22, // put a batch of key-value records
+  OP_MULTI_GET   = 23, // get a batch of keys
+  OP_MULTI_ERASE = 24, // erase a batch of keys
   OP_INVALID     = 0xFE, // not applicable
 };
 
@@ -407,6 +412,28 @@ struct Message_IO_request : public Message_numbered_request {
   static constexpr const char* description = "Message_IO_request";
   using data_t                             = uint8_t; /* some trailing data is typed uint8_t, some is typed
                                                          charu. This used to be char */
+
+  /* OP_MULTI_PUT/GET/ERASE record: header, then key, then value (OP_MULTI_PUT only) */
+  struct multi_record {
+    std::uint32_t key_len;
+    std::uint32_t value_len;
+
+    const char*          key() const { return common::pointer_cast<const char>(this + 1); }
+    const data_t*        value() const { return common::pointer_cast<const data_t>(this + 1) + key_len; }
+    const multi_record*  next() const { return common::pointer_cast<const multi_record>(value() + value_len); }
+    std::string          skey() const { return std::string(key(), key_len); }
+    /* the key in place, for the kvstore; valid as long as the message */
+    basic_string_view<byte> key_view() const { return basic_string_view<byte>(common::pointer_cast<const byte>(key()), key_len); }
+
+    /* true if the whole record lies below end (checks header before lengths) */
+    bool within(const void* end) const
+    {
+      auto e = static_cast<const data_t*>(end);
+      return common::pointer_cast<const data_t>(this + 1) <= e &&
+             std::size_t(e - common::pointer_cast<const data_t>(this + 1)) >= std::size_t(key_len) + value_len;
+    }
+  } __attribute__((packed));
+
  private:
   auto data() const { return common::pointer_cast<const data_t>(this + 1); }
   auto cdata() const { return common::pointer_cast<const char>(this + 1); }
@@ -517,6 +544,25 @@ struct Message_IO_request : public Message_numbered_request {
   {
   }
 
+  /*< version used for OP_MULTI_PUT/GET/ERASE. Records are added by
+   *  append_record. Borrows _key_len for the record count and _val_len
+   *  for the length of the packed records.
+   */
+  Message_IO_request(size_t /* buffer_size */,
+                     uint64_t auth_id,
+                     uint64_t request_id_,
+                     uint64_t pool_id_,
+                     OP_TYPE  op_,
+                     uint32_t flags_)
+      : Message_numbered_request(auth_id, (sizeof *this), id, op_, request_id_, pool_id_),
+        _key_len(0),
+        _val_len(0),
+        addr(),
+        _flags(flags_),
+        _padding()
+  {
+  }
+
   /*< version used for configure_pool command */
   Message_IO_request(size_t             buffer_size,
                      uint64_t           auth_id,
@@ -530,6 +576,8 @@ struct Message_IO_request : public Message_numbered_request {
 
   inline const uint8_t* key() const { return &data()[0]; }
   auto                  skey() const { return std::string(cdata(), _key_len); }
+  /* the key in place, for the kvstore; valid as long as the message */
+  auto                  key_view() const { return basic_string_view<byte>(common::pointer_cast<const byte>(key()), _key_len); }
   inline const char*    cmd() const { return &cdata()[0]; }
   inline const uint8_t* value() const { return &data()[_key_len + 1]; }
 
@@ -595,6 +643,45 @@ struct Message_IO_request : public Message_numbered_request {
   auto key_len() const { return _key_len; }
   auto flags() const { return _flags; }
 
+  /* for OP_MULTI_PUT/GET/ERASE */
+  static std::size_t record_size(std::size_t key_len_, std::size_t value_len_)
+  {
+    return sizeof(multi_record) + key_len_ + value_len_;
+  }
+
+  bool would_fit_record(std::size_t buffer_size, std::size_t key_len_, std::size_t value_len_) const
+  {
+    return would_fit(_val_len + record_size(key_len_, value_len_), buffer_size);
+  }
+
+  void append_record(std::size_t buffer_size,
+                     const void* key_,
+                     std::size_t key_len_,
+                     const void* value_,
+                     std::size_t value_len_)
+  {
+    if (UNLIKELY(!would_fit_record(buffer_size, key_len_, value_len_)))
+      throw API_exception("%s::%s - insufficient buffer for record (key_len=%lu) (val_len=%lu)",
+                          +description, __func__, key_len_, value_len_);
+
+    auto rec       = common::pointer_cast<multi_record>(&data()[_val_len]);
+    rec->key_len   = boost::numeric_cast<std::uint32_t>(key_len_);
+    rec->value_len = boost::numeric_cast<std::uint32_t>(value_len_);
+    auto p         = common::pointer_cast<data_t>(rec + 1);
+    std::memcpy(p, key_, key_len_);
+    if (value_len_) std::memcpy(p + key_len_, value_, value_len_);
+
+    const auto sz = record_size(key_len_, value_len_);
+    _val_len += sz;
+    ++_key_len;
+    increase_msg_len(sz);
+  }
+
+  std::size_t         record_count() const { return _key_len; }
+  std::size_t         records_len() const { return _val_len; }
+  const multi_record* first_record() const { return common::pointer_cast<const multi_record>(data()); }
+  const data_t*       records_end() const { return data() + _val_len; }
+
   // fields
  private:
   uint64_t _key_len;
@@ -619,6 +706,13 @@ class Message_IO_response : public Message_numbered_response {
     std::uint64_t addr;
     std::uint64_t len;
   };
+  /* data elements in response to OP_MULTI_PUT/GET/ERASE: one result per
+   * request record, followed by the OP_MULTI_GET values packed in record order
+   */
+  struct multi_result {
+    std::int32_t  status;
+    std::uint32_t value_len;
+  } __attribute__((packed));
 
  private:
   using data_t = uint8_t; /* some trailing data is typed uint8_t, some is typed
@@ -629,6 +723,7 @@ class Message_IO_response : public Message_numbered_response {
  public:
   auto cdata() const { return common::pointer_cast<const char>(this + 1); }
   auto edata() const { return common::pointer_cast<const locate_element>(this + 1); }
+  auto rdata() const { return common::pointer_cast<const multi_result>(this + 1); }
   auto data() const { return common::pointer_cast<const data_t>(this + 1); }
 
   Message_IO_response(size_t /* buffer_size */,
@@ -697,37 +792,41 @@ struct Message_INFO_request : public Message {
   auto data() { return common::pointer_cast<data_t>(this + 1); }
 
  public:
-  Message_INFO_request(uint64_t auth_id, component::IKVStore::Attribute type_, std::uint64_t pool_id_)
+  Message_INFO_request(uint64_t auth_id, uint64_t request_id_, component::IKVStore::Attribute type_, std::uint64_t pool_id_)
       : Message(auth_id, (sizeof *this), id, OP_INVALID),
         _pool_id(pool_id_),
         _type(type_),
-        pad(),
+        limit(),
         offset(),
-        key_len(0)
+        key_len(0),
+        _request_id(request_id_)
   {
   }
 
-  Message_INFO_request(uint64_t auth_id, INFO_TYPE type_, uint64_t pool_id_)
+  Message_INFO_request(uint64_t auth_id, uint64_t request_id_, INFO_TYPE type_, uint64_t pool_id_)
       : Message(auth_id, (sizeof *this), id, OP_INVALID),
         _pool_id(pool_id_),
         _type(type_),
-        pad(),
+        limit(),
         offset(),
-        key_len(0)
+        key_len(0),
+        _request_id(request_id_)
   {
   }
 
-  Message_INFO_request(uint64_t auth_id, INFO_TYPE type_, uint64_t pool_id_, offset_t offset_)
+  Message_INFO_request(uint64_t auth_id, uint64_t request_id_, INFO_TYPE type_, uint64_t pool_id_, offset_t offset_)
       : Message(auth_id, (sizeof *this), id, OP_INVALID),
         _pool_id(pool_id_),
         _type(type_),
-        pad(),
+        limit(),
         offset(offset_),
-        key_len(0)
+        key_len(0),
+        _request_id(request_id_)
   {
   }
 
   const char* key() const { return cdata(); }
+  auto        key_view() const { return common::basic_string_view<common::byte>(common::pointer_cast<const common::byte>(key()), key_len); }
   const char* c_str() const { return cdata(); }
   size_t      base_message_size() const { return (sizeof *this); }
   size_t      message_size() const { return (sizeof *this) + key_len + 1; }
@@ -745,12 +844,14 @@ struct Message_INFO_request : public Message {
 
   auto     pool_id() const { return _pool_id; }
   auto     type() const { return _type; }
+  auto     request_id() const { return _request_id; }
   // fields
   uint64_t _pool_id;
   uint32_t _type;
-  uint32_t pad;
+  uint32_t limit; /* INFO_TYPE_FIND_KEY_BATCH: most keys per response, 0 is as many as fit */
   uint64_t offset;
   uint64_t key_len;
+  uint64_t _request_id; /* echoed in the response */
   /* data immediately follows */
 } __attribute__((packed));
 
@@ -758,13 +859,44 @@ struct Message_INFO_response : public Message {
   static constexpr auto        id          = MSG_TYPE::INFO_RESPONSE;
   static constexpr const char* description = "Message_INFO_response";
 
- private:
   using data_t = uint8_t;
+
+  /* INFO_TYPE_FIND_KEY_BATCH: the data is a sequence of key records.
+     Status S_MORE means the search may continue from Offset(); S_OK means
+     it is complete. */
+  struct key_record {
+    std::uint32_t key_len;
+
+    const char*       key() const { return common::pointer_cast<const char>(this + 1); }
+    const key_record* next() const { return common::pointer_cast<const key_record>(key() + key_len); }
+    std::string       skey() const { return std::string(key(), key_len); }
+
+    /* true if the whole record lies below end (checks header before length) */
+    bool within(const void* end) const
+    {
+      auto e = static_cast<const data_t*>(end);
+      return common::pointer_cast<const data_t>(this + 1) <= e &&
+             std::size_t(e - common::pointer_cast<const data_t>(this + 1)) >= key_len;
+    }
+  } __attribute__((packed));
+
+  static std::size_t key_record_size(std::size_t key_len_) { return sizeof(key_record) + key_len_; }
+
+  /* append a key record to a batch being accumulated by the shard */
+  static void append_key_record(std::string& records, const std::string& key_)
+  {
+    const auto len = std::uint32_t(key_.size());
+    records.append(common::pointer_cast<const char>(&len), sizeof len);
+    records.append(key_);
+  }
+
+ private:
   auto data() const { return common::pointer_cast<const data_t>(this + 1); }
   auto cdata() const { return common::pointer_cast<const char>(this + 1); }
   auto data() { return common::pointer_cast<data_t>(this + 1); }
 
-  Message_INFO_response(uint64_t authid_, offset_t offset_) : Message(authid_, (sizeof *this), id, OP_INVALID), _v{}, _offset(offset_) {}
+  Message_INFO_response(uint64_t authid_, uint64_t request_id_, offset_t offset_)
+      : Message(authid_, (sizeof *this), id, OP_INVALID), _v{}, _offset(offset_), _request_id(request_id_) {}
   void set_value(size_t buffer_size, const void* value, size_t len)
   {
     if (UNLIKELY((len + 1 + (sizeof *this)) > buffer_size))
@@ -776,7 +908,7 @@ struct Message_INFO_response : public Message {
   }
 
  public:
-  Message_INFO_response(uint64_t authid_) : Message_INFO_response(authid_, offset_t()) {}
+  Message_INFO_response(uint64_t authid_, uint64_t request_id_) : Message_INFO_response(authid_, request_id_, offset_t()) {}
 
   size_t      base_message_size() const { return (sizeof *this); }
   size_t      message_size() const { return (sizeof *this) + _v._value_len + 1; }
@@ -793,6 +925,10 @@ struct Message_INFO_response : public Message {
   auto value_numeric() const { return _v._value; }
   std::size_t value() const { return _v._value; }
   offset_t Offset() const { return _offset; }
+  auto request_id() const { return _request_id; }
+
+  const key_record* first_key_record() const { return common::pointer_cast<const key_record>(data()); }
+  const data_t*     key_records_end() const { return data() + _v._value_len; }
 
   // fields
   /* The type of the request (to which this is a response) determines the field */
@@ -802,6 +938,7 @@ private:
     size_t _value_len;
   } _v;
   offset_t   _offset;
+  uint64_t   _request_id;
   /* data immediately follows */
 } __attribute__((packed));
 
@@ -853,12 +990,14 @@ struct Message_handshake_reply : public Message {
                           uint64_t       sequence,
                           uint64_t       session_id_,
                           size_t         max_message_size_,
-                          bool           start_tls_)
+                          bool           start_tls_,
+                          uint32_t       recv_depth_)
       : Message(auth_id, (sizeof *this), id, OP_INVALID),
         seq(sequence),
         session_id(session_id_),
         max_message_size(max_message_size_),
-        start_tls(start_tls_)
+        start_tls(start_tls_),
+        recv_depth(recv_depth_)
   {
     if (msg_len() > buffer_size)
       throw Logic_exception("%s::%s - insufficient buffer for Message_handshake_reply", +description, __func__);
@@ -869,6 +1008,7 @@ struct Message_handshake_reply : public Message {
   uint64_t session_id;
   size_t   max_message_size; /* RDMA max message size in bytes */
   bool     start_tls : 1;
+  uint32_t recv_depth; /* receive buffers the server keeps posted, i.e. maximum requests in flight */
   /* x509_cert innediately follows */
 } __attribute__((packed));
 
@@ -946,6 +1086,7 @@ struct Message_ado_request : public Message_numbered_request {
   /* ca;er could use Message::msg_len */
   size_t         message_size() const { return msg_len(); }
   const char*    key() const { return cdata(); }
+  auto           key_view() const { return basic_string_view<byte>(common::pointer_cast<const byte>(key()), key_len); }
   const uint8_t* request() const { return (&data()[key_len + 1]); }
   size_t         request_len() const { return this->invocation_data_len; }
   bool           is_async() const { return flags & component::IMCAS::ADO_FLAG_ASYNC; }
@@ -1012,6 +1153,7 @@ struct Message_put_ado_request : public Message_numbered_request {
   /* caller could use Message::msg_len */
   std::size_t message_size() const { return msg_len(); }
   const char* key() const { return cdata(); }
+  auto        key_view() const { return basic_string_view<byte>(common::pointer_cast<const byte>(key()), key_len); }
   size_t      get_key_len() const { return key_len; }
   const void* request() const { return static_cast<const void*>(&data()[key_len + 1]); }
   const void* value() const
@@ -1144,6 +1286,24 @@ struct Message_ado_response : public Message_numbered_response {
 static_assert(sizeof(Message_IO_request) % 8 == 0, "Message_IO_request should be 64bit aligned");
 static_assert(sizeof(Message_IO_response) % 8 == 0, "Message_IO_request should be 64bit aligned");
 
+/* Request id carried by a response, used by the client to route responses
+   when several requests are in flight. Pool and stats responses are not
+   numbered and return 0.
+ */
+inline std::uint64_t response_request_id(const Message* msg)
+{
+  switch (msg->type_id()) {
+  case MSG_TYPE::IO_RESPONSE:
+    return static_cast<const Message_IO_response*>(msg)->request_id();
+  case MSG_TYPE::ADO_RESPONSE:
+    return static_cast<const Message_ado_response*>(msg)->request_id();
+  case MSG_TYPE::INFO_RESPONSE:
+    return static_cast<const Message_INFO_response*>(msg)->request_id();
+  default:
+    return 0;
+  }
+}
+
 }  // namespace protocol
 namespace Protocol = protocol;
 }  // namespace mcas
@@ -15,6 +15,7 @@
 
 #include <api/components.h>
 #include <api/kvindex_itf.h>
+#include <common/cycles.h>
 #include <common/dump_utils.h>
 #include <common/env.h>
 #include <common/profiler.h>
@@ -33,6 +34,7 @@
 #include "resource_unavailable.h"
 #include "env.h"
 
+#include <poll.h>
 #include <sys/types.h> /* getpid */
 #include <unistd.h>
 
@@ -149,6 +151,25 @@ Shard::Shard(const Config_file &config_file,
     _forced_exit(forced_exit),
     _core(config_file.get_shard_core(shard_index)),
     _max_message_size(0),
+    _msg_budget(config_file.get_shard_msg_budget(shard_index)),
+    _msg_budget_cycles(cpu_time_t(double(config_file.get_shard_msg_budget_usec(shard_index)) * double(common::get_rdtsc_frequency_mhz()))),
+    _msg_budget_weights(config_file.get_shard_msg_budget_weights(shard_index)),
+    _drain_next(0),
+    _idle_poll_count(config_file.get_shard_idle_poll_count(shard_index)),
+    _idle_spin_cycles(cpu_time_t(double(config_file.get_shard_idle_spin_usec(shard_index)) * double(common::get_rdtsc_frequency_mhz()))),
+    _task_budget_cycles(cpu_time_t(double(config_file.get_shard_task_budget_usec(shard_index)) * double(common::get_rdtsc_frequency_mhz()))),
+    _idle_block_timeout(config_file.get_shard_idle_block_msec(shard_index)),
+    _ns_per_cycle(1000.0 / common::get_rdtsc_frequency_mhz()),
+    _msg_arrival(0),
+    _msg_latency_op(component::IMCAS::LATENCY_OP_OTHER),
+    _msg_deferred(false),
+    _group_commit_max(config_file.get_shard_group_commit(shard_index)),
+    _group_pools(),
+    _group_responses(),
+    _multi_keys{},
+    _multi_values{},
+    _multi_iovs{},
+    _multi_status{},
     _i_kvstore(nullptr),
     _i_ado_mgr(nullptr),
     _ado_pool_map(debug_level_),
@@ -355,7 +376,7 @@ void Shard::main_loop(common::profiler &pr_)
   static constexpr uint64_t CHECK_CONNECTION_INTERVAL     = 1000;
   static constexpr uint64_t CHECK_CLUSTER_SIGNAL_INTERVAL = 10000;
   static constexpr uint64_t OUTPUT_DEBUG_INTERVAL         = 10000000;
-  static constexpr unsigned SESSIONS_EMPTY_USLEEP         = 50000;
+  static constexpr std::chrono::milliseconds SESSIONS_EMPTY_WAIT{50};
 
   Connection_handler::action_t action;
 
@@ -364,8 +385,9 @@ void Shard::main_loop(common::profiler &pr_)
   static uint64_t score_board[LIVENESS_SHARDS] = {0};
 #endif
 
-  unsigned idle            = 0;
-  uint64_t tick alignas(8) = 0;
+  unsigned   idle            = 0;
+  cpu_time_t idle_start      = 0;
+  uint64_t   tick alignas(8) = 0;
 
   for (; _thread_exit == false; ++idle, ++tick) {
 #ifdef DEBUG_LIVENESS
@@ -392,8 +414,8 @@ void Shard::main_loop(common::profiler &pr_)
       CPLOG(2, "Shard: received SIGINT");
       _thread_exit = true;
     }
-    else if (_handlers.empty()) { /* if there are no sessions, sleep thread */
-      usleep(SESSIONS_EMPTY_USLEEP);
+    else if (_handlers.empty()) { /* if there are no sessions, wait for one */
+      wait_for_new_connection(SESSIONS_EMPTY_WAIT);
       try {
         check_for_new_connections();
       }
@@ -405,7 +427,31 @@ void Shard::main_loop(common::profiler &pr_)
       continue;
     }
 
-    /* check for new connections or sleep on none */
+    /* Adaptive idle policy: poll for _idle_poll_count idle iterations, then
+     * spin (with pause) for _idle_spin_cycles, then block in the network
+     * stack.  Any work resets idle to zero, returning to the poll phase.
+     * ADO messages and tasks are polled, so the shard does not block while
+     * an ADO is attached or a task is outstanding.  Here idle - 1 iterations have passed without
+     * work (the loop increment follows the reset), so the spin phase starts
+     * at idle == _idle_poll_count + 1, including when _idle_poll_count is 0.
+     */
+    if (idle > _idle_poll_count) {
+      if (idle == _idle_poll_count + 1) {
+        idle_start = rdtsc();
+      }
+      else if (_idle_block_timeout.count() != 0 &&
+               _outstanding_work.empty() &&
+               _tasks.empty() &&
+               _ado_map.empty() &&
+               (rdtsc() - idle_start) > _idle_spin_cycles) {
+        idle_block();
+      }
+      else {
+        cpu_relax();
+      }
+    }
+
+    /* check for new connections */
     if (tick % CHECK_CONNECTION_INTERVAL == 0) {
       try {
         check_for_new_connections();
@@ -436,8 +482,11 @@ void Shard::main_loop(common::profiler &pr_)
 
       assert(_handlers.size() < 1000);
 
-      /* iterate connection handlers (each connection is a client session) */
-      for (const auto handler : _handlers) {
+      /* iterate connection handlers (each connection is a client session),
+         rotating the starting handler so that no session is always first */
+      const auto handler_count = _handlers.size();
+      for (size_t h = 0; h != handler_count; ++h) {
+        const auto handler = _handlers[(_drain_next + h) % handler_count];
 
         /* issue tick, unless we are stalling */
         auto tick_response = handler->tick();
@@ -526,32 +575,10 @@ void Shard::main_loop(common::profiler &pr_)
          */
         try {
 
-          /* collect ONE available messages ; don't collect them ALL, they just keep coming! */
-          if (const protocol::Message *p_msg = handler->peek_pending_msg()) {
-
+          /* drain up to this session's share of the message budget */
+          if (handler->peek_pending_msg()) {
             idle = 0;
-            assert(p_msg);
-            /* "split" accepts responsibility for the *preceding* code. Not exactly intuitive. */
-            switch (p_msg->type_id()) {
-            case MSG_TYPE::IO_REQUEST:
-              process_message_IO_request(handler, static_cast<const protocol::Message_IO_request *>(p_msg));
-              break;
-            case MSG_TYPE::ADO_REQUEST:
-              process_ado_request(handler, static_cast<const protocol::Message_ado_request *>(p_msg));
-              break;
-            case MSG_TYPE::PUT_ADO_REQUEST:
-              process_put_ado_request(handler, static_cast<const protocol::Message_put_ado_request *>(p_msg));
-              break;
-            case MSG_TYPE::POOL_REQUEST:
-              process_message_pool_request(handler, static_cast<const protocol::Message_pool_request *>(p_msg));
-              break;
-            case MSG_TYPE::INFO_REQUEST:
-              process_info_request(handler, static_cast<const protocol::Message_INFO_request *>(p_msg), pr_);
-              break;
-            default:
-              throw General_exception("unrecognizable message type");
-            }
-            handler->free_buffer(handler->pop_pending_msg());
+            drain_pending_messages(handler, pr_);
           }
         }
         catch (const resource_unavailable &e) {
@@ -563,6 +590,8 @@ void Shard::main_loop(common::profiler &pr_)
         }
       }  // iteration of handlers
 
+      if (handler_count) _drain_next = (_drain_next + 1) % handler_count;
+
       /* handle messages send back from ADO */
       try {
         if(ado_enabled())
@@ -588,6 +617,7 @@ void Shard::main_loop(common::profiler &pr_)
       {
         for (auto &h : pending_close) {
           _handlers.erase(std::remove(_handlers.begin(), _handlers.end(), h), _handlers.end());
+          _tasks.cancel_if([h](const Shard_task *t) { return t->handler() == h; });
           CPLOG(2, "Shard: deleting handler (%p)", common::p_fmt(h));
 
           assert(h);
@@ -611,6 +641,183 @@ void Shard::main_loop(common::profiler &pr_)
   CPLOG(1, "Shard: shard (%p) exited", common::p_fmt(this));
 }
 
+unsigned Shard::drain_pending_messages(Connection_handler *handler, common::profiler &pr_)
+{
+  using namespace mcas::protocol;
+
+  /* Deficit round-robin: each tick a session is credited its weighted share
+   * of the message budget.  Draining stops when the credit is spent, the time
+   * budget expires or the session has no more pending messages.  At least
+   * one message is always processed, so a session cannot be starved by a
+   * small time budget.  Messages follow the handshake, so the session's
+   * auth id, and hence its weight, is known by the first drain.
+   */
+  if (handler->drain_weight() == 0) {
+    const auto w = _msg_budget_weights.find(handler->auth_id());
+    handler->set_drain_weight(w == _msg_budget_weights.end() ? 1U : w->second);
+  }
+
+  const Drain_budget budget(handler->drain_credit(_msg_budget), _msg_budget_cycles,
+                            _msg_budget_cycles ? rdtsc() : 0);
+  unsigned           drained = 0;
+
+  while (const protocol::Message *p_msg = handler->peek_pending_msg()) {
+    const auto limit = budget.check(drained, budget.timed() ? rdtsc() : 0);
+    if (limit == Drain_budget::Limit::COUNT) {
+      ++_stats.drain_budget_count_exhausted;
+      break;
+    }
+    if (limit == Drain_budget::Limit::TIME) {
+      ++_stats.drain_budget_time_exhausted;
+      break;
+    }
+
+    /* the message is timed from receipt; when its response waits on a
+       task or on the ADO, total time is recorded once that completes */
+    /* responses keep their order: end the group before any other request */
+    if (!_group_responses.empty() && !is_group_commit_op(p_msg)) group_commit_close();
+
+    _msg_arrival  = handler->pending_msg_arrival();
+    _msg_latency_op = latency_op(p_msg);
+    _msg_deferred   = false;
+    const cpu_time_t msg_start = rdtsc();
+
+    switch (p_msg->type_id()) {
+    case MSG_TYPE::IO_REQUEST:
+      process_message_IO_request(handler, static_cast<const protocol::Message_IO_request *>(p_msg));
+      break;
+    case MSG_TYPE::ADO_REQUEST:
+      process_ado_request(handler, static_cast<const protocol::Message_ado_request *>(p_msg));
+      break;
+    case MSG_TYPE::PUT_ADO_REQUEST:
+      process_put_ado_request(handler, static_cast<const protocol::Message_put_ado_request *>(p_msg));
+      break;
+    case MSG_TYPE::POOL_REQUEST:
+      process_message_pool_request(handler, static_cast<const protocol::Message_pool_request *>(p_msg));
+      break;
+    case MSG_TYPE::INFO_REQUEST:
+      process_info_request(handler, static_cast<const protocol::Message_INFO_request *>(p_msg), pr_);
+      break;
+    default:
+      throw General_exception("unrecognizable message type");
+    }
+
+    const cpu_time_t msg_end = rdtsc();
+    auto &latency = _stats.latency[_msg_latency_op];
+    latency.wait.record(cycles_to_ns(msg_start - _msg_arrival));
+    latency.store.record(cycles_to_ns(msg_end - msg_start));
+    if (!_msg_deferred) latency.total.record(cycles_to_ns(msg_end - _msg_arrival));
+    _msg_arrival = 0;
+
+    handler->free_buffer(handler->pop_pending_msg());
+    ++drained;
+  }
+
+  group_commit_close();
+
+  handler->drain_charge(drained);
+
+  ++_stats.drain_tick_count;
+  _stats.drain_msg_count += drained;
+  _stats.drain_max_depth = std::max(_stats.drain_max_depth, uint64_t(drained));
+
+  return drained;
+}
+
+bool Shard::is_group_commit_op(const protocol::Message *msg)
+{
+  return msg->type_id() == protocol::MSG_TYPE::IO_REQUEST &&
+         (msg->op() == protocol::OP_PUT || msg->op() == protocol::OP_ERASE);
+}
+
+bool Shard::group_commit_join(const pool_t pool)
+{
+  if (_group_commit_max == 0) return false;
+  if (std::find(_group_pools.begin(), _group_pools.end(), pool) != _group_pools.end()) return true;
+  /* stores without group commit answer E_NOT_SUPPORTED */
+  if (_i_kvstore->group_commit_begin(pool) != S_OK) return false;
+  _group_pools.push_back(pool);
+  return true;
+}
+
+void Shard::group_commit_respond(Connection_handler *                 handler,
+                                 buffer_t *                           iob,
+                                 const protocol::Message_IO_request * msg,
+                                 const int                            status,
+                                 const bool                           grouped,
+                                 const char *                         func)
+{
+  if (!grouped) {
+    group_commit_close();
+    respond(handler, iob, msg, status, func);
+    return;
+  }
+
+  _group_responses.push_back(
+      Group_response{handler, iob, prepare_response(handler, iob, msg->request_id(), status), _msg_arrival, _msg_latency_op});
+  _msg_deferred = true; /* timed to completion in group_commit_close */
+  if (_group_responses.size() >= _group_commit_max) group_commit_close();
+}
+
+void Shard::group_commit_close()
+{
+  for (const auto pool : _group_pools) {
+    const auto rc = _i_kvstore->group_commit_end(pool);
+    if (rc != S_OK) PWRN("group commit end on pool (%lx) failed (%d)", pool, rc);
+  }
+  _group_pools.clear();
+
+  if (_group_responses.empty()) return;
+
+  const cpu_time_t now = rdtsc();
+  for (const auto &r : _group_responses) {
+    r.handler->post_response(r.iob, r.response, __func__);
+    _stats.latency[r.latency_op].total.record(cycles_to_ns(now - r.arrival));
+  }
+  ++_stats.group_commit_count;
+  _stats.group_commit_op_count += _group_responses.size();
+  _group_responses.clear();
+}
+
+component::IMCAS::Latency_op Shard::latency_op(const protocol::Message *msg)
+{
+  using namespace mcas::protocol;
+  using IMCAS = component::IMCAS;
+
+  switch (msg->type_id()) {
+  case MSG_TYPE::IO_REQUEST:
+    switch (msg->op()) {
+    case OP_PUT:
+    case OP_PUT_ADVANCE:
+    case OP_PUT_SEGMENT:
+      return IMCAS::LATENCY_OP_PUT;
+    case OP_GET:
+      return IMCAS::LATENCY_OP_GET;
+    case OP_PUT_LOCATE:
+    case OP_PUT_RELEASE:
+      return IMCAS::LATENCY_OP_PUT_DIRECT;
+    case OP_GET_LOCATE:
+    case OP_GET_RELEASE:
+      return IMCAS::LATENCY_OP_GET_DIRECT;
+    case OP_ERASE:
+      return IMCAS::LATENCY_OP_ERASE;
+    case OP_MULTI_PUT:
+    case OP_MULTI_GET:
+    case OP_MULTI_ERASE:
+      return IMCAS::LATENCY_OP_MULTI;
+    default:
+      return IMCAS::LATENCY_OP_OTHER;
+    }
+  case MSG_TYPE::ADO_REQUEST:
+  case MSG_TYPE::PUT_ADO_REQUEST:
+    return IMCAS::LATENCY_OP_ADO;
+  case MSG_TYPE::INFO_REQUEST:
+    return IMCAS::LATENCY_OP_INFO;
+  default:
+    return IMCAS::LATENCY_OP_OTHER;
+  }
+}
+
 void Shard::process_message_pool_request(Connection_handler *handler,
                                          const protocol::Message_pool_request *msg)
 {
@@ -1076,7 +1283,7 @@ void Shard::io_response_get_locate(Connection_handler *handler,
 
   auto status = S_OK;
 
-  std::string k = msg->skey();
+  const auto k = msg->key_view();
 
   /* lock value */
   component::IKVStore::key_t key_handle;
@@ -1111,7 +1318,7 @@ void Shard::io_response_get_locate(Connection_handler *handler,
 
       /* record key for signaling */
       if (ado_signal_post_get())
-        add_target_keyname(target, k);
+        add_target_keyname(target, msg->skey());
     }
     catch ( const std::exception &e ) {
       PWRN("%s failed: %s", __func__, e.what());
@@ -1391,12 +1598,14 @@ void Shard::io_response_put(Connection_handler *handler, const protocol::Message
   }
   {
     int status = S_OK;
+    /* a put signalled to the ADO is answered by the ADO, outside any group */
+    const bool grouped = !msg->is_scbe() && !ado_signal_post_put() && group_commit_join(msg->pool_id());
     if (UNLIKELY(msg->is_scbe())) {
       // short-circuit backend - testing only
       CPLOG(2, "PUT: short-circuited backend");
     }
     else {
-      const std::string key = msg->skey();
+      const auto key = msg->key_view();
 
       status = _i_kvstore->put(msg->pool_id(), key, msg->value(), msg->get_value_len(), msg->flags());
 
@@ -1418,7 +1627,7 @@ void Shard::io_response_put(Connection_handler *handler, const protocol::Message
                    handler,
                    msg->request_id(),
                    msg->pool_id(),
-                   key,
+                   msg->skey(),
                    IKVStore::lock_type_t::STORE_LOCK_READ);
         /* note: client will be signalled on return of this ADO call,
            therefore if the ADO operation stalls, the client will be stalled too.
@@ -1429,7 +1638,7 @@ void Shard::io_response_put(Connection_handler *handler, const protocol::Message
     ++_stats.op_put_count;
 
     if (!ado_signal_post_put())
-      respond(handler, iob, msg, status, __func__);
+      group_commit_respond(handler, iob, msg, status, grouped, __func__);
   }
 }
 
@@ -1458,7 +1667,7 @@ void Shard::io_response_get(Connection_handler *handler, const protocol::Message
      */
     static constexpr std::size_t GET_DIRECT_THRESHOLD = KiB(128);
     static_assert(GET_DIRECT_THRESHOLD <= TWO_STAGE_THRESHOLD, "get_direct threshold must not exceed a single-message data size");
-    std::string k = msg->skey();
+    const auto k = msg->key_view();
 
     if ( ! ado_signal_post_get() )
     {
@@ -1544,7 +1753,7 @@ void Shard::io_response_get(Connection_handler *handler, const protocol::Message
                      handler,
                      msg->request_id(),
                      msg->pool_id(),
-                     k,
+                     msg->skey(),
                      IKVStore::lock_type_t::STORE_LOCK_READ,
                      true /* special 'get' response */);
         }
@@ -1593,7 +1802,7 @@ void Shard::io_response_get(Connection_handler *handler, const protocol::Message
                            handler,
                            msg->request_id(),
                            msg->pool_id(),
-                           k,
+                           msg->skey(),
                            IKVStore::lock_type_t::STORE_LOCK_READ,
                            true);
 
@@ -1626,7 +1835,7 @@ void Shard::io_response_get(Connection_handler *handler, const protocol::Message
 /////////////////////
 void Shard::io_response_erase(Connection_handler *handler, const protocol::Message_IO_request *msg, buffer_t *iob)
 {
-  std::string key = msg->skey();
+  const auto key = msg->key_view();
 
   status_t status;
 
@@ -1642,9 +1851,11 @@ void Shard::io_response_erase(Connection_handler *handler, const protocol::Messa
                             handler,
                             msg->request_id(),
                             msg->pool_id(),
-                            key);
+                            msg->skey());
   }
 
+  const bool grouped = group_commit_join(msg->pool_id());
+
   status = _i_kvstore->erase(msg->pool_id(), key);
 
   if (status == S_OK) {
@@ -1656,7 +1867,148 @@ void Shard::io_response_erase(Connection_handler *handler, const protocol::Messa
 
   _stats.op_erase_count++;
 
-  respond(handler, iob, msg, status, __func__);
+  group_commit_respond(handler, iob, msg, status, grouped, __func__);
+}
+
+/////////////////////////////////////////////////////////////////////////////
+//   MULTI PUT/GET/ERASE //
+/////////////////////
+void Shard::io_response_multi(Connection_handler *handler, const protocol::Message_IO_request *msg, buffer_t *iob)
+{
+  using multi_result = protocol::Message_IO_response::multi_result;
+  const auto op    = msg->op();
+  const auto count = msg->record_count();
+
+  CPLOG(2, "MULTI: (%p) op=%d records=%zu len=%zu request_id=%lu", common::p_fmt(this), int(op), count,
+        msg->records_len(), msg->request_id());
+
+  /* post-op ADO signals complete one client request per key, which a
+     single batched response cannot carry */
+  if ((op == protocol::OP_MULTI_PUT && ado_signal_post_put()) ||
+      (op == protocol::OP_MULTI_GET && ado_signal_post_get())) {
+    ++_stats.op_failed_request_count;
+    respond(handler, iob, msg, E_NOT_SUPPORTED, __func__);
+    return;
+  }
+
+  auto              response    = prepare_response(handler, iob, msg->request_id(), S_OK);
+  const std::size_t data_space  = handler->IO_buffer_size() - response->base_message_size();
+  const std::size_t results_len = count * sizeof(multi_result);
+
+  if (results_len > data_space || !protocol::Message_IO_request::would_fit(msg->records_len(), handler->IO_buffer_size())) {
+    ++_stats.op_failed_request_count;
+    respond(handler, iob, msg, E_INVAL, __func__);
+    return;
+  }
+
+  /* validate every record before any is applied, so that a malformed
+     request has no effect */
+  const auto end = msg->records_end();
+  _multi_keys.clear();
+  _multi_values.clear();
+  for (auto rec = msg->first_record(); _multi_keys.size() != count; rec = rec->next()) {
+    if (UNLIKELY(!rec->within(end))) {
+      PWRN("%s: malformed record %zu of %zu", __func__, _multi_keys.size(), count);
+      ++_stats.op_failed_request_count;
+      respond(handler, iob, msg, E_INVAL, __func__);
+      return;
+    }
+    _multi_keys.push_back(rec->key_view());
+    _multi_values.emplace_back(common::pointer_cast<const common::byte>(rec->value()), rec->value_len);
+  }
+
+  /* results are written in place */
+  auto        results   = common::pointer_cast<multi_result>(response->data());
+  auto        value_out = response->data() + results_len;
+  const auto  value_space = data_space - results_len;
+  std::size_t value_len = 0;
+
+  _multi_status.assign(count, S_OK);
+
+  switch (op) {
+  case protocol::OP_MULTI_PUT:
+    if (const auto rc = _i_kvstore->multi_put(msg->pool_id(), _multi_keys, _multi_values, msg->flags(), _multi_status))
+      _multi_status.assign(count, rc);
+    for (std::size_t i = 0; i != count; ++i) {
+      if (_multi_status[i] == S_OK) add_index_key(msg->pool_id(), _multi_keys[i]);
+      results[i].value_len = 0;
+    }
+    _stats.op_put_count += count;
+    break;
+  case protocol::OP_MULTI_GET:
+    multi_get_packed(msg->pool_id(), results, value_out, value_space, value_len);
+    _stats.op_get_count += count;
+    break;
+  default: /* OP_MULTI_ERASE: the store has no batched erase */
+    for (std::size_t i = 0; i != count; ++i) {
+      if (ado_signal_post_erase()) signal_ado_async_nolock("post-erase", handler, msg->request_id(), msg->pool_id(), std::string(common::pointer_cast<char>(_multi_keys[i].data()), _multi_keys[i].size()));
+      _multi_status[i] = _i_kvstore->erase(msg->pool_id(), _multi_keys[i]);
+      if (_multi_status[i] == S_OK) remove_index_key(msg->pool_id(), _multi_keys[i]);
+      results[i].value_len = 0;
+    }
+    _stats.op_erase_count += count;
+    break;
+  }
+
+  for (std::size_t i = 0; i != count; ++i) {
+    if (_multi_status[i] != S_OK) ++_stats.op_failed_request_count;
+    results[i].status = _multi_status[i];
+  }
+
+  response->set_data_len(results_len + value_len);
+  iob->set_length(response->msg_len());
+  handler->post_response(iob, response, __func__);
+}
+
+/* OP_MULTI_GET: read the values of _multi_keys into value_out, packed in key
+ * order.  The store reads all the keys in one batch, each into an equal
+ * share of the space, and the values are then compacted.  A value which
+ * did not fit its share, or whose share has been overwritten by earlier
+ * values, is read again singly into all of the remaining space, so the
+ * packing is as if each key were read in turn.  Values which do not fit
+ * the remaining space are reported as E_INSUFFICIENT_BUFFER; the client
+ * re-fetches them singly.
+ */
+void Shard::multi_get_packed(const pool_t                               pool,
+                             protocol::Message_IO_response::multi_result *results,
+                             std::uint8_t *                             value_out,
+                             const std::size_t                          value_space,
+                             std::size_t &                              value_len)
+{
+  const auto count = _multi_keys.size();
+  const auto share = count ? value_space / count : 0;
+
+  _multi_iovs.clear();
+  if (share != 0) {
+    for (std::size_t i = 0; i != count; ++i)
+      _multi_iovs.push_back(::iovec{value_out + i * share, share});
+    if (const auto rc = _i_kvstore->multi_get(pool, _multi_keys, _multi_iovs, _multi_status))
+      _multi_status.assign(count, rc);
+  }
+  else {
+    _multi_status.assign(count, E_INSUFFICIENT_BUFFER);
+  }
+
+  value_len = 0;
+  for (std::size_t i = 0; i != count; ++i) {
+    auto &      status = _multi_status[i];
+    std::size_t len    = 0;
+    /* values so far occupy [0, value_len) */
+    const bool share_intact = i * share >= value_len;
+
+    if (status == S_OK && share_intact) {
+      len = _multi_iovs[i].iov_len;
+      std::memmove(value_out + value_len, _multi_iovs[i].iov_base, len);
+    }
+    else if (status == S_OK || status == E_INSUFFICIENT_BUFFER) {
+      len    = value_space - value_len;
+      status = len ? _i_kvstore->get_direct(pool, _multi_keys[i], value_out + value_len, len) : E_INSUFFICIENT_BUFFER;
+      if (status != S_OK) len = 0;
+    }
+
+    value_len += len;
+    results[i].value_len = boost::numeric_cast<std::uint32_t>(len);
+  }
 }
 
 /////////////////////////////////////////////////////////////////////////////
@@ -1708,6 +2060,11 @@ void Shard::process_message_IO_request(Connection_handler *handler, const protoc
     case protocol::OP_ERASE:
       io_response_erase(handler, msg, iob);
       break;
+    case protocol::OP_MULTI_PUT:
+    case protocol::OP_MULTI_GET:
+    case protocol::OP_MULTI_ERASE:
+      io_response_multi(handler, msg, iob);
+      break;
     case protocol::OP_CONFIGURE:
       io_response_configure(handler, msg, iob);
       break;
@@ -1936,14 +2293,14 @@ void Shard::process_info_request(Connection_handler *handler, const protocol::Me
 {
   handler->msg_recv_log(msg, __func__);
 
-  if (msg->type() == protocol::INFO_TYPE_FIND_KEY) {
+  if (msg->type() == protocol::INFO_TYPE_FIND_KEY || msg->type() == protocol::INFO_TYPE_FIND_KEY_BATCH) {
     CPLOG(1, "Shard: INFO request INFO_TYPE_FIND_KEY (%s)", msg->c_str());
 
     if (_index_map == nullptr) { /* index does not exist */
       PLOG("Shard: cannot perform regex request, no index!! use "
            "configure('AddIndex::VolatileTree') or similar for dynamic loading ");
       const auto                       iob      = handler->allocate_send();
-      protocol::Message_INFO_response *response = new (iob->base()) protocol::Message_INFO_response(handler->auth_id());
+      protocol::Message_INFO_response *response = new (iob->base()) protocol::Message_INFO_response(handler->auth_id(), msg->request_id());
 
       response->set_status(E_INVAL);
       handler->post_send_buffer(iob, response, __func__);
@@ -1951,15 +2308,21 @@ void Shard::process_info_request(Connection_handler *handler, const protocol::Me
     }
 
     try {
-      add_task_list(new Key_find_task(msg->c_str(),
+      add_task_list(new Key_find_task(std::string(msg->key(), msg->key_len), /* range: holds a NUL */
                                       msg->offset,
                                       handler,
+                                      msg->request_id(),
                                       _index_map->at(msg->pool_id()).get(),
-                                      debug_level()));
+                                      debug_level(),
+                                      msg->type() == protocol::INFO_TYPE_FIND_KEY_BATCH
+                                        ? handler->IO_buffer_size() - sizeof(protocol::Message_INFO_response) - 1
+                                        : 0,
+                                      msg->limit));
+      _msg_deferred = true; /* timed to completion in process_tasks */
     }
     catch (...) {
       const auto                       iob      = handler->allocate_send();
-      protocol::Message_INFO_response *response = new (iob->base()) protocol::Message_INFO_response(handler->auth_id());
+      protocol::Message_INFO_response *response = new (iob->base()) protocol::Message_INFO_response(handler->auth_id(), msg->request_id());
 
       response->set_status(E_INVAL);
       handler->post_send_buffer(iob, response, __func__);
@@ -1975,18 +2338,24 @@ void Shard::process_info_request(Connection_handler *handler, const protocol::Me
   CPLOG(1, "Shard: INFO request type:0x%X", msg->type());
 
   /* stats request handler */
-  if (msg->type() == protocol::INFO_TYPE_GET_STATS) {
+  if (msg->type() == protocol::INFO_TYPE_GET_STATS || msg->type() == protocol::INFO_TYPE_GET_STATS_RESET) {
     protocol::Message_stats *response = new (iob->base()) protocol::Message_stats(handler->auth_id(), _stats);
     response->set_status(S_OK);
     iob->set_length(sizeof(protocol::Message_stats));
 
     if (debug_level() > 1) dump_stats();
 
+    /* reset-on-read, so that periodic scrapes each cover one interval */
+    if (msg->type() == protocol::INFO_TYPE_GET_STATS_RESET) {
+      for (auto &l : _stats.latency) l.reset();
+    }
+
     handler->post_send_buffer(iob, response, __func__);
+    return;
   }
 
   /* info requests */
-  protocol::Message_INFO_response *response = new (iob->base()) protocol::Message_INFO_response(handler->auth_id());
+  protocol::Message_INFO_response *response = new (iob->base()) protocol::Message_INFO_response(handler->auth_id(), msg->request_id());
 
   if (msg->type() == component::IKVStore::Attribute::COUNT) {
     response->set_value(_i_kvstore->count(msg->pool_id()));
@@ -1995,24 +2364,24 @@ void Shard::process_info_request(Connection_handler *handler, const protocol::Me
   }
   else if (msg->type() == component::IKVStore::Attribute::VALUE_LEN) {
     std::vector<uint64_t> v;
-    std::string           key = msg->key();
-    auto hr = _i_kvstore->get_attribute(msg->pool_id(), component::IKVStore::Attribute::VALUE_LEN, v, &key);
+    const auto            key = msg->key_view();
+    auto hr = _i_kvstore->get_attribute(msg->pool_id(), component::IKVStore::Attribute::VALUE_LEN, v, key);
     response->set_status(hr);
 
     if (hr == S_OK && v.size() == 1) {
       response->set_value(v[0]);
     }
     else {
-      PWRN("_i_kvstore->get_attribute failed for value_len (key=%s)", key.c_str());
+      PWRN("_i_kvstore->get_attribute failed for value_len (key=%s)", msg->key());
       response->set_value(0);
     }
     CPLOG(1, "Shard: INFO reqeust INFO_TYPE_VALUE_LEN rc=%d val=%lu", hr, response->value_numeric());
   }
   else {
     std::vector<uint64_t> v;
-    std::string           key = msg->key();
+    const auto            key = msg->key_view();
     auto                  hr =
-      _i_kvstore->get_attribute(msg->pool_id(), static_cast<component::IKVStore::Attribute>(msg->type()), v, &key);
+      _i_kvstore->get_attribute(msg->pool_id(), static_cast<component::IKVStore::Attribute>(msg->type()), v, key);
     response->set_status(hr);
 
     if (hr == S_OK && v.size() == 1) {
@@ -2055,40 +2424,73 @@ void Shard::process_info_request(Connection_handler *handler, const protocol::Me
 
 void Shard::process_tasks(unsigned &idle)
 {
- retry:
-  for (task_list_t::iterator i = _tasks.begin(); i != _tasks.end(); i++) {
-    auto t = *i;
-    assert(t);
-    idle = 0;
-
-    status_t s = t->do_work();
-    if (s != component::IKVStore::S_MORE) {
-      auto handler      = t->handler();
-      auto response_iob = handler->allocate_send();
-      assert(response_iob);
-      protocol::Message_INFO_response *response =
-        new (response_iob->base()) protocol::Message_INFO_response(handler->auth_id());
-
-      if (s == S_OK) {
-        response->set_value(response_iob->length(), t->get_result(), t->get_result_length(), t->matched_position());
-#if 0
-        response->offset = t->matched_position();
-#endif
-        response->set_status(S_OK);
-        response_iob->set_length(response->message_size());
-      }
-      else if (s == E_FAIL) {
-        response->set_status(E_FAIL);
-        response_iob->set_length(response->base_message_size());
-      }
-      else {
-        throw Logic_exception("unexpected task condition");
-      }
+  if (_tasks.empty()) return;
+  idle = 0;
+
+  _tasks.run(_task_budget_cycles, [this](Shard_task *t, status_t s) {
+    auto handler = t->handler();
+    if (!handler) return; /* background task: no response */
+
+    auto response_iob = handler->allocate_send();
+    assert(response_iob);
+    protocol::Message_INFO_response *response =
+      new (response_iob->base()) protocol::Message_INFO_response(handler->auth_id(), t->request_id());
+
+    if (s == S_OK) {
+      response->set_value(response_iob->length(), t->get_result(), t->get_result_length(), t->matched_position());
+      response->set_status(t->result_status());
+      response_iob->set_length(response->message_size());
+    }
+    else if (s == E_FAIL) {
+      response->set_status(E_FAIL);
+      response_iob->set_length(response->base_message_size());
+    }
+    else {
+      throw Logic_exception("unexpected task condition");
+    }
+
+    if (t->arrival())
+      _stats.latency[component::IMCAS::LATENCY_OP_INFO].total.record(cycles_to_ns(rdtsc() - t->arrival()));
 
-      handler->post_send_buffer(response_iob, response, __func__);
-      _tasks.erase(i);
+    handler->post_send_buffer(response_iob, response, __func__);
+  });
+}
+
+bool Shard::wait_for_new_connection(const std::chrono::milliseconds timeout)
+{
+  ::pollfd pfd{new_connection_fd(), POLLIN, 0};
+  auto     rc = ::poll(&pfd, 1, int(timeout.count()));
+  return rc > 0 && (pfd.revents & POLLIN);
+}
+
+void Shard::idle_block()
+{
+  /* One poll over the completion queues of every session and the new
+     connection fd, so that whichever is first wakes the shard.  If any
+     session cannot arm its wait, a completion may already be pending,
+     so do not block.  (The ADO channel is a shared memory queue with no
+     fd; the caller does not block while an ADO is attached.) */
+  assert(!_handlers.empty());
+  std::vector<int> cq_fds;
+  for (auto h : _handlers) {
+    if (!h->arm_completion_wait(cq_fds)) return;
+  }
 
-      goto retry;
+  std::vector<::pollfd> pfds;
+  pfds.reserve(cq_fds.size() + 1);
+  pfds.push_back(::pollfd{new_connection_fd(), POLLIN, 0});
+  for (auto fd : cq_fds) pfds.push_back(::pollfd{fd, POLLIN | POLLPRI, 0});
+
+  ++_stats.idle_block_count;
+  auto rc = ::poll(pfds.data(), pfds.size(), int(_idle_block_timeout.count()));
+
+  if (rc > 0 && (pfds[0].revents & POLLIN)) {
+    try {
+      check_for_new_connections();
+    }
+    catch (const std::exception &e) {
+      PERR("Shard: cannot get new connection: %s", e.what());
+      _thread_exit = true;
     }
   }
 }
@@ -2118,7 +2520,7 @@ status_t Shard::process_configure(const protocol::Message_IO_request *msg)
      way (as oppposed to via shard configuration) will
      cause a rebuild by iterating the key space in the main
      storage engine
-     e.g. AddIndex::rbtree, AddIndex::customtree
+     e.g. AddIndex::rbtree, AddIndex::ostree
   */
   if (command.substr(0, 10) == "AddIndex::") {
     std::string index_str = command.substr(10);
@@ -2153,32 +2555,14 @@ status_t Shard::process_configure(const protocol::Message_IO_request *msg)
     auto p = _index_map->insert(std::make_pair(msg->pool_id(), std::move(index))).first;
     factory.reset(nullptr);
 
-    CPLOG(1, "Shard: rebuilding secondary index ...");
-
-    status_t hr = S_OK;
-
-    /* optionally, iterate key space for rebuilding */
-    if(index && index->iterate_key_space_on_load()) {
-      if ((hr = _i_kvstore->map_keys(msg->pool_id(),
-                                     [p](const std::string &key)
-                                     {
-                                       p->second->insert(key);
-                                       return 0;
-                                     })) != S_OK) {
-
-        /* alternative when map_keys method optimization is not supported on main engine */
-        hr = _i_kvstore->map(msg->pool_id(),
-                             [p](const void *key,
-                                 const size_t key_len, const void *,  // value
-                                 const size_t) {  // value_len
-                               std::string k(static_cast<const char *>(key), key_len);
-                               p->second->insert(k);
-                               return 0;
-                             });
-      }
+    /* optionally, iterate key space for rebuilding, in the background */
+    if (p->second->iterate_key_space_on_load()) {
+      CPLOG(1, "Shard: rebuilding secondary index ...");
+      add_task_list(new Index_rebuild_task(_i_kvstore.get(), msg->pool_id(), p->second.get(), debug_level()),
+                    Shard_task::PRIORITY_BACKGROUND);
     }
 
-    return hr;
+    return S_OK;
   }
   else if (command == "RemoveIndex::") {
     try {
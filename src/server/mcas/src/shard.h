@@ -31,6 +31,7 @@
 #include <common/string_view.h>
 #include <common/perf/tm_fwd.h>
 
+#include <chrono>
 #include <csignal> /* sig_atomic_t */
 #include <list>
 #include <memory>
@@ -40,6 +41,7 @@
 #include <thread>
 #include <unordered_map>
 #include <future>
+#include <vector>
 
 #include "ado_map.h"
 #include "cluster_messages.h"
@@ -50,7 +52,9 @@
 #include "pool_manager.h"
 #include "range.h"
 #include "security.h"
+#include "task_index_rebuild.h"
 #include "task_key_find.h"
+#include "task_scheduler.h"
 #include "types.h"
 
 #include <nupm/mcas_mod.h>
@@ -136,7 +140,6 @@ class Shard : public Shard_transport, private common::log_source {
   using locked_value_map_t  = std::unordered_map<const void* , lock_info_t>;
   using spaces_shared_map_t = std::map<range<std::uint64_t>, space_lock_info_t>;
   using rename_map_t        = std::unordered_map<const void* , rename_info_t>;
-  using task_list_t         = std::list<Shard_task* >;
 
  public:
   using string_view = common::string_view;
@@ -217,8 +220,43 @@ class Shard : public Shard_transport, private common::log_source {
 
   void check_for_new_connections();
 
+  bool wait_for_new_connection(std::chrono::milliseconds timeout);
+
+  void idle_block();
+
   void main_loop(common::profiler &);
 
+  unsigned drain_pending_messages(Connection_handler *handler, common::profiler &pr);
+
+  /* latency accounting, see IMCAS::Shard_stats::latency */
+  static component::IMCAS::Latency_op latency_op(const protocol::Message *msg);
+
+  inline uint64_t cycles_to_ns(cpu_time_t cycles) const { return uint64_t(double(cycles) * _ns_per_cycle); }
+
+  /* group commit (config "group_commit"): puts and erases drained from one
+     connection leave common persistence work to the store's group commit,
+     and their responses are posted once the group commit ends */
+  struct Group_response {
+    Connection_handler *            handler;
+    buffer_t *                      iob;
+    protocol::Message_IO_response * response;
+    cpu_time_t                      arrival;
+    component::IMCAS::Latency_op    latency_op;
+  };
+
+  static bool is_group_commit_op(const protocol::Message *msg);
+
+  bool group_commit_join(const pool_t pool);
+
+  void group_commit_respond(Connection_handler *                 handler,
+                            buffer_t *                           iob,
+                            const protocol::Message_IO_request * msg,
+                            int                                  status,
+                            bool                                 grouped,
+                            const char *                         func);
+
+  void group_commit_close();
+
   /* message processing functions */
   void process_message_pool_request(Connection_handler *handler, const protocol::Message_pool_request *msg);
   void process_message_IO_request(Connection_handler *handler, const protocol::Message_IO_request *msg);
@@ -237,6 +275,12 @@ class Shard : public Shard_transport, private common::log_source {
   void io_response_put(Connection_handler *handler, const protocol::Message_IO_request *msg, buffer_t *iob);
   void io_response_get(Connection_handler *handler, const protocol::Message_IO_request *msg, buffer_t *iob);
   void io_response_erase(Connection_handler *handler, const protocol::Message_IO_request *msg, buffer_t *iob);
+  void io_response_multi(Connection_handler *handler, const protocol::Message_IO_request *msg, buffer_t *iob);
+  void multi_get_packed(pool_t                                       pool,
+                        protocol::Message_IO_response::multi_result *results,
+                        std::uint8_t *                               value_out,
+                        std::size_t                                  value_space,
+                        std::size_t &                                value_len);
   void io_response_configure(Connection_handler *handler, const protocol::Message_IO_request *msg, buffer_t *iob);
   void io_response_locate(Connection_handler *handler, const protocol::Message_IO_request *msg, buffer_t *iob);
   void io_response_release(Connection_handler *handler, const protocol::Message_IO_request *msg, buffer_t *iob);
@@ -290,13 +334,30 @@ class Shard : public Shard_transport, private common::log_source {
     if (index) index->insert(k);
   }
 
+  /* the index holds std::string keys: copy the view only if there is an index */
+  void add_index_key(const pool_t pool_id, const component::IKVStore::string_view_key k)
+  {
+    auto index = lookup_index(pool_id);
+    if (index) index->insert(component::IKVStore::to_key_string(k));
+  }
+
   void remove_index_key(const pool_t pool_id, const std::string &k)
   {
     auto index = lookup_index(pool_id);
     if (index) index->erase(k);
   }
 
-  inline void add_task_list(Shard_task *task) { _tasks.push_back(task); }
+  void remove_index_key(const pool_t pool_id, const component::IKVStore::string_view_key k)
+  {
+    auto index = lookup_index(pool_id);
+    if (index) index->erase(component::IKVStore::to_key_string(k));
+  }
+
+  inline void add_task_list(Shard_task *task, Shard_task::priority_t priority = Shard_task::PRIORITY_FOREGROUND)
+  {
+    task->set_arrival(_msg_arrival);
+    _tasks.add(task, priority);
+  }
 
   inline size_t session_count() const { return _handlers.size(); }
 
@@ -345,6 +406,28 @@ class Shard : public Shard_transport, private common::log_source {
     PINF("ADO count          : %lu (enabled=%s)", _stats.op_ado_count, ado_enabled() ? "yes" : "no");
     PINF("Failed count       : %lu", _stats.op_failed_request_count);
     PINF("Session count      : %lu", session_count());
+    PINF("Drain ticks        : %lu", _stats.drain_tick_count);
+    PINF("Drain mean depth   : %.2f", _stats.drain_tick_count ?
+         double(_stats.drain_msg_count) / double(_stats.drain_tick_count) : 0.0);
+    PINF("Drain max depth    : %lu", _stats.drain_max_depth);
+    PINF("Drain count limit  : %lu", _stats.drain_budget_count_exhausted);
+    PINF("Drain time limit   : %lu", _stats.drain_budget_time_exhausted);
+    PINF("Idle blocks        : %lu", _stats.idle_block_count);
+    PINF("Group commits      : %lu (mean %.2f ops)", _stats.group_commit_count, _stats.group_commit_count ?
+         double(_stats.group_commit_op_count) / double(_stats.group_commit_count) : 0.0);
+    static const char *latency_op_name[] = {"PUT", "GET", "PUT_DIRECT", "GET_DIRECT", "ERASE",
+                                            "MULTI", "ADO", "INFO", "OTHER"};
+    static_assert(sizeof latency_op_name / sizeof latency_op_name[0] == component::IMCAS::LATENCY_OP_COUNT,
+                  "latency op names out of step with Latency_op");
+    for (unsigned i = 0; i != component::IMCAS::LATENCY_OP_COUNT; ++i) {
+      const auto &l = _stats.latency[i];
+      if (l.total.count == 0) continue;
+      PINF("%-10s latency  : n=%lu wait p50/p99 %lu/%lu ns, store p50/p99 %lu/%lu ns, total p50/p99/max %lu/%lu/%lu ns",
+           latency_op_name[i], l.total.count,
+           l.wait.percentile(50.0), l.wait.percentile(99.0),
+           l.store.percentile(50.0), l.store.percentile(99.0),
+           l.total.percentile(50.0), l.total.percentile(99.0), l.total.max_ns);
+    }
     PINF("------------------------------------------------");
   }
 
@@ -358,6 +441,8 @@ class Shard : public Shard_transport, private common::log_source {
     component::IKVStore::lock_type_t lock_type;
     uint64_t                         request_id; /* original client request */
     uint32_t                         flags;
+    cpu_time_t                       arrival;    /* receipt of client request, 0 if not timed */
+    component::IMCAS::Latency_op     latency_op; /* class the response is timed under */
 
     inline bool is_async() const { return flags & component::IMCAS::ADO_FLAG_ASYNC; }
   };
@@ -418,6 +503,25 @@ class Shard : public Shard_transport, private common::log_source {
   bool                                              _forced_exit;
   unsigned                                          _core;
   size_t                                            _max_message_size;
+  const unsigned                                    _msg_budget;        /*< messages per connection per tick */
+  const cpu_time_t                                  _msg_budget_cycles; /*< time per connection per tick, 0 is unlimited */
+  const std::map<uint64_t, unsigned>                _msg_budget_weights; /*< drain weight by client auth id, default 1 */
+  size_t                                            _drain_next;        /*< first handler to drain in next tick */
+  const unsigned                                    _idle_poll_count;   /*< idle iterations before spinning */
+  const cpu_time_t                                  _idle_spin_cycles;  /*< idle spin time before blocking */
+  const cpu_time_t                                  _task_budget_cycles; /*< time running tasks per tick, 0 is one slice per task */
+  const std::chrono::milliseconds                   _idle_block_timeout; /*< longest single block, 0 disables blocking */
+  const double                                      _ns_per_cycle;       /*< rdtsc to nanoseconds, for latency histograms */
+  cpu_time_t                                        _msg_arrival;        /*< receipt of the message being processed */
+  component::IMCAS::Latency_op                      _msg_latency_op;     /*< class of the message being processed */
+  bool                                              _msg_deferred;       /*< its response waits on a task, the ADO or a group commit */
+  const unsigned                                    _group_commit_max;   /*< puts and erases per group commit, 0 disables */
+  std::vector<pool_t>                               _group_pools;        /*< pools with a group commit open */
+  std::vector<Group_response>                       _group_responses;    /*< responses waiting for the group commit */
+  std::vector<component::IKVStore::string_view_key> _multi_keys;         /*< keys of the multi-record request being processed */
+  std::vector<component::IKVStore::string_view_value> _multi_values;     /*< its values (OP_MULTI_PUT) */
+  std::vector<::iovec>                              _multi_iovs;         /*< its value buffers (OP_MULTI_GET) */
+  std::vector<status_t>                             _multi_status;       /*< its results from the store */
   component::Itf_ref<component::IKVStore>           _i_kvstore;
   component::Itf_ref<component::IADO_manager_proxy> _i_ado_mgr;    /*< null indicate non-ADO mode */
   Ado_pool_map                                      _ado_pool_map; /*< maps open pool handles to ADO proxy */
@@ -428,7 +532,7 @@ class Shard : public Shard_transport, private common::log_source {
   std::map<const void*, std::string>                _target_keyname_map;
   spaces_shared_map_t                               _spaces_shared;
   rename_map_t                                      _pending_renames;
-  task_list_t                                       _tasks; /*< list of deferred tasks */
+  Task_scheduler                                    _tasks; /*< deferred and background tasks */
   std::set<work_request_key_t>                      _outstanding_work;
   std::vector<work_request_t *>                     _failed_async_requests;
   const std::string                                 _ado_path;
@@ -275,10 +275,9 @@ void Shard::process_put_ado_request(Connection_handler* handler, const protocol:
   bool value_already_exists = false;
   if ((msg->flags & IMCAS::ADO_FLAG_NO_OVERWRITE) || (msg->flags & IMCAS::ADO_FLAG_DETACHED)) {
     std::vector<uint64_t> answer;
-    std::string           key(msg->key());
 
     /* check if key exists */
-    if (_i_kvstore->get_attribute(msg->pool_id(), IKVStore::Attribute::VALUE_LEN, answer, &key) !=
+    if (_i_kvstore->get_attribute(msg->pool_id(), IKVStore::Attribute::VALUE_LEN, answer, msg->key_view()) !=
         IKVStore::E_KEY_NOT_FOUND) {
       /* already exists */
       value_already_exists = true;
@@ -290,7 +289,7 @@ void Shard::process_put_ado_request(Connection_handler* handler, const protocol:
     value_len = msg->root_val_len;
 
     size_t alignment = 0;
-    status_t s = _i_kvstore->lock(msg->pool_id(), msg->key(), locktype, value, value_len, alignment, key_handle, &key_ptr);
+    status_t s = _i_kvstore->lock(msg->pool_id(), msg->key_view(), locktype, value, value_len, alignment, key_handle, &key_ptr);
     if (s < S_OK) {
       error_func("ADO!ALREADY_LOCKED");
       return;
@@ -327,7 +326,7 @@ void Shard::process_put_ado_request(Connection_handler* handler, const protocol:
   }
   else {
     /* write value passed with invocation message */
-    rc = _i_kvstore->put(msg->pool_id(), msg->key(), msg->value(), msg->value_len());
+    rc = _i_kvstore->put(msg->pool_id(), msg->key_view(), msg->value(), msg->value_len());
     if (rc != S_OK) throw Logic_exception("put_ado_invoke: put failed");
   }
 
@@ -337,7 +336,7 @@ void Shard::process_put_ado_request(Connection_handler* handler, const protocol:
   */
   if (!value) { /* now take the lock if not already locked */
     size_t alignment = 0;
-    if (_i_kvstore->lock(msg->pool_id(), msg->key(), locktype, value, value_len, alignment, key_handle, &key_ptr) != S_OK) {
+    if (_i_kvstore->lock(msg->pool_id(), msg->key_view(), locktype, value, value_len, alignment, key_handle, &key_ptr) != S_OK) {
       error_func("ADO!ALREADY_LOCKED(key)");
       return;
     }
@@ -348,7 +347,8 @@ void Shard::process_put_ado_request(Connection_handler* handler, const protocol:
 
   /* register outstanding work */
   work_request_t* wr = _wr_allocator.allocate();
-  *wr     = {handler, msg->pool_id(), key_handle, key_ptr, msg->get_key_len(), locktype, msg->request_id(), msg->flags};
+  *wr     = {handler, msg->pool_id(), key_handle, key_ptr, msg->get_key_len(), locktype, msg->request_id(), msg->flags,
+             _msg_arrival, _msg_latency_op};
 
   auto wr_key = reinterpret_cast<work_request_key_t>(wr); /* pointer to uint64_t */
   _outstanding_work.insert(wr_key);
@@ -360,6 +360,8 @@ void Shard::process_put_ado_request(Connection_handler* handler, const protocol:
                              msg->request(), msg->request_len(), new_root) != S_OK)
     throw General_exception("send_work_request failed");
 
+  _msg_deferred = !wr->is_async(); /* response is timed to work completion */
+
   CPLOG(2, "Shard_ado: sent work request (len=%lu, key=%lx)", msg->request_len(), wr_key);
 }
 
@@ -415,10 +417,9 @@ void Shard::process_ado_request(Connection_handler* handler,
     /* handle ADO_FLAG_CREATE_ONLY - no invocation to ADO is made */
     if (msg->flags & IMCAS::ADO_FLAG_CREATE_ONLY) {
       std::vector<uint64_t> answer;
-      std::string           key(msg->key(), msg->get_key_len());
 
       /* if pair exists, return with error */
-      if (_i_kvstore->get_attribute(msg->pool_id(), IKVStore::Attribute::VALUE_LEN, answer, &key) !=
+      if (_i_kvstore->get_attribute(msg->pool_id(), IKVStore::Attribute::VALUE_LEN, answer, msg->key_view()) !=
           IKVStore::E_KEY_NOT_FOUND) {
         error_func(E_ALREADY_EXISTS, "ADO!ALREADY_EXISTS");
 
@@ -434,7 +435,7 @@ void Shard::process_ado_request(Connection_handler* handler,
       size_t alignment = 0;
       
       status_t s = _i_kvstore->lock(msg->pool_id(),
-                                    msg->key(),
+                                    msg->key_view(),
                                     locktype,
                                     value,
                                     value_len,
@@ -489,7 +490,7 @@ void Shard::process_ado_request(Connection_handler* handler,
 
       size_t alignment = 0;
       s = _i_kvstore->lock(msg->pool_id(),
-                           msg->key(),
+                           msg->key_view(),
                            locktype,
                            value,
                            value_len,
@@ -519,7 +520,8 @@ void Shard::process_ado_request(Connection_handler* handler,
 
     /* register outstanding work */
     auto wr = _wr_allocator.allocate();
-    *wr     = {handler, msg->pool_id(), key_handle, key_ptr, msg->get_key_len(), locktype, msg->request_id(), msg->flags};
+    *wr     = {handler, msg->pool_id(), key_handle, key_ptr, msg->get_key_len(), locktype, msg->request_id(), msg->flags,
+             _msg_arrival, _msg_latency_op};
 
     auto wr_key = reinterpret_cast<work_request_key_t>(wr); /* pointer to uint64_t */
     _outstanding_work.insert(wr_key);                       /* save request by index on key-handle */
@@ -530,6 +532,8 @@ void Shard::process_ado_request(Connection_handler* handler,
                                0, msg->request(), msg->request_len(), (s == S_OK_CREATED)) != S_OK)
       throw General_exception("send_work_request failed");
 
+    _msg_deferred = !wr->is_async(); /* response is timed to work completion */
+
     CPLOG(2, "Shard_ado: sent work request (len=%lu, key=%lx, key_ptr=%p)",
           msg->request_len(), wr_key, static_cast<const void*>(key_ptr));
 
@@ -598,7 +602,9 @@ void Shard::signal_ado_async_nolock(const char * tag,
          key_len,
          IKVStore::lock_type_t::STORE_LOCK_NONE,
          client_request_id,
-         IMCAS::ADO_FLAG_ASYNC /* flag to indicate no reply */};
+         IMCAS::ADO_FLAG_ASYNC /* flag to indicate no reply */,
+         0 /* not timed */,
+         IMCAS::LATENCY_OP_OTHER};
 
   auto wr_key = reinterpret_cast<work_request_key_t>(wr); /* pointer to uint64_t */
   _outstanding_work.insert(wr_key); /* save request by index on key-handle */
@@ -669,7 +675,7 @@ void Shard::signal_ado(const char * tag,
 
   *wr = {handler, pool, key_handle, key_ptr,
          key_len, lock_type, client_request_id,
-         flags};
+         flags, _msg_arrival, _msg_latency_op};
 
   auto wr_key = reinterpret_cast<work_request_key_t>(wr); /* pointer to uint64_t */
   _outstanding_work.insert(wr_key); /* save request by index on key-handle */
@@ -687,6 +693,8 @@ void Shard::signal_ado(const char * tag,
                              false /* new root */) != S_OK)
     throw General_exception("send_work_request failed");
 
+  _msg_deferred = true; /* the IO response is timed to work completion */
+
   CPLOG(2, "Shard_ado: sent signal to ADO (value=%p value_len=%lu, key=%s %lu)",
         value, value_len, key_ptr, key_len);
 
@@ -802,6 +810,10 @@ void Shard::process_messages_from_ado()
       /* for sync, give response, unless the client is disconnected */
       else if (handler->client_connected()) {
 
+        /* the request (ADO or IO with ADO signal) completes here */
+        if (request_record->arrival)
+          _stats.latency[request_record->latency_op].total.record(cycles_to_ns(rdtsc() - request_record->arrival));
+
         auto iob = handler->allocate_send();
         assert(iob);
         assert(iob->base());
@@ -3,20 +3,51 @@
 
 namespace mcas
 {
+class Task_scheduler;
+
 class Shard_task {
+  friend class Task_scheduler;
+
  public:
-  Shard_task(Connection_handler* handler) : _handler(handler) {}
+  /* scheduling priority: foreground tasks (a client awaits the result)
+     run before background tasks (maintenance) */
+  enum priority_t : unsigned {
+    PRIORITY_FOREGROUND = 0,
+    PRIORITY_BACKGROUND = 1,
+    PRIORITY_COUNT,
+  };
+
+  Shard_task(Connection_handler* handler, uint64_t request_id = 0)
+      : _handler(handler), _request_id(request_id), _arrival(0),
+        _sched_prev(nullptr), _sched_next(nullptr), _sched_priority(PRIORITY_FOREGROUND)
+  {
+  }
   Shard_task(const Shard_task&) = delete;
   Shard_task& operator=(const Shard_task&)      = delete;
   virtual ~Shard_task()                         = default;
+  /* do a bounded slice of work; S_MORE to be called again */
   virtual status_t    do_work()                 = 0;
   virtual const void* get_result() const        = 0;
   virtual size_t      get_result_length() const = 0;
   virtual offset_t    matched_position() const  = 0;
+  /* status for the response once do_work has returned S_OK */
+  virtual status_t    result_status() const { return S_OK; }
+  /* null for background tasks, which send no response */
   Connection_handler* handler() const { return _handler; }
+  uint64_t            request_id() const { return _request_id; }
+  cpu_time_t          arrival() const { return _arrival; }
+  void                set_arrival(cpu_time_t arrival) { _arrival = arrival; }
+  priority_t          priority() const { return _sched_priority; }
 
  protected:
   Connection_handler* _handler;
+  uint64_t            _request_id; /* of the request, echoed in the response */
+  cpu_time_t          _arrival;    /* receipt of the request, 0 if not timed */
+
+ private:
+  Shard_task* _sched_prev; /* intrusive links, owned by Task_scheduler */
+  Shard_task* _sched_next;
+  priority_t  _sched_priority;
 };
 
 }  // namespace mcas
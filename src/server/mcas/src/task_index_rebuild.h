@@ -0,0 +1,119 @@
+#ifndef __mcas_SERVER_TASK_INDEX_REBUILD_H__
+#define __mcas_SERVER_TASK_INDEX_REBUILD_H__
+
+#include <api/kvindex_itf.h>
+#include <api/kvstore_itf.h>
+#include <common/logging.h>
+#include <gsl/pointers>
+#include <string>
+
+#include "task.h"
+
+namespace mcas
+{
+/**
+ * Background rebuild of a secondary index from the key space of a pool.
+ * Each slice maps a few objects of one partition of the pool, so that
+ * the shard continues to serve IO while the index is rebuilt.  Keys put
+ * or erased meanwhile are applied to the index by the shard as usual;
+ * index inserts are idempotent, so a partition disturbed by a change of
+ * pool layout is simply mapped again.
+ *
+ * Stores without map_partition are mapped in one (blocking) slice.
+ */
+class Index_rebuild_task : public Shard_task,
+                           private common::log_source
+{
+  static constexpr unsigned PARTITION_COUNT  = 16;
+  static constexpr size_t   OBJECTS_PER_WORK = 256;
+
+ public:
+  Index_rebuild_task(gsl::not_null<component::IKVStore*> store,
+                     const component::IKVStore::pool_t pool,
+                     gsl::not_null<component::IKVIndex*> index,
+                     const unsigned debug_level)
+      : Shard_task(nullptr),
+        log_source(debug_level),
+        _store(store),
+        _pool(pool),
+        _index(index),
+        _partition(0),
+        _cursor{},
+        _count(0)
+  {
+    _index->add_ref();
+  }
+
+  Index_rebuild_task(const Index_rebuild_task&) = delete;
+  Index_rebuild_task& operator=(const Index_rebuild_task&) = delete;
+
+  status_t do_work() override
+  {
+    using namespace component;
+
+    try {
+      auto hr = _store->map_partition(_pool, _partition, PARTITION_COUNT, _cursor, OBJECTS_PER_WORK,
+                                      [this](const void* key, const size_t key_len, const void*, const size_t) {
+                                        _index->insert(std::string(static_cast<const char*>(key), key_len));
+                                        ++_count;
+                                        return 0;
+                                      });
+      switch (hr) {
+      case S_OK:
+        _cursor = IKVStore::map_cursor_t();
+        if (++_partition != PARTITION_COUNT) return IKVStore::S_MORE;
+        CPLOG(1, "Shard: rebuilt secondary index (%lu keys)", _count);
+        return S_OK;
+      case IKVStore::S_MORE:
+        return IKVStore::S_MORE;
+      case E_ITERATOR_DISTURBED:
+        CPLOG(2, "Shard: index rebuild partition %u disturbed, restarting it", _partition);
+        _cursor = IKVStore::map_cursor_t();
+        return IKVStore::S_MORE;
+      case E_NOT_SUPPORTED:
+        return rebuild_all();
+      default:
+        PWRN("index rebuild on pool (%lx) stopped (%d)", _pool, hr);
+        return hr;
+      }
+    }
+    catch (...) {
+      return E_FAIL;
+    }
+  }
+
+  const void* get_result() const override { return nullptr; }
+
+  size_t get_result_length() const override { return 0; }
+
+  offset_t matched_position() const override { return 0; }
+
+ private:
+  status_t rebuild_all()
+  {
+    status_t hr;
+    if ((hr = _store->map_keys(_pool, [this](const std::string& key) {
+           _index->insert(key);
+           return 0;
+         })) != S_OK) {
+      /* alternative when map_keys method optimization is not supported on main engine */
+      hr = _store->map(_pool, [this](const void* key, const size_t key_len, const void*,  // value
+                                     const size_t) {                                       // value_len
+        _index->insert(std::string(static_cast<const char*>(key), key_len));
+        return 0;
+      });
+    }
+    CPLOG(1, "Shard: rebuilt secondary index (map, %d)", hr);
+    return hr;
+  }
+
+  component::IKVStore*                    _store;
+  const component::IKVStore::pool_t       _pool;
+  component::Itf_ref<component::IKVIndex> _index;
+  unsigned                                _partition;
+  component::IKVStore::map_cursor_t       _cursor;
+  size_t                                  _count;
+};
+
+}  // namespace mcas
+#endif  // __mcas_SERVER_TASK_INDEX_REBUILD_H__
@@ -6,6 +6,7 @@
 #include <unistd.h>
 #include <string>
 
+#include "protocol.h"
 #include "task.h"
 
 namespace mcas
@@ -14,11 +15,17 @@ namespace mcas
  * Key search task.  We limit the number of hops we search so as to bound
  * the worst case execution time.
  *
+ * In batch mode (INFO_TYPE_FIND_KEY_BATCH) matches are packed as key
+ * records until the response buffer or the key limit is reached, and
+ * the response carries the offset from which to continue.
  */
 class Key_find_task : public Shard_task,
                       private common::log_source
 {
-  static constexpr unsigned MAX_COMPARES_PER_WORK = 5;
+  /* a slice of work is short; the shard scheduler runs slices until its
+     per-tick budget is spent */
+  static constexpr unsigned MAX_COMPARES_PER_WORK = 64;
+  static constexpr unsigned MAX_FINDS_PER_WORK    = 8; /* batch mode */
 
  public:
 #pragma GCC diagnostic push
@@ -26,12 +33,19 @@ class Key_find_task : public Shard_task,
   Key_find_task(const std::string& expression,
                 const offset_t offset,
                 Connection_handler* handler,
+                const uint64_t request_id,
                 gsl::not_null<component::IKVIndex*> index,
-                const unsigned debug_level)
-      : Shard_task(handler),
+                const unsigned debug_level,
+                const size_t batch_bytes = 0, /* 0: one match per response */
+                const unsigned batch_limit = 0) /* 0: as many as fit */
+      : Shard_task(handler, request_id),
         log_source(debug_level),
         _offset(offset),
-        _index(index)
+        _index(index),
+        _batch_bytes(batch_bytes),
+        _batch_limit(batch_limit),
+        _batch_count(0),
+        _batch_status(S_OK)
   {
     using namespace component;
     _index->add_ref();
@@ -55,6 +69,10 @@ class Key_find_task : public Shard_task,
       _type = IKVIndex::FIND_TYPE_PREFIX;
       _expr = expression.substr(7);
     }
+    else if (expression.substr(0, 6) == "range:") {
+      _type = IKVIndex::FIND_TYPE_RANGE;
+      _expr = expression.substr(6); /* from, NUL, to */
+    }
     else
       throw Logic_exception("unhandled expression");
 
@@ -68,6 +86,8 @@ class Key_find_task : public Shard_task,
   {
     using namespace component;
 
+    if (_batch_bytes) return do_batch_work();
+
     status_t hr;
     try {
       hr = _index->find(_expr, _offset, _type, _offset, _out_key, MAX_COMPARES_PER_WORK);
@@ -96,14 +116,62 @@ class Key_find_task : public Shard_task,
 
   size_t get_result_length() const override { return _out_key.length(); }
 
+  /* batch mode: the offset from which to continue */
   offset_t matched_position() const override { return _offset; }
 
+  status_t result_status() const override { return _batch_status; }
+
  private:
+  status_t do_batch_work()
+  {
+    using namespace component;
+    using response_t = protocol::Message_INFO_response;
+
+    try {
+      for (unsigned i = 0; i != MAX_FINDS_PER_WORK; ++i) {
+        offset_t matched;
+        std::string key;
+        auto hr = _index->find(_expr, _offset, _type, matched, key, MAX_COMPARES_PER_WORK);
+
+        if (hr == E_MAX_REACHED) {
+          _offset = matched + 1;
+          continue;
+        }
+        if (hr != S_OK) { /* no more matches */
+          _batch_status = S_OK;
+          return S_OK;
+        }
+
+        if (_out_key.size() + response_t::key_record_size(key.size()) > _batch_bytes) {
+          if (_batch_count == 0) return E_FAIL; /* key alone exceeds the buffer */
+          _batch_status = S_MORE; /* continue from this key */
+          return S_OK;
+        }
+
+        response_t::append_key_record(_out_key, key);
+        _offset = matched + 1;
+
+        if (++_batch_count == _batch_limit) {
+          _batch_status = S_MORE;
+          return S_OK;
+        }
+      }
+    }
+    catch (...) {
+      return E_FAIL;
+    }
+    return component::IKVStore::S_MORE; /* come back next tick */
+  }
+
   std::string                             _expr;
   std::string                             _out_key;
   component::IKVIndex::find_t             _type;
   offset_t                                _offset;
   component::Itf_ref<component::IKVIndex> _index;
+  const size_t                            _batch_bytes;
+  const unsigned                          _batch_limit;
+  unsigned                                _batch_count;
+  status_t                                _batch_status;
 };
 
 }  // namespace mcas
@@ -0,0 +1,177 @@
+#ifndef __mcas_SERVER_TASK_SCHEDULER_H__
+#define __mcas_SERVER_TASK_SCHEDULER_H__
+
+#include <api/kvstore_itf.h>
+#include <common/cycles.h>
+#include <common/delete_copy.h>
+#include <common/logging.h> /* PWRN */
+
+#include <cassert>
+#include <cstddef>
+#include <exception>
+#include <memory>
+
+#include "task.h"
+
+namespace mcas
+{
+/**
+ * Shard-local cooperative scheduler for resumable tasks (index scans,
+ * maintenance).  Each shard tick runs task slices for a time budget, so
+ * that long-running tasks make progress without delaying IO.  A task
+ * whose do_work returns S_MORE is rotated to the back of its priority
+ * level; any other status completes it.  Foreground tasks run first; a
+ * lower level which is not empty still runs at least one slice per tick,
+ * so that it is not starved.
+ *
+ * Tasks are linked intrusively, so add and remove are O(1).  The
+ * scheduler owns the tasks it holds.
+ */
+class Task_scheduler {
+  using priority_t = Shard_task::priority_t;
+
+ public:
+  Task_scheduler() : _level{}, _size(0) {}
+  ~Task_scheduler() { clear(); }
+
+  DELETE_COPY(Task_scheduler);
+
+  void add(Shard_task* task, const priority_t priority = Shard_task::PRIORITY_FOREGROUND)
+  {
+    assert(task);
+    assert(priority < Shard_task::PRIORITY_COUNT);
+    task->_sched_priority = priority;
+    push_back(_level[priority], task);
+    ++_size;
+  }
+
+  /**
+   * Remove a task without running it; ownership passes to the caller
+   */
+  void remove(Shard_task* task)
+  {
+    unlink(_level[task->_sched_priority], task);
+    --_size;
+  }
+
+  void cancel(Shard_task* task)
+  {
+    remove(task);
+    delete task;
+  }
+
+  /**
+   * Cancel the tasks for which pred(task) is true, e.g. those of a
+   * closed connection
+   */
+  template <typename P>
+  void cancel_if(P pred)
+  {
+    for (auto& l : _level) {
+      for (auto t = l.head; t;) {
+        auto next = t->_sched_next;
+        if (pred(t)) cancel(t);
+        t = next;
+      }
+    }
+  }
+
+  void clear()
+  {
+    cancel_if([](const Shard_task*) { return true; });
+  }
+
+  bool   empty() const { return _size == 0; }
+  size_t size() const { return _size; }
+
+  /**
+   * Run task slices, highest priority first, for up to budget_cycles.
+   * With a budget of 0 each task runs one slice.  on_complete(task,
+   * status) is called for each task whose do_work returned other than
+   * S_MORE, or E_FAIL if do_work threw; the task is then deleted.
+   *
+   * @return Number of slices run
+   */
+  template <typename C>
+  unsigned run(const cpu_time_t budget_cycles, C&& on_complete)
+  {
+    const cpu_time_t start  = budget_cycles ? rdtsc() : 0;
+    unsigned         slices = 0;
+
+    for (auto& l : _level) {
+      std::size_t pass = l.size; /* slices left in this pass over the level */
+      for (unsigned n = 0; l.head; ++n) {
+        if (n != 0 && (budget_cycles ? (rdtsc() - start) > budget_cycles : pass == 0)) break;
+        if (pass == 0) pass = l.size;
+        --pass;
+
+        auto t = l.head;
+        unlink(l, t);
+        ++slices;
+
+        status_t s;
+        try {
+          s = t->do_work();
+        }
+        catch (const std::exception& e) {
+          PWRN("%s: task %p failed: %s", __func__, static_cast<const void*>(t), e.what());
+          s = E_FAIL;
+        }
+        catch (...) {
+          PWRN("%s: task %p failed", __func__, static_cast<const void*>(t));
+          s = E_FAIL;
+        }
+
+        if (s == component::IKVStore::S_MORE) {
+          push_back(l, t);
+          continue;
+        }
+
+        --_size;
+        std::unique_ptr<Shard_task> done(t);
+        on_complete(done.get(), s);
+      }
+    }
+    return slices;
+  }
+
+ private:
+  struct level_t {
+    Shard_task* head;
+    Shard_task* tail;
+    std::size_t size;
+  };
+
+  static void push_back(level_t& l, Shard_task* t)
+  {
+    t->_sched_prev = l.tail;
+    t->_sched_next = nullptr;
+    if (l.tail)
+      l.tail->_sched_next = t;
+    else
+      l.head = t;
+    l.tail = t;
+    ++l.size;
+  }
+
+  static void unlink(level_t& l, Shard_task* t)
+  {
+    if (t->_sched_prev)
+      t->_sched_prev->_sched_next = t->_sched_next;
+    else
+      l.head = t->_sched_next;
+    if (t->_sched_next)
+      t->_sched_next->_sched_prev = t->_sched_prev;
+    else
+      l.tail = t->_sched_prev;
+    t->_sched_prev = t->_sched_next = nullptr;
+    --l.size;
+  }
+
+  level_t     _level[Shard_task::PRIORITY_COUNT];
+  std::size_t _size;
+};
+
+}  // namespace mcas
+
+#endif  // __mcas_SERVER_TASK_SCHEDULER_H__
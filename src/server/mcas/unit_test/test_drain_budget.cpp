@@ -0,0 +1,142 @@
+/*
+   Copyright [2017-2021] [IBM Corporation]
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+       http://www.apache.org/licenses/LICENSE-2.0
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+/*
+ * The shard's per-connection message budget: weighted credit by count,
+ * and the time budget.
+ */
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Weffc++"
+#pragma GCC diagnostic ignored "-Wconversion"
+#pragma GCC diagnostic ignored "-Wsign-compare"
+#include <gtest/gtest.h>
+#pragma GCC diagnostic pop
+
+#include "drain_budget.h"
+
+#include <utility> /* pair */
+
+using mcas::Drain_budget;
+using mcas::Drain_credit;
+
+namespace
+{
+constexpr unsigned quantum = 32;
+
+/* messages drained before a limit is reached, one message per cycles_per_msg */
+std::pair<unsigned, Drain_budget::Limit> drain(const Drain_budget &budget_, unsigned pending_, cpu_time_t cycles_per_msg_)
+{
+  unsigned drained = 0;
+  for (; drained != pending_; ++drained) {
+    const auto limit = budget_.check(drained, drained * cycles_per_msg_);
+    if (limit != Drain_budget::Limit::NONE) return {drained, limit};
+  }
+  return {drained, Drain_budget::Limit::NONE};
+}
+
+TEST(Drain_budget_test, CountLimit)
+{
+  Drain_credit c;
+  const Drain_budget budget(c.credit(quantum), 0, 0);
+  EXPECT_FALSE(budget.timed());
+  const auto r = drain(budget, 1000, 1000000);
+  EXPECT_EQ(quantum, r.first);
+  EXPECT_EQ(Drain_budget::Limit::COUNT, r.second);
+}
+
+TEST(Drain_budget_test, TimeLimit)
+{
+  /* 10 cycles per message against a 95 cycle budget: the message starting
+     at cycle 100 is refused */
+  const Drain_budget budget(quantum, 95, 0);
+  EXPECT_TRUE(budget.timed());
+  const auto r = drain(budget, 1000, 10);
+  EXPECT_EQ(10U, r.first);
+  EXPECT_EQ(Drain_budget::Limit::TIME, r.second);
+}
+
+TEST(Drain_budget_test, TimeLimitAllowsOneMessage)
+{
+  const Drain_budget budget(quantum, 1, 0);
+  EXPECT_EQ(Drain_budget::Limit::NONE, budget.check(0, 1000));
+  EXPECT_EQ(Drain_budget::Limit::TIME, budget.check(1, 1000));
+}
+
+TEST(Drain_budget_test, CountBeforeTime)
+{
+  const Drain_budget budget(4, 1000, 0);
+  const auto r = drain(budget, 1000, 10);
+  EXPECT_EQ(4U, r.first);
+  EXPECT_EQ(Drain_budget::Limit::COUNT, r.second);
+}
+
+TEST(Drain_credit_test, Weight)
+{
+  Drain_credit c;
+  EXPECT_EQ(0U, c.weight());
+  EXPECT_EQ(quantum, c.credit(quantum)); /* unassigned: weight 1 */
+
+  Drain_credit w;
+  w.set_weight(3);
+  EXPECT_EQ(3U, w.weight());
+  EXPECT_EQ(3 * quantum, w.credit(quantum));
+
+  Drain_credit z;
+  z.set_weight(0);
+  EXPECT_EQ(1U, z.weight());
+}
+
+TEST(Drain_credit_test, CarryOverOneRound)
+{
+  Drain_credit c;
+  c.set_weight(2);
+  /* spend part of the credit with more pending: the rest carries over */
+  EXPECT_EQ(2 * quantum, c.credit(quantum));
+  c.charge(quantum / 2, true);
+  EXPECT_EQ(2 * quantum + 2 * quantum - quantum / 2, c.credit(quantum));
+  /* an unspent credit never exceeds two rounds */
+  c.charge(0, true);
+  EXPECT_EQ(4 * quantum, c.credit(quantum));
+  /* nothing left to drain: the credit is dropped */
+  c.charge(1, false);
+  EXPECT_EQ(2 * quantum, c.credit(quantum));
+}
+
+TEST(Drain_credit_test, WeightedShares)
+{
+  /* two busy connections of weights 1 and 3 drain in a 1:3 ratio */
+  Drain_credit a;
+  Drain_credit b;
+  a.set_weight(1);
+  b.set_weight(3);
+  unsigned total_a = 0;
+  unsigned total_b = 0;
+  for (unsigned tick = 0; tick != 100; ++tick) {
+    const auto na = drain(Drain_budget(a.credit(quantum), 0, 0), 1000, 1).first;
+    const auto nb = drain(Drain_budget(b.credit(quantum), 0, 0), 1000, 1).first;
+    a.charge(na, true);
+    b.charge(nb, true);
+    total_a += na;
+    total_b += nb;
+  }
+  EXPECT_EQ(100 * quantum, total_a);
+  EXPECT_EQ(3 * total_a, total_b);
+}
+}  // namespace
+
+int main(int argc, char **argv)
+{
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}